@@ -0,0 +1,94 @@
+/**
+ * @file pdc read delta の出力を展開するコマンド(ホスト用)
+ *        fcdecode <input> <output>
+ *        入力は "DATA delta ..." の行に続く圧縮データを含むファイル(行の前後にあるテキストは読み飛ばす)。
+ *        出力はキャプチャデータそのもの(pdc read raw と同じ内容)。
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "frame_codec_decode.h"
+
+/**
+ * @brief ヘッダ行の先頭
+ */
+#define HEADER_PREFIX "DATA delta "
+
+/**
+ * @brief エントリポイント
+ * @param ac 引数の数
+ * @param av 引数配列
+ * @return 成功した場合には0, 失敗した場合には1.
+ */
+int main(int ac, char** av)
+{
+    if (ac < 3)
+    {
+        fprintf(stderr, "usage: %s <input> <output>\n", av[0]);
+        return 1;
+    }
+
+    FILE* fp = fopen(av[1], "rb");
+    if (fp == NULL)
+    {
+        perror(av[1]);
+        return 1;
+    }
+    fseek(fp, 0, SEEK_END);
+    long file_size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    uint8_t* pin = (uint8_t*)(malloc((size_t)(file_size) + 1u));
+    if ((pin == NULL) || (fread(pin, 1, (size_t)(file_size), fp) != (size_t)(file_size)))
+    {
+        fprintf(stderr, "Could not read %s\n", av[1]);
+        fclose(fp);
+        return 1;
+    }
+    fclose(fp);
+    pin[file_size] = '\0';
+
+    // DATA delta <size> <width> <height> <bpp> ...
+    const char* pheader = NULL;
+    for (long i = 0; (i + (long)(strlen(HEADER_PREFIX))) <= file_size; i++)
+    {
+        if (memcmp(pin + i, HEADER_PREFIX, strlen(HEADER_PREFIX)) == 0)
+        {
+            pheader = (const char*)(pin + i);
+            break;
+        }
+    }
+    unsigned int size, width, height, bpp;
+    if ((pheader == NULL) || (sscanf(pheader, HEADER_PREFIX "%u %u %u %u", &size, &width, &height, &bpp) != 4))
+    {
+        fprintf(stderr, "Header not found.\n");
+        return 1;
+    }
+    const uint8_t* pdata = (const uint8_t*)(strchr(pheader, '\n'));
+    if ((pdata == NULL) || ((pdata + 1 + size) > (pin + file_size)))
+    {
+        fprintf(stderr, "Data is truncated.\n");
+        return 1;
+    }
+    pdata++;
+
+    uint32_t line_bytes = width * bpp;
+    uint8_t* pframe = (uint8_t*)(malloc((size_t)(line_bytes) * height));
+    if ((pframe == NULL) || (frame_codec_decode_frame(pframe, line_bytes, height, (uint8_t)(bpp), pdata, size) != (int32_t)(size)))
+    {
+        fprintf(stderr, "Could not decode.\n");
+        return 1;
+    }
+
+    fp = fopen(av[2], "wb");
+    if ((fp == NULL) || (fwrite(pframe, 1, (size_t)(line_bytes) * height, fp) != ((size_t)(line_bytes) * height)))
+    {
+        perror(av[2]);
+        return 1;
+    }
+    fclose(fp);
+    printf("%ux%u bpp=%u, %u -> %u bytes\n", width, height, bpp, size, line_bytes * height);
+
+    return 0;
+}
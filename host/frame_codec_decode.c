@@ -0,0 +1,105 @@
+/**
+ * @file フレーム圧縮データのデコーダ(ホスト用)定義
+ *        圧縮データの形式は src/frame_codec.h を参照。
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stddef.h>
+
+#include "../src/frame_codec.h"
+#include "frame_codec_decode.h"
+
+/**
+ * @brief 1ラインを展開する。
+ * @param pline 展開先(len バイト)
+ * @param pprev 展開済みの前のライン(先頭ラインの場合はNULL)
+ * @param len 1ラインのバイト数
+ * @param bpp 1ピクセルあたりのバイト数
+ * @param psrc 圧縮データ(ラインヘッダから)
+ * @param src_size 圧縮データの残りサイズ[byte]
+ * @return 読み取った圧縮データのサイズ[byte]。データが不正な場合は-1.
+ */
+int32_t frame_codec_decode_line(uint8_t* pline, const uint8_t* pprev, uint32_t len, uint8_t bpp, const uint8_t* psrc,
+                                uint32_t src_size)
+{
+    if ((src_size < FRAME_CODEC_LINE_HEADER_SIZE) || (bpp == 0u))
+    {
+        return -1;
+    }
+    uint8_t predictor = psrc[0];
+    uint32_t payload = (uint32_t)(psrc[1]) | ((uint32_t)(psrc[2]) << 8);
+    if ((predictor >= FRAME_CODEC_PREDICTOR_COUNT) || ((FRAME_CODEC_LINE_HEADER_SIZE + payload) > src_size))
+    {
+        return -1;
+    }
+
+    const uint8_t* rp = psrc + FRAME_CODEC_LINE_HEADER_SIZE;
+    const uint8_t* end = rp + payload;
+    uint32_t i = 0u;
+    while ((rp < end) && (i < len))
+    {
+        uint8_t ctrl = *rp;
+        rp++;
+        uint32_t count = (ctrl >= 0x80u) ? (uint32_t)(ctrl - 0x7Fu) : (uint32_t)(ctrl + 1u);
+        if (((i + count) > len) || ((ctrl < 0x80u) && ((rp + count) > end)))
+        {
+            return -1;
+        }
+        for (uint32_t n = 0u; n < count; n++, i++)
+        {
+            uint8_t residual = 0u;
+            if (ctrl < 0x80u)
+            {
+                residual = *rp;
+                rp++;
+            }
+
+            uint8_t prediction = 0u;
+            if (predictor == FRAME_CODEC_PREDICTOR_LEFT)
+            {
+                uint32_t distance = (bpp == 2u) ? (((i & 0x1u) == 0u) ? 2u : 4u) : bpp;
+                prediction = (i >= distance) ? pline[i - distance] : 0u;
+            }
+            else if (predictor == FRAME_CODEC_PREDICTOR_UP)
+            {
+                prediction = (pprev != NULL) ? pprev[i] : 0u;
+            }
+            pline[i] = (uint8_t)(prediction + residual);
+        }
+    }
+    if ((rp != end) || (i != len))
+    {
+        return -1;
+    }
+
+    return (int32_t)(FRAME_CODEC_LINE_HEADER_SIZE + payload);
+}
+
+/**
+ * @brief 1フレームを展開する。
+ * @param pframe 展開先(line_bytes * lines バイト)
+ * @param line_bytes 1ラインのバイト数
+ * @param lines ライン数
+ * @param bpp 1ピクセルあたりのバイト数
+ * @param psrc 圧縮データ
+ * @param src_size 圧縮データのサイズ[byte]
+ * @return 読み取った圧縮データのサイズ[byte]。データが不正な場合は-1.
+ */
+int32_t frame_codec_decode_frame(uint8_t* pframe, uint32_t line_bytes, uint32_t lines, uint8_t bpp, const uint8_t* psrc,
+                                 uint32_t src_size)
+{
+    uint32_t offset = 0u;
+
+    for (uint32_t y = 0u; y < lines; y++)
+    {
+        uint8_t* pline = pframe + ((size_t)(y) * line_bytes);
+        const uint8_t* pprev = (y > 0u) ? (pline - line_bytes) : NULL;
+        int32_t used = frame_codec_decode_line(pline, pprev, line_bytes, bpp, psrc + offset, src_size - offset);
+        if (used < 0)
+        {
+            return -1;
+        }
+        offset += (uint32_t)(used);
+    }
+
+    return (int32_t)(offset);
+}
@@ -0,0 +1,16 @@
+/**
+ * @file フレーム圧縮データのデコーダ(ホスト用)のインタフェース宣言
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+
+#ifndef FRAME_CODEC_DECODE_H_
+#define FRAME_CODEC_DECODE_H_
+
+#include <stdint.h>
+
+int32_t frame_codec_decode_line(uint8_t* pline, const uint8_t* pprev, uint32_t len, uint8_t bpp, const uint8_t* psrc,
+                                uint32_t src_size);
+int32_t frame_codec_decode_frame(uint8_t* pframe, uint32_t line_bytes, uint32_t lines, uint8_t bpp, const uint8_t* psrc,
+                                 uint32_t src_size);
+
+#endif /* FRAME_CODEC_DECODE_H_ */
@@ -0,0 +1,232 @@
+/**
+ * @file I2Cバスベンチマーク(シミュレーションスレーブ)のテスト(ホスト用)
+ *        i2c_bench_test
+ *        src/i2c_bench.c をホストでビルドし、シミュレーションスレーブに対して種別毎にベンチマークを実行して、
+ *        トランザクション数, 成功/NACK数, バス転送ビット数, 所要時間の下限を確認する。
+ *        また、i2c_bench_update() が1回あたり I2C_BENCH_UPDATE_MICROS 程度で戻る(メインループを止めない)ことを確認する。
+ *        時刻は hwtick_get_micros() を呼び出す毎に1マイクロ秒進む疑似時刻を使用する。
+ *        1つでも基準を満たさない場合は1を返す。
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <errno.h>
+
+#include "hwtick.h"
+#include "i2c.h"
+#include "i2c_bench.h"
+
+/**
+ * @brief 1種別あたりの実行回数
+ */
+#define BENCH_COUNT (200u)
+
+/**
+ * @brief シミュレーションスレーブのビットレート[bps]
+ */
+#define BENCH_BIT_RATE (100000u)
+
+/**
+ * @brief 1回の i2c_bench_update() の上限時間[マイクロ秒]
+ *        i2c_bench.c の I2C_BENCH_UPDATE_MICROS に、最後のトランザクション処理分の余裕を加えたもの。
+ */
+#define UPDATE_LIMIT_MICROS (2100u)
+
+/**
+ * @brief ベンチマーク完了までの最大 i2c_bench_update() 呼び出し回数
+ */
+#define MAX_UPDATES (100000u)
+
+/**
+ * @brief テストケース
+ */
+struct test_case
+{
+    uint8_t slave_addr;       // スレーブアドレス
+    enum i2c_bench_type type; // トランザクション種別
+    uint32_t bus_bits;        // 成功した1トランザクションのバス転送ビット数
+    bool is_nack;             // NACKになるかどうか
+};
+
+static int run_case(const struct test_case* pcase);
+static void on_bench_done(const struct i2c_bench_result* presult);
+
+//@formatter:off
+/**
+ * @brief テストケース
+ *        バス転送ビット数は、1バイトあたりACKを含めて9ビット, スタート/リピートスタート/ストップを各1ビットとする。
+ */
+static const struct test_case s_cases[] = {
+    { I2C_BENCH_SIM_SLAVE_ADDR,      I2C_BENCH_WRITE,      1u + 1u + (9u * 2u),                  false },
+    { I2C_BENCH_SIM_SLAVE_ADDR,      I2C_BENCH_READ,       1u + 1u + (9u * 3u),                  false },
+    { I2C_BENCH_SIM_SLAVE_ADDR,      I2C_BENCH_WRITE_READ, 1u + 1u + (9u * 2u) + 1u + (9u * 3u), false },
+    { I2C_BENCH_SIM_SLAVE_ADDR + 1u, I2C_BENCH_WRITE_READ, 0u,                                   true  },
+};
+//@formatter:on
+
+/**
+ * @brief 疑似時刻[マイクロ秒]
+ */
+static uint32_t s_now_micros;
+
+/**
+ * @brief 完了通知された回数
+ */
+static int s_done_count;
+
+/**
+ * @brief 完了通知された結果
+ */
+static struct i2c_bench_result s_result;
+
+/**
+ * @brief テストを実行する。
+ * @return 全てのテストケースが基準を満たした場合には0, それ以外は1.
+ */
+int main(void)
+{
+    int failures = 0;
+
+    i2c_bench_init();
+    i2c_bench_set_simulated(true);
+    if (i2c_bench_set_bitrate(BENCH_BIT_RATE) != 0)
+    {
+        printf("FAIL: could not set bit-rate\n");
+        return 1;
+    }
+    for (size_t i = 0u; i < (sizeof(s_cases) / sizeof(s_cases[0])); i++)
+    {
+        failures += run_case(&(s_cases[i]));
+    }
+    printf("%s: %d failure(s)\n", (failures == 0) ? "PASS" : "FAIL", failures);
+
+    return (failures == 0) ? 0 : 1;
+}
+
+/**
+ * @brief 1つのテストケースを実行し、結果を1行表示する。
+ * @param pcase テストケース
+ * @return 基準を満たした場合には0, それ以外は1.
+ */
+static int run_case(const struct test_case* pcase)
+{
+    const char* name = i2c_bench_type_name(pcase->type);
+
+    s_done_count = 0;
+    int retval = i2c_bench_start(pcase->slave_addr, pcase->type, BENCH_COUNT, on_bench_done);
+    if (retval != 0)
+    {
+        printf("%02x %-10s: FAIL start error (%d)\n", pcase->slave_addr, name, retval);
+        return 1;
+    }
+    if (i2c_bench_start(pcase->slave_addr, pcase->type, BENCH_COUNT, NULL) != EBUSY)
+    {
+        printf("%02x %-10s: FAIL second start was accepted\n", pcase->slave_addr, name);
+        return 1;
+    }
+
+    uint32_t updates = 0u;
+    uint32_t max_update_micros = 0u;
+    while (i2c_bench_is_running() && (updates < MAX_UPDATES))
+    {
+        uint32_t begin = s_now_micros;
+        i2c_bench_update();
+        uint32_t micros = s_now_micros - begin;
+        max_update_micros = (micros > max_update_micros) ? micros : max_update_micros;
+        updates++;
+    }
+
+    uint32_t expected_success = pcase->is_nack ? 0u : BENCH_COUNT;
+    uint32_t expected_nack = pcase->is_nack ? BENCH_COUNT : 0u;
+    uint32_t min_elapsed = (uint32_t)((uint64_t)(BENCH_COUNT) * pcase->bus_bits * 1000000u / BENCH_BIT_RATE);
+    bool is_passed = !i2c_bench_is_running() && (s_done_count == 1) && (s_result.count == BENCH_COUNT)
+                     && (s_result.success_count == expected_success) && (s_result.nack_count == expected_nack)
+                     && (s_result.timeout_count == 0u) && (s_result.error_count == 0u)
+                     && (s_result.bus_bits == (expected_success * pcase->bus_bits)) && (s_result.elapsed_micros >= min_elapsed)
+                     && (s_result.bit_rate == BENCH_BIT_RATE) && (updates > 1u) && (max_update_micros <= UPDATE_LIMIT_MICROS);
+
+    printf("%02x %-10s: %s %u/%u ok, %u nack, %u bits, %u us (min %u), %u updates (max %u us)\n", pcase->slave_addr, name,
+           is_passed ? "ok  " : "FAIL", s_result.success_count, s_result.count, s_result.nack_count, s_result.bus_bits,
+           s_result.elapsed_micros, min_elapsed, updates, max_update_micros);
+
+    return is_passed ? 0 : 1;
+}
+
+/**
+ * @brief ベンチマーク完了通知を受け取る。
+ * @param presult ベンチマーク結果
+ */
+static void on_bench_done(const struct i2c_bench_result* presult)
+{
+    s_result = *presult;
+    s_done_count++;
+
+    return;
+}
+
+/**
+ * @brief 疑似時刻[ミリ秒]を得る。
+ * @return 疑似時刻[ミリ秒]
+ */
+uint32_t hwtick_get(void)
+{
+    return s_now_micros / 1000u;
+}
+
+/**
+ * @brief 疑似時刻[マイクロ秒]を得る。呼び出す毎に1マイクロ秒進む。
+ * @return 疑似時刻[マイクロ秒]
+ */
+uint32_t hwtick_get_micros(void)
+{
+    s_now_micros++;
+
+    return s_now_micros;
+}
+
+/**
+ * @brief 実バスのビットレート設定(ホストでは使用しない)
+ * @param bit_rate ビットレート[bps]
+ * @return 常にEIO
+ */
+int i2c_set_bitrate(uint32_t bit_rate)
+{
+    return EIO;
+}
+
+/**
+ * @brief 実バスのビットレート取得(ホストでは使用しない)
+ * @return 常に0
+ */
+uint32_t i2c_get_bitrate(void)
+{
+    return 0u;
+}
+
+/**
+ * @brief 実バスの送信(ホストでは使用しない)
+ * @return 常にEIO
+ */
+int i2c_master_send_async(uint8_t slave_addr, uint8_t* tx_data, uint16_t tx_len, i2c_callback_func_t pcallback)
+{
+    return EIO;
+}
+
+/**
+ * @brief 実バスの送受信(ホストでは使用しない)
+ * @return 常にEIO
+ */
+int i2c_master_send_and_receive_async(uint8_t slave_addr, uint8_t* tx_data, uint16_t tx_len, uint8_t* rx_bufp, uint16_t rx_len,
+                                      i2c_callback_func_t pcallback)
+{
+    return EIO;
+}
+
+/**
+ * @brief 実バスの中止(ホストでは使用しない)
+ */
+void i2c_abort(void)
+{
+    return;
+}
@@ -0,0 +1,321 @@
+/**
+ * @file JPEGエンコーダの回帰テスト(ホスト用)
+ *        jpeg_test
+ *        固定の合成YUYVフレーム(単色, グラデーション, カラーバー, ノイズ)を src/jpeg_enc.c で品質毎に圧縮し、
+ *        リファレンスデコーダ(libjpeg)で展開して、PSNRの下限と圧縮サイズの上限を確認する。
+ *        PSNRは元のYUYVと、展開したYCbCrをYUYVに並べ直したデータとの間で計算する。
+ *        1つでも基準を満たさない場合は1を返す。
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <math.h>
+
+#include <jpeglib.h>
+
+#include "jpeg_enc.h"
+
+/**
+ * @brief テストフレームの幅[pixel]
+ */
+#define FRAME_WIDTH (320)
+
+/**
+ * @brief テストフレームの高さ[line]
+ */
+#define FRAME_HEIGHT (240)
+
+/**
+ * @brief テストフレームのサイズ[byte]
+ */
+#define FRAME_BYTES (FRAME_WIDTH * FRAME_HEIGHT * 2)
+
+/**
+ * @brief 誤差がない場合のPSNR[dB]
+ */
+#define PSNR_LOSSLESS (99.0)
+
+/**
+ * @brief テストフレーム
+ */
+enum frame_kind
+{
+    FRAME_KIND_FLAT = 0,  // 単色
+    FRAME_KIND_GRADIENT,  // 輝度の水平グラデーション, 色差の垂直グラデーション
+    FRAME_KIND_COLOR_BARS, // BT.601 8色のカラーバー
+    FRAME_KIND_NOISE,     // 一様ノイズ
+    FRAME_KIND_COUNT,     // テストフレーム数
+};
+
+/**
+ * @brief テストケース(フレームと品質毎の基準)
+ */
+struct test_case
+{
+    enum frame_kind kind; // テストフレーム
+    uint8_t quality;      // 品質
+    double min_psnr;      // PSNRの下限[dB]
+    uint32_t max_bytes;   // 圧縮サイズの上限[byte]
+};
+
+/**
+ * @brief libjpegのエラー通知先
+ */
+struct decode_error
+{
+    struct jpeg_error_mgr mgr; // libjpegのエラーマネージャ(先頭に置く)
+    jmp_buf jump;              // エラー時の戻り先
+};
+
+static void make_frame(uint8_t* pframe, enum frame_kind kind);
+static bool decode_jpeg(const uint8_t* pjpeg, uint32_t len, uint8_t* pyuyv);
+static void on_decode_error(j_common_ptr cinfo);
+static double calc_psnr(const uint8_t* pa, const uint8_t* pb, uint32_t len);
+
+/**
+ * @brief テストフレーム名
+ */
+static const char* const s_frame_names[FRAME_KIND_COUNT] = {"flat", "gradient", "color-bars", "noise"};
+
+//@formatter:off
+/**
+ * @brief テストケース
+ *        基準は現在のエンコーダの結果に余裕(PSNRは約0.5dB, サイズは約10%)を持たせて決めている。
+ *        エンコーダを変更して結果が良くなった場合は、基準も合わせて厳しくする。
+ */
+static const struct test_case s_cases[] = {
+    { FRAME_KIND_FLAT,       50, 50.5,   2400u },
+    { FRAME_KIND_FLAT,       75, 98.5,   2400u },
+    { FRAME_KIND_FLAT,       90, 98.5,   2400u },
+    { FRAME_KIND_GRADIENT,   50, 49.9,   4300u },
+    { FRAME_KIND_GRADIENT,   75, 52.6,   5100u },
+    { FRAME_KIND_GRADIENT,   90, 58.4,   7100u },
+    { FRAME_KIND_COLOR_BARS, 50, 45.5,   4100u },
+    { FRAME_KIND_COLOR_BARS, 75, 49.1,   5000u },
+    { FRAME_KIND_COLOR_BARS, 90, 57.3,   6000u },
+    { FRAME_KIND_NOISE,      50, 20.8,  65400u },
+    { FRAME_KIND_NOISE,      75, 26.6,  88600u },
+    { FRAME_KIND_NOISE,      90, 34.4, 127000u },
+};
+
+/**
+ * @brief カラーバーの色(Y, Cb, Cr) 白, 黄, シアン, 緑, マゼンタ, 赤, 青, 黒
+ */
+static const uint8_t s_color_bars[8][3] = {
+    { 235, 128, 128 }, { 210,  16, 146 }, { 170, 166,  16 }, { 145,  54,  34 },
+    { 106, 202, 222 }, {  81,  90, 240 }, {  41, 240, 110 }, {  16, 128, 128 },
+};
+//@formatter:on
+
+/**
+ * @brief 元のフレーム
+ */
+static uint8_t s_frame[FRAME_BYTES];
+
+/**
+ * @brief 展開したフレーム(YUYV)
+ */
+static uint8_t s_decoded[FRAME_BYTES];
+
+/**
+ * @brief 圧縮データ(元のフレームより大きくなる場合に備えて2倍)
+ */
+static uint8_t s_jpeg[FRAME_BYTES * 2];
+
+/**
+ * @brief エントリポイント
+ * @return 全てのテストケースが基準を満たした場合には0, それ以外は1.
+ */
+int main(void)
+{
+    int failures = 0;
+
+    for (size_t i = 0u; i < (sizeof(s_cases) / sizeof(s_cases[0])); i++)
+    {
+        const struct test_case* pcase = &(s_cases[i]);
+        make_frame(s_frame, pcase->kind);
+
+        uint32_t len = 0u;
+        int retval = jpeg_enc_begin(s_jpeg, sizeof(s_jpeg), FRAME_WIDTH, FRAME_HEIGHT, pcase->quality);
+        for (uint32_t y = 0u; (retval == 0) && (y < FRAME_HEIGHT); y += JPEG_ENC_MCU_HEIGHT)
+        {
+            retval = jpeg_enc_encode_stripe(s_frame + (y * FRAME_WIDTH * 2u), FRAME_WIDTH * 2u);
+        }
+        if (retval == 0)
+        {
+            retval = jpeg_enc_end(&len);
+        }
+        if (retval != 0)
+        {
+            printf("%-10s q=%3u: FAIL encode error (%d)\n", s_frame_names[pcase->kind], pcase->quality, retval);
+            failures++;
+            continue;
+        }
+        if (!decode_jpeg(s_jpeg, len, s_decoded))
+        {
+            printf("%-10s q=%3u: FAIL decode error\n", s_frame_names[pcase->kind], pcase->quality);
+            failures++;
+            continue;
+        }
+
+        double psnr = calc_psnr(s_frame, s_decoded, FRAME_BYTES);
+        bool is_passed = (psnr >= pcase->min_psnr) && (len <= pcase->max_bytes);
+        printf("%-10s q=%3u: %s PSNR %6.2f dB (min %6.2f), %6u bytes (max %6u)\n", s_frame_names[pcase->kind],
+               pcase->quality, is_passed ? "ok  " : "FAIL", psnr, pcase->min_psnr, len, pcase->max_bytes);
+        if (!is_passed)
+        {
+            failures++;
+        }
+    }
+
+    printf("%s: %d failure(s)\n", (failures == 0) ? "PASS" : "FAIL", failures);
+
+    return (failures == 0) ? 0 : 1;
+}
+
+/**
+ * @brief テストフレーム(YUYV)を生成する。乱数は固定の初期値から生成するため、毎回同じになる。
+ * @param pframe 出力先
+ * @param kind テストフレーム
+ */
+static void make_frame(uint8_t* pframe, enum frame_kind kind)
+{
+    uint32_t seed = 0x12345678u;
+
+    for (uint32_t y = 0u; y < FRAME_HEIGHT; y++)
+    {
+        for (uint32_t x = 0u; x < FRAME_WIDTH; x += 2u)
+        {
+            uint8_t* pword = pframe + (((y * FRAME_WIDTH) + x) * 2u);
+            switch (kind)
+            {
+            case FRAME_KIND_GRADIENT: {
+                pword[0] = (uint8_t)((x * 255u) / (FRAME_WIDTH - 1u));
+                pword[1] = (uint8_t)(16u + ((y * 224u) / (FRAME_HEIGHT - 1u)));
+                pword[2] = (uint8_t)(((x + 1u) * 255u) / (FRAME_WIDTH - 1u));
+                pword[3] = (uint8_t)(240u - ((y * 224u) / (FRAME_HEIGHT - 1u)));
+                break;
+            }
+            case FRAME_KIND_COLOR_BARS: {
+                const uint8_t* pcolor = s_color_bars[(x * 8u) / FRAME_WIDTH];
+                pword[0] = pcolor[0];
+                pword[1] = pcolor[1];
+                pword[2] = pcolor[0];
+                pword[3] = pcolor[2];
+                break;
+            }
+            case FRAME_KIND_NOISE: {
+                for (int i = 0; i < 4; i++)
+                {
+                    seed ^= seed << 13; // xorshift32
+                    seed ^= seed >> 17;
+                    seed ^= seed << 5;
+                    pword[i] = (uint8_t)(seed >> 24);
+                }
+                break;
+            }
+            case FRAME_KIND_FLAT:
+            default: {
+                pword[0] = 100u;
+                pword[1] = 140u;
+                pword[2] = 100u;
+                pword[3] = 110u;
+                break;
+            }
+            }
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief libjpegでJPEGを展開し、YUYVに並べ直す。
+ *        色差は補間せずに展開し(do_fancy_upsampling = FALSE)、偶数ピクセルの値を使う。
+ * @param pjpeg 圧縮データ
+ * @param len 圧縮データのサイズ[byte]
+ * @param pyuyv 出力先(FRAME_BYTES)
+ * @return 成功した場合にはtrue, 失敗した場合にはfalse.
+ */
+static bool decode_jpeg(const uint8_t* pjpeg, uint32_t len, uint8_t* pyuyv)
+{
+    struct jpeg_decompress_struct cinfo;
+    struct decode_error error;
+    static uint8_t line[FRAME_WIDTH * 3];
+
+    cinfo.err = jpeg_std_error(&(error.mgr));
+    error.mgr.error_exit = on_decode_error;
+    if (setjmp(error.jump) != 0)
+    {
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, (unsigned char*)(pjpeg), len);
+    jpeg_read_header(&cinfo, TRUE);
+    cinfo.out_color_space = JCS_YCbCr;
+    cinfo.do_fancy_upsampling = FALSE;
+    jpeg_start_decompress(&cinfo);
+    if ((cinfo.output_width != FRAME_WIDTH) || (cinfo.output_height != FRAME_HEIGHT) || (cinfo.output_components != 3))
+    {
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+
+    while (cinfo.output_scanline < cinfo.output_height)
+    {
+        uint8_t* pdst = pyuyv + (cinfo.output_scanline * FRAME_WIDTH * 2u);
+        JSAMPROW row = line;
+        jpeg_read_scanlines(&cinfo, &row, 1);
+        for (uint32_t x = 0u; x < FRAME_WIDTH; x += 2u)
+        {
+            pdst[(x * 2u) + 0u] = line[(x * 3u) + 0u];
+            pdst[(x * 2u) + 1u] = line[(x * 3u) + 1u];
+            pdst[(x * 2u) + 2u] = line[(x * 3u) + 3u];
+            pdst[(x * 2u) + 3u] = line[(x * 3u) + 2u];
+        }
+    }
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+
+    return true;
+}
+
+/**
+ * @brief libjpegのエラー通知を受け取る。メッセージを表示して decode_jpeg() に戻る。
+ * @param cinfo libjpegの共通構造体
+ */
+static void on_decode_error(j_common_ptr cinfo)
+{
+    struct decode_error* perror = (struct decode_error*)(cinfo->err);
+    (*cinfo->err->output_message)(cinfo);
+    longjmp(perror->jump, 1);
+}
+
+/**
+ * @brief 2つのデータ間のPSNRを計算する。
+ * @param pa データ
+ * @param pb データ
+ * @param len サイズ[byte]
+ * @return PSNR[dB] (誤差がない場合は PSNR_LOSSLESS)
+ */
+static double calc_psnr(const uint8_t* pa, const uint8_t* pb, uint32_t len)
+{
+    uint64_t sq_sum = 0u;
+
+    for (uint32_t i = 0u; i < len; i++)
+    {
+        int32_t diff = (int32_t)(pa[i]) - (int32_t)(pb[i]);
+        sq_sum += (uint64_t)(diff * diff);
+    }
+    if (sq_sum == 0u)
+    {
+        return PSNR_LOSSLESS;
+    }
+    double mse = (double)(sq_sum) / len;
+
+    return 10.0 * log10((255.0 * 255.0) / mse);
+}
@@ -0,0 +1,445 @@
+/**
+ * @file バス競合ベンチマーク定義
+ *        DMACでRAM1(内蔵RAM, 0x00000000〜)とRAM2(拡張RAM, 0x00800000〜)に書き込みながら、
+ *        GLCDCのスキャンアウト, CPUのmemcpy, USB CDCの送信を同時に実行し、
+ *        DMA転送速度, 負荷なしの場合からの転送時間の増加(ストール時間), 割り込み応答時間を測定する。
+ *        DMA転送はPDCのキャプチャと同じく、転送元アドレス固定, 転送先アドレス加算の32bit転送で行う。
+ *        (転送元は転送先と同じ領域に置く)
+ *        割り込み応答時間は、ソフトウェア割り込み(SWINT)を要求してから割り込みハンドラに入るまでの時間を、
+ *        DMA転送中に繰り返し測定する。
+ *        RAM2はキャプチャバッファを使用するため、キャプチャ中, パススルー表示中は実行できない。(キャプチャデータは上書きされる)
+ *        測定中はテスト信号出力とGR2の表示を変更し、終了時に元に戻す。
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+
+#include <platform.h>
+#include <r_smc_entry.h>
+
+#include "hwtick.h"
+#include "usb_cdc.h"
+#include "dmac.h"
+#include "memop.h"
+#include "memmap.h"
+#include "pdc.h"
+#include "test_signal.h"
+#include "bus_bench.h"
+
+/**
+ * @brief 1回のDMA転送のタイムアウト時間[ミリ秒]
+ */
+#define DMA_TIMEOUT_MILLIS (100)
+
+/**
+ * @brief GLCDCの出力開始後, 停止後の待ち時間[ミリ秒]
+ *        GR2の設定は次のVSyncで反映されるため、最も遅いプロファイルで2フレーム分待つ。
+ */
+#define GLCDC_SETTLE_MILLIS (120)
+
+/**
+ * @brief CPU負荷で1回にコピーするサイズ[byte]
+ */
+#define CPU_COPY_CHUNK (1024)
+
+/**
+ * @brief USB負荷で1回に送信キューに入れるサイズ[byte]
+ */
+#define USB_WRITE_CHUNK (64)
+
+/**
+ * @brief SWINT割り込みプライオリティ
+ *        他の割り込みによる待ちを含めないよう、高めにする。
+ */
+#define SWINT_INTERRUPT_PRIORITY (14)
+
+/**
+ * @brief RAM2のGR2プレビュー領域のサイズ[byte] (キャプチャバッファの先頭から)
+ */
+#define RAM2_PREVIEW_AREA_SIZE (256u * 1024u)
+
+/**
+ * @brief RAM2のDMA転送先のオフセット[byte]
+ */
+#define RAM2_DMA_OFFSET (RAM2_PREVIEW_AREA_SIZE)
+
+/**
+ * @brief RAM2のCPUコピー領域のオフセット[byte]
+ */
+#define RAM2_CPU_OFFSET (RAM2_DMA_OFFSET + BUS_BENCH_MAX_SIZE)
+
+/**
+ * @brief RAM2のDMA転送元のオフセット[byte]
+ */
+#define RAM2_SOURCE_OFFSET (RAM2_CPU_OFFSET + (CPU_COPY_CHUNK * 2))
+
+/**
+ * @brief GLCDCのラインオフセットの単位[byte]
+ */
+#define PREVIEW_WIDTH_ALIGN (64)
+
+/**
+ * @brief 転送先の領域
+ */
+struct bus_region
+{
+    const char* name;   // 領域名
+    uint8_t* pdma_dst;  // DMA転送先
+    uint32_t* psource;  // DMA転送元(アドレス固定)
+    uint8_t* pcpu_area; // CPUコピー領域(CPU_COPY_CHUNK * 2)
+};
+
+static void setup_regions(void);
+static bool run_dma(const struct bus_region* pregion, uint8_t loads, struct bus_bench_entry* pentry);
+static bool set_glcdc_load(bool is_enabled);
+static void request_irq_sample(void);
+
+/**
+ * @brief 負荷条件
+ */
+//@formatter:off
+static const uint8_t s_loads[BUS_BENCH_LOAD_COUNT] = {
+    BUS_BENCH_LOAD_NONE,
+    BUS_BENCH_LOAD_GLCDC,
+    BUS_BENCH_LOAD_CPU,
+    BUS_BENCH_LOAD_USB,
+    BUS_BENCH_LOAD_GLCDC | BUS_BENCH_LOAD_CPU | BUS_BENCH_LOAD_USB,
+};
+//@formatter:on
+
+/**
+ * @brief RAM1のDMA転送先
+ */
+static uint8_t s_ram1_dma_buf[BUS_BENCH_MAX_SIZE] __attribute__((aligned(4)));
+
+/**
+ * @brief RAM1のCPUコピー領域
+ */
+static uint8_t s_ram1_cpu_buf[CPU_COPY_CHUNK * 2] __attribute__((aligned(4)));
+
+/**
+ * @brief RAM1のDMA転送元
+ */
+static uint32_t s_ram1_source;
+
+/**
+ * @brief USB負荷の送信データ(端末に表示されないようNUL文字にする)
+ */
+static const uint8_t s_usb_filler[USB_WRITE_CHUNK];
+
+/**
+ * @brief 転送先の領域
+ */
+static struct bus_region s_regions[BUS_BENCH_REGION_COUNT];
+
+/**
+ * @brief 使用するDMACチャネルのレジスタ
+ */
+static volatile struct st_dmac1* s_pregs;
+
+/**
+ * @brief 使用するDMACチャネル番号
+ */
+static int s_channel;
+
+/**
+ * @brief 1回のDMA転送サイズ[byte]
+ */
+static uint32_t s_size;
+
+/**
+ * @brief 割り込み応答時間を測定中の結果
+ */
+static struct bus_bench_entry* volatile s_pirq_entry;
+
+/**
+ * @brief SWINTを要求した時刻[マイクロ秒]
+ */
+static volatile uint32_t s_irq_request_micros;
+
+/**
+ * @brief SWINTの応答待ちかどうか
+ */
+static volatile bool s_is_irq_pending;
+
+/**
+ * @brief バス競合ベンチマークを実行する。
+ *        全ての測定が完了してから戻る。
+ * @param size 1回のDMA転送サイズ[byte] (4の倍数, BUS_BENCH_MAX_SIZE 以下)
+ * @param rounds 条件毎の繰り返し回数
+ * @param presult 測定結果を格納する構造体
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int bus_bench_run(uint32_t size, uint32_t rounds, struct bus_bench_result* presult)
+{
+    if ((size == 0u) || ((size % 4u) != 0u) || (size > BUS_BENCH_MAX_SIZE) || (rounds == 0u) || (rounds > BUS_BENCH_MAX_ROUNDS))
+    {
+        return EINVAL;
+    }
+    if (pdc_get_capture_buffer_size() < (RAM2_SOURCE_OFFSET + sizeof(uint32_t)))
+    {
+        return ENOMEM;
+    }
+    if (pdc_is_busy() || test_signal_is_preview() || memop_is_busy())
+    {
+        return EBUSY;
+    }
+
+    s_channel = dmac_claim("bus-bench", DMAC_PRIORITY_HIGH, 0u, NULL);
+    s_pregs = dmac_get_regs(s_channel);
+    if (s_pregs == NULL)
+    {
+        return EBUSY;
+    }
+    dmac_set_activation_source(s_channel, 0u);
+    s_pregs->DMTMD.WORD = _0000_DMAC_TRANS_MODE_NORMAL | _2000_DMAC_REPEAT_AREA_NONE | _0200_DMAC_TRANS_DATA_SIZE_32
+                          | _0000_DMAC_TRANS_REQ_SOURCE_SOFTWARE;
+    s_pregs->DMAMD.WORD = _0000_DMAC_SRC_ADDR_UPDATE_FIXED | _0080_DMAC_DST_ADDR_UPDATE_INCREMENT;
+    s_pregs->DMINT.BYTE = _00_DMAC_TRANS_END_INT_DISABLE; // 完了はDTEをポーリングして検出する。
+    s_pregs->DMCSL.BYTE = _00_DMAC_INT_TRIGGER_FLAG_CLEAR;
+
+    memset(presult, 0, sizeof(struct bus_bench_result));
+    presult->size = size;
+    presult->rounds = rounds;
+    presult->dma_channel = s_channel;
+    s_size = size;
+    setup_regions();
+
+    bool saved_output = test_signal_is_output();
+    IPR(ICU, SWINT) = SWINT_INTERRUPT_PRIORITY;
+    IR(ICU, SWINT) = 0U;
+    IEN(ICU, SWINT) = 1U;
+
+    for (int r = 0; r < BUS_BENCH_REGION_COUNT; r++)
+    {
+        uint32_t idle_micros = 0u;
+        for (int l = 0; l < BUS_BENCH_LOAD_COUNT; l++)
+        {
+            struct bus_bench_entry* pentry = &(presult->entries[presult->entry_count]);
+            presult->entry_count++;
+            pentry->region = s_regions[r].name;
+            pentry->loads = s_loads[l];
+            pentry->is_completed = true;
+            pentry->irq_min = UINT32_MAX;
+
+            bool is_glcdc = (s_loads[l] & BUS_BENCH_LOAD_GLCDC) != 0u;
+            if (is_glcdc && !set_glcdc_load(true))
+            {
+                set_glcdc_load(false);
+                pentry->is_completed = false;
+                pentry->irq_min = 0u;
+                continue;
+            }
+            for (uint32_t i = 0u; i < rounds; i++)
+            {
+                if (!run_dma(&(s_regions[r]), s_loads[l], pentry))
+                {
+                    pentry->is_completed = false;
+                }
+            }
+            if (is_glcdc)
+            {
+                set_glcdc_load(false);
+            }
+
+            if (pentry->irq_samples == 0u)
+            {
+                pentry->irq_min = 0u;
+            }
+            if (s_loads[l] == BUS_BENCH_LOAD_NONE)
+            {
+                idle_micros = pentry->dma_micros;
+            }
+            pentry->stall_micros = (pentry->dma_micros > idle_micros) ? (pentry->dma_micros - idle_micros) : 0u;
+        }
+    }
+
+    IEN(ICU, SWINT) = 0U;
+    test_signal_set_output(saved_output);
+    dmac_release(s_channel);
+
+    return 0;
+}
+
+/**
+ * @brief 拡張バスマスタの優先順位(EBMAPCRの設定)を得る。
+ * @param order 優先順位の高い順に、マスタ番号(BSP_CFG_EBMAPCR_xxx_PRIORITY の値)を格納する配列
+ */
+void bus_bench_get_bus_master_order(uint8_t order[BUS_BENCH_BUS_MASTER_COUNT])
+{
+    order[0] = (uint8_t)(BSC.EBMAPCR.BIT.PR1SEL);
+    order[1] = (uint8_t)(BSC.EBMAPCR.BIT.PR2SEL);
+    order[2] = (uint8_t)(BSC.EBMAPCR.BIT.PR3SEL);
+    order[3] = (uint8_t)(BSC.EBMAPCR.BIT.PR4SEL);
+    order[4] = (uint8_t)(BSC.EBMAPCR.BIT.PR5SEL);
+
+    return;
+}
+
+/**
+ * @brief 転送先の領域を設定する。
+ */
+static void setup_regions(void)
+{
+    uint8_t* pram2 = (uint8_t*)(pdc_get_capture_slot_buffer(0)); // キャプチャバッファの先頭
+
+    s_regions[0].name = memmap_get_region(MEMMAP_REGION_RAM1)->name;
+    s_regions[0].pdma_dst = s_ram1_dma_buf;
+    s_regions[0].psource = &s_ram1_source;
+    s_regions[0].pcpu_area = s_ram1_cpu_buf;
+
+    s_regions[1].name = memmap_get_region(MEMMAP_REGION_RAM2)->name;
+    s_regions[1].pdma_dst = pram2 + RAM2_DMA_OFFSET;
+    s_regions[1].psource = (uint32_t*)(pram2 + RAM2_SOURCE_OFFSET);
+    s_regions[1].pcpu_area = pram2 + RAM2_CPU_OFFSET;
+
+    return;
+}
+
+/**
+ * @brief DMA転送を行い、完了するまでの間、負荷の実行と割り込み応答時間の測定を繰り返す。
+ * @param pregion 転送先の領域
+ * @param loads 同時に実行する負荷
+ * @param pentry 測定結果
+ * @return 転送が完了した場合にはtrue, タイムアウトした場合にはfalse.
+ */
+static bool run_dma(const struct bus_region* pregion, uint8_t loads, struct bus_bench_entry* pentry)
+{
+    uint8_t* pcpu_src = pregion->pcpu_area;
+    uint8_t* pcpu_dst = pregion->pcpu_area + CPU_COPY_CHUNK;
+
+    (*pregion->psource) = 0x5A5A5A5Au;
+    s_pregs->DMSAR = pregion->psource;
+    s_pregs->DMDAR = pregion->pdma_dst;
+    s_pregs->DMCRA = s_size / 4u;
+    s_is_irq_pending = false;
+    s_pirq_entry = pentry;
+
+    dmac_notify_start(s_channel);
+    uint32_t begin = hwtick_get_micros();
+    s_pregs->DMCNT.BIT.DTE = 1U;
+    s_pregs->DMREQ.BYTE = _01_DMAC_TRIGGER_SOFTWARE | _10_DMAC_TRIGGER_SOFTWARE_CLEAR_MANUAL;
+
+    bool is_completed = true;
+    uint32_t begin_millis = hwtick_get();
+    while (s_pregs->DMCNT.BIT.DTE != 0U)
+    {
+        if ((hwtick_get() - begin_millis) >= DMA_TIMEOUT_MILLIS)
+        {
+            s_pregs->DMCNT.BIT.DTE = 0U;
+            is_completed = false;
+            break;
+        }
+        request_irq_sample();
+        if ((loads & BUS_BENCH_LOAD_CPU) != 0u)
+        {
+            memcpy(pcpu_dst, pcpu_src, CPU_COPY_CHUNK);
+            pentry->cpu_bytes += CPU_COPY_CHUNK;
+        }
+        if ((loads & BUS_BENCH_LOAD_USB) != 0u)
+        {
+            usb_cdc_write(s_usb_filler, sizeof(s_usb_filler));
+            usb_cdc_update();
+        }
+    }
+    uint32_t elapsed = hwtick_get_micros() - begin;
+    s_pregs->DMREQ.BYTE = 0U;
+
+    // 応答待ちのSWINTを待ってから測定を終える。
+    uint32_t wait_begin = hwtick_get();
+    while (s_is_irq_pending && ((hwtick_get() - wait_begin) < DMA_TIMEOUT_MILLIS))
+    {
+        // 応答待ち
+    }
+    s_pirq_entry = NULL;
+
+    uint32_t transferred = s_size - (s_pregs->DMCRA & 0xFFFFu) * 4u;
+    dmac_notify_end(s_channel, transferred);
+    pentry->bytes += transferred;
+    pentry->dma_micros += elapsed;
+
+    return is_completed;
+}
+
+/**
+ * @brief GLCDC負荷を開始/停止する。
+ *        開始時はテスト信号を出力し、GR2でRAM2のプレビュー領域を表示する。
+ * @param is_enabled 開始する場合にはtrue, 停止する場合にはfalse.
+ * @return 成功した場合にはtrue, 失敗した場合にはfalse.
+ */
+static bool set_glcdc_load(bool is_enabled)
+{
+    bool is_succeed;
+
+    if (is_enabled)
+    {
+        struct test_signal_timing timing;
+        test_signal_get_timing(&timing);
+        uint16_t width = (uint16_t)((timing.hactive / PREVIEW_WIDTH_ALIGN) * PREVIEW_WIDTH_ALIGN);
+        uint16_t height = timing.vactive;
+        if ((width > 0u) && (((uint32_t)(width) * height) > RAM2_PREVIEW_AREA_SIZE))
+        {
+            height = (uint16_t)(RAM2_PREVIEW_AREA_SIZE / width);
+        }
+        is_succeed = test_signal_set_output(true)
+                     && test_signal_start_preview(pdc_get_capture_slot_buffer(0), width, height, false);
+    }
+    else
+    {
+        is_succeed = test_signal_stop_preview();
+    }
+
+    uint32_t begin = hwtick_get();
+    while ((hwtick_get() - begin) < GLCDC_SETTLE_MILLIS)
+    {
+        // 設定反映待ち
+    }
+
+    return is_succeed;
+}
+
+/**
+ * @brief 応答待ちでなければ、SWINTを要求して割り込み応答時間の測定を開始する。
+ */
+static void request_irq_sample(void)
+{
+    if (s_is_irq_pending)
+    {
+        return;
+    }
+
+    s_is_irq_pending = true;
+    s_irq_request_micros = hwtick_get_micros();
+    ICU.SWINTR.BIT.SWINT = 1U;
+
+    return;
+}
+
+/**
+ * @brief SWINT割り込みハンドラ
+ *        要求してからの時間を割り込み応答時間として集計する。
+ */
+R_BSP_PRAGMA_STATIC_INTERRUPT(bus_bench_swint_isr, VECT(ICU, SWINT))
+R_BSP_ATTRIB_STATIC_INTERRUPT void bus_bench_swint_isr(void)
+{
+    uint32_t latency = hwtick_get_micros() - s_irq_request_micros;
+    struct bus_bench_entry* pentry = s_pirq_entry;
+
+    if (s_is_irq_pending && (pentry != NULL))
+    {
+        pentry->irq_samples++;
+        pentry->irq_total += latency;
+        if (latency < pentry->irq_min)
+        {
+            pentry->irq_min = latency;
+        }
+        if (latency > pentry->irq_max)
+        {
+            pentry->irq_max = latency;
+        }
+    }
+    s_is_irq_pending = false;
+
+    return;
+}
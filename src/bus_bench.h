@@ -0,0 +1,81 @@
+/**
+ * @file バス競合ベンチマークのインタフェース宣言
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+
+#ifndef BUS_BENCH_H_
+#define BUS_BENCH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief DMA転送サイズの最大値[byte]
+ */
+#define BUS_BENCH_MAX_SIZE (32768)
+
+/**
+ * @brief 最大繰り返し回数
+ */
+#define BUS_BENCH_MAX_ROUNDS (1000)
+
+/**
+ * @brief 転送先の領域数(RAM1, RAM2)
+ */
+#define BUS_BENCH_REGION_COUNT (2)
+
+/**
+ * @brief 負荷条件数
+ */
+#define BUS_BENCH_LOAD_COUNT (5)
+
+/**
+ * @brief 拡張バスマスタ数(EBMAPCRで優先順位を設定するマスタの数)
+ */
+#define BUS_BENCH_BUS_MASTER_COUNT (5)
+
+/**
+ * @brief 同時に実行する負荷
+ */
+enum bus_bench_load
+{
+    BUS_BENCH_LOAD_NONE = 0x00,  // 負荷なし
+    BUS_BENCH_LOAD_GLCDC = 0x01, // GLCDCスキャンアウト(GR1: RAM1のパターン, GR2: RAM2のプレビュー)
+    BUS_BENCH_LOAD_CPU = 0x02,   // CPUのmemcpy(転送先と同じ領域内)
+    BUS_BENCH_LOAD_USB = 0x04,   // USB CDCの送信
+};
+
+/**
+ * @brief 1条件の測定結果
+ */
+struct bus_bench_entry
+{
+    const char* region;    // 転送先の領域名
+    uint8_t loads;         // 同時に実行した負荷(enum bus_bench_load の組み合わせ)
+    bool is_completed;     // 全ての転送が完了したかどうか(タイムアウトしなかったか)
+    uint32_t bytes;        // DMA転送したバイト数の合計
+    uint32_t dma_micros;   // DMA転送時間の合計[マイクロ秒]
+    uint32_t stall_micros; // 負荷なしの場合からのDMA転送時間の増加[マイクロ秒]
+    uint32_t cpu_bytes;    // DMA転送中にCPUがコピーしたバイト数の合計
+    uint32_t irq_samples;  // 割り込み応答時間の測定回数
+    uint32_t irq_min;      // 割り込み応答時間の最小値[マイクロ秒]
+    uint32_t irq_max;      // 割り込み応答時間の最大値[マイクロ秒]
+    uint32_t irq_total;    // 割り込み応答時間の合計[マイクロ秒]
+};
+
+/**
+ * @brief 測定結果
+ */
+struct bus_bench_result
+{
+    struct bus_bench_entry entries[BUS_BENCH_REGION_COUNT * BUS_BENCH_LOAD_COUNT]; // 条件毎の結果
+    int entry_count;                                                               // 条件数
+    uint32_t size;                                                                 // 1回のDMA転送サイズ[byte]
+    uint32_t rounds;                                                               // 条件毎の繰り返し回数
+    int dma_channel;                                                               // 使用したDMACチャネル
+};
+
+int bus_bench_run(uint32_t size, uint32_t rounds, struct bus_bench_result* presult);
+void bus_bench_get_bus_master_order(uint8_t order[BUS_BENCH_BUS_MASTER_COUNT]);
+
+#endif /* BUS_BENCH_H_ */
@@ -0,0 +1,308 @@
+/**
+ * @file bench コマンド定義
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stddef.h>
+#include <stdio.h>
+#include "utils.h"
+#include "test_signal.h"
+#include "pdc_bench.h"
+#include "memop_bench.h"
+#include "bus_bench.h"
+#include "command_table.h"
+#include "command_bench.h"
+
+/**
+ * @brief bench pdc-sweep のデフォルトキャプチャ回数
+ */
+#define DEFAULT_SWEEP_COUNT (5)
+
+/**
+ * @brief bench memop のデフォルト測定サイズ[byte]
+ */
+#define DEFAULT_MEMOP_SIZE (65536)
+
+/**
+ * @brief bench bus のデフォルトDMA転送サイズ[byte]
+ */
+#define DEFAULT_BUS_SIZE (32768)
+
+/**
+ * @brief bench bus のデフォルト繰り返し回数
+ */
+#define DEFAULT_BUS_ROUNDS (10)
+
+static void cmd_bench_pdc_sweep(int ac, char** av);
+static void on_pdc_sweep_done(const struct pdc_bench_sweep_result* presult);
+static void print_sweep_matrix(const struct pdc_bench_sweep_result* presult);
+static void cmd_bench_memop(int ac, char** av);
+static void cmd_bench_bus(int ac, char** av);
+static void print_bus_master_order(void);
+
+/**
+ * コマンドエントリテーブル
+ */
+//@formatter:off
+static const struct cmd_entry CommandEntries[] = {
+    {"pdc-sweep", "Sweep PDC capture over timing profiles.", cmd_bench_pdc_sweep},
+    {"memop", "Compare memory fill/copy bandwidth.", cmd_bench_memop},
+    {"bus", "Measure DMA bandwidth under bus contention.", cmd_bench_bus},
+};
+//@formatter:on
+/**
+ * コマンドエントリ数
+ */
+static const int CommandEntryCount = (int)(sizeof(CommandEntries) / sizeof(struct cmd_entry));
+
+/**
+ * @brief bench コマンドを処理する
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+void cmd_bench(int ac, char** av)
+{
+    if (ac >= 2)
+    {
+        const struct cmd_entry* pentry = command_table_find_cmd(CommandEntries, CommandEntryCount, av[1]);
+        if (pentry != NULL)
+        {
+            pentry->cmd_proc(ac, av);
+        }
+        else
+        {
+            printf("Unknown subcommand: %s\n", av[1]);
+        }
+    }
+    else
+    {
+        for (uint32_t i = 0u; i < CommandEntryCount; i++)
+        {
+            const struct cmd_entry* pentry = &(CommandEntries[i]);
+            if ((pentry->cmd != NULL) && (pentry->desc != NULL))
+            {
+                printf("bench %s - %s\n", pentry->cmd, pentry->desc);
+            }
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief bench pdc-sweep コマンドを処理する。
+ *        bench pdc-sweep [count# [profile$]]
+ *        タイミングプロファイル, キャプチャサイズ, bppの組み合わせ毎に、指定回数だけキャプチャする。
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_bench_pdc_sweep(int ac, char** av)
+{
+    uint32_t count = DEFAULT_SWEEP_COUNT;
+    const struct test_signal_profile* pprofile = NULL;
+
+    if ((ac >= 3) && !parse_u32(av[2], &count))
+    {
+        printf("Invalid argument. %s\n", av[2]);
+        return;
+    }
+    if (ac >= 4)
+    {
+        pprofile = test_signal_find_profile(av[3]);
+        if (pprofile == NULL)
+        {
+            printf("Invalid argument. %s\n", av[3]);
+            return;
+        }
+    }
+
+    int retval = pdc_bench_sweep_start(count, pprofile, on_pdc_sweep_done);
+    if (retval != 0)
+    {
+        printf("Could not start sweep. (%d)\n", retval);
+        return;
+    }
+    printf("Sweep started. (%u captures/condition, %s)\n", count, (pprofile != NULL) ? pprofile->name : "all profiles");
+
+    return;
+}
+
+/**
+ * @brief スイープが完了したときの処理を行う。
+ *        条件毎の結果を1行ずつ表示し、最後に合否のマトリクスを表示する。
+ *        margin はPDCの最大ピクセルクロックに対する余裕[%]で、負の場合は上限を超えている。
+ *        recv は最も少なかった受信済みサイズの総転送サイズに対する割合[%]。
+ * @param presult スイープ結果
+ */
+static void on_pdc_sweep_done(const struct pdc_bench_sweep_result* presult)
+{
+    printf("profile    pclk[kHz] margin size bpp  bytes x lines  ok/n    ovr udr verf herf tmo recv[%%] result\n");
+    for (int i = 0; i < presult->entry_count; i++)
+    {
+        const struct pdc_bench_entry* pentry = &(presult->entries[i]);
+        int32_t margin = (int32_t)((((int64_t)(presult->max_pixel_clock_hz) - (int64_t)(pentry->pixel_clock_hz)) * 100)
+                                   / (int64_t)(presult->max_pixel_clock_hz));
+        if (!pentry->is_configured)
+        {
+            printf("%-10s %9u %5d%%  1/%u %3u  (not configured)\n", pentry->pprofile->name, pentry->pixel_clock_hz / 1000u,
+                   (int)(margin), pentry->size_div, pentry->bpp);
+            continue;
+        }
+        uint32_t recv_x10 = (uint32_t)((uint64_t)(pentry->min_received_len) * 1000u / pentry->total_len);
+        printf("%-10s %9u %5d%%  1/%u %3u %6u x %-5u %3u/%-3u %3u %3u %4u %4u %3u %3u.%u  %s\n", pentry->pprofile->name,
+               pentry->pixel_clock_hz / 1000u, (int)(margin), pentry->size_div, pentry->bpp, pentry->line_bytes, pentry->lines,
+               pentry->completed, pentry->captures, pentry->overruns, pentry->underruns, pentry->vline_errors, pentry->hsize_errors,
+               pentry->timeouts, recv_x10 / 10u, recv_x10 % 10u, pdc_bench_is_entry_passed(pentry) ? "PASS" : "FAIL");
+    }
+    print_sweep_matrix(presult);
+    printf("elapsed: %u ms\n", presult->elapsed_millis);
+
+    return;
+}
+
+/**
+ * @brief スイープ結果の合否をマトリクス表示する。
+ *        行がタイミングプロファイル、列がキャプチャサイズとbppの組み合わせになる。
+ *        (スイープ条件はプロファイル毎にまとめて並んでいる)
+ * @param presult スイープ結果
+ */
+static void print_sweep_matrix(const struct pdc_bench_sweep_result* presult)
+{
+    const int columns = PDC_BENCH_SIZE_COUNT * PDC_BENCH_BPP_COUNT;
+
+    printf("\n%-10s", "");
+    for (int i = 0; (i < columns) && (i < presult->entry_count); i++)
+    {
+        printf(" 1/%u:%u", presult->entries[i].size_div, presult->entries[i].bpp);
+    }
+    printf("\n");
+
+    for (int row = 0; (row * columns) < presult->entry_count; row++)
+    {
+        const struct pdc_bench_entry* prow = &(presult->entries[row * columns]);
+        printf("%-10s", prow->pprofile->name);
+        for (int i = 0; (i < columns) && (((row * columns) + i) < presult->entry_count); i++)
+        {
+            const struct pdc_bench_entry* pentry = &(prow[i]);
+            printf(" %5s", (!pentry->is_configured) ? "--" : (pdc_bench_is_entry_passed(pentry) ? "ok" : "NG"));
+        }
+        printf("\n");
+    }
+
+    return;
+}
+
+/**
+ * @brief bench memop コマンドを処理する。
+ *        bench memop [size#]
+ *        libc, ストリング命令, DMACのフィル/コピー/2次元コピーの速度を測定し、表にして表示する。
+ *        キャプチャバッファを使用するため、キャプチャデータは上書きされる。
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_bench_memop(int ac, char** av)
+{
+    static struct memop_bench_result result;
+    uint32_t size = DEFAULT_MEMOP_SIZE;
+
+    if ((ac >= 3) && !parse_u32(av[2], &size))
+    {
+        printf("Invalid argument. %s\n", av[2]);
+        return;
+    }
+
+    int retval = memop_bench_run(size, &result);
+    if (retval != 0)
+    {
+        printf("Could not run benchmark. (%d)\n", retval);
+        return;
+    }
+
+    printf("op      engine       bytes      us   MB/s verify\n");
+    for (int i = 0; i < result.entry_count; i++)
+    {
+        const struct memop_bench_entry* pentry = &(result.entries[i]);
+        uint32_t mbps_x10 = (pentry->micros > 0u) ? (uint32_t)((uint64_t)(pentry->bytes) * 10u / pentry->micros) : 0u;
+        printf("%-7s %-10s %7u %7u %4u.%u %s\n", pentry->op, pentry->engine, pentry->bytes, pentry->micros, mbps_x10 / 10u,
+               mbps_x10 % 10u, pentry->is_verified ? "ok" : "NG");
+    }
+
+    return;
+}
+
+/**
+ * @brief bench bus コマンドを処理する。
+ *        bench bus [size# [rounds#]]
+ *        RAM1, RAM2へのDMA転送をGLCDC, CPU, USBの負荷と同時に行い、転送速度, ストール時間, 割り込み応答時間を表にして表示する。
+ *        キャプチャバッファを使用するため、キャプチャデータは上書きされる。
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_bench_bus(int ac, char** av)
+{
+    static struct bus_bench_result result;
+    uint32_t size = DEFAULT_BUS_SIZE;
+    uint32_t rounds = DEFAULT_BUS_ROUNDS;
+
+    if ((ac >= 3) && !parse_u32(av[2], &size))
+    {
+        printf("Invalid argument. %s\n", av[2]);
+        return;
+    }
+    if ((ac >= 4) && !parse_u32(av[3], &rounds))
+    {
+        printf("Invalid argument. %s\n", av[3]);
+        return;
+    }
+
+    int retval = bus_bench_run(size, rounds, &result);
+    if (retval != 0)
+    {
+        printf("Could not run benchmark. (%d)\n", retval);
+        return;
+    }
+
+    printf("size: %u bytes x %u rounds, DMAC%d\n", result.size, result.rounds, result.dma_channel);
+    printf("region load         MB/s  dma[us] stall[us] cpu[KB]  irq n   min   avg   max[us] ok\n");
+    for (int i = 0; i < result.entry_count; i++)
+    {
+        const struct bus_bench_entry* pentry = &(result.entries[i]);
+        char loads[16];
+        snprintf(loads, sizeof(loads), "%s%s%s%s", (pentry->loads == BUS_BENCH_LOAD_NONE) ? "none" : "",
+                 ((pentry->loads & BUS_BENCH_LOAD_GLCDC) != 0u) ? "G" : "", ((pentry->loads & BUS_BENCH_LOAD_CPU) != 0u) ? "C" : "",
+                 ((pentry->loads & BUS_BENCH_LOAD_USB) != 0u) ? "U" : "");
+        uint32_t mbps_x10 = (pentry->dma_micros > 0u) ? (uint32_t)((uint64_t)(pentry->bytes) * 10u / pentry->dma_micros) : 0u;
+        uint32_t irq_avg = (pentry->irq_samples > 0u) ? (pentry->irq_total / pentry->irq_samples) : 0u;
+        printf("%-6s %-8s %5u.%u %8u %9u %7u %6u %5u %5u %5u     %s\n", (pentry->region != NULL) ? pentry->region : "-", loads,
+               mbps_x10 / 10u, mbps_x10 % 10u, pentry->dma_micros, pentry->stall_micros, pentry->cpu_bytes / 1024u,
+               pentry->irq_samples, pentry->irq_min, irq_avg, pentry->irq_max, pentry->is_completed ? "ok" : "NG");
+    }
+    printf("load: G=GLCDC scanout, C=CPU memcpy, U=USB CDC write\n");
+    print_bus_master_order();
+
+    return;
+}
+
+/**
+ * @brief 拡張バスマスタの優先順位(BSP_CFG_EBMAPCR_xxx_PRIORITY)を表示する。
+ */
+static void print_bus_master_order(void)
+{
+    //@formatter:off
+    static const char* const master_names[] = {
+        "GLCDC-GR1", "DRW2D-TX", "DRW2D-FB", "GLCDC-GR2", "EDMAC",
+    };
+    //@formatter:on
+    uint8_t order[BUS_BENCH_BUS_MASTER_COUNT];
+
+    bus_bench_get_bus_master_order(order);
+    printf("EBMAPCR priority:");
+    for (int i = 0; i < BUS_BENCH_BUS_MASTER_COUNT; i++)
+    {
+        uint8_t master = order[i];
+        printf(" %s%s", (i > 0) ? "> " : "",
+               (master < (sizeof(master_names) / sizeof(master_names[0]))) ? master_names[master] : "?");
+    }
+    printf("\n");
+
+    return;
+}
@@ -0,0 +1,11 @@
+/**
+ * @file bench コマンドインタフェース宣言
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+
+#ifndef COMMAND_BENCH_H_
+#define COMMAND_BENCH_H_
+
+void cmd_bench(int ac, char** av);
+
+#endif /* COMMAND_BENCH_H_ */
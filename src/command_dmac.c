@@ -0,0 +1,98 @@
+/**
+ * @file dmac コマンド定義
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stddef.h>
+#include <stdio.h>
+#include "dmac.h"
+#include "command_table.h"
+#include "command_dmac.h"
+
+static void cmd_dmac_state(int ac, char** av);
+static void cmd_dmac_clear(int ac, char** av);
+
+/**
+ * コマンドエントリテーブル
+ */
+//@formatter:off
+static const struct cmd_entry CommandEntries[] = {
+    {"state", "Get channel owners and statistics.", cmd_dmac_state},
+    {"clear", "Clear channel statistics.", cmd_dmac_clear},
+};
+//@formatter:on
+/**
+ * コマンドエントリ数
+ */
+static const int CommandEntryCount = (int)(sizeof(CommandEntries) / sizeof(struct cmd_entry));
+
+/**
+ * @brief dmac コマンドを処理する
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+void cmd_dmac(int ac, char** av)
+{
+    if (ac >= 2)
+    {
+        const struct cmd_entry* pentry = command_table_find_cmd(CommandEntries, CommandEntryCount, av[1]);
+        if (pentry != NULL)
+        {
+            pentry->cmd_proc(ac, av);
+        }
+        else
+        {
+            printf("Unknown subcommand: %s\n", av[1]);
+        }
+    }
+    else
+    {
+        for (uint32_t i = 0u; i < CommandEntryCount; i++)
+        {
+            const struct cmd_entry* pentry = &(CommandEntries[i]);
+            if ((pentry->cmd != NULL) && (pentry->desc != NULL))
+            {
+                printf("dmac %s - %s\n", pentry->cmd, pentry->desc);
+            }
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief dmac state コマンドを処理する。
+ *        チャネル毎に、所有者, 起動要因, 転送中かどうか, 転送数, 転送量, 転送中だった時間を表示する。
+ *        予約済み(コード生成されたドライバが使用する)チャネルは所有者に * を付ける。
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_dmac_state(int ac, char** av)
+{
+    printf("ch owner      src  busy transfers      KB busy[ms]\n");
+    for (int ch = 0; ch < DMAC_CHANNEL_COUNT; ch++)
+    {
+        struct dmac_channel_info info;
+        if (!dmac_get_info(ch, &info))
+        {
+            continue;
+        }
+        printf("%2d %-9s%c 0x%02X %-4s %9u %7u %8u\n", ch, (info.owner != NULL) ? info.owner : "-", info.is_reserved ? '*' : ' ',
+               info.activation_source, info.is_busy ? "yes" : "no", info.transfers, (uint32_t)(info.bytes / 1024u),
+               info.busy_micros / 1000u);
+    }
+
+    return;
+}
+
+/**
+ * @brief dmac clear コマンドを処理する。
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_dmac_clear(int ac, char** av)
+{
+    dmac_clear_stats();
+    printf("Cleared.\n");
+
+    return;
+}
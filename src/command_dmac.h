@@ -0,0 +1,11 @@
+/**
+ * @file dmac コマンドインタフェース宣言
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+
+#ifndef COMMAND_DMAC_H_
+#define COMMAND_DMAC_H_
+
+void cmd_dmac(int ac, char** av);
+
+#endif /* COMMAND_DMAC_H_ */
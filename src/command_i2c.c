@@ -9,10 +9,51 @@
 
 #include "utils.h"
 #include "i2c.h"
+#include "i2c_bench.h"
+#include "i2c_scan.h"
 #include "command_i2c.h"
 
 #define I2C_MAX_IOLEN (16)
 
+/**
+ * @brief ベンチマークの最大実行回数
+ */
+#define I2C_BENCH_MAX_COUNT (100000u)
+
+/**
+ * @brief ベンチマークで指定できる最大ビットレート数
+ */
+#define I2C_BENCH_MAX_RATES (8)
+
+/**
+ * @brief スキャン時に読み出すIDレジスタアドレス 初期値
+ */
+#define I2C_SCAN_DEFAULT_ID_REG (0x0A)
+
+/**
+ * @brief スキャン時に読み出すIDレジスタのバイト数 初期値
+ */
+#define I2C_SCAN_DEFAULT_ID_LEN (2)
+
+/**
+ * @brief i2c bench の実行状態
+ */
+struct bench_plan
+{
+    uint8_t slave_addr;                      // スレーブアドレス
+    uint32_t count;                          // 1種別あたりの実行回数
+    uint32_t bit_rates[I2C_BENCH_MAX_RATES]; // ビットレート[bps]
+    int rate_count;                          // ビットレート数(0の場合は現在のビットレートで実行する)
+    int rate_index;                          // 実行中のビットレートのインデックス
+    int type;                                // 実行中のトランザクション種別
+    uint32_t saved_bit_rate;                 // 実行前のビットレート[bps]
+};
+
+/**
+ * @brief i2c bench の実行状態
+ */
+static struct bench_plan s_bench;
+
 /**
  * @brief I2C送信バッファ
  */
@@ -24,7 +65,15 @@ static uint8_t s_i2c_tx_buf[I2C_MAX_IOLEN];
 static uint8_t s_i2c_rx_buf[I2C_MAX_IOLEN];
 
 static void cmd_i2c_bit_rate(int ac, char** av);
+static void cmd_i2c_bench(int ac, char** av);
+static void start_bench_step(void);
+static void on_bench_done(const struct i2c_bench_result* presult);
+static void cmd_i2c_scan(int ac, char** av);
+static void on_scan_done(void);
+static void print_scan_result(void);
 static void cmd_i2c_process(int ac, char** av);
+static bool parse_bit_rate(const char* s, uint32_t* pbit_rate);
+static void print_bench_result(enum i2c_bench_type type, const struct i2c_bench_result* presult);
 
 /**
  * @brief i2cコマンドを処理する
@@ -37,6 +86,14 @@ void cmd_i2c(int ac, char** av)
     {
         cmd_i2c_bit_rate(ac, av);
     }
+    else if ((ac >= 2) && (strcmp(av[1], "bench") == 0))
+    {
+        cmd_i2c_bench(ac, av);
+    }
+    else if ((ac >= 2) && (strcmp(av[1], "scan") == 0))
+    {
+        cmd_i2c_scan(ac, av);
+    }
     else if (ac >= 2)
     {
         cmd_i2c_process(ac, av);
@@ -44,6 +101,9 @@ void cmd_i2c(int ac, char** av)
     else
     {
         printf("i2c bit-rate [rate#] - Set/get bit-rate.\n");
+        printf("i2c bench slave_addr#|sim count# [rate# [ rate# [ ... ] ] ] - Run benchmark.\n");
+        printf("i2c scan [ id_reg# [ id_len# ] ] - Scan bus.\n");
+        printf("i2c scan list - Print last scan result.\n");
         printf("i2c slave_addr# [ send tx0# [ tx1# [ ... ] ] ] [ recv rx_len# ] - Do transaction.\n");
     }
     return;
@@ -59,33 +119,14 @@ static void cmd_i2c_bit_rate(int ac, char** av)
 {
     if (ac >= 3)
     {
-        int32_t bit_rate;
-        char* p;
-
-        bit_rate = strtol(av[2], &p, 0);
-        if ((p != NULL) && (*p != '\0'))
-        {
-            if (((*p) == 'M') || ((*p) == 'm')) // Mbps, mbps
-            {
-                bit_rate *= 1E6;
-            }
-            else if (((*p) == 'K') || ((*p) == 'k')) // Kbps, kbps
-            {
-                bit_rate *= 1E3;
-            }
-            else
-            {
-                printf("Invalid bit rate. %s\n", av[2]);
-                return;
-            }
-        }
-        if (bit_rate < 0)
+        uint32_t bit_rate;
+        if (!parse_bit_rate(av[2], &bit_rate))
         {
             printf("Invalid bit rate. %s\n", av[2]);
             return;
         }
 
-        int s = i2c_set_bitrate((uint32_t)(bit_rate));
+        int s = i2c_set_bitrate(bit_rate);
         if (s != 0)
         {
             printf("Could not set bit-rate. (%d)\n", s);
@@ -102,6 +143,275 @@ static void cmd_i2c_bit_rate(int ac, char** av)
     return;
 }
 
+/**
+ * @brief i2c bench コマンドを処理する。
+ *        i2c bench slave_addr#|sim count# [rate# [ rate# [ ... ] ] ]
+ *        ビットレート毎に write, read, write-read をcount回ずつ実行し、結果を表示する。
+ *        ビットレートの指定が無い場合には現在のビットレートで実行する。
+ *        ベンチマークはバックグラウンドで実行し、1種別が完了する毎に結果を1行表示する。
+ *        終了後、ビットレートは実行前の値に戻す。
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_i2c_bench(int ac, char** av)
+{
+    uint8_t slave_addr;
+    uint32_t count;
+
+    if ((ac < 4) || ((ac - 4) > I2C_BENCH_MAX_RATES))
+    {
+        printf("usage:\n");
+        printf("  i2c bench slave_addr#|sim count# [rate# [ rate# [ ... ] ] ]\n");
+        return;
+    }
+    if (i2c_bench_is_running() || i2c_scan_is_running())
+    {
+        printf("I2C bus is busy.\n");
+        return;
+    }
+
+    bool is_simulated = (strcmp(av[2], "sim") == 0) ? true : false;
+    if (is_simulated)
+    {
+        slave_addr = I2C_BENCH_SIM_SLAVE_ADDR;
+    }
+    else if (!parse_u8(av[2], &slave_addr) || (slave_addr >= 0x80))
+    {
+        printf("Invalid slave address. : %s\n", av[2]);
+        return;
+    }
+    if (!parse_u32(av[3], &count) || (count == 0u) || (count > I2C_BENCH_MAX_COUNT))
+    {
+        printf("Invalid count. : %s\n", av[3]);
+        return;
+    }
+    for (int i = 4; i < ac; i++)
+    {
+        uint32_t bit_rate;
+        if (!parse_bit_rate(av[i], &bit_rate) || (bit_rate == 0u))
+        {
+            printf("Invalid bit rate. %s\n", av[i]);
+            return;
+        }
+        s_bench.bit_rates[i - 4] = bit_rate;
+    }
+
+    s_bench.slave_addr = slave_addr;
+    s_bench.count = count;
+    s_bench.rate_count = ac - 4;
+    s_bench.rate_index = 0;
+    s_bench.type = I2C_BENCH_WRITE;
+    i2c_bench_set_simulated(is_simulated);
+    s_bench.saved_bit_rate = i2c_bench_get_bitrate();
+
+    printf("%8s %-10s %8s %8s %5s %6s %6s %6s %10s\n", "conf.bps", "type", "trans/s", "eff.bps", "eff%", "nack", "tmo", "err", "cpu[us]/tr");
+    start_bench_step();
+
+    return;
+}
+
+/**
+ * @brief 現在のビットレート, 種別のベンチマークを開始する。
+ *        ビットレートを設定できなかった場合は次のビットレートに進み、全て終わったら設定を元に戻す。
+ */
+static void start_bench_step(void)
+{
+    int pass_count = (s_bench.rate_count > 0) ? s_bench.rate_count : 1; // 指定が無い場合は現在のビットレートで1回
+
+    while (s_bench.rate_index < pass_count)
+    {
+        if ((s_bench.type == I2C_BENCH_WRITE) && (s_bench.rate_count > 0))
+        {
+            uint32_t bit_rate = s_bench.bit_rates[s_bench.rate_index];
+            int s = i2c_bench_set_bitrate(bit_rate);
+            if (s != 0)
+            {
+                printf("%8u Could not set bit-rate. (%d)\n", bit_rate, s);
+                s_bench.rate_index++;
+                continue;
+            }
+        }
+
+        int s = i2c_bench_start(s_bench.slave_addr, (enum i2c_bench_type)(s_bench.type), s_bench.count, on_bench_done);
+        if (s == 0)
+        {
+            return;
+        }
+        printf("Benchmark failure. (%d)\n", s);
+        s_bench.type = I2C_BENCH_WRITE;
+        s_bench.rate_index++;
+    }
+
+    i2c_bench_set_bitrate(s_bench.saved_bit_rate);
+    i2c_bench_set_simulated(false);
+    printf("Benchmark done.\n");
+
+    return;
+}
+
+/**
+ * @brief 1種別のベンチマークが完了したときの処理を行う。
+ *        結果を表示し、次の種別(全種別が終わった場合は次のビットレート)を開始する。
+ * @param presult ベンチマーク結果
+ */
+static void on_bench_done(const struct i2c_bench_result* presult)
+{
+    print_bench_result((enum i2c_bench_type)(s_bench.type), presult);
+    s_bench.type++;
+    if (s_bench.type > I2C_BENCH_WRITE_READ)
+    {
+        s_bench.type = I2C_BENCH_WRITE;
+        s_bench.rate_index++;
+    }
+    start_bench_step();
+
+    return;
+}
+
+/**
+ * @brief i2c scan コマンドを処理する。
+ *        i2c scan [ id_reg# [ id_len# ] ]
+ *        i2c scan list
+ *        スキャンはバックグラウンドで実行し、完了時に結果を表示する。
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_i2c_scan(int ac, char** av)
+{
+    uint8_t id_reg = I2C_SCAN_DEFAULT_ID_REG;
+    uint8_t id_len = I2C_SCAN_DEFAULT_ID_LEN;
+
+    if ((ac >= 3) && (strcmp(av[2], "list") == 0))
+    {
+        if (i2c_scan_is_running())
+        {
+            printf("Scanning.\n");
+        }
+        else
+        {
+            print_scan_result();
+        }
+        return;
+    }
+    if ((ac >= 3) && !parse_u8(av[2], &id_reg))
+    {
+        printf("Invalid register address. : %s\n", av[2]);
+        return;
+    }
+    if ((ac >= 4) && (!parse_u8(av[3], &id_len) || (id_len > I2C_SCAN_ID_MAX_LEN)))
+    {
+        printf("Invalid length. : %s\n", av[3]);
+        return;
+    }
+
+    if (i2c_bench_is_running())
+    {
+        printf("I2C bus is busy.\n");
+        return;
+    }
+    int s = i2c_scan_start(id_reg, id_len, on_scan_done);
+    if (s != 0)
+    {
+        printf("Could not start scan. (%d)\n", s);
+        return;
+    }
+    printf("Scan started.\n");
+
+    return;
+}
+
+/**
+ * @brief スキャンが完了したときの処理を行う。
+ */
+static void on_scan_done(void)
+{
+    printf("Scan done.\n");
+    print_scan_result();
+
+    return;
+}
+
+/**
+ * @brief スキャン結果を表示する。
+ */
+static void print_scan_result(void)
+{
+    int count = i2c_scan_get_device_count();
+    for (int i = 0; i < count; i++)
+    {
+        const struct i2c_device_info* pdev = i2c_scan_get_device(i);
+        printf("%02x :", pdev->addr);
+        if (pdev->has_id)
+        {
+            for (uint8_t j = 0u; j < pdev->id_len; j++)
+            {
+                printf(" %02x", pdev->id[j]);
+            }
+        }
+        printf("\n");
+    }
+    printf("%d device(s) found. (%u ms)\n", count, i2c_scan_get_elapsed_millis());
+
+    return;
+}
+
+/**
+ * @brief ベンチマーク結果を1行表示する。
+ * @param type トランザクション種別
+ * @param presult 結果
+ */
+static void print_bench_result(enum i2c_bench_type type, const struct i2c_bench_result* presult)
+{
+    uint32_t elapsed = (presult->elapsed_micros > 0u) ? presult->elapsed_micros : 1u;
+    uint32_t trans_per_sec = (uint32_t)((uint64_t)(presult->count) * 1000000u / elapsed);
+    uint32_t eff_bps = (uint32_t)((uint64_t)(presult->bus_bits) * 1000000u / elapsed);
+    uint32_t eff_ratio = (presult->bit_rate > 0u) ? (uint32_t)((uint64_t)(eff_bps) * 100u / presult->bit_rate) : 0u;
+    uint32_t cpu_per_trans = presult->cpu_micros / presult->count;
+
+    printf("%8u %-10s %8u %8u %5u %6u %6u %6u %10u\n", presult->bit_rate, i2c_bench_type_name(type), trans_per_sec, eff_bps, eff_ratio,
+           presult->nack_count, presult->timeout_count, presult->error_count, cpu_per_trans);
+
+    return;
+}
+
+/**
+ * @brief ビットレート文字列を解析する。
+ *        数値の後にK(k), M(m)の単位を付けることができる。
+ * @param s 文字列
+ * @param pbit_rate ビットレートを格納する変数
+ * @return 成功した場合にはtrue, 失敗した場合にはfalse.
+ */
+static bool parse_bit_rate(const char* s, uint32_t* pbit_rate)
+{
+    int32_t bit_rate;
+    char* p;
+
+    bit_rate = strtol(s, &p, 0);
+    if ((p != NULL) && (*p != '\0'))
+    {
+        if (((*p) == 'M') || ((*p) == 'm')) // Mbps, mbps
+        {
+            bit_rate *= 1E6;
+        }
+        else if (((*p) == 'K') || ((*p) == 'k')) // Kbps, kbps
+        {
+            bit_rate *= 1E3;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    if (bit_rate < 0)
+    {
+        return false;
+    }
+
+    (*pbit_rate) = (uint32_t)(bit_rate);
+
+    return true;
+}
+
 /**
  * @brief i2c トランザクション処理をする。
  * @param ac 引数の数
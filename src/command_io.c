@@ -10,8 +10,13 @@
 
 #include "usb_cdc.h"
 #include "hwtick.h"
+#include "command_bench.h"
+#include "command_dmac.h"
+#include "command_memmap.h"
 #include "command_pdc.h"
 #include "command_i2c.h"
+#include "command_selftest.h"
+#include "command_sensor.h"
 #include "command_test_data.h"
 #include "command_table.h"
 
@@ -60,10 +65,15 @@ static const char* PromptStr = "> ";
 //@formatter:off
 static const struct cmd_entry CommandEntries[] = {
     {"args", "Print arguments.", cmd_args},
+    {"bench", "Run benchmark.", cmd_bench},
+    {"dmac", "Show DMAC channel usage.", cmd_dmac},
     {"help", "Print help message.", cmd_help},
     {"reset", "Reset software.", cmd_reset},
     {"i2c", "Bus access", cmd_i2c},
+    {"memmap", "Show memory region map.", cmd_memmap},
     {"pdc", "Control PDC(Parallel Data Capture)", cmd_pdc},
+    {"selftest", "Run self test.", cmd_selftest},
+    {"sensor", "Control image sensor.", cmd_sensor},
     {"test-data", "Control test data.", cmd_test_data},
 };
 //@formatter:on
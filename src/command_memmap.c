@@ -0,0 +1,49 @@
+/**
+ * @file memmap コマンド定義
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stddef.h>
+#include <stdio.h>
+#include "memmap.h"
+#include "command_memmap.h"
+
+/**
+ * @brief memmap コマンドを処理する。
+ *        memmap
+ *        領域毎の範囲, リンカが配置したデータの終端, アリーナの使用状況と、アリーナから確保したバッファを表示する。
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+void cmd_memmap(int ac, char** av)
+{
+    printf("region start      end        align linker-end arena[KB] used[KB] free[KB]\n");
+    for (int id = 0; id < MEMMAP_REGION_COUNT; id++)
+    {
+        struct memmap_region_info info;
+        if (!memmap_get_region_info((enum memmap_region_id)(id), &info))
+        {
+            continue;
+        }
+        const struct memmap_region* pregion = info.pregion;
+        printf("%-6s 0x%08X 0x%08X %5u 0x%08X %9u %8u %8u\n", pregion->name, (uint32_t)(pregion->start),
+               (uint32_t)(pregion->start + pregion->size - 1u), pregion->align, (uint32_t)(info.linker_end), info.arena_size / 1024u,
+               info.arena_used / 1024u, memmap_get_free_size((enum memmap_region_id)(id), 0u) / 1024u);
+    }
+
+    printf("owner      region addr       size\n");
+    for (int i = 0; i < memmap_get_allocation_count(); i++)
+    {
+        struct memmap_allocation alloc;
+        if (!memmap_get_allocation(i, &alloc))
+        {
+            continue;
+        }
+        printf("%-10s %-6s 0x%08X %u\n", alloc.owner, memmap_get_region(alloc.region)->name, (uint32_t)(alloc.addr), alloc.size);
+    }
+    if (!memmap_is_valid())
+    {
+        printf("Linker placement does not match the region map.\n");
+    }
+
+    return;
+}
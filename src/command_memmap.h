@@ -0,0 +1,11 @@
+/**
+ * @file memmap コマンドインタフェース宣言
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+
+#ifndef COMMAND_MEMMAP_H_
+#define COMMAND_MEMMAP_H_
+
+void cmd_memmap(int ac, char** av);
+
+#endif /* COMMAND_MEMMAP_H_ */
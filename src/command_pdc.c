@@ -9,7 +9,14 @@
 #include <string.h>
 
 #include "utils.h"
+#include "hwtick.h"
+#include "usb_cdc.h"
 #include "pdc.h"
+#include "pdc_seq.h"
+#include "pdc_passthrough.h"
+#include "pdc_stream.h"
+#include "pdc_tile.h"
+#include "pdc_motion.h"
 #include "command_table.h"
 #include "command_pdc.h"
 
@@ -22,6 +29,59 @@ static void cmd_pdc_capture_range(int ac, char** av);
 static void cmd_pdc_signal_polarity(int ac, char** av);
 static bool parse_polarity(const char* str, bool* polarity);
 static void cmd_pdc_reset(int ac, char** av);
+static void cmd_pdc_seq(int ac, char** av);
+static void on_seq_done(const struct pdc_seq_result* presult);
+static void cmd_pdc_passthrough(int ac, char** av);
+static void cmd_pdc_read(int ac, char** av);
+static void read_encoded(enum pdc_stream_format format);
+static void cmd_pdc_preview(int ac, char** av);
+static void send_padding(uint32_t size, uint32_t sent_bytes);
+static void cmd_pdc_tiles(int ac, char** av);
+static void cmd_pdc_motion(int ac, char** av);
+static void cmd_pdc_stats(int ac, char** av);
+static void print_stats(const struct yuv_stats* pstats);
+static void print_histogram(const struct yuv_stats* pstats);
+static void cmd_pdc_focus(int ac, char** av);
+static void print_focus(const struct yuv_focus* pfocus);
+static void build_focus_record(uint8_t* pdst, uint32_t index, const struct pdc_stream_result* presult, const struct pdc_stream_roi* proi,
+                               const struct yuv_focus* pfocus);
+static void put_u32(uint8_t* pdst, uint32_t value);
+static void cmd_pdc_focus_roi(int ac, char** av);
+
+/**
+ * @brief pdc seq のデフォルトフレーム数
+ */
+#define DEFAULT_SEQ_FRAMES (100)
+
+/**
+ * @brief pdc preview のデフォルトフレーム数
+ */
+#define DEFAULT_PREVIEW_FRAMES (30)
+
+/**
+ * @brief pdc tiles のデフォルトフレーム数
+ */
+#define DEFAULT_TILES_FRAMES (100)
+
+/**
+ * @brief pdc motion のデフォルトフレーム数
+ */
+#define DEFAULT_MOTION_FRAMES (300)
+
+/**
+ * @brief pdc focus bin の1フレーム分のレコードサイズ[byte]
+ */
+#define FOCUS_RECORD_SIZE (32u)
+
+/**
+ * @brief バイナリ出力の送信タイムアウト時間[ミリ秒]
+ */
+#define SEND_TIMEOUT_MILLIS (10000)
+
+/**
+ * @brief 送信できなかった分を0で埋める際の1回の送信サイズ[byte]
+ */
+#define PADDING_CHUNK_SIZE (64u)
 
 /**
  * コマンドエントリテーブル
@@ -34,6 +94,15 @@ static const struct cmd_entry CommandEntries[] = {
     {"capture-range", "Set/Get capture range.", cmd_pdc_capture_range},
     {"signal-polarity", "Set/Get signal polarity setting.", cmd_pdc_signal_polarity},
     {"reset", "Reset status.", cmd_pdc_reset},
+    {"seq", "Check frame sequence.", cmd_pdc_seq},
+    {"passthrough", "Start/Stop/Get capture passthrough display.", cmd_pdc_passthrough},
+    {"read", "Capture frame and send binary data.", cmd_pdc_read},
+    {"preview", "Stream downscaled frames.", cmd_pdc_preview},
+    {"tiles", "Stream changed tiles against previous frame.", cmd_pdc_tiles},
+    {"motion", "Send frames only when motion is detected.", cmd_pdc_motion},
+    {"stats", "Get frame statistics.", cmd_pdc_stats},
+    {"focus", "Measure focus score.", cmd_pdc_focus},
+    {"focus-roi", "Set/Get focus region of interest.", cmd_pdc_focus_roi},
 };
 //@formatter:on
 /**
@@ -131,6 +200,8 @@ static void cmd_pdc_state(int ac, char** av)
     }
 
     print_pdc_status(&status);
+    printf("TailFill = %s\n", pdc_has_tail_fills() ? "Pending" : "Done");
+    printf("Owner = %s\n", (pdc_get_owner() != NULL) ? pdc_get_owner() : "-");
     return;
 }
 
@@ -315,3 +386,842 @@ static void cmd_pdc_reset(int ac, char** av)
 
     return;
 }
+
+/**
+ * @brief pdc seq コマンドを処理する。
+ *        pdc seq [frames#]
+ *        テスト信号のフレーム番号を出力し、指定フレーム数だけ連続してキャプチャしてフレーム番号を調べる。
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_pdc_seq(int ac, char** av)
+{
+    uint32_t frames = DEFAULT_SEQ_FRAMES;
+
+    if ((ac >= 3) && !parse_u32(av[2], &frames))
+    {
+        printf("Invalid argument. %s\n", av[2]);
+        return;
+    }
+
+    int retval = pdc_seq_start(frames, on_seq_done);
+    if (retval != 0)
+    {
+        printf("Could not start sequence check. (%d)\n", retval);
+        return;
+    }
+    printf("Sequence check started. (%u frames)\n", frames);
+
+    return;
+}
+
+/**
+ * @brief フレームシーケンスチェックが完了したときの処理を行う。
+ * @param presult チェック結果
+ */
+static void on_seq_done(const struct pdc_seq_result* presult)
+{
+    printf("frames: %u, captured: %u, capture errors: %u, bad stamps: %u\n", presult->frames, presult->captured_frames,
+           presult->capture_errors, presult->bad_stamps);
+    printf("sequential: %u, skipped frames: %u (max gap %u), duplicates: %u, out of order: %u\n", presult->sequential,
+           presult->skipped_frames, presult->max_gap, presult->duplicates, presult->out_of_order);
+    if (presult->has_seq)
+    {
+        printf("frame number: %u - %u\n", presult->first_seq, presult->last_seq);
+    }
+    printf("elapsed: %u ms\n", presult->elapsed_millis);
+
+    return;
+}
+
+/**
+ * @brief pdc passthrough コマンドを処理する。
+ *        pdc passthrough [on [gray|rgb565]|off]
+ *        gray(省略時)はキャプチャデータの1バイトを1ピクセルのグレースケール、rgb565はYUYVをRGB565に変換して表示する。
+ *        引数がない場合は状態と統計を表示する。
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_pdc_passthrough(int ac, char** av)
+{
+    if (ac >= 3)
+    {
+        bool is_on;
+        if (!parse_boolean(av[2], &is_on))
+        {
+            printf("Invalid argument. %s\n", av[2]);
+            return;
+        }
+        if (is_on)
+        {
+            bool is_rgb565 = false;
+            if (ac >= 4)
+            {
+                if (strcmp(av[3], "rgb565") == 0)
+                {
+                    is_rgb565 = true;
+                }
+                else if (strcmp(av[3], "gray") != 0)
+                {
+                    printf("Invalid argument. %s\n", av[3]);
+                    return;
+                }
+                else
+                {
+                    // グレースケール
+                }
+            }
+            int retval = pdc_passthrough_start(is_rgb565);
+            if (retval != 0)
+            {
+                printf("Could not start passthrough. (%d)\n", retval);
+                return;
+            }
+            printf("Passthrough started.\n");
+            return;
+        }
+        pdc_passthrough_stop();
+    }
+
+    struct pdc_passthrough_stats stats;
+    pdc_passthrough_get_stats(&stats);
+    uint32_t fps_x10 = (stats.elapsed_millis > 0u) ? (uint32_t)((uint64_t)(stats.captured_frames) * 10000u / stats.elapsed_millis) : 0u;
+    printf("%s\n", pdc_passthrough_is_running() ? "on" : "off");
+    printf("captured: %u (%u.%u fps), capture errors: %u, swaps: %u, swap waits: %u, elapsed: %u ms\n", stats.captured_frames,
+           fps_x10 / 10u, fps_x10 % 10u, stats.capture_errors, stats.swaps, stats.swap_waits, stats.elapsed_millis);
+    if (stats.convert_pixels > 0u)
+    {
+        uint32_t mpixels_x100 = (stats.convert_micros > 0u) ? (uint32_t)(stats.convert_pixels * 100u / stats.convert_micros) : 0u;
+        printf("rgb565 convert: %u us (%u.%02u Mpixel/s)\n", stats.convert_micros, mpixels_x100 / 100u, mpixels_x100 % 100u);
+    }
+
+    return;
+}
+
+/**
+ * @brief pdc read コマンドを処理する。
+ *        pdc read [raw|y|bin2|bin4|rgb565|rgb888|delta|jpeg [quality#]]
+ *        1フレームをキャプチャしながらバイナリで送信する。
+ *        "DATA <format> <size>" の行に続けて size バイトのデータを送信し、改行の後に結果を1行表示する。
+ *        キャプチャを開始できなかった場合など、size バイトを送信できなかった場合は残りを0で埋める。
+ *        変換して送信する場合は、変換時間と変換速度も表示する。
+ *        delta, jpeg の場合は圧縮してから送信する。(read_encoded()を参照)
+ *        jpeg の場合は品質(1〜100)を指定できる。指定した品質は次回以降も使用する。
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_pdc_read(int ac, char** av)
+{
+    enum pdc_stream_format format = PDC_STREAM_FORMAT_RAW;
+
+    if ((ac >= 3) && !pdc_stream_find_format(av[2], &format))
+    {
+        printf("Invalid argument. %s\n", av[2]);
+        return;
+    }
+    if ((format == PDC_STREAM_FORMAT_JPEG) && (ac >= 4))
+    {
+        uint32_t quality;
+        if (!parse_u32(av[3], &quality) || (quality > 0xFFu) || !pdc_stream_set_jpeg_quality((uint8_t)(quality)))
+        {
+            printf("Invalid argument. %s\n", av[3]);
+            return;
+        }
+    }
+    if ((format == PDC_STREAM_FORMAT_DELTA) || (format == PDC_STREAM_FORMAT_JPEG))
+    {
+        read_encoded(format);
+        return;
+    }
+    uint32_t size = pdc_stream_get_output_size(format);
+    if (size == 0u)
+    {
+        printf("Format %s is not available for current capture range.\n", pdc_stream_get_format_name(format));
+        return;
+    }
+
+    if (pdc_is_busy())
+    {
+        printf("Capture is running.\n");
+        return;
+    }
+
+    printf("DATA %s %u\n", pdc_stream_get_format_name(format), size);
+    struct pdc_stream_result result;
+    int retval = pdc_stream_read(format, &result);
+    send_padding(size, result.sent_bytes);
+    if ((retval != 0) && (result.sent_bytes == 0u))
+    {
+        printf("\nCould not read. (%d)\n", retval);
+        return;
+    }
+    printf("\n%s: %u/%u bytes captured, %u bytes sent, capture %u ms, total %u ms\n", result.is_captured ? "Captured" : "Failed",
+           result.received_len, result.total_len, result.sent_bytes, result.capture_millis, result.elapsed_millis);
+    if (format != PDC_STREAM_FORMAT_RAW)
+    {
+        uint16_t xst, yst, width, height;
+        uint8_t bpp;
+        pdc_get_capture_range(&xst, &width, &yst, &height, &bpp);
+        uint32_t micros = (result.convert_micros > 0u) ? result.convert_micros : 1u;
+        uint32_t mpixels_x1000 = (uint32_t)(((uint64_t)(width) * height * 1000u) / micros);
+        printf("convert %u us (%u.%02u Mpixel/s)\n", result.convert_micros, mpixels_x1000 / 1000u, (mpixels_x1000 % 1000u) / 10u);
+    }
+
+    return;
+}
+
+/**
+ * @brief 1フレームをキャプチャしながら圧縮し、圧縮後に送信する。
+ *        delta: "DATA delta <size> <width> <height> <bpp> ratio=<圧縮率> encode=<圧縮速度>MB/s"
+ *        jpeg:  "DATA jpeg <size> <width> <height> <quality> ratio=<圧縮率> encode=<圧縮速度>MB/s"
+ *        の行に続けて size バイトの圧縮データを送信し、改行の後に結果を1行表示する。送信できなかった分は0で埋める。
+ *        delta の圧縮データは host/fcdecode で展開できる。jpeg の圧縮データはそのままJPEGファイルになる。
+ * @param format 圧縮フォーマット
+ */
+static void read_encoded(enum pdc_stream_format format)
+{
+    uint16_t width, height;
+    const char* name = pdc_stream_get_format_name(format);
+
+    if (!pdc_stream_get_output_dimension(format, &width, &height))
+    {
+        printf("Format %s is not available for current capture range.\n", name);
+        return;
+    }
+    if (pdc_is_busy())
+    {
+        printf("Capture is running.\n");
+        return;
+    }
+
+    struct pdc_stream_result result;
+    int retval = pdc_stream_encode(format, &result);
+    if (retval != 0)
+    {
+        printf("Could not encode. (%d)\n", retval);
+        return;
+    }
+    uint32_t param = (format == PDC_STREAM_FORMAT_JPEG) ? pdc_stream_get_jpeg_quality()
+                                                        : (result.total_len / ((uint32_t)(width) * height)); // bpp
+    uint32_t ratio_x100 = (uint32_t)(((uint64_t)(result.total_len) * 100u) / result.encoded_bytes);
+    uint32_t speed_x10 = (result.encode_micros > 0u) ? (uint32_t)(((uint64_t)(result.total_len) * 10u) / result.encode_micros) : 0u;
+    printf("DATA %s %u %u %u %u ratio=%u.%02u encode=%u.%uMB/s\n", name, result.encoded_bytes, width, height, param,
+           ratio_x100 / 100u, ratio_x100 % 100u, speed_x10 / 10u, speed_x10 % 10u);
+    retval = pdc_stream_send_encoded(&result);
+    send_padding(result.encoded_bytes, result.sent_bytes);
+    if ((retval != 0) && (result.sent_bytes == 0u))
+    {
+        printf("\nCould not send. (%d)\n", retval);
+        return;
+    }
+    printf("\n%s: %u/%u bytes captured, %u bytes sent, capture %u ms, encode %u us, total %u ms\n",
+           result.is_captured ? "Captured" : "Failed", result.received_len, result.total_len, result.sent_bytes, result.capture_millis,
+           result.encode_micros, result.elapsed_millis);
+
+    return;
+}
+
+/**
+ * @brief pdc preview コマンドを処理する。
+ *        pdc preview [bin2|bin4 [frames#]]
+ *        縮小したフレームを、指定フレーム数だけ連続してキャプチャしながら送信する。
+ *        フレーム毎に "FRAME <index> <width> <height> <size>" の行に続けて size バイトのYUYVデータを送信する。
+ *        size バイトを送信できなかったフレームは残りを0で埋めて、そこで中止する。
+ *        何か受信すると中止する。最後に改行の後、フレーム数とフレームレートを1行表示する。
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_pdc_preview(int ac, char** av)
+{
+    enum pdc_stream_format format = PDC_STREAM_FORMAT_BIN2;
+    uint32_t frames = DEFAULT_PREVIEW_FRAMES;
+    uint16_t width, height;
+
+    if ((ac >= 3) && (!pdc_stream_find_format(av[2], &format) || ((format != PDC_STREAM_FORMAT_BIN2) && (format != PDC_STREAM_FORMAT_BIN4))))
+    {
+        printf("Invalid argument. %s\n", av[2]);
+        return;
+    }
+    if ((ac >= 4) && (!parse_u32(av[3], &frames) || (frames == 0u)))
+    {
+        printf("Invalid argument. %s\n", av[3]);
+        return;
+    }
+    if (!pdc_stream_get_output_dimension(format, &width, &height))
+    {
+        printf("Format %s is not available for current capture range.\n", pdc_stream_get_format_name(format));
+        return;
+    }
+    if (pdc_is_busy())
+    {
+        printf("Capture is running.\n");
+        return;
+    }
+
+    uint32_t size = pdc_stream_get_output_size(format);
+    uint32_t captured = 0u;
+    uint32_t sent_frames = 0u;
+    uint32_t begin = hwtick_get();
+    for (uint32_t i = 0u; i < frames; i++)
+    {
+        uint8_t c;
+        if (usb_cdc_read(&c, sizeof(c)) > 0) // 中止要求？
+        {
+            break;
+        }
+
+        printf("FRAME %u %u %u %u\n", i, width, height, size);
+        struct pdc_stream_result result;
+        int retval = pdc_stream_read(format, &result);
+        send_padding(size, result.sent_bytes);
+        if (retval != 0)
+        {
+            break;
+        }
+        sent_frames++;
+        if (result.is_captured)
+        {
+            captured++;
+        }
+    }
+    uint32_t elapsed = hwtick_get() - begin;
+    uint32_t fps_x10 = (elapsed > 0u) ? (sent_frames * 10000u / elapsed) : 0u;
+    printf("\n%u frames (%u captured), %u ms, %u.%u fps\n", sent_frames, captured, elapsed, fps_x10 / 10u, fps_x10 % 10u);
+
+    return;
+}
+
+/**
+ * @brief ヘッダ行で予告したサイズに満たない分を0で送信する。
+ *        途中で送信が終わった場合でも、ホストが予告したサイズを読み終えて次の行を受信できるようにする。
+ * @param size 予告したサイズ[byte]
+ * @param sent_bytes 送信済みのサイズ[byte]
+ */
+static void send_padding(uint32_t size, uint32_t sent_bytes)
+{
+    uint8_t zeros[PADDING_CHUNK_SIZE];
+
+    memset(zeros, 0, sizeof(zeros));
+    while (sent_bytes < size)
+    {
+        uint32_t len = ((size - sent_bytes) < sizeof(zeros)) ? (size - sent_bytes) : sizeof(zeros);
+        if (usb_cdc_write_blocking(zeros, len, SEND_TIMEOUT_MILLIS) != len)
+        {
+            break;
+        }
+        sent_bytes += len;
+    }
+
+    return;
+}
+
+/**
+ * @brief pdc tiles コマンドを処理する。
+ *        pdc tiles [frames# [key-interval# [threshold#]]]
+ *        指定フレーム数だけ連続してキャプチャし、前に送信したフレームから変化したタイルだけを送信する。
+ *        フレーム毎に "FRAME <index> <key|tile> <size> <width> <height> <bpp> <tile-size> <changed-tiles>" の行に続けて
+ *        size バイトのデータを送信する。(データ形式は pdc_tile.c を参照)
+ *        何か受信すると中止する。最後に改行の後、フレーム数, キーフレーム数, 送信量, フレームレートを1行表示する。
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_pdc_tiles(int ac, char** av)
+{
+    uint32_t frames = DEFAULT_TILES_FRAMES;
+    uint32_t key_interval = PDC_TILE_DEFAULT_KEY_INTERVAL;
+    uint32_t threshold = 0u;
+
+    if ((ac >= 3) && (!parse_u32(av[2], &frames) || (frames == 0u)))
+    {
+        printf("Invalid argument. %s\n", av[2]);
+        return;
+    }
+    if ((ac >= 4) && (!parse_u32(av[3], &key_interval) || (key_interval == 0u)))
+    {
+        printf("Invalid argument. %s\n", av[3]);
+        return;
+    }
+    if ((ac >= 5) && (!parse_u32(av[4], &threshold) || (threshold > 0xFFu)))
+    {
+        printf("Invalid argument. %s\n", av[4]);
+        return;
+    }
+
+    int retval = pdc_tile_start(key_interval, (uint8_t)(threshold));
+    if (retval != 0)
+    {
+        printf("Could not start. (%d)\n", retval);
+        return;
+    }
+
+    uint16_t xst, yst, width, height;
+    uint8_t bpp;
+    pdc_get_capture_range(&xst, &width, &yst, &height, &bpp);
+    uint32_t sent_frames = 0u;
+    uint32_t key_frames = 0u;
+    uint32_t capture_errors = 0u;
+    uint32_t sent_bytes = 0u;
+    uint32_t raw_bytes = 0u;
+    uint32_t begin = hwtick_get();
+    for (uint32_t i = 0u; i < frames; i++)
+    {
+        uint8_t c;
+        if (usb_cdc_read(&c, sizeof(c)) > 0) // 中止要求？
+        {
+            break;
+        }
+
+        struct pdc_tile_result result;
+        if (pdc_tile_capture(&result) != 0)
+        {
+            capture_errors++;
+            continue;
+        }
+        printf("FRAME %u %s %u %u %u %u %u %u\n", i, pdc_tile_get_mode_name(result.mode), result.payload_bytes, width, height, bpp,
+               PDC_TILE_SIZE, result.changed_tiles);
+        retval = pdc_tile_send(&result);
+        sent_bytes += result.sent_bytes;
+        if (retval != 0)
+        {
+            break;
+        }
+        sent_frames++;
+        raw_bytes += result.frame_bytes;
+        if (result.mode == PDC_TILE_MODE_KEY)
+        {
+            key_frames++;
+        }
+    }
+    uint32_t elapsed = hwtick_get() - begin;
+    pdc_tile_stop();
+
+    uint32_t fps_x10 = (elapsed > 0u) ? (sent_frames * 10000u / elapsed) : 0u;
+    uint32_t percent_x10 = (raw_bytes > 0u) ? (uint32_t)(((uint64_t)(sent_bytes) * 1000u) / raw_bytes) : 0u;
+    printf("\n%u frames (%u key, %u capture errors), %u bytes sent (%u.%u%% of raw), %u ms, %u.%u fps\n", sent_frames, key_frames,
+           capture_errors, sent_bytes, percent_x10 / 10u, percent_x10 % 10u, elapsed, fps_x10 / 10u, fps_x10 % 10u);
+
+    return;
+}
+
+/**
+ * @brief pdc motion コマンドを処理する。
+ *        pdc motion [frames# [threshold# [min-tiles#]]]
+ *        指定フレーム数だけ連続してキャプチャし、前のフレームと比較して動きを検出したフレームだけを送信する。
+ *        動きを検出したフレーム毎に "MOTION <index> <changed-tiles> <tiles-x> <tiles-y> <size> <width> <height>" の行に続けて
+ *        size バイトのデータ(タイルビットマップ + YUYVデータ)を送信する。(データ形式は pdc_motion.c を参照)
+ *        動きがないフレームは何も送信しない。何か受信すると中止する。
+ *        最後に改行の後、フレーム数, 動きを検出したフレーム数, 送信量, 処理時間, フレームレートを1行表示する。
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_pdc_motion(int ac, char** av)
+{
+    uint32_t frames = DEFAULT_MOTION_FRAMES;
+    uint16_t threshold = PDC_MOTION_DEFAULT_THRESHOLD;
+    uint32_t min_tiles = PDC_MOTION_DEFAULT_MIN_TILES;
+
+    if ((ac >= 3) && (!parse_u32(av[2], &frames) || (frames == 0u)))
+    {
+        printf("Invalid argument. %s\n", av[2]);
+        return;
+    }
+    if ((ac >= 4) && !parse_u16(av[3], &threshold))
+    {
+        printf("Invalid argument. %s\n", av[3]);
+        return;
+    }
+    if ((ac >= 5) && (!parse_u32(av[4], &min_tiles) || (min_tiles == 0u)))
+    {
+        printf("Invalid argument. %s\n", av[4]);
+        return;
+    }
+
+    int retval = pdc_motion_start(threshold, min_tiles);
+    if (retval != 0)
+    {
+        printf("Could not start. (%d)\n", retval);
+        return;
+    }
+
+    uint16_t xst, yst, width, height;
+    uint8_t bpp;
+    uint16_t tiles_x, tiles_y;
+    pdc_get_capture_range(&xst, &width, &yst, &height, &bpp);
+    pdc_motion_get_tiles(&tiles_x, &tiles_y);
+    uint32_t size = pdc_motion_get_bitmap_size() + ((uint32_t)(width) * bpp * height);
+    uint32_t captured_frames = 0u;
+    uint32_t motion_frames = 0u;
+    uint32_t capture_errors = 0u;
+    uint32_t sent_bytes = 0u;
+    uint32_t max_micros = 0u;
+    uint32_t begin = hwtick_get();
+    for (uint32_t i = 0u; i < frames; i++)
+    {
+        uint8_t c;
+        if (usb_cdc_read(&c, sizeof(c)) > 0) // 中止要求？
+        {
+            break;
+        }
+
+        struct pdc_motion_result result;
+        if (pdc_motion_capture(&result) != 0)
+        {
+            capture_errors++;
+            continue;
+        }
+        captured_frames++;
+        uint32_t micros = result.grid_micros + result.compare_micros;
+        max_micros = (micros > max_micros) ? micros : max_micros;
+        if (!result.is_motion)
+        {
+            continue;
+        }
+        printf("MOTION %u %u %u %u %u %u %u\n", i, result.changed_tiles, tiles_x, tiles_y, size, width, height);
+        retval = pdc_motion_send(&result);
+        sent_bytes += result.sent_bytes;
+        if (retval != 0)
+        {
+            break;
+        }
+        motion_frames++;
+    }
+    uint32_t elapsed = hwtick_get() - begin;
+    pdc_motion_stop();
+
+    uint32_t fps_x10 = (elapsed > 0u) ? (captured_frames * 10000u / elapsed) : 0u;
+    uint64_t raw_bytes = (uint64_t)(captured_frames) * size;
+    uint32_t percent_x10 = (raw_bytes > 0u) ? (uint32_t)(((uint64_t)(sent_bytes) * 1000u) / raw_bytes) : 0u;
+    printf("\n%u frames (%u motion, %u capture errors), %u bytes sent (%u.%u%% of full), detect max %u us, %u ms, %u.%u fps\n",
+           captured_frames, motion_frames, capture_errors, sent_bytes, percent_x10 / 10u, percent_x10 % 10u, max_micros, elapsed,
+           fps_x10 / 10u, fps_x10 % 10u);
+
+    return;
+}
+
+/**
+ * @brief pdc stats コマンドを処理する。
+ *        pdc stats [frame|last|hist]
+ *        frame(デフォルト): 1フレームをキャプチャしながら統計情報を集計して表示する。(送信しない)
+ *        last: 直前に pdc read/preview/stats でキャプチャしたフレームの統計情報を表示する。
+ *        hist: 直前にキャプチャしたフレームの輝度ヒストグラムを表示する。
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_pdc_stats(int ac, char** av)
+{
+    const char* mode = (ac >= 3) ? av[2] : "frame";
+
+    if (strcmp(mode, "frame") == 0)
+    {
+        if (pdc_is_busy())
+        {
+            printf("Capture is running.\n");
+            return;
+        }
+        struct pdc_stream_result result;
+        int retval = pdc_stream_measure(&result);
+        if (retval != 0)
+        {
+            printf("Could not measure. (%d)\n", retval);
+            return;
+        }
+        // 30fpsで毎フレーム集計した場合のCPU使用率
+        uint32_t cpu_x10 = (uint32_t)(((uint64_t)(result.stats_micros) * 30u) / 1000u);
+        printf("%s: %u/%u bytes captured, capture %u ms, stats %u us (%u.%u%% CPU at 30fps)\n",
+               result.is_captured ? "Captured" : "Failed", result.received_len, result.total_len, result.capture_millis,
+               result.stats_micros, cpu_x10 / 10u, cpu_x10 % 10u);
+        print_stats(pdc_stream_get_stats());
+    }
+    else if (strcmp(mode, "last") == 0)
+    {
+        print_stats(pdc_stream_get_stats());
+    }
+    else if (strcmp(mode, "hist") == 0)
+    {
+        print_histogram(pdc_stream_get_stats());
+    }
+    else
+    {
+        printf("Invalid argument. %s\n", mode);
+    }
+
+    return;
+}
+
+/**
+ * @brief 統計情報を表示する。
+ * @param pstats 統計情報(NULLの場合は集計していない旨を表示する)
+ */
+static void print_stats(const struct yuv_stats* pstats)
+{
+    if ((pstats == NULL) || (pstats->pixels == 0u))
+    {
+        printf("No statistics.\n");
+        return;
+    }
+
+    uint32_t chroma_samples = pstats->pixels / 2u;
+    uint32_t y_mean_x10 = (uint32_t)(((uint64_t)(pstats->y_sum) * 10u) / pstats->pixels);
+    uint32_t u_mean_x10 = (uint32_t)(((uint64_t)(pstats->u_sum) * 10u) / chroma_samples);
+    uint32_t v_mean_x10 = (uint32_t)(((uint64_t)(pstats->v_sum) * 10u) / chroma_samples);
+    uint32_t low_x10 = (uint32_t)(((uint64_t)(pstats->y_clip_low) * 1000u) / pstats->pixels);
+    uint32_t high_x10 = (uint32_t)(((uint64_t)(pstats->y_clip_high) * 1000u) / pstats->pixels);
+    printf("pixels: %u\n", pstats->pixels);
+    printf("Y: mean %u.%u, min %u, max %u, clipped low %u (%u.%u%%), high %u (%u.%u%%)\n", y_mean_x10 / 10u, y_mean_x10 % 10u,
+           pstats->y_min, pstats->y_max, pstats->y_clip_low, low_x10 / 10u, low_x10 % 10u, pstats->y_clip_high, high_x10 / 10u,
+           high_x10 % 10u);
+    printf("U: mean %u.%u, min %u, max %u\n", u_mean_x10 / 10u, u_mean_x10 % 10u, pstats->u_min, pstats->u_max);
+    printf("V: mean %u.%u, min %u, max %u\n", v_mean_x10 / 10u, v_mean_x10 % 10u, pstats->v_min, pstats->v_max);
+
+    return;
+}
+
+/**
+ * @brief 輝度ヒストグラムを表示する。(1行に16ビン)
+ * @param pstats 統計情報(NULLの場合は集計していない旨を表示する)
+ */
+static void print_histogram(const struct yuv_stats* pstats)
+{
+    if ((pstats == NULL) || (pstats->pixels == 0u))
+    {
+        printf("No statistics.\n");
+        return;
+    }
+
+    for (uint32_t i = 0u; i < 256u; i += 16u)
+    {
+        printf("%3u:", i);
+        for (uint32_t j = 0u; j < 16u; j++)
+        {
+            printf(" %u", pstats->y_hist[i + j]);
+        }
+        printf("\n");
+    }
+
+    return;
+}
+
+/**
+ * @brief pdc focus コマンドを処理する。
+ *        pdc focus [frames# [text|bin]]
+ *        指定フレーム数(デフォルト: 1)だけ連続してキャプチャしながら、ROI内の合焦評価値を計算する。(画像は送信しない)
+ *        text(デフォルト): フレーム毎に評価値を1行表示し、最後に計算時間の最大値と30fpsでのCPU使用率を表示する。
+ *        bin: フレーム毎に "FOCUS <index> <size>" の行に続けて size バイトのレコードを送信する。(build_focus_record()を参照)
+ *             最後に改行の後、フレーム数を1行表示する。
+ *        何か受信すると中止する。
+ *        pdc focus last
+ *        直前に pdc read raw/delta/jpeg, pdc stats, pdc focus でキャプチャしたフレームの評価値を表示する。
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_pdc_focus(int ac, char** av)
+{
+    uint32_t frames = 1u;
+    bool is_binary = false;
+
+    if ((ac >= 3) && (strcmp(av[2], "last") == 0))
+    {
+        print_focus(pdc_stream_get_focus());
+        return;
+    }
+    if ((ac >= 3) && (!parse_u32(av[2], &frames) || (frames == 0u)))
+    {
+        printf("Invalid argument. %s\n", av[2]);
+        return;
+    }
+    if (ac >= 4)
+    {
+        if (strcmp(av[3], "bin") == 0)
+        {
+            is_binary = true;
+        }
+        else if (strcmp(av[3], "text") != 0)
+        {
+            printf("Invalid argument. %s\n", av[3]);
+            return;
+        }
+        else
+        {
+            // テキストで表示する。
+        }
+    }
+    struct pdc_stream_roi roi;
+    if (!pdc_stream_get_focus_roi(&roi))
+    {
+        printf("Focus ROI is not available for current capture range.\n");
+        return;
+    }
+    if (pdc_is_busy())
+    {
+        printf("Capture is running.\n");
+        return;
+    }
+
+    uint32_t measured = 0u;
+    uint32_t max_micros = 0u;
+    for (uint32_t i = 0u; i < frames; i++)
+    {
+        uint8_t c;
+        if (usb_cdc_read(&c, sizeof(c)) > 0) // 中止要求？
+        {
+            break;
+        }
+
+        struct pdc_stream_result result;
+        int retval = pdc_stream_measure(&result);
+        const struct yuv_focus* pfocus = pdc_stream_get_focus();
+        if ((retval != 0) || (pfocus == NULL))
+        {
+            if (!is_binary)
+            {
+                printf("Could not measure. (%d)\n", retval);
+            }
+            break;
+        }
+        measured++;
+        max_micros = (result.focus_micros > max_micros) ? result.focus_micros : max_micros;
+        if (is_binary)
+        {
+            uint8_t record[FOCUS_RECORD_SIZE];
+            build_focus_record(record, i, &result, &roi, pfocus);
+            printf("FOCUS %u %u\n", i, FOCUS_RECORD_SIZE);
+            if (usb_cdc_write_blocking(record, sizeof(record), SEND_TIMEOUT_MILLIS) != sizeof(record))
+            {
+                break;
+            }
+        }
+        else
+        {
+            printf("%u: %s, gradient %u, laplacian variance %u, focus %u us\n", i, result.is_captured ? "captured" : "failed",
+                   pfocus->gradient, pfocus->laplacian_var, result.focus_micros);
+        }
+    }
+
+    if (is_binary)
+    {
+        printf("\n%u frames\n", measured);
+    }
+    else
+    {
+        // 30fpsで毎フレーム計算した場合のCPU使用率
+        uint32_t cpu_x10 = (uint32_t)(((uint64_t)(max_micros) * 30u) / 1000u);
+        printf("ROI: %u,%u %ux%u, %u frames, focus max %u us (%u.%u%% CPU at 30fps)\n", roi.x, roi.y, roi.width, roi.height, measured,
+               max_micros, cpu_x10 / 10u, cpu_x10 % 10u);
+    }
+
+    return;
+}
+
+/**
+ * @brief 合焦評価値を表示する。
+ * @param pfocus 合焦評価値(NULLの場合は計算していない旨を表示する)
+ */
+static void print_focus(const struct yuv_focus* pfocus)
+{
+    if ((pfocus == NULL) || (pfocus->pixels == 0u))
+    {
+        printf("No focus score.\n");
+        return;
+    }
+
+    printf("pixels: %u, gradient %u, laplacian variance %u\n", pfocus->pixels, pfocus->gradient, pfocus->laplacian_var);
+
+    return;
+}
+
+/**
+ * @brief pdc focus bin で送信するレコードを組み立てる。
+ *        32bitリトルエンディアンの値を8つ並べたもの。
+ *          0: フレーム番号
+ *          4: フラグ(bit0: エラーなくキャプチャできた)
+ *          8: ROIの左端(下位16bit), 上端(上位16bit)
+ *         12: ROIの幅(下位16bit), 高さ(上位16bit)
+ *         16: 評価したピクセル数
+ *         20: 1ピクセルあたりの勾配エネルギー
+ *         24: ラプラシアンの分散
+ *         28: 計算時間[マイクロ秒]
+ * @param pdst 格納先(FOCUS_RECORD_SIZE バイト)
+ * @param index フレーム番号
+ * @param presult キャプチャ結果
+ * @param proi 合焦評価の対象領域
+ * @param pfocus 合焦評価値
+ */
+static void build_focus_record(uint8_t* pdst, uint32_t index, const struct pdc_stream_result* presult, const struct pdc_stream_roi* proi,
+                               const struct yuv_focus* pfocus)
+{
+    put_u32(pdst + 0, index);
+    put_u32(pdst + 4, presult->is_captured ? 1u : 0u);
+    put_u32(pdst + 8, (uint32_t)(proi->x) | ((uint32_t)(proi->y) << 16));
+    put_u32(pdst + 12, (uint32_t)(proi->width) | ((uint32_t)(proi->height) << 16));
+    put_u32(pdst + 16, pfocus->pixels);
+    put_u32(pdst + 20, pfocus->gradient);
+    put_u32(pdst + 24, pfocus->laplacian_var);
+    put_u32(pdst + 28, presult->focus_micros);
+
+    return;
+}
+
+/**
+ * @brief 32bit値をリトルエンディアンで格納する。
+ * @param pdst 格納先
+ * @param value 値
+ */
+static void put_u32(uint8_t* pdst, uint32_t value)
+{
+    pdst[0] = (uint8_t)(value & 0xFFu);
+    pdst[1] = (uint8_t)((value >> 8) & 0xFFu);
+    pdst[2] = (uint8_t)((value >> 16) & 0xFFu);
+    pdst[3] = (uint8_t)((value >> 24) & 0xFFu);
+
+    return;
+}
+
+/**
+ * @brief pdc focus-roi コマンドを処理する。
+ *        pdc focus-roi [center|x# y# width# height#]
+ *        合焦評価の対象領域をキャプチャ範囲内の位置で設定する。x, width は偶数に切り下げる。
+ *        ROIの外側に左右2ピクセル, 上下1ラインが必要になる。
+ *        center を指定すると、キャプチャ範囲の中央(幅, 高さとも1/2)にする。(デフォルト)
+ *        引数がない場合は、現在のキャプチャ範囲での対象領域を表示する。
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_pdc_focus_roi(int ac, char** av)
+{
+    struct pdc_stream_roi roi;
+
+    if ((ac == 3) && (strcmp(av[2], "center") == 0))
+    {
+        pdc_stream_set_focus_roi(NULL);
+    }
+    else if (ac >= 3)
+    {
+        if ((ac != 6) || !parse_u16(av[2], &(roi.x)) || !parse_u16(av[3], &(roi.y)) || !parse_u16(av[4], &(roi.width))
+            || !parse_u16(av[5], &(roi.height)))
+        {
+            printf("usage:\n");
+            printf("  pdc focus-roi [center|x# y# width# height#]\n");
+            return;
+        }
+        if (!pdc_stream_set_focus_roi(&roi))
+        {
+            printf("ROI is out of capture range.\n");
+            return;
+        }
+    }
+    else
+    {
+        // 表示のみ
+    }
+
+    if (pdc_stream_get_focus_roi(&roi))
+    {
+        printf("%u,%u %ux%u\n", roi.x, roi.y, roi.width, roi.height);
+    }
+    else
+    {
+        printf("ROI is not available for current capture range.\n");
+    }
+
+    return;
+}
@@ -0,0 +1,214 @@
+/**
+ * @file selftest コマンド定義
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stddef.h>
+#include <stdio.h>
+#include "utils.h"
+#include "test_signal.h"
+#include "selftest.h"
+#include "command_table.h"
+#include "command_selftest.h"
+
+/**
+ * @brief selftest pdc のデフォルトフレーム数
+ */
+#define DEFAULT_PDC_FRAMES (10)
+
+/**
+ * @brief selftest bands のデフォルトフレーム数
+ */
+#define DEFAULT_BANDS_FRAMES (30)
+
+/**
+ * @brief selftest pdc のデフォルトテストパターン
+ *        ラインの欠落やずれも検出できるように、ライン毎に値が異なるパターンにする。
+ */
+#define DEFAULT_PDC_PATTERN (TEST_PATTERN_LINE_COUNTER)
+
+static void cmd_selftest_pdc(int ac, char** av);
+static void on_pdc_test_done(const struct selftest_pdc_result* presult);
+static void cmd_selftest_bands(int ac, char** av);
+static void on_bands_test_done(const struct selftest_bands_result* presult);
+
+/**
+ * コマンドエントリテーブル
+ */
+//@formatter:off
+static const struct cmd_entry CommandEntries[] = {
+    {"pdc", "GLCDC to PDC loopback test.", cmd_selftest_pdc},
+    {"bands", "Measure band switch position.", cmd_selftest_bands},
+};
+//@formatter:on
+/**
+ * コマンドエントリ数
+ */
+static const int CommandEntryCount = (int)(sizeof(CommandEntries) / sizeof(struct cmd_entry));
+
+/**
+ * @brief selftest コマンドを処理する
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+void cmd_selftest(int ac, char** av)
+{
+    if (ac >= 2)
+    {
+        const struct cmd_entry* pentry = command_table_find_cmd(CommandEntries, CommandEntryCount, av[1]);
+        if (pentry != NULL)
+        {
+            pentry->cmd_proc(ac, av);
+        }
+        else
+        {
+            printf("Unknown subcommand: %s\n", av[1]);
+        }
+    }
+    else
+    {
+        for (uint32_t i = 0u; i < CommandEntryCount; i++)
+        {
+            const struct cmd_entry* pentry = &(CommandEntries[i]);
+            if ((pentry->cmd != NULL) && (pentry->desc != NULL))
+            {
+                printf("selftest %s - %s\n", pentry->cmd, pentry->desc);
+            }
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief selftest pdc コマンドを処理する。
+ *        selftest pdc [frames# [pattern$]]
+ *        現在のPDCキャプチャ範囲で、テストパターンのキャプチャと検証を指定フレーム数だけ繰り返す。
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_selftest_pdc(int ac, char** av)
+{
+    uint32_t frames = DEFAULT_PDC_FRAMES;
+    enum test_pattern pattern = DEFAULT_PDC_PATTERN;
+
+    if ((ac >= 3) && !parse_u32(av[2], &frames))
+    {
+        printf("Invalid argument. %s\n", av[2]);
+        return;
+    }
+    if ((ac >= 4) && !test_signal_find_pattern(av[3], &pattern))
+    {
+        printf("Invalid argument. %s\n", av[3]);
+        return;
+    }
+
+    int retval = selftest_pdc_start(frames, pattern, on_pdc_test_done);
+    if (retval != 0)
+    {
+        printf("Could not start test. (%d)\n", retval);
+        return;
+    }
+    printf("Test started. (%u frames, %s)\n", frames, test_signal_get_pattern_name(pattern));
+
+    return;
+}
+
+/**
+ * @brief PDCループバックテストが完了したときの処理を行う。
+ * @param presult テスト結果
+ */
+static void on_pdc_test_done(const struct selftest_pdc_result* presult)
+{
+    uint32_t total_bytes = presult->captured_frames * presult->frame_bytes;
+    uint32_t elapsed = (presult->elapsed_micros > 0u) ? presult->elapsed_micros : 1u;
+    uint32_t capture = (presult->capture_micros > 0u) ? presult->capture_micros : 1u;
+    // バイト/マイクロ秒 = MB/s なので、100倍して小数点以下2桁まで表示する。
+    uint32_t sustained = (uint32_t)((uint64_t)(total_bytes) * 100u / elapsed);
+    uint32_t capture_rate = (uint32_t)((uint64_t)(total_bytes) * 100u / capture);
+    uint32_t verify_per_frame = (presult->captured_frames > 0u) ? (presult->verify_micros / presult->captured_frames) : 0u;
+    bool is_passed = (presult->captured_frames == presult->frames) && (presult->error_frames == 0u);
+
+    printf("pattern: %s, %u bytes/frame (%u bytes x %u lines)\n", test_signal_get_pattern_name(presult->pattern),
+           presult->frame_bytes, presult->line_bytes, presult->frame_bytes / presult->line_bytes);
+    printf("frames: %u, captured: %u, dropped: %u, error frames: %u\n", presult->frames, presult->captured_frames,
+           presult->dropped_frames, presult->error_frames);
+    printf("bit errors: %u\n", presult->bit_errors);
+    if (presult->has_bad_data)
+    {
+        printf("first bad: frame %u, offset %u (x=%u, y=%u), expected %02xh, actual %02xh\n", presult->first_bad_frame,
+               presult->first_bad_offset, presult->first_bad_offset % presult->line_bytes, presult->first_bad_offset / presult->line_bytes,
+               presult->first_bad_expected, presult->first_bad_actual);
+    }
+    printf("throughput: %u.%02u MB/s sustained, %u.%02u MB/s while capturing\n", sustained / 100u, sustained % 100u,
+           capture_rate / 100u, capture_rate % 100u);
+    printf("elapsed: %u ms, verify: %u us/frame\n", presult->elapsed_micros / 1000u, verify_per_frame);
+    printf("%s\n", (is_passed) ? "PASS" : "FAIL");
+
+    return;
+}
+
+/**
+ * @brief selftest bands コマンドを処理する。
+ *        selftest bands [frames#]
+ *        現在のPDCキャプチャ範囲とバンドテーブルで、バンド毎の背景色の切り替え位置を指定フレーム数だけ測定する。
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_selftest_bands(int ac, char** av)
+{
+    uint32_t frames = DEFAULT_BANDS_FRAMES;
+
+    if ((ac >= 3) && !parse_u32(av[2], &frames))
+    {
+        printf("Invalid argument. %s\n", av[2]);
+        return;
+    }
+
+    int retval = selftest_bands_start(frames, on_bands_test_done);
+    if (retval != 0)
+    {
+        printf("Could not start test. (%d)\n", retval);
+        return;
+    }
+    printf("Test started. (%u frames)\n", frames);
+
+    return;
+}
+
+/**
+ * @brief バンド切り替え位置の測定が完了したときの処理を行う。
+ *        切り替え位置はバンド開始ラインのHSync開始からのピクセルクロック数と時間で表示する。
+ *        キャプチャ範囲の先頭で切り替わっていた場合は、それ以前に切り替わっている。
+ * @param presult 測定結果
+ */
+static void on_bands_test_done(const struct selftest_bands_result* presult)
+{
+    uint32_t pclk_mhz_x10 = presult->pixel_clock_hz / 100000u;
+
+    printf("frames: %u, captured: %u, dropped: %u\n", presult->frames, presult->captured_frames, presult->dropped_frames);
+    printf("pixel clock %u.%u MHz, %u clocks/line, capture starts at %u clocks from HSync\n", pclk_mhz_x10 / 10u,
+           pclk_mhz_x10 % 10u, presult->htotal_clocks, presult->capture_start_clocks);
+    for (int i = 0; i < presult->band_count; i++)
+    {
+        const struct selftest_band_landing* planding = &(presult->landings[i]);
+        printf("line %u -> %02xh: ", planding->line, planding->value);
+        if (!planding->is_measurable)
+        {
+            printf("not measurable\n");
+        }
+        else if (planding->found_frames == 0u)
+        {
+            printf("not found\n");
+        }
+        else
+        {
+            int32_t min_ns = (int32_t)(((int64_t)(planding->min_clocks) * 1000000000) / (int64_t)(presult->pixel_clock_hz));
+            int32_t max_ns = (int32_t)(((int64_t)(planding->max_clocks) * 1000000000) / (int64_t)(presult->pixel_clock_hz));
+            printf("found %u/%u, before capture start %u, at %d..%d clocks (%d..%d ns)\n", planding->found_frames,
+                   presult->captured_frames, planding->clean_frames, (int)(planding->min_clocks), (int)(planding->max_clocks),
+                   (int)(min_ns), (int)(max_ns));
+        }
+    }
+
+    return;
+}
@@ -0,0 +1,11 @@
+/**
+ * @file selftest コマンドインタフェース宣言
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+
+#ifndef COMMAND_SELFTEST_H_
+#define COMMAND_SELFTEST_H_
+
+void cmd_selftest(int ac, char** av);
+
+#endif /* COMMAND_SELFTEST_H_ */
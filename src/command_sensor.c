@@ -0,0 +1,439 @@
+/**
+ * @file sensorコマンド定義
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils.h"
+#include "usb_cdc.h"
+#include "pdc.h"
+#include "pdc_stream.h"
+#include "sensor.h"
+#include "sensor_ae.h"
+#include "command_table.h"
+#include "command_sensor.h"
+
+static void cmd_sensor_probe(int ac, char** av);
+static void cmd_sensor_mode(int ac, char** av);
+static void cmd_sensor_exposure(int ac, char** av);
+static void cmd_sensor_gain(int ac, char** av);
+static void cmd_sensor_stream(int ac, char** av);
+static void cmd_sensor_ae(int ac, char** av);
+static void cmd_sensor_ae_config(int ac, char** av);
+static void cmd_sensor_ae_limits(int ac, char** av);
+static void cmd_sensor_ae_run(int ac, char** av);
+static void print_modes(const struct sensor_driver* pdriver);
+static void print_ae_state(void);
+
+/**
+ * @brief sensor ae-run のデフォルト最大フレーム数
+ */
+#define DEFAULT_AE_RUN_FRAMES (30)
+
+/**
+ * コマンドエントリテーブル
+ */
+//@formatter:off
+static const struct cmd_entry CommandEntries[] = {
+    {"probe", "Probe sensor.", cmd_sensor_probe},
+    {"mode", "Set/Get sensor mode.", cmd_sensor_mode},
+    {"exposure", "Set exposure.", cmd_sensor_exposure},
+    {"gain", "Set gain.", cmd_sensor_gain},
+    {"stream", "Set/Get stream on/off.", cmd_sensor_stream},
+    {"ae", "Start/Stop/Get auto exposure.", cmd_sensor_ae},
+    {"ae-config", "Set/Get auto exposure target and damping.", cmd_sensor_ae_config},
+    {"ae-limits", "Set/Get auto exposure limits.", cmd_sensor_ae_limits},
+    {"ae-run", "Run auto exposure until converged.", cmd_sensor_ae_run},
+};
+//@formatter:on
+/**
+ * コマンドエントリ数
+ */
+static const int CommandEntryCount = (int)(sizeof(CommandEntries) / sizeof(struct cmd_entry));
+
+/**
+ * @brief sensorコマンドを処理する。
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+void cmd_sensor(int ac, char** av)
+{
+    if (ac >= 2)
+    {
+        const struct cmd_entry* pentry = command_table_find_cmd(CommandEntries, CommandEntryCount, av[1]);
+        if (pentry != NULL)
+        {
+            pentry->cmd_proc(ac, av);
+        }
+        else
+        {
+            printf("Unknown subcommand: %s\n", av[1]);
+        }
+    }
+    else
+    {
+        for (uint32_t i = 0u; i < CommandEntryCount; i++)
+        {
+            const struct cmd_entry* pentry = &(CommandEntries[i]);
+            if ((pentry->cmd != NULL) && (pentry->desc != NULL))
+            {
+                printf("sensor %s - %s\n", pentry->cmd, pentry->desc);
+            }
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief sensor probe コマンドを処理する。
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_sensor_probe(int ac, char** av)
+{
+    int s = sensor_probe();
+    if (s != 0)
+    {
+        printf("Sensor not found. (%d)\n", s);
+        return;
+    }
+
+    const struct sensor_driver* pdriver = sensor_get_driver();
+    printf("%s\n", pdriver->name);
+    print_modes(pdriver);
+
+    return;
+}
+
+/**
+ * @brief sensor mode コマンドを処理する。
+ *        sensor mode [name$]
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_sensor_mode(int ac, char** av)
+{
+    const struct sensor_driver* pdriver = sensor_get_driver();
+    if (pdriver == NULL)
+    {
+        printf("Sensor not probed.\n");
+        return;
+    }
+
+    if (ac >= 3)
+    {
+        int s = sensor_set_mode(av[2]);
+        if (s != 0)
+        {
+            printf("Could not set mode. (%d)\n", s);
+            return;
+        }
+    }
+
+    const struct sensor_mode* pmode = sensor_get_mode();
+    if (pmode != NULL)
+    {
+        printf("%s %ux%u (capture %u %u %u %u %u)\n", pmode->name, pmode->width, pmode->height, pmode->xst, pmode->xsize, pmode->yst, pmode->ysize,
+               pmode->bpp);
+    }
+    else
+    {
+        printf("Mode not set.\n");
+        print_modes(pdriver);
+    }
+
+    return;
+}
+
+/**
+ * @brief sensor exposure コマンドを処理する。
+ *        sensor exposure lines#
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_sensor_exposure(int ac, char** av)
+{
+    uint32_t exposure;
+
+    if ((ac != 3) || !parse_u32(av[2], &exposure))
+    {
+        printf("usage:\n");
+        printf("  sensor exposure lines#\n");
+        return;
+    }
+
+    sensor_ae_stop(); // 手動で設定した値を自動露出が上書きしないようにする。
+    int s = sensor_set_exposure(exposure);
+    if (s != 0)
+    {
+        printf("Could not set exposure. (%d)\n", s);
+    }
+
+    return;
+}
+
+/**
+ * @brief sensor gain コマンドを処理する。
+ *        sensor gain gain# (16で1倍)
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_sensor_gain(int ac, char** av)
+{
+    uint16_t gain;
+
+    if ((ac != 3) || !parse_u16(av[2], &gain))
+    {
+        printf("usage:\n");
+        printf("  sensor gain gain# (16=x1)\n");
+        return;
+    }
+
+    sensor_ae_stop(); // 手動で設定した値を自動露出が上書きしないようにする。
+    int s = sensor_set_gain(gain);
+    if (s != 0)
+    {
+        printf("Could not set gain. (%d)\n", s);
+    }
+
+    return;
+}
+
+/**
+ * @brief sensor stream コマンドを処理する。
+ *        sensor stream [on|off]
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_sensor_stream(int ac, char** av)
+{
+    if (ac >= 3)
+    {
+        bool is_on;
+        if (!parse_boolean(av[2], &is_on))
+        {
+            printf("Invalid argument. : %s\n", av[2]);
+            return;
+        }
+        int s = sensor_set_stream(is_on);
+        if (s != 0)
+        {
+            printf("Could not set stream. (%d)\n", s);
+            return;
+        }
+    }
+    else
+    {
+        printf("%s\n", sensor_is_streaming() ? "on" : "off");
+    }
+
+    return;
+}
+
+/**
+ * @brief sensor ae コマンドを処理する。
+ *        sensor ae [on|off]
+ *        on にすると、pdc read/preview/stats でキャプチャしたフレーム毎に露光時間/ゲインを補正する。
+ *        引数がない場合は状態を表示する。
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_sensor_ae(int ac, char** av)
+{
+    if (ac >= 3)
+    {
+        bool is_on;
+        if (!parse_boolean(av[2], &is_on))
+        {
+            printf("Invalid argument. : %s\n", av[2]);
+            return;
+        }
+        if (is_on)
+        {
+            int s = sensor_ae_start();
+            if (s != 0)
+            {
+                printf("Could not start auto exposure. (%d)\n", s);
+                return;
+            }
+        }
+        else
+        {
+            sensor_ae_stop();
+        }
+    }
+    else
+    {
+        print_ae_state();
+    }
+
+    return;
+}
+
+/**
+ * @brief sensor ae-config コマンドを処理する。
+ *        sensor ae-config [target# [damping# [tolerance# [settle-frames#]]]]
+ *        damping は1フレームで補正する割合[%] (1〜100)
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_sensor_ae_config(int ac, char** av)
+{
+    struct sensor_ae_config config;
+
+    sensor_ae_get_config(&config);
+    if (ac >= 3)
+    {
+        if (!parse_u8(av[2], &(config.target)) || ((ac >= 4) && !parse_u8(av[3], &(config.damping)))
+            || ((ac >= 5) && !parse_u8(av[4], &(config.tolerance))) || ((ac >= 6) && !parse_u8(av[5], &(config.settle_frames)))
+            || !sensor_ae_set_config(&config))
+        {
+            printf("usage:\n");
+            printf("  sensor ae-config [target# [damping%%# [tolerance# [settle-frames#]]]]\n");
+            return;
+        }
+    }
+    else
+    {
+        printf("target: %u, damping: %u%%, tolerance: %u, settle frames: %u\n", config.target, config.damping, config.tolerance,
+               config.settle_frames);
+    }
+
+    return;
+}
+
+/**
+ * @brief sensor ae-limits コマンドを処理する。
+ *        sensor ae-limits [min-exposure# max-exposure# min-gain# max-gain#]
+ *        露光時間はライン数, ゲインは16で1倍。
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_sensor_ae_limits(int ac, char** av)
+{
+    struct sensor_ae_config config;
+
+    sensor_ae_get_config(&config);
+    if (ac >= 3)
+    {
+        if ((ac != 6) || !parse_u32(av[2], &(config.min_exposure)) || !parse_u32(av[3], &(config.max_exposure))
+            || !parse_u16(av[4], &(config.min_gain)) || !parse_u16(av[5], &(config.max_gain)) || !sensor_ae_set_config(&config))
+        {
+            printf("usage:\n");
+            printf("  sensor ae-limits min-exposure# max-exposure# min-gain# max-gain# (16=x1)\n");
+            return;
+        }
+    }
+    else
+    {
+        printf("exposure: %u-%u lines (mode limit %u), gain: %u-%u (16=x1)\n", config.min_exposure, config.max_exposure,
+               sensor_ae_get_max_exposure(), config.min_gain, config.max_gain);
+    }
+
+    return;
+}
+
+/**
+ * @brief sensor ae-run コマンドを処理する。
+ *        sensor ae-run [frames#]
+ *        フレームをキャプチャ(送信しない)しながら自動露出を動かし、収束するか、補正できなくなるか、
+ *        指定フレーム数に達するまで、フレーム毎に平均輝度と露光時間/ゲインを表示する。何か受信すると中止する。
+ *        自動露出が停止していた場合は、終了後に停止する。
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_sensor_ae_run(int ac, char** av)
+{
+    uint32_t frames = DEFAULT_AE_RUN_FRAMES;
+
+    if ((ac >= 3) && (!parse_u32(av[2], &frames) || (frames == 0u)))
+    {
+        printf("usage:\n");
+        printf("  sensor ae-run [frames#]\n");
+        return;
+    }
+    if (pdc_is_busy())
+    {
+        printf("Capture is running.\n");
+        return;
+    }
+
+    bool was_enabled = sensor_ae_is_enabled();
+    if (!was_enabled)
+    {
+        int s = sensor_ae_start();
+        if (s != 0)
+        {
+            printf("Could not start auto exposure. (%d)\n", s);
+            return;
+        }
+    }
+
+    for (uint32_t i = 0u; i < frames; i++)
+    {
+        uint8_t c;
+        if (usb_cdc_read(&c, sizeof(c)) > 0) // 中止要求？
+        {
+            break;
+        }
+
+        struct pdc_stream_result result;
+        int s = pdc_stream_measure(&result);
+        if (s != 0)
+        {
+            printf("Could not capture. (%d)\n", s);
+            break;
+        }
+        struct sensor_ae_state state;
+        sensor_ae_get_state(&state);
+        printf("%u: %s, mean %u, exposure %u, gain %u%s%s\n", i, result.is_captured ? "captured" : "failed", state.last_mean,
+               state.exposure, state.gain, state.is_converged ? ", converged" : "", state.is_limited ? ", limited" : "");
+        if (state.is_converged || state.is_limited)
+        {
+            break;
+        }
+    }
+
+    if (!was_enabled)
+    {
+        sensor_ae_stop();
+    }
+
+    return;
+}
+
+/**
+ * @brief 自動露出の状態を表示する。
+ */
+static void print_ae_state(void)
+{
+    struct sensor_ae_state state;
+
+    sensor_ae_get_state(&state);
+    printf("%s\n", state.is_enabled ? "on" : "off");
+    printf("exposure: %u lines, gain: %u (16=x1), last mean: %u%s%s\n", state.exposure, state.gain, state.last_mean,
+           state.is_converged ? ", converged" : "", state.is_limited ? ", limited" : "");
+    printf("frames: %u, settled: %u, updates: %u, errors: %u\n", state.frames, state.settled, state.updates, state.errors);
+
+    return;
+}
+
+/**
+ * @brief センサのモード一覧を表示する。
+ * @param pdriver センサドライバ
+ */
+static void print_modes(const struct sensor_driver* pdriver)
+{
+    for (uint8_t i = 0u; i < pdriver->mode_count; i++)
+    {
+        const struct sensor_mode* pmode = &(pdriver->modes[i]);
+        printf("  %s %ux%u\n", pmode->name, pmode->width, pmode->height);
+    }
+
+    return;
+}
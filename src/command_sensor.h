@@ -0,0 +1,11 @@
+/**
+ * @file sensorコマンドインタフェース宣言
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+
+#ifndef COMMAND_SENSOR_H_
+#define COMMAND_SENSOR_H_
+
+void cmd_sensor(int ac, char** av);
+
+#endif /* COMMAND_SENSOR_H_ */
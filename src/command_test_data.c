@@ -4,13 +4,22 @@
  */
 #include <stddef.h>
 #include <stdio.h>
+#include <string.h>
 #include "utils.h"
 #include "test_signal.h"
+#include "pdc.h"
 #include "command_table.h"
 #include "command_test_data.h"
 
 static void cmd_test_data_output(int ac, char** av);
 static void cmd_test_data_data(int ac, char** av);
+static void cmd_test_data_pattern(int ac, char** av);
+static void cmd_test_data_timing(int ac, char** av);
+static void cmd_test_data_stamp(int ac, char** av);
+static void cmd_test_data_bands(int ac, char** av);
+static bool parse_band(char* str, struct test_signal_band* pband);
+static void print_timing(void);
+static bool follow_capture_range(void);
 
 /**
  * コマンドエントリテーブル
@@ -19,6 +28,10 @@ static void cmd_test_data_data(int ac, char** av);
 static const struct cmd_entry CommandEntries[] = {
     {"output", "Output On/Off control.", cmd_test_data_output},
     {"data", "Set test data.", cmd_test_data_data},
+    {"pattern", "Set test pattern.", cmd_test_data_pattern},
+    {"timing", "Set timing profile.", cmd_test_data_timing},
+    {"stamp", "Frame number stamp On/Off control.", cmd_test_data_stamp},
+    {"bands", "Set band pattern.", cmd_test_data_bands},
 };
 //@formatter:on
 /**
@@ -116,3 +129,220 @@ static void cmd_test_data_data(int ac, char** av)
         printf("%xh\n", test_signal_get_data());
     }
 }
+
+/**
+ * @brief test-data pattern コマンドを処理する
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_test_data_pattern(int ac, char** av)
+{
+    if (ac >= 3)
+    {
+        enum test_pattern pattern;
+        if (!test_signal_find_pattern(av[2], &pattern))
+        {
+            printf("Invalid argument. %s\n", av[2]);
+            for (int i = 0; i < TEST_PATTERN_COUNT; i++)
+            {
+                printf("  %s\n", test_signal_get_pattern_name((enum test_pattern)(i)));
+            }
+            return;
+        }
+        if (!test_signal_set_pattern(pattern))
+        {
+            printf("Set test pattern failure.\n");
+            return;
+        }
+        printf("%s\n", test_signal_get_pattern_name(test_signal_get_pattern()));
+    }
+    else
+    {
+        printf("%s\n", test_signal_get_pattern_name(test_signal_get_pattern()));
+    }
+}
+
+/**
+ * @brief test-data timing コマンドを処理する
+ *        test-data timing [profile$]
+ *        プロファイルを設定した場合には、PDCのキャプチャ範囲と同期信号極性も新しいタイミングに合わせる。
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_test_data_timing(int ac, char** av)
+{
+    if (ac >= 3)
+    {
+        const struct test_signal_profile* pprofile = test_signal_find_profile(av[2]);
+        if (pprofile == NULL)
+        {
+            printf("Invalid argument. %s\n", av[2]);
+            for (int i = 0; i < test_signal_get_profile_count(); i++)
+            {
+                printf("  %s\n", test_signal_get_profile_at(i)->name);
+            }
+            return;
+        }
+        if (pdc_is_running())
+        {
+            printf("PDC is running.\n");
+            return;
+        }
+        if (!test_signal_set_profile(pprofile))
+        {
+            printf("Set timing profile failure.\n");
+            return;
+        }
+        if (!follow_capture_range())
+        {
+            printf("Could not set capture range.\n");
+        }
+    }
+    print_timing();
+
+    return;
+}
+
+/**
+ * @brief test-data stamp コマンドを処理する。
+ *        test-data stamp [on|off]
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_test_data_stamp(int ac, char** av)
+{
+    if (ac >= 3)
+    {
+        bool is_on;
+        if (!parse_boolean(av[2], &is_on))
+        {
+            printf("Invalid argument. %s\n", av[2]);
+            return;
+        }
+        if (!test_signal_set_stamp(is_on))
+        {
+            printf("Set frame number stamp failure.\n");
+            return;
+        }
+    }
+    printf("%s (frame %u)\n", test_signal_is_stamp_enabled() ? "on" : "off", test_signal_get_frame_seq());
+
+    return;
+}
+
+/**
+ * @brief test-data bands コマンドを処理する。
+ *        test-data bands [clear | line#:value# [line#:value# [...]]]
+ *        バンドテーブルを設定し、テストパターンをバンドにする。
+ * @param ac 引数の数
+ * @param av 引数配列
+ */
+static void cmd_test_data_bands(int ac, char** av)
+{
+    if (ac >= 3)
+    {
+        struct test_signal_band bands[TEST_SIGNAL_MAX_BANDS];
+        int count = 0;
+        if (strcmp(av[2], "clear") != 0)
+        {
+            if ((ac - 2) > TEST_SIGNAL_MAX_BANDS)
+            {
+                printf("Too many bands. (max %d)\n", TEST_SIGNAL_MAX_BANDS);
+                return;
+            }
+            for (int i = 2; i < ac; i++)
+            {
+                if (!parse_band(av[i], &(bands[count])))
+                {
+                    printf("Invalid argument. %s\n", av[i]);
+                    return;
+                }
+                count++;
+            }
+        }
+        if (!test_signal_set_bands(bands, count))
+        {
+            printf("Invalid band table. (ascending, %d lines apart, within active lines)\n", TEST_SIGNAL_BAND_MIN_LINES);
+            return;
+        }
+        if (!test_signal_set_pattern(TEST_PATTERN_BANDS))
+        {
+            printf("Set test pattern failure.\n");
+            return;
+        }
+    }
+
+    const struct test_signal_band* pbands;
+    int count = test_signal_get_bands(&pbands);
+    printf("0: %02xh (test data)\n", test_signal_get_data());
+    for (int i = 0; i < count; i++)
+    {
+        printf("%u: %02xh\n", pbands[i].line, pbands[i].value);
+    }
+
+    return;
+}
+
+/**
+ * @brief バンド指定(line:value)を解析する。
+ * @param str 文字列(区切り文字が書き換えられる)
+ * @param pband バンドを格納する変数
+ * @return 成功した場合にはtrue, 失敗した場合にはfalse.
+ */
+static bool parse_band(char* str, struct test_signal_band* pband)
+{
+    char* pvalue = strchr(str, ':');
+    if (pvalue == NULL)
+    {
+        return false;
+    }
+    (*pvalue) = '\0';
+    pvalue++;
+
+    return parse_u16(str, &(pband->line)) && parse_u8(pvalue, &(pband->value));
+}
+
+/**
+ * @brief 現在のタイミングを表示する。
+ */
+static void print_timing(void)
+{
+    struct test_signal_timing timing;
+    test_signal_get_timing(&timing);
+
+    uint32_t htotal = (uint32_t)(timing.hactive) + timing.hfp + timing.hsync + timing.hbp;
+    uint32_t vtotal = (uint32_t)(timing.vactive) + timing.vfp + timing.vsync + timing.vbp;
+    uint32_t fps_x10 = (uint32_t)((uint64_t)(timing.pixel_clock_hz) * 10u / (htotal * vtotal));
+
+    printf("%s\n", test_signal_get_profile()->name);
+    printf("  H: active %u, fp %u, sync %u, bp %u (total %u)\n", timing.hactive, timing.hfp, timing.hsync, timing.hbp, htotal);
+    printf("  V: active %u, fp %u, sync %u, bp %u (total %u)\n", timing.vactive, timing.vfp, timing.vsync, timing.vbp, vtotal);
+    printf("  pixel clock %u Hz, %u.%u fps\n", timing.pixel_clock_hz, fps_x10 / 10u, fps_x10 % 10u);
+
+    return;
+}
+
+/**
+ * @brief PDCのキャプチャ範囲と同期信号極性をテスト信号のタイミングに合わせる。
+ *        有効表示領域全体(YUYV)をキャプチャする。キャプチャバッファに収まらない場合はライン数を減らす。
+ * @return 成功した場合にはtrue, 失敗した場合にはfalse.
+ */
+static bool follow_capture_range(void)
+{
+    struct test_signal_timing timing;
+    test_signal_get_timing(&timing);
+
+    uint16_t ysize = timing.vactive;
+    uint32_t max_lines = pdc_get_capture_buffer_size() / timing.hactive;
+    if (ysize > max_lines)
+    {
+        ysize = (uint16_t)(max_lines);
+    }
+    while ((ysize > 0u) && ((((uint32_t)(timing.hactive) * ysize) % 32u) != 0u)) // PDCの転送単位(32バイト)に合わせる。
+    {
+        ysize--;
+    }
+
+    return pdc_set_signal_polarity(timing.is_hsync_hactive, timing.is_vsync_hactive)
+           && pdc_set_capture_range(timing.hbp / 2u, timing.hactive / 2u, timing.vbp, ysize, 2u);
+}
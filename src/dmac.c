@@ -0,0 +1,453 @@
+/**
+ * @file DMACチャネル管理定義
+ *        DMAC0〜DMAC7の所有者を管理し、実行時にチャネルを確保/解放する。
+ *        確保したチャネルの転送完了割り込みは、チャネル毎に登録したコールバックに振り分ける。
+ *        (DMAC4〜DMAC7は割り込み要因DMAC74Iを共有するため、DMISTで要因のチャネルを判別する)
+ *        Smart Configuratorでコード生成したチャネル(PDC用のDMAC3)は、割り込みハンドラも生成コード側にあるため、
+ *        初期化時に所有者だけを登録(予約)し、動的な確保の対象にしない。
+ *        統計は、チャネルを使用するモジュールが転送の開始/終了を通知して集計する。
+ * @author Cosmosweb Co.,Ltd. 2024
+ * @note DMACのモジュールストップ解除と起動許可(DMAST.DMST)は、HardwareSetup内のR_Config_DMAC3_Create()で行われる。
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include <platform.h>
+
+#include "hwtick.h"
+#include "dmac.h"
+
+/**
+ * @brief 割り込み要因DMAC74Iを共有する最初のチャネル
+ */
+#define SHARED_IRQ_FIRST_CHANNEL (4)
+
+/**
+ * @brief Smart Configurator(Config_DMAC3)でPDC用に生成されたチャネル
+ */
+#define PDC_CHANNEL (3)
+
+/**
+ * @brief チャネル管理情報
+ */
+struct dmac_channel
+{
+    const char* owner;        // 所有者名(未確保の場合はNULL)
+    bool is_reserved;         // コード生成されたドライバが使用するチャネルかどうか
+    uint8_t int_priority;     // 割り込みプライオリティ
+    void (*callback)(int ch); // 転送完了時コールバック
+    volatile bool is_busy;    // 転送中かどうか
+    uint32_t begin_micros;    // 転送開始時刻[マイクロ秒]
+    uint32_t transfers;       // 完了した転送数
+    uint64_t bytes;           // 転送したバイト数の合計
+    uint32_t busy_micros;     // 転送中だった時間の合計[マイクロ秒]
+};
+
+static void set_channel_interrupt(int ch, bool is_enabled);
+static void update_shared_interrupt(void);
+static void dispatch(int ch);
+
+/**
+ * @brief チャネルのレジスタ
+ *        DMAC0はDMOFRが追加されているが、それ以外のレジスタ配置はDMAC1〜DMAC7と同じ。
+ */
+//@formatter:off
+static volatile struct st_dmac1* const s_regs[DMAC_CHANNEL_COUNT] = {
+    (volatile struct st_dmac1*)(&DMAC0), &DMAC1, &DMAC2, &DMAC3, &DMAC4, &DMAC5, &DMAC6, &DMAC7
+};
+//@formatter:on
+
+/**
+ * @brief チャネルの起動要因レジスタ(DMRSRn)
+ */
+//@formatter:off
+static volatile uint8_t* const s_dmrsr[DMAC_CHANNEL_COUNT] = {
+    &ICU.DMRSR0, &ICU.DMRSR1, &ICU.DMRSR2, &ICU.DMRSR3, &ICU.DMRSR4, &ICU.DMRSR5, &ICU.DMRSR6, &ICU.DMRSR7
+};
+//@formatter:on
+
+/**
+ * @brief チャネル管理情報
+ */
+static struct dmac_channel s_channels[DMAC_CHANNEL_COUNT];
+
+/**
+ * @brief DMACチャネル管理を初期化する。
+ *        他のモジュールがチャネルを確保する前に呼び出すこと。
+ */
+void dmac_init(void)
+{
+    memset(s_channels, 0, sizeof(s_channels));
+    dmac_reserve(PDC_CHANNEL, "pdc");
+
+    return;
+}
+
+/**
+ * @brief 空きチャネルを確保する。
+ *        確保したチャネルは転送停止状態で、転送完了割り込みが許可される。
+ *        転送モード等のレジスタ設定は、dmac_get_regs()で得たレジスタに対して確保した側で行う。
+ * @param owner 所有者名
+ * @param priority 優先度
+ * @param int_priority 転送完了割り込みのプライオリティ(DMAC4〜DMAC7は共有するチャネルの最大値になる)
+ * @param callback 転送完了時に呼び出すコールバック関数(割り込みコンテキスト, 不要な場合はNULL)
+ * @return 確保したチャネル番号。空きチャネルがない場合には DMAC_NO_CHANNEL.
+ */
+int dmac_claim(const char* owner, enum dmac_priority priority, uint8_t int_priority, void (*callback)(int ch))
+{
+    if ((owner == NULL) || (int_priority > 15u))
+    {
+        return DMAC_NO_CHANNEL;
+    }
+
+    int ch = DMAC_NO_CHANNEL;
+    R_BSP_InterruptsDisable();
+    for (int i = 0; i < DMAC_CHANNEL_COUNT; i++)
+    {
+        int candidate = (priority == DMAC_PRIORITY_HIGH) ? i : (DMAC_CHANNEL_COUNT - 1 - i);
+        if (s_channels[candidate].owner == NULL)
+        {
+            ch = candidate;
+            s_channels[ch].owner = owner;
+            break;
+        }
+    }
+    R_BSP_InterruptsEnable();
+    if (ch == DMAC_NO_CHANNEL)
+    {
+        return DMAC_NO_CHANNEL;
+    }
+
+    struct dmac_channel* pch = &(s_channels[ch]);
+    pch->is_reserved = false;
+    pch->int_priority = int_priority;
+    pch->callback = callback;
+    pch->is_busy = false;
+    s_regs[ch]->DMCNT.BIT.DTE = 0U;
+    (*s_dmrsr[ch]) = 0U;
+    set_channel_interrupt(ch, true);
+
+    return ch;
+}
+
+/**
+ * @brief コード生成されたドライバが使用するチャネルの所有者を登録する。
+ *        レジスタ設定と割り込みは生成されたドライバが行うため、変更しない。
+ * @param ch チャネル番号
+ * @param owner 所有者名
+ * @return 成功した場合にはtrue, 失敗した場合(確保済み)にはfalse.
+ */
+bool dmac_reserve(int ch, const char* owner)
+{
+    if ((ch < 0) || (ch >= DMAC_CHANNEL_COUNT) || (owner == NULL))
+    {
+        return false;
+    }
+
+    bool is_succeed = false;
+    R_BSP_InterruptsDisable();
+    if (s_channels[ch].owner == NULL)
+    {
+        s_channels[ch].owner = owner;
+        s_channels[ch].is_reserved = true;
+        s_channels[ch].callback = NULL;
+        is_succeed = true;
+    }
+    R_BSP_InterruptsEnable();
+
+    return is_succeed;
+}
+
+/**
+ * @brief チャネルを解放する。転送中の場合は停止する。統計は残る。
+ * @param ch チャネル番号
+ * @return 成功した場合にはtrue, 失敗した場合にはfalse.
+ */
+bool dmac_release(int ch)
+{
+    if ((ch < 0) || (ch >= DMAC_CHANNEL_COUNT) || (s_channels[ch].owner == NULL))
+    {
+        return false;
+    }
+
+    struct dmac_channel* pch = &(s_channels[ch]);
+    if (!pch->is_reserved)
+    {
+        s_regs[ch]->DMCNT.BIT.DTE = 0U;
+        (*s_dmrsr[ch]) = 0U;
+    }
+    pch->is_busy = false;
+    pch->callback = NULL;
+    pch->owner = NULL; // 割り込み許可の判定から外してから割り込みを更新する。
+    if (!pch->is_reserved)
+    {
+        set_channel_interrupt(ch, false);
+    }
+    pch->is_reserved = false;
+
+    return true;
+}
+
+/**
+ * @brief チャネルのレジスタを得る。
+ * @param ch チャネル番号
+ * @return レジスタ。チャネル番号が範囲外の場合にはNULL.
+ */
+volatile struct st_dmac1* dmac_get_regs(int ch)
+{
+    return ((ch >= 0) && (ch < DMAC_CHANNEL_COUNT)) ? s_regs[ch] : NULL;
+}
+
+/**
+ * @brief チャネルの起動要因(DMRSR)を設定する。転送停止中に呼び出すこと。
+ * @param ch チャネル番号
+ * @param source 起動要因の割り込みベクタ番号(ソフトウェア起動のみの場合は0)
+ * @return 成功した場合にはtrue, 失敗した場合にはfalse.
+ */
+bool dmac_set_activation_source(int ch, uint8_t source)
+{
+    if ((ch < 0) || (ch >= DMAC_CHANNEL_COUNT) || (s_channels[ch].owner == NULL) || s_channels[ch].is_reserved
+        || (s_regs[ch]->DMCNT.BIT.DTE != 0U))
+    {
+        return false;
+    }
+
+    (*s_dmrsr[ch]) = source;
+
+    return true;
+}
+
+/**
+ * @brief 転送の開始を通知する。(統計用)
+ * @param ch チャネル番号
+ */
+void dmac_notify_start(int ch)
+{
+    if ((ch < 0) || (ch >= DMAC_CHANNEL_COUNT))
+    {
+        return;
+    }
+
+    s_channels[ch].begin_micros = hwtick_get_micros();
+    s_channels[ch].is_busy = true;
+
+    return;
+}
+
+/**
+ * @brief 転送の終了を通知する。(統計用, 割り込みコンテキストからも呼び出せる)
+ *        開始が通知されていない場合は何もしない。
+ * @param ch チャネル番号
+ * @param bytes 転送したバイト数
+ */
+void dmac_notify_end(int ch, uint32_t bytes)
+{
+    if ((ch < 0) || (ch >= DMAC_CHANNEL_COUNT) || !s_channels[ch].is_busy)
+    {
+        return;
+    }
+
+    struct dmac_channel* pch = &(s_channels[ch]);
+    pch->is_busy = false;
+    pch->busy_micros += hwtick_get_micros() - pch->begin_micros;
+    pch->bytes += bytes;
+    pch->transfers++;
+
+    return;
+}
+
+/**
+ * @brief チャネルの使用状況を得る。
+ * @param ch チャネル番号
+ * @param pinfo 使用状況を格納する構造体
+ * @return 成功した場合にはtrue, 失敗した場合にはfalse.
+ */
+bool dmac_get_info(int ch, struct dmac_channel_info* pinfo)
+{
+    if ((ch < 0) || (ch >= DMAC_CHANNEL_COUNT) || (pinfo == NULL))
+    {
+        return false;
+    }
+
+    const struct dmac_channel* pch = &(s_channels[ch]);
+    R_BSP_InterruptsDisable(); // 割り込みで更新される統計を揃えて読む。
+    pinfo->owner = pch->owner;
+    pinfo->is_reserved = pch->is_reserved;
+    pinfo->is_busy = pch->is_busy;
+    pinfo->transfers = pch->transfers;
+    pinfo->bytes = pch->bytes;
+    pinfo->busy_micros = pch->busy_micros;
+    R_BSP_InterruptsEnable();
+    pinfo->activation_source = (*s_dmrsr[ch]);
+
+    return true;
+}
+
+/**
+ * @brief 全チャネルの統計をクリアする。
+ */
+void dmac_clear_stats(void)
+{
+    R_BSP_InterruptsDisable();
+    for (int ch = 0; ch < DMAC_CHANNEL_COUNT; ch++)
+    {
+        s_channels[ch].transfers = 0u;
+        s_channels[ch].bytes = 0u;
+        s_channels[ch].busy_micros = 0u;
+    }
+    R_BSP_InterruptsEnable();
+
+    return;
+}
+
+/**
+ * @brief チャネルの転送完了割り込みを許可/禁止する。
+ * @param ch チャネル番号
+ * @param is_enabled 許可する場合にはtrue, 禁止する場合にはfalse.
+ */
+static void set_channel_interrupt(int ch, bool is_enabled)
+{
+    uint8_t priority = s_channels[ch].int_priority;
+
+    switch (ch)
+    {
+    case 0: {
+        IEN(DMAC, DMAC0I) = 0U;
+        IPR(DMAC, DMAC0I) = priority;
+        IR(DMAC, DMAC0I) = 0U;
+        IEN(DMAC, DMAC0I) = (is_enabled) ? 1U : 0U;
+        break;
+    }
+    case 1: {
+        IEN(DMAC, DMAC1I) = 0U;
+        IPR(DMAC, DMAC1I) = priority;
+        IR(DMAC, DMAC1I) = 0U;
+        IEN(DMAC, DMAC1I) = (is_enabled) ? 1U : 0U;
+        break;
+    }
+    case 2: {
+        IEN(DMAC, DMAC2I) = 0U;
+        IPR(DMAC, DMAC2I) = priority;
+        IR(DMAC, DMAC2I) = 0U;
+        IEN(DMAC, DMAC2I) = (is_enabled) ? 1U : 0U;
+        break;
+    }
+    case 3: {
+        break; // DMAC3はコード生成されたドライバが割り込みを管理する。
+    }
+    default: {
+        update_shared_interrupt();
+        break;
+    }
+    }
+
+    return;
+}
+
+/**
+ * @brief DMAC4〜DMAC7で共有する割り込みDMAC74Iを、確保されているチャネルに合わせて設定する。
+ *        プライオリティは確保されているチャネルの最大値にする。
+ */
+static void update_shared_interrupt(void)
+{
+    uint8_t priority = 0u;
+    bool is_used = false;
+
+    for (int ch = SHARED_IRQ_FIRST_CHANNEL; ch < DMAC_CHANNEL_COUNT; ch++)
+    {
+        const struct dmac_channel* pch = &(s_channels[ch]);
+        if ((pch->owner != NULL) && !pch->is_reserved)
+        {
+            is_used = true;
+            if (pch->int_priority > priority)
+            {
+                priority = pch->int_priority;
+            }
+        }
+    }
+
+    IEN(DMAC, DMAC74I) = 0U;
+    IPR(DMAC, DMAC74I) = priority;
+    if (is_used)
+    {
+        IEN(DMAC, DMAC74I) = 1U;
+    }
+
+    return;
+}
+
+/**
+ * @brief チャネルの転送完了をコールバックに通知する。(割り込みコンテキスト)
+ * @param ch チャネル番号
+ */
+static void dispatch(int ch)
+{
+    volatile struct st_dmac1* pregs = s_regs[ch];
+
+    if (pregs->DMSTS.BIT.DTIF == 0U)
+    {
+        return;
+    }
+    pregs->DMSTS.BIT.DTIF = 0U;
+
+    void (*callback)(int ch) = s_channels[ch].callback;
+    if (callback != NULL)
+    {
+        callback(ch);
+    }
+
+    return;
+}
+
+/**
+ * @brief DMAC0転送完了割り込みハンドラ
+ */
+R_BSP_PRAGMA_STATIC_INTERRUPT(dmac_dmac0i_isr, VECT(DMAC, DMAC0I))
+R_BSP_ATTRIB_STATIC_INTERRUPT void dmac_dmac0i_isr(void)
+{
+    dispatch(0);
+
+    return;
+}
+
+/**
+ * @brief DMAC1転送完了割り込みハンドラ
+ */
+R_BSP_PRAGMA_STATIC_INTERRUPT(dmac_dmac1i_isr, VECT(DMAC, DMAC1I))
+R_BSP_ATTRIB_STATIC_INTERRUPT void dmac_dmac1i_isr(void)
+{
+    dispatch(1);
+
+    return;
+}
+
+/**
+ * @brief DMAC2転送完了割り込みハンドラ
+ */
+R_BSP_PRAGMA_STATIC_INTERRUPT(dmac_dmac2i_isr, VECT(DMAC, DMAC2I))
+R_BSP_ATTRIB_STATIC_INTERRUPT void dmac_dmac2i_isr(void)
+{
+    dispatch(2);
+
+    return;
+}
+
+/**
+ * @brief DMAC4〜DMAC7転送完了割り込みハンドラ
+ *        DMISTで割り込みを要求しているチャネルを判別する。
+ */
+R_BSP_PRAGMA_STATIC_INTERRUPT(dmac_dmac74i_isr, VECT(DMAC, DMAC74I))
+R_BSP_ATTRIB_STATIC_INTERRUPT void dmac_dmac74i_isr(void)
+{
+    uint8_t requests = DMAC.DMIST.BYTE;
+
+    for (int ch = SHARED_IRQ_FIRST_CHANNEL; ch < DMAC_CHANNEL_COUNT; ch++)
+    {
+        if ((requests & (uint8_t)(1u << ch)) != 0u)
+        {
+            dispatch(ch);
+        }
+    }
+
+    return;
+}
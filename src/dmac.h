@@ -0,0 +1,61 @@
+/**
+ * @file DMACチャネル管理のインタフェース宣言
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+
+#ifndef DMAC_H_
+#define DMAC_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <platform.h>
+
+/**
+ * @brief DMACチャネル数
+ */
+#define DMAC_CHANNEL_COUNT (8)
+
+/**
+ * @brief チャネルを確保できなかったことを表すチャネル番号
+ */
+#define DMAC_NO_CHANNEL (-1)
+
+/**
+ * @brief チャネル確保時の優先度
+ *        DMACのチャネル間の優先順位は固定(DMAC0が最高, DMAC7が最低)なので、
+ *        優先度に応じて空きチャネルを探す順番を変える。
+ */
+enum dmac_priority
+{
+    DMAC_PRIORITY_HIGH = 0, // 番号の小さい(優先順位の高い)チャネルから確保する
+    DMAC_PRIORITY_LOW,      // 番号の大きい(優先順位の低い)チャネルから確保する
+};
+
+/**
+ * @brief チャネルの使用状況
+ */
+struct dmac_channel_info
+{
+    const char* owner;         // 所有者名(未確保の場合はNULL)
+    bool is_reserved;          // コード生成されたドライバが使用するチャネルかどうか
+    bool is_busy;              // 転送中かどうか
+    uint8_t activation_source; // 起動要因(DMRSRの値)
+    uint32_t transfers;        // 完了した転送数
+    uint64_t bytes;            // 転送したバイト数の合計
+    uint32_t busy_micros;      // 転送中だった時間の合計[マイクロ秒]
+};
+
+void dmac_init(void);
+int dmac_claim(const char* owner, enum dmac_priority priority, uint8_t int_priority, void (*callback)(int ch));
+bool dmac_reserve(int ch, const char* owner);
+bool dmac_release(int ch);
+volatile struct st_dmac1* dmac_get_regs(int ch);
+bool dmac_set_activation_source(int ch, uint8_t source);
+
+void dmac_notify_start(int ch);
+void dmac_notify_end(int ch, uint32_t bytes);
+bool dmac_get_info(int ch, struct dmac_channel_info* pinfo);
+void dmac_clear_stats(void);
+
+#endif /* DMAC_H_ */
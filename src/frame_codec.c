@@ -0,0 +1,158 @@
+/**
+ * @file フレーム圧縮(差分予測 + ランレングス)定義
+ *        ライン毎に、予測なし/左隣/前のラインのうち残差0が最も多くなる予測を選び、
+ *        残差を0の連続とそれ以外(リテラル)に分けて符号化する。
+ *        作業領域は持たず、前のラインはキャプチャバッファ上のものをそのまま参照する。
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stddef.h>
+
+#include "frame_codec.h"
+
+static uint32_t get_left_distance(uint32_t offset, uint8_t bpp);
+static uint8_t predict(enum frame_codec_predictor predictor, const uint8_t* pline, const uint8_t* pprev, uint32_t offset,
+                       uint8_t bpp);
+
+/**
+ * @brief 1ラインを圧縮する。
+ * @param pdst 出力先
+ * @param dst_size 出力先のサイズ[byte]
+ * @param pline ラインデータ
+ * @param pprev 前のラインデータ(先頭ラインの場合はNULL)
+ * @param len 1ラインのバイト数(65535以下)
+ * @param bpp 1ピクセルあたりのバイト数
+ * @return 出力したサイズ[byte]。出力先が足りない場合, 引数が不正な場合は-1.
+ */
+int32_t frame_codec_encode_line(uint8_t* pdst, uint32_t dst_size, const uint8_t* pline, const uint8_t* pprev, uint32_t len,
+                                uint8_t bpp)
+{
+    if ((len == 0u) || (len > 0xFFFFu) || (bpp == 0u) || (dst_size < FRAME_CODEC_LINE_HEADER_SIZE))
+    {
+        return -1;
+    }
+
+    // 予測モード毎に残差0の数を数え、最も多いものを選ぶ。
+    uint32_t zeros[FRAME_CODEC_PREDICTOR_COUNT] = { 0u, 0u, 0u };
+    for (uint32_t i = 0u; i < len; i++)
+    {
+        uint8_t value = pline[i];
+        uint32_t distance = get_left_distance(i, bpp);
+        zeros[FRAME_CODEC_PREDICTOR_NONE] += (value == 0u) ? 1u : 0u;
+        zeros[FRAME_CODEC_PREDICTOR_LEFT] += (value == ((i >= distance) ? pline[i - distance] : 0u)) ? 1u : 0u;
+        zeros[FRAME_CODEC_PREDICTOR_UP] += (value == ((pprev != NULL) ? pprev[i] : 0u)) ? 1u : 0u;
+    }
+    enum frame_codec_predictor predictor = FRAME_CODEC_PREDICTOR_NONE;
+    for (int mode = FRAME_CODEC_PREDICTOR_LEFT; mode < FRAME_CODEC_PREDICTOR_COUNT; mode++)
+    {
+        if (zeros[mode] > zeros[predictor])
+        {
+            predictor = (enum frame_codec_predictor)(mode);
+        }
+    }
+
+    uint32_t wp = FRAME_CODEC_LINE_HEADER_SIZE;
+    uint32_t i = 0u;
+    while (i < len)
+    {
+        // 残差0の連続
+        uint32_t run = 0u;
+        while (((i + run) < len) && (run < FRAME_CODEC_MAX_RUN)
+               && (pline[i + run] == predict(predictor, pline, pprev, i + run, bpp)))
+        {
+            run++;
+        }
+        if ((run >= 2u) || ((run == 1u) && ((i + 1u) == len))) // 残差0が2個以上続く(またはラインの最後)？
+        {
+            if (wp >= dst_size)
+            {
+                return -1;
+            }
+            pdst[wp] = (uint8_t)(0x7Fu + run);
+            wp++;
+            i += run;
+            continue;
+        }
+
+        // リテラル(残差0が2個以上続くところまで)
+        // 残差0が1個だけの場合はリテラルに含める。(ランに分けると制御バイトが増えて、圧縮後のサイズが入力より大きくなる)
+        uint32_t ctrl = wp;
+        wp++;
+        uint32_t count = 0u;
+        while (((i + count) < len) && (count < FRAME_CODEC_MAX_RUN))
+        {
+            uint32_t pos = i + count;
+            uint8_t residual = (uint8_t)(pline[pos] - predict(predictor, pline, pprev, pos, bpp));
+            if ((residual == 0u) && (count > 0u) && ((pos + 1u) < len)
+                && (pline[pos + 1u] == predict(predictor, pline, pprev, pos + 1u, bpp)))
+            {
+                break;
+            }
+            if (wp >= dst_size)
+            {
+                return -1;
+            }
+            pdst[wp] = residual;
+            wp++;
+            count++;
+        }
+        if (ctrl >= dst_size)
+        {
+            return -1;
+        }
+        pdst[ctrl] = (uint8_t)(count - 1u);
+        i += count;
+    }
+
+    uint32_t payload = wp - FRAME_CODEC_LINE_HEADER_SIZE;
+    pdst[0] = (uint8_t)(predictor);
+    pdst[1] = (uint8_t)(payload & 0xFFu);
+    pdst[2] = (uint8_t)((payload >> 8) & 0xFFu);
+
+    return (int32_t)(wp);
+}
+
+/**
+ * @brief 左隣の同じ成分までの距離を得る。
+ * @param offset ライン内位置[byte]
+ * @param bpp 1ピクセルあたりのバイト数
+ * @return 距離[byte]
+ */
+static uint32_t get_left_distance(uint32_t offset, uint8_t bpp)
+{
+    if (bpp == 2u) // YUYV
+    {
+        return ((offset & 0x1u) == 0u) ? 2u : 4u;
+    }
+    else
+    {
+        return bpp;
+    }
+}
+
+/**
+ * @brief 予測値を得る。
+ * @param predictor 予測モード
+ * @param pline ラインデータ
+ * @param pprev 前のラインデータ(先頭ラインの場合はNULL)
+ * @param offset ライン内位置[byte]
+ * @param bpp 1ピクセルあたりのバイト数
+ * @return 予測値
+ */
+static uint8_t predict(enum frame_codec_predictor predictor, const uint8_t* pline, const uint8_t* pprev, uint32_t offset,
+                       uint8_t bpp)
+{
+    switch (predictor)
+    {
+    case FRAME_CODEC_PREDICTOR_LEFT: {
+        uint32_t distance = get_left_distance(offset, bpp);
+        return (offset >= distance) ? pline[offset - distance] : 0u;
+    }
+    case FRAME_CODEC_PREDICTOR_UP: {
+        return (pprev != NULL) ? pprev[offset] : 0u;
+    }
+    case FRAME_CODEC_PREDICTOR_NONE:
+    default: {
+        return 0u;
+    }
+    }
+}
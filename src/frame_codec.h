@@ -0,0 +1,54 @@
+/**
+ * @file フレーム圧縮(差分予測 + ランレングス)のインタフェース宣言
+ *        ホスト側のデコーダ(host/frame_codec_decode.c)と共用する。
+ *
+ *        圧縮データはラインの順に並び、1ラインは次の形式になる。
+ *          [0]    予測モード(enum frame_codec_predictor)
+ *          [1..2] 残差データのサイズ[byte] (リトルエンディアン)
+ *          [3..]  残差データ
+ *        残差は (値 - 予測値) mod 256 で、予測値は次の通り。(範囲外は0)
+ *          NONE: 0
+ *          LEFT: 同じラインの同じ成分の左隣(bpp=2 はYUYVとして、Yは2バイト前, U/Vは4バイト前。それ以外は bpp バイト前)
+ *          UP:   前のラインの同じ位置
+ *        残差データは制御バイトに続くデータの繰り返しになる。
+ *          0x00〜0x7F: 続く (制御バイト + 1) バイトが残差
+ *          0x80〜0xFF: 残差0が (制御バイト - 0x7F) 個続く
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+
+#ifndef FRAME_CODEC_H_
+#define FRAME_CODEC_H_
+
+#include <stdint.h>
+
+/**
+ * @brief ラインヘッダのサイズ[byte]
+ */
+#define FRAME_CODEC_LINE_HEADER_SIZE (3)
+
+/**
+ * @brief 1つの制御バイトで表せる最大バイト数
+ */
+#define FRAME_CODEC_MAX_RUN (128)
+
+/**
+ * @brief 圧縮後の1ラインの最大サイズ[byte]
+ * @param len 1ラインのバイト数
+ */
+#define FRAME_CODEC_MAX_LINE_SIZE(len) (FRAME_CODEC_LINE_HEADER_SIZE + (len) + (((len) + FRAME_CODEC_MAX_RUN - 1) / FRAME_CODEC_MAX_RUN))
+
+/**
+ * @brief 予測モード
+ */
+enum frame_codec_predictor
+{
+    FRAME_CODEC_PREDICTOR_NONE = 0, // 予測なし
+    FRAME_CODEC_PREDICTOR_LEFT,     // 左隣の同じ成分
+    FRAME_CODEC_PREDICTOR_UP,       // 前のラインの同じ位置
+    FRAME_CODEC_PREDICTOR_COUNT,    // 予測モード数
+};
+
+int32_t frame_codec_encode_line(uint8_t* pdst, uint32_t dst_size, const uint8_t* pline, const uint8_t* pprev, uint32_t len,
+                                uint8_t bpp);
+
+#endif /* FRAME_CODEC_H_ */
@@ -6,6 +6,18 @@
 
 #include <r_smc_entry.h>
 
+/**
+ * @brief 1マイクロ秒あたりのTPU0カウント数
+ *        TPU0はPCLK/1でカウントし、TGRA(1msec周期)でクリアされる。
+ */
+#define TPU0_COUNTS_PER_MICROS (BSP_PCLKB_HZ / TPU0_PCLK_COUNTER_DIVISION / 1000000)
+
+/**
+ * @brief TPU0カウンタがクリアされてからCMTW0カウントに反映されるまでの猶予カウント数
+ *        この値未満のときは、ELC経由のカウントアップが間に合っていない可能性がある。
+ */
+#define TPU0_SETTLE_COUNT (16)
+
 /**
  * @brief ハードウェアTICKカウンタを初期化する。
  */
@@ -27,3 +39,24 @@ uint32_t hwtick_get(void)
 {
     return CMTW0.CMWCNT;
 }
+
+/**
+ * @brief ハードウェアTICKカウンタの値をマイクロ秒単位で得る。
+ *        ミリ秒カウンタ(CMTW0)とミリ秒未満のカウンタ(TPU0)を組み合わせて求める。
+ *        約71分でラップアラウンドするため、差分をとって経過時間を求めること。
+ * @return マイクロ秒単位のTICKカウンタ値
+ */
+uint32_t hwtick_get_micros(void)
+{
+    uint32_t millis;
+    uint32_t count;
+
+    do
+    {
+        millis = CMTW0.CMWCNT;
+        count = TPU0.TCNT;
+    } while ((count < TPU0_SETTLE_COUNT)    // TPU0クリア直後でCMTW0への反映待ち？
+             || (millis != CMTW0.CMWCNT)); // 読み出し中にミリ秒カウンタが進んだ？
+
+    return (millis * 1000u) + (count / TPU0_COUNTS_PER_MICROS);
+}
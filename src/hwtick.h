@@ -10,5 +10,6 @@
 
 void hwtick_init(void);
 uint32_t hwtick_get(void);
+uint32_t hwtick_get_micros(void);
 
 #endif /* HWTICK_H_ */
@@ -442,7 +442,7 @@ int i2c_master_send_async(uint8_t slave_addr, uint8_t* tx_data, uint16_t tx_len,
  * @param pcallback 完了時に通知を受けるコールバック関数。通知不要な場合にはNULL
  * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
  */
-bool i2c_master_receive_async(uint8_t slave_addr, uint8_t* rx_bufp, uint16_t rx_len, i2c_callback_func_t pcallback)
+int i2c_master_receive_async(uint8_t slave_addr, uint8_t* rx_bufp, uint16_t rx_len, i2c_callback_func_t pcallback)
 {
     return i2c_master_send_and_receive_async(slave_addr, NULL, 0, rx_bufp, rx_len, pcallback);
 }
@@ -456,7 +456,7 @@ bool i2c_master_receive_async(uint8_t slave_addr, uint8_t* rx_bufp, uint16_t rx_
  * @param rx_bufp 受信バッファ
  * @param rx_len 受信バッファサイズ
  * @param pcallback 完了時に通知を受けるコールバック関数。通知不要な場合にはNULL
- * @return 成功した場合にはtrue, 失敗した場合にはfalseを返します。
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
  */
 int i2c_master_send_and_receive_async(uint8_t slave_addr, uint8_t* tx_data, uint16_t tx_len, uint8_t* rx_bufp, uint16_t rx_len, i2c_callback_func_t pcallback)
 {
@@ -497,11 +497,27 @@ static void on_transaction_done(void)
     if (s_callback != NULL)
     {
         sci_iic_ch_dev_status_t st = s_sci_iic_info.dev_sts;
-        int status = convert_status_to_errno(status);
+        int status = convert_status_to_errno(st);
         s_callback(status);
     }
 }
 
+/**
+ * @brief 実行中のトランザクションを中止し、バスをリセットする。
+ *        非同期I/Oでタイムアウトした場合に使用する。
+ *        中止したトランザクションのコールバックは呼び出されない。
+ */
+void i2c_abort(void)
+{
+    s_callback = NULL;
+    if (s_sci_iic_info.dev_sts == SCI_IIC_COMMUNICATION)
+    {
+        R_SCI_IIC_Control(&s_sci_iic_info, SCI_IIC_GEN_RESET);
+    }
+
+    return;
+}
+
 /**
  * @brief バスビジーかどうかを判定する。
  * @return バスビジーの場合にはtrue, それ以外はfalse.
@@ -25,8 +25,9 @@ int i2c_master_receive_sync(uint8_t slave_addr, uint8_t* rx_bufp, uint16_t rx_le
 int i2c_master_send_and_receive_sync(uint8_t slave_addr, uint8_t* tx_data, uint16_t tx_len, uint8_t* rx_bufp, uint16_t rx_len, uint32_t timeout_millis);
 
 int i2c_master_send_async(uint8_t slave_addr, uint8_t* tx_data, uint16_t tx_len, i2c_callback_func_t pcallback);
-bool i2c_master_receive_async(uint8_t slave_addr, uint8_t* rx_bufp, uint16_t rx_len, i2c_callback_func_t pcallback);
+int i2c_master_receive_async(uint8_t slave_addr, uint8_t* rx_bufp, uint16_t rx_len, i2c_callback_func_t pcallback);
 int i2c_master_send_and_receive_async(uint8_t slave_addr, uint8_t* tx_data, uint16_t tx_len, uint8_t* rx_bufp, uint16_t rx_len, i2c_callback_func_t pcallback);
+void i2c_abort(void);
 bool i2c_is_busy(void);
 
 #endif /* I2C_H_ */
@@ -0,0 +1,700 @@
+/**
+ * @file I2Cバスベンチマークの定義
+ *        SCI6 IICの1秒あたりのトランザクション数、実効ビットレート、
+ *        トランザクションあたりのCPU使用時間を計測する。
+ *        CPU使用時間は、完了待ち中に回したアイドルループの回数と、
+ *        事前に校正した単位時間あたりのアイドルループ回数から求める。
+ *        処理は i2c_bench_update() で I2C_BENCH_UPDATE_MICROS ずつ進めるため、実行中もメインループ(USB送受信など)は止まらない。
+ *        CPU使用時間は i2c_bench_update() 内で過ごした時間からアイドル時間を引いたもので、メインループの他の処理は含まない。
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+
+#include "hwtick.h"
+#include "i2c.h"
+#include "i2c_bench.h"
+
+/**
+ * @brief 1トランザクションのタイムアウト時間[マイクロ秒]
+ */
+#define I2C_BENCH_TIMEOUT_MICROS (100000u)
+
+/**
+ * @brief 1回の i2c_bench_update() で処理する最大時間[マイクロ秒]
+ */
+#define I2C_BENCH_UPDATE_MICROS (2000u)
+
+/**
+ * @brief アイドルループ校正時間[マイクロ秒]
+ */
+#define I2C_BENCH_CALIBRATE_MICROS (20000u)
+
+/**
+ * @brief 書き込み時に送信するレジスタアドレス
+ *        実デバイスに対して副作用が無いよう、レジスタポインタの設定だけを行う。
+ */
+#define I2C_BENCH_REG_ADDR (0x00)
+
+/**
+ * @brief 読み出しバイト数
+ */
+#define I2C_BENCH_READ_LEN (2)
+
+/**
+ * @brief シミュレーションスレーブのレジスタ数
+ */
+#define SIM_REG_COUNT (256)
+
+/**
+ * @brief ベンチマーク状態
+ */
+enum bench_state
+{
+    BENCH_STATE_IDLE = 0, // 停止中
+    BENCH_STATE_START,    // トランザクション開始待ち
+    BENCH_STATE_WAIT,     // トランザクション完了待ち
+};
+
+/**
+ * @brief バスアクセス関数
+ */
+struct i2c_bench_bus
+{
+    int (*start)(uint8_t slave_addr, uint8_t* tx_data, uint16_t tx_len, uint8_t* rx_bufp, uint16_t rx_len, i2c_callback_func_t pcallback);
+    void (*poll)(void);
+    void (*abort)(void);
+    int (*set_bitrate)(uint32_t bit_rate);
+    uint32_t (*get_bitrate)(void);
+};
+
+/**
+ * @brief シミュレーションスレーブの状態
+ */
+struct sim_slave
+{
+    uint8_t regs[SIM_REG_COUNT];   // レジスタファイル
+    uint8_t reg_addr;              // レジスタポインタ
+    uint32_t bit_rate;             // ビットレート[bps]
+    bool is_busy;                  // トランザクション実行中かどうか
+    int status;                    // 完了時に通知するステータス
+    uint32_t begin_micros;         // トランザクション開始時刻
+    uint32_t duration_micros;      // トランザクション所要時間
+    i2c_callback_func_t pcallback; // 完了通知先
+};
+
+static int real_start(uint8_t slave_addr, uint8_t* tx_data, uint16_t tx_len, uint8_t* rx_bufp, uint16_t rx_len, i2c_callback_func_t pcallback);
+static void real_poll(void);
+static int sim_start(uint8_t slave_addr, uint8_t* tx_data, uint16_t tx_len, uint8_t* rx_bufp, uint16_t rx_len, i2c_callback_func_t pcallback);
+static void sim_poll(void);
+static void sim_abort(void);
+static int sim_set_bitrate(uint32_t bit_rate);
+static uint32_t sim_get_bitrate(void);
+static void start_transaction(void);
+static void wait_transaction(uint32_t update_begin);
+static void finish_bench(void);
+static void calibrate_idle_loop(void);
+static bool wait_done(uint32_t timeout_micros, uint32_t* pidle_count);
+static uint32_t calc_bus_bits(uint16_t tx_len, uint16_t rx_len);
+static void on_transaction_done(int status);
+
+//@formatter:off
+/**
+ * @brief 実バス(SCI6 IIC)のアクセス関数
+ */
+static const struct i2c_bench_bus s_real_bus = {
+    .start = real_start,
+    .poll = real_poll,
+    .abort = i2c_abort,
+    .set_bitrate = i2c_set_bitrate,
+    .get_bitrate = i2c_get_bitrate
+};
+
+/**
+ * @brief シミュレーションスレーブのアクセス関数
+ */
+static const struct i2c_bench_bus s_sim_bus = {
+    .start = sim_start,
+    .poll = sim_poll,
+    .abort = sim_abort,
+    .set_bitrate = sim_set_bitrate,
+    .get_bitrate = sim_get_bitrate
+};
+
+/**
+ * @brief トランザクション種別名
+ */
+static const char* s_type_names[] = {
+    "write",
+    "read",
+    "write-read"
+};
+//@formatter:on
+
+/**
+ * @brief 使用中のバスアクセス関数
+ */
+static const struct i2c_bench_bus* s_bus = &s_real_bus;
+
+/**
+ * @brief シミュレーションスレーブ
+ */
+static struct sim_slave s_sim = { .bit_rate = 100000u };
+
+/**
+ * @brief 校正したアイドルループ回数
+ */
+static uint32_t s_calib_idle_count = 0u;
+
+/**
+ * @brief 校正したアイドルループの計測時間[マイクロ秒]
+ */
+static uint32_t s_calib_micros = 0u;
+
+/**
+ * @brief ベンチマーク状態
+ */
+static enum bench_state s_state;
+
+/**
+ * @brief スレーブアドレス
+ */
+static uint8_t s_slave_addr;
+
+/**
+ * @brief 実行回数
+ */
+static uint32_t s_count;
+
+/**
+ * @brief 送信バイト数
+ */
+static uint16_t s_tx_len;
+
+/**
+ * @brief 受信バイト数
+ */
+static uint16_t s_rx_len;
+
+/**
+ * @brief 成功した1トランザクションのバス転送ビット数
+ */
+static uint32_t s_bus_bits;
+
+/**
+ * @brief ベンチマーク開始時刻[マイクロ秒]
+ */
+static uint32_t s_bench_begin;
+
+/**
+ * @brief 実行中のトランザクションの開始時刻[マイクロ秒]
+ */
+static uint32_t s_transaction_begin;
+
+/**
+ * @brief i2c_bench_update() 内で過ごした時間の合計[マイクロ秒]
+ */
+static uint32_t s_active_micros;
+
+/**
+ * @brief 完了待ち中に回したアイドルループ回数の合計
+ */
+static uint32_t s_idle_total;
+
+/**
+ * @brief 実行中のベンチマーク結果
+ */
+static struct i2c_bench_result s_result;
+
+/**
+ * @brief ベンチマーク完了時コールバック
+ */
+static void (*s_end_callback)(const struct i2c_bench_result* presult);
+
+/**
+ * @brief トランザクション完了フラグ(割り込みで設定される)
+ */
+static volatile bool s_is_done;
+
+/**
+ * @brief トランザクション完了ステータス
+ */
+static volatile int s_done_status;
+
+/**
+ * @brief 送信バッファ
+ */
+static uint8_t s_tx_buf[1];
+
+/**
+ * @brief 受信バッファ
+ */
+static uint8_t s_rx_buf[I2C_BENCH_READ_LEN];
+
+/**
+ * @brief シミュレーションスレーブを使用するかどうかを設定する。
+ * @param is_simulated シミュレーションスレーブを使用する場合にはtrue, 実バスを使用する場合にはfalse.
+ */
+void i2c_bench_set_simulated(bool is_simulated)
+{
+    s_bus = (is_simulated) ? &s_sim_bus : &s_real_bus;
+    s_calib_idle_count = 0u;
+
+    return;
+}
+
+/**
+ * @brief シミュレーションスレーブを使用しているかどうかを取得する。
+ * @return シミュレーションスレーブを使用している場合にはtrue, それ以外はfalse.
+ */
+bool i2c_bench_is_simulated(void)
+{
+    return (s_bus == &s_sim_bus) ? true : false;
+}
+
+/**
+ * @brief ベンチマーク対象バスのビットレートを設定する。
+ * @param bit_rate ビットレート[bps]
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int i2c_bench_set_bitrate(uint32_t bit_rate)
+{
+    return s_bus->set_bitrate(bit_rate);
+}
+
+/**
+ * @brief ベンチマーク対象バスのビットレートを取得する。
+ * @return ビットレート[bps]
+ */
+uint32_t i2c_bench_get_bitrate(void)
+{
+    return s_bus->get_bitrate();
+}
+
+/**
+ * @brief トランザクション種別名を得る。
+ * @param type トランザクション種別
+ * @return トランザクション種別名
+ */
+const char* i2c_bench_type_name(enum i2c_bench_type type)
+{
+    return (type <= I2C_BENCH_WRITE_READ) ? s_type_names[type] : "?";
+}
+
+/**
+ * @brief I2Cバスベンチマークを初期化する。
+ */
+void i2c_bench_init(void)
+{
+    s_state = BENCH_STATE_IDLE;
+    s_end_callback = NULL;
+
+    return;
+}
+
+/**
+ * @brief ベンチマークを開始する。
+ *        指定種別のトランザクションをcount回、1つずつ完了を待ちながら実行する。
+ *        完了を待つ間はメインループに戻り、i2c_bench_update() で続きを処理する。
+ * @param slave_addr スレーブアドレス
+ * @param type トランザクション種別
+ * @param count 実行回数
+ * @param callback 完了時に呼び出すコールバック関数(不要な場合にはNULL)
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int i2c_bench_start(uint8_t slave_addr, enum i2c_bench_type type, uint32_t count,
+                    void (*callback)(const struct i2c_bench_result* presult))
+{
+    if ((slave_addr >= 0x80) || (type > I2C_BENCH_WRITE_READ) || (count == 0u))
+    {
+        return EINVAL;
+    }
+    if (s_state != BENCH_STATE_IDLE)
+    {
+        return EBUSY;
+    }
+
+    if (s_calib_idle_count == 0u)
+    {
+        calibrate_idle_loop();
+    }
+
+    s_slave_addr = slave_addr;
+    s_count = count;
+    s_tx_len = (type != I2C_BENCH_READ) ? sizeof(s_tx_buf) : 0u;
+    s_rx_len = (type != I2C_BENCH_WRITE) ? sizeof(s_rx_buf) : 0u;
+    s_bus_bits = calc_bus_bits(s_tx_len, s_rx_len);
+    s_active_micros = 0u;
+    s_idle_total = 0u;
+    memset(&s_result, 0, sizeof(s_result));
+    s_result.bit_rate = s_bus->get_bitrate();
+    s_end_callback = callback;
+    s_bench_begin = hwtick_get_micros();
+    s_state = BENCH_STATE_START;
+
+    return 0;
+}
+
+/**
+ * @brief ベンチマーク処理を更新する。
+ *        メインループから呼び出す。1回の呼び出しでは最大 I2C_BENCH_UPDATE_MICROS だけ処理して戻る。
+ */
+void i2c_bench_update(void)
+{
+    if (s_state == BENCH_STATE_IDLE)
+    {
+        return;
+    }
+
+    uint32_t update_begin = hwtick_get_micros();
+    while ((hwtick_get_micros() - update_begin) < I2C_BENCH_UPDATE_MICROS)
+    {
+        if (s_state == BENCH_STATE_START)
+        {
+            start_transaction();
+        }
+        else
+        {
+            wait_transaction(update_begin);
+        }
+
+        if ((s_state == BENCH_STATE_START) && (s_result.count >= s_count)) // 全て完了？
+        {
+            s_active_micros += hwtick_get_micros() - update_begin;
+            finish_bench();
+            return;
+        }
+    }
+    s_active_micros += hwtick_get_micros() - update_begin;
+
+    return;
+}
+
+/**
+ * @brief ベンチマーク実行中かどうかを得る。
+ * @return 実行中の場合にはtrue, それ以外はfalse.
+ */
+bool i2c_bench_is_running(void)
+{
+    return (s_state != BENCH_STATE_IDLE) ? true : false;
+}
+
+/**
+ * @brief トランザクションを開始する。
+ *        開始できなかった場合はエラーとして数え、次のトランザクションに進む。
+ */
+static void start_transaction(void)
+{
+    s_tx_buf[0] = I2C_BENCH_REG_ADDR;
+    s_is_done = false;
+    int s = s_bus->start(s_slave_addr, s_tx_buf, s_tx_len, s_rx_buf, s_rx_len, on_transaction_done);
+    s_result.count++;
+    if (s != 0)
+    {
+        s_result.error_count++;
+        return;
+    }
+
+    s_transaction_begin = hwtick_get_micros();
+    s_state = BENCH_STATE_WAIT;
+
+    return;
+}
+
+/**
+ * @brief トランザクションの完了を、今回の i2c_bench_update() の残り時間だけ待つ。
+ *        完了またはタイムアウトした場合は結果を数え、次のトランザクションに進む。
+ * @param update_begin 今回の i2c_bench_update() の開始時刻[マイクロ秒]
+ */
+static void wait_transaction(uint32_t update_begin)
+{
+    uint32_t now = hwtick_get_micros();
+    uint32_t spent = now - update_begin;
+    uint32_t update_left = (spent < I2C_BENCH_UPDATE_MICROS) ? (I2C_BENCH_UPDATE_MICROS - spent) : 0u;
+    uint32_t elapsed = now - s_transaction_begin;
+    uint32_t timeout_left = (elapsed < I2C_BENCH_TIMEOUT_MICROS) ? (I2C_BENCH_TIMEOUT_MICROS - elapsed) : 0u;
+    uint32_t idle_count = 0u;
+
+    bool is_done = wait_done((update_left < timeout_left) ? update_left : timeout_left, &idle_count);
+    s_idle_total += idle_count;
+    if (is_done)
+    {
+        if (s_done_status == 0)
+        {
+            s_result.success_count++;
+            s_result.bus_bits += s_bus_bits;
+        }
+        else if (s_done_status == EACCES)
+        {
+            s_result.nack_count++;
+        }
+        else
+        {
+            s_result.error_count++;
+        }
+    }
+    else if ((hwtick_get_micros() - s_transaction_begin) >= I2C_BENCH_TIMEOUT_MICROS)
+    {
+        s_bus->abort();
+        s_result.timeout_count++;
+    }
+    else
+    {
+        return; // 次回の i2c_bench_update() で続けて待つ。
+    }
+    s_state = BENCH_STATE_START;
+
+    return;
+}
+
+/**
+ * @brief ベンチマークを終了し、結果を通知する。
+ *        経過時間は開始から終了までの時間, CPU使用時間は i2c_bench_update() 内の時間からアイドル時間を引いた時間とする。
+ */
+static void finish_bench(void)
+{
+    s_result.elapsed_micros = hwtick_get_micros() - s_bench_begin;
+    uint32_t idle_micros = (uint32_t)((uint64_t)(s_idle_total) * s_calib_micros / s_calib_idle_count);
+    s_result.cpu_micros = (idle_micros < s_active_micros) ? (s_active_micros - idle_micros) : 0u;
+    s_state = BENCH_STATE_IDLE;
+
+    if (s_end_callback != NULL)
+    {
+        void (*callback)(const struct i2c_bench_result* presult) = s_end_callback;
+        s_end_callback = NULL;
+        callback(&s_result);
+    }
+
+    return;
+}
+
+/**
+ * @brief アイドルループを校正する。
+ *        トランザクションを発行せずにwait_done()を回し、単位時間あたりのループ回数を得る。
+ */
+static void calibrate_idle_loop(void)
+{
+    uint32_t idle_count = 0u;
+
+    s_is_done = false;
+    uint32_t begin = hwtick_get_micros();
+    wait_done(I2C_BENCH_CALIBRATE_MICROS, &idle_count);
+    s_calib_micros = hwtick_get_micros() - begin;
+    s_calib_idle_count = (idle_count > 0u) ? idle_count : 1u;
+
+    return;
+}
+
+/**
+ * @brief トランザクション完了を待つ。
+ *        校正時とベンチマーク時で同じループを使用するため、ループ本体を変更する場合には注意すること。
+ * @param timeout_micros タイムアウト時間[マイクロ秒]
+ * @param pidle_count 待機中に回したループ回数を格納する変数
+ * @return 完了した場合にはtrue, タイムアウトした場合にはfalse.
+ */
+static bool wait_done(uint32_t timeout_micros, uint32_t* pidle_count)
+{
+    uint32_t idle_count = 0u;
+    uint32_t begin = hwtick_get_micros();
+
+    while (!s_is_done && ((hwtick_get_micros() - begin) < timeout_micros))
+    {
+        s_bus->poll();
+        idle_count++;
+    }
+    (*pidle_count) = idle_count;
+
+    return s_is_done;
+}
+
+/**
+ * @brief トランザクションのバス転送ビット数を計算する。
+ *        1バイトあたりACKを含めて9ビット、スタート/リピートスタート/ストップを各1ビットとする。
+ * @param tx_len 送信バイト数
+ * @param rx_len 受信バイト数
+ * @return バス転送ビット数
+ */
+static uint32_t calc_bus_bits(uint16_t tx_len, uint16_t rx_len)
+{
+    uint32_t bits = 1u; // ストップコンディション
+
+    if (tx_len > 0u)
+    {
+        bits += 1u + (9u * (1u + tx_len)); // スタート + スレーブアドレス + データ
+    }
+    if (rx_len > 0u)
+    {
+        bits += 1u + (9u * (1u + rx_len)); // (リピート)スタート + スレーブアドレス + データ
+    }
+
+    return bits;
+}
+
+/**
+ * @brief トランザクション完了通知を受け取る。
+ * @param status 完了ステータス
+ */
+static void on_transaction_done(int status)
+{
+    s_done_status = status;
+    s_is_done = true;
+
+    return;
+}
+
+/**
+ * @brief 実バスでトランザクションを開始する。
+ * @param slave_addr スレーブアドレス
+ * @param tx_data 送信データ
+ * @param tx_len 送信データ長
+ * @param rx_bufp 受信バッファ
+ * @param rx_len 受信サイズ
+ * @param pcallback 完了通知先
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+static int real_start(uint8_t slave_addr, uint8_t* tx_data, uint16_t tx_len, uint8_t* rx_bufp, uint16_t rx_len, i2c_callback_func_t pcallback)
+{
+    int retval;
+
+    if (rx_len > 0u)
+    {
+        retval = i2c_master_send_and_receive_async(slave_addr, tx_data, tx_len, rx_bufp, rx_len, pcallback);
+    }
+    else
+    {
+        retval = i2c_master_send_async(slave_addr, tx_data, tx_len, pcallback);
+    }
+
+    return retval;
+}
+
+/**
+ * @brief 実バスのポーリング処理をする。
+ *        実バスは割り込みで完了通知されるため、何もしない。
+ */
+static void real_poll(void)
+{
+    return;
+}
+
+/**
+ * @brief シミュレーションスレーブでトランザクションを開始する。
+ *        I2C_BENCH_SIM_SLAVE_ADDR 以外のアドレスはNACKを返す。
+ *        所要時間はバス転送ビット数とビットレートから求め、経過後に完了通知する。
+ * @param slave_addr スレーブアドレス
+ * @param tx_data 送信データ
+ * @param tx_len 送信データ長
+ * @param rx_bufp 受信バッファ
+ * @param rx_len 受信サイズ
+ * @param pcallback 完了通知先
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+static int sim_start(uint8_t slave_addr, uint8_t* tx_data, uint16_t tx_len, uint8_t* rx_bufp, uint16_t rx_len, i2c_callback_func_t pcallback)
+{
+    if (s_sim.is_busy)
+    {
+        return EBUSY;
+    }
+    if ((slave_addr >= 0x80) || ((tx_len > 0u) && (tx_data == NULL)) || ((rx_len > 0u) && (rx_bufp == NULL)))
+    {
+        return EINVAL;
+    }
+
+    uint32_t bits;
+    if (slave_addr != I2C_BENCH_SIM_SLAVE_ADDR)
+    {
+        bits = 1u + 9u + 1u; // スタート + スレーブアドレス(NACK) + ストップ
+        s_sim.status = EACCES;
+    }
+    else
+    {
+        if (tx_len > 0u)
+        {
+            s_sim.reg_addr = tx_data[0];
+            for (uint16_t i = 1u; i < tx_len; i++)
+            {
+                s_sim.regs[s_sim.reg_addr] = tx_data[i];
+                s_sim.reg_addr++;
+            }
+        }
+        for (uint16_t i = 0u; i < rx_len; i++)
+        {
+            rx_bufp[i] = s_sim.regs[s_sim.reg_addr];
+            s_sim.reg_addr++;
+        }
+        bits = calc_bus_bits(tx_len, rx_len);
+        s_sim.status = 0;
+    }
+
+    s_sim.duration_micros = (uint32_t)((uint64_t)(bits) * 1000000u / s_sim.bit_rate);
+    s_sim.pcallback = pcallback;
+    s_sim.begin_micros = hwtick_get_micros();
+    s_sim.is_busy = true;
+
+    return 0;
+}
+
+/**
+ * @brief シミュレーションスレーブのポーリング処理をする。
+ *        所要時間が経過していたら完了通知する。
+ */
+static void sim_poll(void)
+{
+    if (s_sim.is_busy && ((hwtick_get_micros() - s_sim.begin_micros) >= s_sim.duration_micros))
+    {
+        s_sim.is_busy = false;
+        if (s_sim.pcallback != NULL)
+        {
+            s_sim.pcallback(s_sim.status);
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief シミュレーションスレーブのトランザクションを中止する。
+ */
+static void sim_abort(void)
+{
+    s_sim.is_busy = false;
+    s_sim.pcallback = NULL;
+
+    return;
+}
+
+/**
+ * @brief シミュレーションスレーブのビットレートを設定する。
+ * @param bit_rate ビットレート[bps]
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+static int sim_set_bitrate(uint32_t bit_rate)
+{
+    int retval;
+
+    if (s_sim.is_busy)
+    {
+        retval = EBUSY;
+    }
+    else if (bit_rate == 0u)
+    {
+        retval = EINVAL;
+    }
+    else
+    {
+        s_sim.bit_rate = bit_rate;
+        retval = 0;
+    }
+
+    return retval;
+}
+
+/**
+ * @brief シミュレーションスレーブのビットレートを取得する。
+ * @return ビットレート[bps]
+ */
+static uint32_t sim_get_bitrate(void)
+{
+    return s_sim.bit_rate;
+}
@@ -0,0 +1,54 @@
+/**
+ * @file I2Cバスベンチマークのインタフェース宣言
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+
+#ifndef I2C_BENCH_H_
+#define I2C_BENCH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief シミュレーションスレーブのスレーブアドレス
+ */
+#define I2C_BENCH_SIM_SLAVE_ADDR (0x50)
+
+/**
+ * @brief ベンチマークするトランザクション種別
+ */
+enum i2c_bench_type
+{
+    I2C_BENCH_WRITE = 0, // 書き込み(レジスタアドレス送信)
+    I2C_BENCH_READ,      // 読み出し
+    I2C_BENCH_WRITE_READ // 書き込み後、リピートスタートで読み出し
+};
+
+/**
+ * @brief ベンチマーク結果
+ */
+struct i2c_bench_result
+{
+    uint32_t bit_rate;       // 設定ビットレート[bps]
+    uint32_t count;          // 実行トランザクション数
+    uint32_t success_count;  // 成功数
+    uint32_t nack_count;     // NACK数
+    uint32_t timeout_count;  // タイムアウト数
+    uint32_t error_count;    // その他のエラー数
+    uint32_t bus_bits;       // 成功したトランザクションのバス転送ビット数
+    uint32_t elapsed_micros; // 経過時間[マイクロ秒]
+    uint32_t cpu_micros;     // CPU使用時間[マイクロ秒]
+};
+
+void i2c_bench_init(void);
+void i2c_bench_update(void);
+void i2c_bench_set_simulated(bool is_simulated);
+bool i2c_bench_is_simulated(void);
+int i2c_bench_set_bitrate(uint32_t bit_rate);
+uint32_t i2c_bench_get_bitrate(void);
+int i2c_bench_start(uint8_t slave_addr, enum i2c_bench_type type, uint32_t count,
+                    void (*callback)(const struct i2c_bench_result* presult));
+bool i2c_bench_is_running(void);
+const char* i2c_bench_type_name(enum i2c_bench_type type);
+
+#endif /* I2C_BENCH_H_ */
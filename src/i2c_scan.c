@@ -0,0 +1,356 @@
+/**
+ * @file I2Cバススキャンの定義
+ *        非同期I/Oで全アドレスに1バイト読み出しを行い、応答(ACK)したデバイスを記録する。
+ *        応答したデバイスは、続けてIDレジスタを読み出して記録する。
+ *        処理はi2c_scan_update()で少しずつ進めるため、スキャン中もメインループは止まらない。
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+
+#include "hwtick.h"
+#include "i2c.h"
+#include "i2c_scan.h"
+
+/**
+ * @brief 1アドレスあたりのタイムアウト時間[ミリ秒]
+ */
+#define I2C_SCAN_TIMEOUT_MILLIS (5)
+
+/**
+ * @brief スキャン状態
+ */
+enum scan_state
+{
+    SCAN_STATE_IDLE = 0,    // 停止中
+    SCAN_STATE_PROBE,       // アドレス応答確認中
+    SCAN_STATE_ID_ADDR,     // IDレジスタアドレス送信中
+    SCAN_STATE_ID_READ,     // IDレジスタ読み出し中
+};
+
+static void start_transaction(void);
+static void on_transaction_done(int status);
+
+/**
+ * @brief スキャン状態
+ */
+static enum scan_state s_state;
+
+/**
+ * @brief スキャン中のアドレス
+ */
+static uint8_t s_addr;
+
+/**
+ * @brief IDレジスタアドレス
+ */
+static uint8_t s_id_reg;
+
+/**
+ * @brief IDレジスタ読み出しバイト数
+ */
+static uint8_t s_id_len;
+
+/**
+ * @brief トランザクション実行中かどうか
+ */
+static bool s_is_transaction_running;
+
+/**
+ * @brief トランザクション開始時刻
+ */
+static uint32_t s_transaction_begin;
+
+/**
+ * @brief トランザクション完了フラグ(割り込みで設定される)
+ */
+static volatile bool s_is_done;
+
+/**
+ * @brief トランザクション完了ステータス
+ */
+static volatile int s_done_status;
+
+/**
+ * @brief 受信バッファ
+ */
+static uint8_t s_rx_buf[I2C_SCAN_ID_MAX_LEN];
+
+/**
+ * @brief 検出したデバイス
+ */
+static struct i2c_device_info s_devices[I2C_SCAN_MAX_DEVICES];
+
+/**
+ * @brief 検出したデバイス数
+ */
+static int s_device_count;
+
+/**
+ * @brief スキャン開始時刻
+ */
+static uint32_t s_scan_begin;
+
+/**
+ * @brief スキャン所要時間[ミリ秒]
+ */
+static uint32_t s_scan_elapsed;
+
+/**
+ * @brief スキャン完了時コールバック
+ */
+static void (*s_end_callback)(void);
+
+/**
+ * @brief I2Cバススキャンを初期化する。
+ */
+void i2c_scan_init(void)
+{
+    s_state = SCAN_STATE_IDLE;
+    s_is_transaction_running = false;
+    s_device_count = 0;
+    s_scan_elapsed = 0u;
+    s_end_callback = NULL;
+
+    return;
+}
+
+/**
+ * @brief スキャンを開始する。
+ *        前回のスキャン結果は破棄される。
+ * @param id_reg IDレジスタアドレス
+ * @param id_len IDレジスタ読み出しバイト数(0の場合はIDを読み出さない)
+ * @param callback スキャン完了時に呼び出すコールバック関数(不要な場合にはNULL)
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int i2c_scan_start(uint8_t id_reg, uint8_t id_len, void (*callback)(void))
+{
+    if (id_len > I2C_SCAN_ID_MAX_LEN)
+    {
+        return EINVAL;
+    }
+    if (s_state != SCAN_STATE_IDLE)
+    {
+        return EBUSY;
+    }
+
+    s_id_reg = id_reg;
+    s_id_len = id_len;
+    s_device_count = 0;
+    s_addr = I2C_SCAN_FIRST_ADDR;
+    s_end_callback = callback;
+    s_scan_begin = hwtick_get();
+    s_scan_elapsed = 0u;
+    s_is_transaction_running = false;
+    s_state = SCAN_STATE_PROBE;
+
+    return 0;
+}
+
+/**
+ * @brief スキャン処理を更新する。
+ *        メインループから呼び出す。1回の呼び出しでは待たずに戻る。
+ */
+void i2c_scan_update(void)
+{
+    if (s_state == SCAN_STATE_IDLE)
+    {
+        return;
+    }
+
+    if (!s_is_transaction_running)
+    {
+        if (!i2c_is_busy())
+        {
+            start_transaction();
+        }
+        return;
+    }
+
+    bool is_succeed;
+    if (s_is_done)
+    {
+        is_succeed = (s_done_status == 0);
+    }
+    else if ((hwtick_get() - s_transaction_begin) >= I2C_SCAN_TIMEOUT_MILLIS)
+    {
+        i2c_abort();
+        is_succeed = false;
+    }
+    else
+    {
+        return; // 完了待ち
+    }
+    s_is_transaction_running = false;
+
+    bool is_next_addr = true;
+    switch (s_state)
+    {
+    case SCAN_STATE_PROBE: {
+        if (is_succeed && (s_device_count < I2C_SCAN_MAX_DEVICES))
+        {
+            struct i2c_device_info* pdev = &(s_devices[s_device_count]);
+            memset(pdev, 0, sizeof(struct i2c_device_info));
+            pdev->addr = s_addr;
+            s_device_count++;
+            if (s_id_len > 0u)
+            {
+                s_state = SCAN_STATE_ID_ADDR;
+                is_next_addr = false;
+            }
+        }
+        break;
+    }
+    case SCAN_STATE_ID_ADDR: {
+        if (is_succeed)
+        {
+            s_state = SCAN_STATE_ID_READ;
+            is_next_addr = false;
+        }
+        break;
+    }
+    case SCAN_STATE_ID_READ: {
+        if (is_succeed)
+        {
+            struct i2c_device_info* pdev = &(s_devices[s_device_count - 1]);
+            memcpy(pdev->id, s_rx_buf, s_id_len);
+            pdev->id_len = s_id_len;
+            pdev->has_id = true;
+        }
+        break;
+    }
+    default: {
+        break;
+    }
+    }
+
+    if (is_next_addr)
+    {
+        if (s_addr >= I2C_SCAN_LAST_ADDR)
+        {
+            s_state = SCAN_STATE_IDLE;
+            s_scan_elapsed = hwtick_get() - s_scan_begin;
+            if (s_end_callback != NULL)
+            {
+                void (*callback)(void) = s_end_callback;
+                s_end_callback = NULL;
+                callback();
+            }
+        }
+        else
+        {
+            s_addr++;
+            s_state = SCAN_STATE_PROBE;
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief スキャン中かどうかを得る。
+ * @return スキャン中の場合にはtrue, それ以外はfalse.
+ */
+bool i2c_scan_is_running(void)
+{
+    return (s_state != SCAN_STATE_IDLE) ? true : false;
+}
+
+/**
+ * @brief 前回のスキャン所要時間を得る。
+ * @return スキャン所要時間[ミリ秒]
+ */
+uint32_t i2c_scan_get_elapsed_millis(void)
+{
+    return s_scan_elapsed;
+}
+
+/**
+ * @brief 検出したデバイス数を得る。
+ * @return デバイス数
+ */
+int i2c_scan_get_device_count(void)
+{
+    return s_device_count;
+}
+
+/**
+ * @brief 検出したデバイスの情報を得る。
+ * @param index インデックス
+ * @return デバイス情報。インデックスが範囲外の場合にはNULL.
+ */
+const struct i2c_device_info* i2c_scan_get_device(int index)
+{
+    return ((index >= 0) && (index < s_device_count)) ? &(s_devices[index]) : NULL;
+}
+
+/**
+ * @brief 検出したデバイスの情報をアドレスで検索する。
+ * @param addr スレーブアドレス
+ * @return デバイス情報。見つからない場合にはNULL.
+ */
+const struct i2c_device_info* i2c_scan_find_device(uint8_t addr)
+{
+    const struct i2c_device_info* pdev = NULL;
+
+    for (int i = 0; i < s_device_count; i++)
+    {
+        if (s_devices[i].addr == addr)
+        {
+            pdev = &(s_devices[i]);
+            break;
+        }
+    }
+
+    return pdev;
+}
+
+/**
+ * @brief 現在の状態に応じたトランザクションを開始する。
+ *        開始できなかった場合には、失敗として完了扱いにする。
+ */
+static void start_transaction(void)
+{
+    int s;
+
+    s_is_done = false;
+    switch (s_state)
+    {
+    case SCAN_STATE_ID_ADDR: {
+        s = i2c_master_send_async(s_addr, &s_id_reg, 1, on_transaction_done);
+        break;
+    }
+    case SCAN_STATE_ID_READ: {
+        s = i2c_master_receive_async(s_addr, s_rx_buf, s_id_len, on_transaction_done);
+        break;
+    }
+    case SCAN_STATE_PROBE:
+    default: {
+        s = i2c_master_receive_async(s_addr, s_rx_buf, 1, on_transaction_done);
+        break;
+    }
+    }
+
+    if (s != 0)
+    {
+        s_done_status = s;
+        s_is_done = true;
+    }
+    s_transaction_begin = hwtick_get();
+    s_is_transaction_running = true;
+
+    return;
+}
+
+/**
+ * @brief トランザクション完了通知を受け取る。
+ * @param status 完了ステータス
+ */
+static void on_transaction_done(int status)
+{
+    s_done_status = status;
+    s_is_done = true;
+
+    return;
+}
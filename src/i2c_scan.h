@@ -0,0 +1,49 @@
+/**
+ * @file I2Cバススキャンのインタフェース宣言
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+
+#ifndef I2C_SCAN_H_
+#define I2C_SCAN_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief スキャン開始アドレス(0x00-0x07は予約アドレス)
+ */
+#define I2C_SCAN_FIRST_ADDR (0x08)
+/**
+ * @brief スキャン終了アドレス(0x78-0x7Fは予約アドレス)
+ */
+#define I2C_SCAN_LAST_ADDR (0x77)
+/**
+ * @brief 記録できるデバイス数
+ */
+#define I2C_SCAN_MAX_DEVICES (16)
+/**
+ * @brief IDレジスタの最大読み出しバイト数
+ */
+#define I2C_SCAN_ID_MAX_LEN (4)
+
+/**
+ * @brief 検出したデバイスの情報
+ */
+struct i2c_device_info
+{
+    uint8_t addr;                     // スレーブアドレス
+    bool has_id;                      // IDレジスタを読み出せたかどうか
+    uint8_t id_len;                   // IDレジスタの読み出しバイト数
+    uint8_t id[I2C_SCAN_ID_MAX_LEN];  // IDレジスタ値
+};
+
+void i2c_scan_init(void);
+void i2c_scan_update(void);
+int i2c_scan_start(uint8_t id_reg, uint8_t id_len, void (*callback)(void));
+bool i2c_scan_is_running(void);
+uint32_t i2c_scan_get_elapsed_millis(void);
+int i2c_scan_get_device_count(void);
+const struct i2c_device_info* i2c_scan_get_device(int index);
+const struct i2c_device_info* i2c_scan_find_device(uint8_t addr);
+
+#endif /* I2C_SCAN_H_ */
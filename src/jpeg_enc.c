@@ -0,0 +1,817 @@
+/**
+ * @file JPEGエンコーダ定義
+ *        ベースラインJPEG(ハフマン符号化, 8bit精度)。
+ *        DCTは整数演算のLLM(Loeffler-Ligtenberg-Moschytz)方式で、出力は真値の8倍になる。
+ *        量子化は除算の代わりに、品質設定時に計算した逆数テーブルとの乗算で行う。
+ *        ハフマンテーブルはJPEG規格 Annex K の標準テーブルを使用する。
+ *        出力先を超える場合は出力を打ち切り、エラーを返す。
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+
+#include "jpeg_enc.h"
+
+/**
+ * @brief DCT定数の小数部ビット数
+ */
+#define CONST_BITS (13)
+
+/**
+ * @brief DCT 1パス目の出力に残す小数部ビット数
+ */
+#define PASS1_BITS (2)
+
+/**
+ * @brief 量子化逆数テーブルの小数部ビット数
+ */
+#define RECIP_BITS (18)
+
+/**
+ * @brief 小数部を丸めて取り除く。
+ */
+#define DESCALE(x, n) (((x) + (1L << ((n) - 1))) >> (n))
+
+//@formatter:off
+#define FIX_0_298631336 (2446)
+#define FIX_0_390180644 (3196)
+#define FIX_0_541196100 (4433)
+#define FIX_0_765366865 (6270)
+#define FIX_0_899976223 (7373)
+#define FIX_1_175875602 (9633)
+#define FIX_1_501321110 (12299)
+#define FIX_1_847759065 (15137)
+#define FIX_1_961570560 (16069)
+#define FIX_2_053119869 (16819)
+#define FIX_2_562915447 (20995)
+#define FIX_3_072711026 (25172)
+//@formatter:on
+
+/**
+ * @brief ハフマンテーブル番号
+ */
+enum huff_table
+{
+    HUFF_TABLE_DC_LUMA = 0, // 輝度DC
+    HUFF_TABLE_AC_LUMA,     // 輝度AC
+    HUFF_TABLE_DC_CHROMA,   // 色差DC
+    HUFF_TABLE_AC_CHROMA,   // 色差AC
+    HUFF_TABLE_COUNT,       // テーブル数
+};
+
+/**
+ * @brief ハフマンテーブル定義(JPEG規格の BITS, HUFFVAL)
+ */
+struct huff_spec
+{
+    uint8_t cls_id;         // テーブルクラス(上位4bit)と識別子(下位4bit)
+    const uint8_t* bits;    // 符号長毎の符号数(16要素)
+    const uint8_t* values;  // 符号化する値
+};
+
+/**
+ * @brief ハフマン符号
+ */
+struct huff_code
+{
+    uint16_t code; // 符号
+    uint8_t size;  // 符号長[bit]
+};
+
+/**
+ * @brief 成分
+ */
+enum component
+{
+    COMPONENT_Y = 0,  // 輝度
+    COMPONENT_CB,     // 色差(青)
+    COMPONENT_CR,     // 色差(赤)
+    COMPONENT_COUNT,  // 成分数
+};
+
+static void build_quant_table(uint8_t table_no, uint8_t quality);
+static void build_huff_table(enum huff_table table);
+static void write_headers(void);
+static void write_byte(uint8_t value);
+static void write_word(uint16_t value);
+static void load_block(int32_t* pblock, const uint8_t* psrc, uint32_t stride, uint32_t step);
+static void forward_dct(int32_t* pblock);
+static void encode_block(int32_t* pblock, enum component comp);
+static void put_bits(uint32_t bits, uint8_t size);
+static void flush_bits(void);
+
+//@formatter:off
+/**
+ * @brief ジグザグスキャン順(ジグザグ順の番号 -> ブロック内の位置)
+ */
+static const uint8_t s_zigzag[64] = {
+     0,  1,  8, 16,  9,  2,  3, 10,
+    17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34,
+    27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36,
+    29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46,
+    53, 60, 61, 54, 47, 55, 62, 63,
+};
+
+/**
+ * @brief 輝度の基準量子化テーブル(JPEG規格 Annex K, 品質50相当, ブロック内の位置の順)
+ */
+static const uint8_t s_base_quant_luma[64] = {
+    16,  11,  10,  16,  24,  40,  51,  61,
+    12,  12,  14,  19,  26,  58,  60,  55,
+    14,  13,  16,  24,  40,  57,  69,  56,
+    14,  17,  22,  29,  51,  87,  80,  62,
+    18,  22,  37,  56,  68, 109, 103,  77,
+    24,  35,  55,  64,  81, 104, 113,  92,
+    49,  64,  78,  87, 103, 121, 120, 101,
+    72,  92,  95,  98, 112, 100, 103,  99,
+};
+
+/**
+ * @brief 色差の基準量子化テーブル(JPEG規格 Annex K, 品質50相当, ブロック内の位置の順)
+ */
+static const uint8_t s_base_quant_chroma[64] = {
+    17,  18,  24,  47,  99,  99,  99,  99,
+    18,  21,  26,  66,  99,  99,  99,  99,
+    24,  26,  56,  99,  99,  99,  99,  99,
+    47,  66,  99,  99,  99,  99,  99,  99,
+    99,  99,  99,  99,  99,  99,  99,  99,
+    99,  99,  99,  99,  99,  99,  99,  99,
+    99,  99,  99,  99,  99,  99,  99,  99,
+    99,  99,  99,  99,  99,  99,  99,  99,
+};
+
+static const uint8_t s_dc_luma_bits[16] = { 0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0 };
+static const uint8_t s_dc_chroma_bits[16] = { 0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0 };
+static const uint8_t s_dc_values[12] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+
+static const uint8_t s_ac_luma_bits[16] = { 0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7D };
+static const uint8_t s_ac_luma_values[162] = {
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+    0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xA1, 0x08, 0x23, 0x42, 0xB1, 0xC1, 0x15, 0x52, 0xD1, 0xF0,
+    0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0A, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2A, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+    0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,
+    0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3, 0xC4, 0xC5,
+    0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xE1, 0xE2,
+    0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+    0xF9, 0xFA,
+};
+
+static const uint8_t s_ac_chroma_bits[16] = { 0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77 };
+static const uint8_t s_ac_chroma_values[162] = {
+    0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+    0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xA1, 0xB1, 0xC1, 0x09, 0x23, 0x33, 0x52, 0xF0,
+    0x15, 0x62, 0x72, 0xD1, 0x0A, 0x16, 0x24, 0x34, 0xE1, 0x25, 0xF1, 0x17, 0x18, 0x19, 0x1A, 0x26,
+    0x27, 0x28, 0x29, 0x2A, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+    0x49, 0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+    0x69, 0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5,
+    0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3,
+    0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA,
+    0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+    0xF9, 0xFA,
+};
+
+/**
+ * @brief ハフマンテーブル定義(enum huff_table の順)
+ */
+static const struct huff_spec s_huff_specs[HUFF_TABLE_COUNT] = {
+    { 0x00, s_dc_luma_bits, s_dc_values },
+    { 0x10, s_ac_luma_bits, s_ac_luma_values },
+    { 0x01, s_dc_chroma_bits, s_dc_values },
+    { 0x11, s_ac_chroma_bits, s_ac_chroma_values },
+};
+//@formatter:on
+
+/**
+ * @brief 量子化テーブル(0:輝度, 1:色差, ジグザグ順)
+ *        DQTにそのまま出力する。
+ */
+static uint8_t s_quant[2][64];
+
+/**
+ * @brief 量子化逆数テーブル(0:輝度, 1:色差, ブロック内の位置の順)
+ *        2^RECIP_BITS / (量子化値 * 8)。(DCT出力が8倍されているため)
+ */
+static uint16_t s_recip[2][64];
+
+/**
+ * @brief ハフマン符号テーブル(enum huff_table の順, 符号化する値で引く)
+ */
+static struct huff_code s_huff_codes[HUFF_TABLE_COUNT][256];
+
+/**
+ * @brief ハフマン符号テーブルを作成済みかどうか
+ */
+static bool s_is_huff_built;
+
+/**
+ * @brief 品質(量子化テーブル作成済みの品質。未作成の場合は0)
+ */
+static uint8_t s_quality;
+
+/**
+ * @brief 出力先
+ */
+static uint8_t* s_pdst;
+
+/**
+ * @brief 出力先のサイズ[byte]
+ */
+static uint32_t s_dst_size;
+
+/**
+ * @brief 出力したサイズ[byte]
+ */
+static uint32_t s_len;
+
+/**
+ * @brief 出力先が足りなかったかどうか
+ */
+static bool s_is_overflow;
+
+/**
+ * @brief 画像の幅[pixel]
+ */
+static uint16_t s_width;
+
+/**
+ * @brief 画像の高さ[line]
+ */
+static uint16_t s_height;
+
+/**
+ * @brief 圧縮済みのライン数
+ */
+static uint16_t s_encoded_lines;
+
+/**
+ * @brief 圧縮中かどうか
+ */
+static bool s_is_busy;
+
+/**
+ * @brief ビット出力バッファ(上位詰め)
+ */
+static uint32_t s_bit_buf;
+
+/**
+ * @brief ビット出力バッファのビット数
+ */
+static uint8_t s_bit_count;
+
+/**
+ * @brief 成分毎の前のブロックのDC値
+ */
+static int32_t s_last_dc[COMPONENT_COUNT];
+
+/**
+ * @brief 圧縮を開始する。ヘッダを出力する。
+ *        以降、先頭から8ラインずつ jpeg_enc_encode_stripe() に渡し、最後に jpeg_enc_end() を呼び出す。
+ * @param pdst 出力先
+ * @param dst_size 出力先のサイズ[byte]
+ * @param width 幅[pixel] (16の倍数)
+ * @param height 高さ[line] (8の倍数)
+ * @param quality 品質(1〜100)
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int jpeg_enc_begin(uint8_t* pdst, uint32_t dst_size, uint16_t width, uint16_t height, uint8_t quality)
+{
+    if ((pdst == NULL) || (width == 0u) || (height == 0u) || ((width % JPEG_ENC_MCU_WIDTH) != 0u)
+        || ((height % JPEG_ENC_MCU_HEIGHT) != 0u) || (quality < JPEG_ENC_MIN_QUALITY) || (quality > JPEG_ENC_MAX_QUALITY))
+    {
+        return EINVAL;
+    }
+    if (dst_size < JPEG_ENC_HEADER_SIZE)
+    {
+        return ENOSPC;
+    }
+
+    if (!s_is_huff_built)
+    {
+        for (int table = 0; table < HUFF_TABLE_COUNT; table++)
+        {
+            build_huff_table((enum huff_table)(table));
+        }
+        s_is_huff_built = true;
+    }
+    if (quality != s_quality)
+    {
+        build_quant_table(0u, quality);
+        build_quant_table(1u, quality);
+        s_quality = quality;
+    }
+
+    s_pdst = pdst;
+    s_dst_size = dst_size;
+    s_len = 0u;
+    s_is_overflow = false;
+    s_width = width;
+    s_height = height;
+    s_encoded_lines = 0u;
+    s_bit_buf = 0u;
+    s_bit_count = 0u;
+    for (int comp = 0; comp < COMPONENT_COUNT; comp++)
+    {
+        s_last_dc[comp] = 0;
+    }
+    write_headers();
+    s_is_busy = true;
+
+    return 0;
+}
+
+/**
+ * @brief 8ライン(1MCUライン)を圧縮する。
+ * @param psrc 先頭ラインのYUYVデータ(Y0, Cb, Y1, Cr の順)
+ * @param stride ライン間のバイト数
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int jpeg_enc_encode_stripe(const uint8_t* psrc, uint32_t stride)
+{
+    int32_t block[64];
+
+    if (!s_is_busy || (s_encoded_lines >= s_height))
+    {
+        return EINVAL;
+    }
+
+    for (uint16_t x = 0u; x < s_width; x += JPEG_ENC_MCU_WIDTH)
+    {
+        const uint8_t* pmcu = psrc + ((uint32_t)(x) * 2u);
+
+        // Y 2ブロック(左, 右), Cb, Cr の順
+        load_block(block, pmcu, stride, 2u);
+        encode_block(block, COMPONENT_Y);
+        load_block(block, pmcu + 16u, stride, 2u);
+        encode_block(block, COMPONENT_Y);
+        load_block(block, pmcu + 1u, stride, 4u);
+        encode_block(block, COMPONENT_CB);
+        load_block(block, pmcu + 3u, stride, 4u);
+        encode_block(block, COMPONENT_CR);
+    }
+    s_encoded_lines += JPEG_ENC_MCU_HEIGHT;
+
+    return s_is_overflow ? ENOSPC : 0;
+}
+
+/**
+ * @brief 圧縮を終了する。EOIを出力する。
+ * @param plen 出力したサイズ[byte]を格納する変数
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int jpeg_enc_end(uint32_t* plen)
+{
+    if (!s_is_busy)
+    {
+        return EINVAL;
+    }
+    s_is_busy = false;
+    if (s_encoded_lines < s_height)
+    {
+        return EINVAL;
+    }
+
+    flush_bits();
+    write_byte(0xFFu); // EOI
+    write_byte(0xD9u);
+    if (s_is_overflow)
+    {
+        return ENOSPC;
+    }
+    (*plen) = s_len;
+
+    return 0;
+}
+
+/**
+ * @brief 圧縮中かどうかを得る。
+ * @return 圧縮中の場合にはtrue, それ以外はfalse.
+ */
+bool jpeg_enc_is_busy(void)
+{
+    return s_is_busy;
+}
+
+/**
+ * @brief 品質に合わせた量子化テーブルと逆数テーブルを作成する。
+ *        スケーリングはIJG(libjpeg)と同じ。
+ * @param table_no テーブル番号(0:輝度, 1:色差)
+ * @param quality 品質(1〜100)
+ */
+static void build_quant_table(uint8_t table_no, uint8_t quality)
+{
+    const uint8_t* pbase = (table_no == 0u) ? s_base_quant_luma : s_base_quant_chroma;
+    uint32_t scale = (quality < 50u) ? (5000u / quality) : (200u - (quality * 2u));
+
+    for (int i = 0; i < 64; i++)
+    {
+        uint32_t value = ((pbase[i] * scale) + 50u) / 100u;
+        if (value < 1u)
+        {
+            value = 1u;
+        }
+        else if (value > 255u)
+        {
+            value = 255u;
+        }
+        s_recip[table_no][i] = (uint16_t)(((1u << RECIP_BITS) + (value * 4u)) / (value * 8u));
+    }
+    for (int i = 0; i < 64; i++)
+    {
+        uint32_t value = ((pbase[s_zigzag[i]] * scale) + 50u) / 100u;
+        s_quant[table_no][i] = (uint8_t)((value < 1u) ? 1u : ((value > 255u) ? 255u : value));
+    }
+
+    return;
+}
+
+/**
+ * @brief ハフマン符号テーブルを作成する。(JPEG規格 Annex C)
+ * @param table テーブル番号
+ */
+static void build_huff_table(enum huff_table table)
+{
+    const struct huff_spec* pspec = &(s_huff_specs[table]);
+    struct huff_code* pcodes = s_huff_codes[table];
+    uint16_t code = 0u;
+    uint32_t index = 0u;
+
+    memset(pcodes, 0, sizeof(s_huff_codes[0]));
+    for (uint8_t size = 1u; size <= 16u; size++)
+    {
+        for (uint8_t n = 0u; n < pspec->bits[size - 1u]; n++)
+        {
+            pcodes[pspec->values[index]].code = code;
+            pcodes[pspec->values[index]].size = size;
+            index++;
+            code++;
+        }
+        code <<= 1;
+    }
+
+    return;
+}
+
+/**
+ * @brief SOI, APP0(JFIF), DQT, SOF0, DHT, SOS を出力する。
+ */
+static void write_headers(void)
+{
+    write_word(0xFFD8u); // SOI
+
+    write_word(0xFFE0u); // APP0
+    write_word(16u);
+    write_byte('J');
+    write_byte('F');
+    write_byte('I');
+    write_byte('F');
+    write_byte(0u);
+    write_word(0x0101u); // Version 1.01
+    write_byte(0u);      // 密度単位なし(アスペクト比)
+    write_word(1u);
+    write_word(1u);
+    write_byte(0u); // サムネイルなし
+    write_byte(0u);
+
+    write_word(0xFFDBu); // DQT
+    write_word(2u + (2u * 65u));
+    for (uint8_t table_no = 0u; table_no < 2u; table_no++)
+    {
+        write_byte(table_no); // 8bit精度
+        for (int i = 0; i < 64; i++)
+        {
+            write_byte(s_quant[table_no][i]);
+        }
+    }
+
+    write_word(0xFFC0u); // SOF0
+    write_word(8u + (3u * COMPONENT_COUNT));
+    write_byte(8u);
+    write_word(s_height);
+    write_word(s_width);
+    write_byte(COMPONENT_COUNT);
+    write_byte(1u); // Y: H=2, V=1, 量子化テーブル0
+    write_byte(0x21u);
+    write_byte(0u);
+    write_byte(2u); // Cb: H=1, V=1, 量子化テーブル1
+    write_byte(0x11u);
+    write_byte(1u);
+    write_byte(3u); // Cr: H=1, V=1, 量子化テーブル1
+    write_byte(0x11u);
+    write_byte(1u);
+
+    write_word(0xFFC4u); // DHT
+    uint16_t dht_len = 2u;
+    for (int table = 0; table < HUFF_TABLE_COUNT; table++)
+    {
+        dht_len += 17u;
+        for (int i = 0; i < 16; i++)
+        {
+            dht_len += s_huff_specs[table].bits[i];
+        }
+    }
+    write_word(dht_len);
+    for (int table = 0; table < HUFF_TABLE_COUNT; table++)
+    {
+        const struct huff_spec* pspec = &(s_huff_specs[table]);
+        uint32_t count = 0u;
+        write_byte(pspec->cls_id);
+        for (int i = 0; i < 16; i++)
+        {
+            write_byte(pspec->bits[i]);
+            count += pspec->bits[i];
+        }
+        for (uint32_t i = 0u; i < count; i++)
+        {
+            write_byte(pspec->values[i]);
+        }
+    }
+
+    write_word(0xFFDAu); // SOS
+    write_word(6u + (2u * COMPONENT_COUNT));
+    write_byte(COMPONENT_COUNT);
+    write_byte(1u); // Y: DC0, AC0
+    write_byte(0x00u);
+    write_byte(2u); // Cb: DC1, AC1
+    write_byte(0x11u);
+    write_byte(3u); // Cr: DC1, AC1
+    write_byte(0x11u);
+    write_byte(0u);  // Ss
+    write_byte(63u); // Se
+    write_byte(0u);  // Ah, Al
+
+    return;
+}
+
+/**
+ * @brief 1バイト出力する。出力先が足りない場合は出力せずにオーバーフローとする。
+ * @param value 値
+ */
+static void write_byte(uint8_t value)
+{
+    if (s_len < s_dst_size)
+    {
+        s_pdst[s_len] = value;
+        s_len++;
+    }
+    else
+    {
+        s_is_overflow = true;
+    }
+
+    return;
+}
+
+/**
+ * @brief 2バイトをビッグエンディアンで出力する。
+ * @param value 値
+ */
+static void write_word(uint16_t value)
+{
+    write_byte((uint8_t)(value >> 8));
+    write_byte((uint8_t)(value & 0xFFu));
+
+    return;
+}
+
+/**
+ * @brief 8x8ブロックを読み出し、レベルシフト(-128)する。
+ * @param pblock ブロックを格納する配列
+ * @param psrc ブロック左上の成分の位置
+ * @param stride ライン間のバイト数
+ * @param step 同じ成分の水平方向の間隔[byte]
+ */
+static void load_block(int32_t* pblock, const uint8_t* psrc, uint32_t stride, uint32_t step)
+{
+    for (int y = 0; y < 8; y++)
+    {
+        const uint8_t* pline = psrc + (stride * (uint32_t)(y));
+        for (int x = 0; x < 8; x++)
+        {
+            pblock[(y * 8) + x] = (int32_t)(pline[(uint32_t)(x) * step]) - 128;
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief 8x8ブロックを順方向DCTする。(その場で変換する)
+ *        出力は真値の8倍になる。
+ * @param pblock ブロック
+ */
+static void forward_dct(int32_t* pblock)
+{
+    int32_t* p;
+
+    // 1パス目: 行。出力は 2^PASS1_BITS 倍にする。
+    p = pblock;
+    for (int row = 0; row < 8; row++)
+    {
+        int32_t tmp0 = p[0] + p[7];
+        int32_t tmp7 = p[0] - p[7];
+        int32_t tmp1 = p[1] + p[6];
+        int32_t tmp6 = p[1] - p[6];
+        int32_t tmp2 = p[2] + p[5];
+        int32_t tmp5 = p[2] - p[5];
+        int32_t tmp3 = p[3] + p[4];
+        int32_t tmp4 = p[3] - p[4];
+
+        int32_t tmp10 = tmp0 + tmp3;
+        int32_t tmp13 = tmp0 - tmp3;
+        int32_t tmp11 = tmp1 + tmp2;
+        int32_t tmp12 = tmp1 - tmp2;
+
+        p[0] = (tmp10 + tmp11) << PASS1_BITS;
+        p[4] = (tmp10 - tmp11) << PASS1_BITS;
+        int32_t z1 = (tmp12 + tmp13) * FIX_0_541196100;
+        p[2] = DESCALE(z1 + (tmp13 * FIX_0_765366865), CONST_BITS - PASS1_BITS);
+        p[6] = DESCALE(z1 - (tmp12 * FIX_1_847759065), CONST_BITS - PASS1_BITS);
+
+        z1 = tmp4 + tmp7;
+        int32_t z2 = tmp5 + tmp6;
+        int32_t z3 = tmp4 + tmp6;
+        int32_t z4 = tmp5 + tmp7;
+        int32_t z5 = (z3 + z4) * FIX_1_175875602;
+        tmp4 *= FIX_0_298631336;
+        tmp5 *= FIX_2_053119869;
+        tmp6 *= FIX_3_072711026;
+        tmp7 *= FIX_1_501321110;
+        z1 *= -FIX_0_899976223;
+        z2 *= -FIX_2_562915447;
+        z3 = (z3 * -FIX_1_961570560) + z5;
+        z4 = (z4 * -FIX_0_390180644) + z5;
+        p[7] = DESCALE(tmp4 + z1 + z3, CONST_BITS - PASS1_BITS);
+        p[5] = DESCALE(tmp5 + z2 + z4, CONST_BITS - PASS1_BITS);
+        p[3] = DESCALE(tmp6 + z2 + z3, CONST_BITS - PASS1_BITS);
+        p[1] = DESCALE(tmp7 + z1 + z4, CONST_BITS - PASS1_BITS);
+
+        p += 8;
+    }
+
+    // 2パス目: 列。2^PASS1_BITS 倍を取り除く。
+    p = pblock;
+    for (int col = 0; col < 8; col++)
+    {
+        int32_t tmp0 = p[8 * 0] + p[8 * 7];
+        int32_t tmp7 = p[8 * 0] - p[8 * 7];
+        int32_t tmp1 = p[8 * 1] + p[8 * 6];
+        int32_t tmp6 = p[8 * 1] - p[8 * 6];
+        int32_t tmp2 = p[8 * 2] + p[8 * 5];
+        int32_t tmp5 = p[8 * 2] - p[8 * 5];
+        int32_t tmp3 = p[8 * 3] + p[8 * 4];
+        int32_t tmp4 = p[8 * 3] - p[8 * 4];
+
+        int32_t tmp10 = tmp0 + tmp3;
+        int32_t tmp13 = tmp0 - tmp3;
+        int32_t tmp11 = tmp1 + tmp2;
+        int32_t tmp12 = tmp1 - tmp2;
+
+        p[8 * 0] = DESCALE(tmp10 + tmp11, PASS1_BITS);
+        p[8 * 4] = DESCALE(tmp10 - tmp11, PASS1_BITS);
+        int32_t z1 = (tmp12 + tmp13) * FIX_0_541196100;
+        p[8 * 2] = DESCALE(z1 + (tmp13 * FIX_0_765366865), CONST_BITS + PASS1_BITS);
+        p[8 * 6] = DESCALE(z1 - (tmp12 * FIX_1_847759065), CONST_BITS + PASS1_BITS);
+
+        z1 = tmp4 + tmp7;
+        int32_t z2 = tmp5 + tmp6;
+        int32_t z3 = tmp4 + tmp6;
+        int32_t z4 = tmp5 + tmp7;
+        int32_t z5 = (z3 + z4) * FIX_1_175875602;
+        tmp4 *= FIX_0_298631336;
+        tmp5 *= FIX_2_053119869;
+        tmp6 *= FIX_3_072711026;
+        tmp7 *= FIX_1_501321110;
+        z1 *= -FIX_0_899976223;
+        z2 *= -FIX_2_562915447;
+        z3 = (z3 * -FIX_1_961570560) + z5;
+        z4 = (z4 * -FIX_0_390180644) + z5;
+        p[8 * 7] = DESCALE(tmp4 + z1 + z3, CONST_BITS + PASS1_BITS);
+        p[8 * 5] = DESCALE(tmp5 + z2 + z4, CONST_BITS + PASS1_BITS);
+        p[8 * 3] = DESCALE(tmp6 + z2 + z3, CONST_BITS + PASS1_BITS);
+        p[8 * 1] = DESCALE(tmp7 + z1 + z4, CONST_BITS + PASS1_BITS);
+
+        p++;
+    }
+
+    return;
+}
+
+/**
+ * @brief 8x8ブロックをDCT, 量子化し、ハフマン符号化して出力する。
+ * @param pblock ブロック(DCTで上書きされる)
+ * @param comp 成分
+ */
+static void encode_block(int32_t* pblock, enum component comp)
+{
+    const uint16_t* precip = s_recip[(comp == COMPONENT_Y) ? 0 : 1];
+    const struct huff_code* pdc = s_huff_codes[(comp == COMPONENT_Y) ? HUFF_TABLE_DC_LUMA : HUFF_TABLE_DC_CHROMA];
+    const struct huff_code* pac = s_huff_codes[(comp == COMPONENT_Y) ? HUFF_TABLE_AC_LUMA : HUFF_TABLE_AC_CHROMA];
+
+    forward_dct(pblock);
+
+    // 量子化(符号を除いた値に逆数を掛けて丸める)
+    for (int i = 0; i < 64; i++)
+    {
+        int32_t value = pblock[i];
+        uint32_t abs_value = (uint32_t)((value < 0) ? -value : value);
+        int32_t q = (int32_t)(((abs_value * precip[i]) + (1u << (RECIP_BITS - 1))) >> RECIP_BITS);
+        pblock[i] = (value < 0) ? -q : q;
+    }
+
+    // DC: 前のブロックとの差分
+    int32_t diff = pblock[0] - s_last_dc[comp];
+    s_last_dc[comp] = pblock[0];
+    uint32_t abs_diff = (uint32_t)((diff < 0) ? -diff : diff);
+    uint8_t nbits = 0u;
+    while (abs_diff != 0u)
+    {
+        nbits++;
+        abs_diff >>= 1;
+    }
+    put_bits(pdc[nbits].code, pdc[nbits].size);
+    if (nbits > 0u)
+    {
+        put_bits((uint32_t)((diff < 0) ? (diff - 1) : diff) & ((1u << nbits) - 1u), nbits);
+    }
+
+    // AC: (0の連続数, ビット数) + 値
+    uint32_t run = 0u;
+    for (int k = 1; k < 64; k++)
+    {
+        int32_t value = pblock[s_zigzag[k]];
+        if (value == 0)
+        {
+            run++;
+            continue;
+        }
+        while (run > 15u)
+        {
+            put_bits(pac[0xF0].code, pac[0xF0].size); // ZRL
+            run -= 16u;
+        }
+        uint32_t abs_value = (uint32_t)((value < 0) ? -value : value);
+        nbits = 0u;
+        while (abs_value != 0u)
+        {
+            nbits++;
+            abs_value >>= 1;
+        }
+        uint8_t symbol = (uint8_t)((run << 4) | nbits);
+        put_bits(pac[symbol].code, pac[symbol].size);
+        put_bits((uint32_t)((value < 0) ? (value - 1) : value) & ((1u << nbits) - 1u), nbits);
+        run = 0u;
+    }
+    if (run > 0u)
+    {
+        put_bits(pac[0x00].code, pac[0x00].size); // EOB
+    }
+
+    return;
+}
+
+/**
+ * @brief ビット列を出力する。0xFFの後には0x00を挿入する。(バイトスタッフィング)
+ * @param bits ビット列(下位 size ビット)
+ * @param size ビット数(16以下)
+ */
+static void put_bits(uint32_t bits, uint8_t size)
+{
+    s_bit_buf |= bits << (32u - s_bit_count - size);
+    s_bit_count += size;
+    while (s_bit_count >= 8u)
+    {
+        uint8_t value = (uint8_t)(s_bit_buf >> 24);
+        write_byte(value);
+        if (value == 0xFFu)
+        {
+            write_byte(0x00u);
+        }
+        s_bit_buf <<= 8;
+        s_bit_count -= 8u;
+    }
+
+    return;
+}
+
+/**
+ * @brief 残りのビットを1で埋めてバイト境界まで出力する。
+ */
+static void flush_bits(void)
+{
+    if (s_bit_count > 0u)
+    {
+        put_bits(0x7Fu, 7u);
+    }
+    s_bit_buf = 0u;
+    s_bit_count = 0u;
+
+    return;
+}
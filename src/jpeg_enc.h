@@ -0,0 +1,45 @@
+/**
+ * @file JPEGエンコーダのインタフェース宣言
+ *        YUYV(YUV422)のキャプチャデータを、ベースラインJPEG(YCbCr 4:2:2, H2V1)に圧縮する。
+ *        1MCUは16x8ピクセルで、8ライン(MCUストライプ)単位で圧縮する。
+ *        プラットフォームに依存しないため、ホストでもビルドできる。
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+
+#ifndef JPEG_ENC_H_
+#define JPEG_ENC_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief MCUの幅[pixel]
+ */
+#define JPEG_ENC_MCU_WIDTH (16)
+
+/**
+ * @brief MCUの高さ[line] (1回の jpeg_enc_encode_stripe() で圧縮するライン数)
+ */
+#define JPEG_ENC_MCU_HEIGHT (8)
+
+/**
+ * @brief 品質の最小値
+ */
+#define JPEG_ENC_MIN_QUALITY (1)
+
+/**
+ * @brief 品質の最大値
+ */
+#define JPEG_ENC_MAX_QUALITY (100)
+
+/**
+ * @brief ヘッダ(SOI〜SOS)のサイズ[byte]
+ */
+#define JPEG_ENC_HEADER_SIZE (607)
+
+int jpeg_enc_begin(uint8_t* pdst, uint32_t dst_size, uint16_t width, uint16_t height, uint8_t quality);
+int jpeg_enc_encode_stripe(const uint8_t* psrc, uint32_t stride);
+int jpeg_enc_end(uint32_t* plen);
+bool jpeg_enc_is_busy(void);
+
+#endif /* JPEG_ENC_H_ */
@@ -14,7 +14,18 @@
 #include "command_io.h"
 #include "test_signal.h"
 #include "i2c.h"
+#include "i2c_scan.h"
+#include "i2c_bench.h"
+#include "memmap.h"
+#include "dmac.h"
+#include "memop.h"
 #include "pdc.h"
+#include "sensor.h"
+#include "sensor_ae.h"
+#include "selftest.h"
+#include "pdc_bench.h"
+#include "pdc_seq.h"
+#include "pdc_passthrough.h"
 
 void main(void);
 
@@ -23,19 +34,36 @@ void main(void);
  */
 void main(void)
 {
+    memmap_init(); // 照合結果は memmap コマンドで確認する。
     hwtick_init();
     usb_cdc_init();
     command_io_init();
     test_signal_init();
     i2c_init();
+    i2c_scan_init();
+    i2c_bench_init();
+    dmac_init();
+    memop_init();
     pdc_init();
+    sensor_init();
+    sensor_ae_init();
+    selftest_init();
+    pdc_bench_init();
+    pdc_seq_init();
+    pdc_passthrough_init();
 
     volatile int counter = 0;
     while (1)
     {
         usb_cdc_update();
         command_io_update();
+        i2c_scan_update();
+        i2c_bench_update();
         pdc_update();
+        selftest_update();
+        pdc_bench_update();
+        pdc_seq_update();
+        pdc_passthrough_update();
 
         // TODO :
 
@@ -0,0 +1,316 @@
+/**
+ * @file メモリ領域マップ定義
+ *        RAM1(内蔵RAM)とRAM2(拡張RAM)の範囲, 配置単位, アクセスできるバスマスタを1か所にまとめ、
+ *        リンカが配置したデータ(スタックを含む)の後ろの空き領域を、大きなバッファ用のアリーナとして管理する。
+ *        アリーナは先頭から順に確保するだけで、解放はできない。(起動時に必要なバッファを確保する)
+ *        起動時にリンカシンボルと領域の定義を照合し、リンカが配置したデータが領域からはみ出していないことを確認する。
+ *        RAM2に静的に配置する変数は、__attribute__((section(".bss_ram2"))) を指定する。(ゼロクリアされない)
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "memmap.h"
+
+/**
+ * @brief 全てのバスマスタ
+ */
+#define MEMMAP_MASTER_ALL (MEMMAP_MASTER_CPU | MEMMAP_MASTER_DMAC | MEMMAP_MASTER_GLCDC | MEMMAP_MASTER_DRW2D | MEMMAP_MASTER_EDMAC)
+
+/**
+ * @brief RAM1(.data, .bss, スタック)の終端 (リンカスクリプトで定義)
+ *        RXのGCCはCのシンボル名に _ を付加するため、アセンブラ名で直接参照する。
+ */
+extern uint8_t s_linker_ebss[] __asm__("_end");
+extern uint8_t s_linker_istack[] __asm__("_istack");
+extern uint8_t s_linker_ustack[] __asm__("_ustack");
+
+/**
+ * @brief RAM2(.bss_ram2)の範囲 (リンカスクリプトで定義)
+ */
+extern uint8_t s_linker_bss_ram2[] __asm__("_bss_ram2");
+extern uint8_t s_linker_ebss_ram2[] __asm__("_ebss_ram2");
+
+static uintptr_t get_linker_end(enum memmap_region_id id);
+static bool is_power_of_2(uint32_t value);
+static uintptr_t align_up(uintptr_t addr, uint32_t align);
+
+/**
+ * @brief メモリ領域の定義
+ *        RAM2の配置単位は、GLCDCのグラフィックスプレーンとして直接表示できるよう、GLCDCの読み出し単位(64byte)にする。
+ */
+//@formatter:off
+static const struct memmap_region s_regions[MEMMAP_REGION_COUNT] = {
+    { "RAM1", 0x00000000UL, 0x00080000UL, 4u, MEMMAP_MASTER_ALL },
+    { "RAM2", 0x00800000UL, 0x00080000UL, 64u, MEMMAP_MASTER_ALL },
+};
+//@formatter:on
+
+/**
+ * @brief 領域毎のアリーナ
+ */
+static struct memmap_region_info s_infos[MEMMAP_REGION_COUNT];
+
+/**
+ * @brief アリーナから確保したバッファ
+ */
+static struct memmap_allocation s_allocations[MEMMAP_MAX_ALLOCATIONS];
+
+/**
+ * @brief アリーナから確保したバッファ数
+ */
+static int s_allocation_count;
+
+/**
+ * @brief 起動時の照合結果
+ */
+static bool s_is_valid;
+
+/**
+ * @brief メモリ領域マップを初期化する。
+ *        リンカシンボルと領域の定義を照合し、リンカが配置したデータの後ろをアリーナにする。
+ *        照合に失敗した領域はアリーナを0バイトにする。
+ * @return 照合に成功した場合にはtrue, 失敗した場合にはfalse.
+ */
+bool memmap_init(void)
+{
+    s_is_valid = true;
+    s_allocation_count = 0;
+    memset(s_allocations, 0, sizeof(s_allocations));
+
+    for (int id = 0; id < MEMMAP_REGION_COUNT; id++)
+    {
+        const struct memmap_region* pregion = &(s_regions[id]);
+        struct memmap_region_info* pinfo = &(s_infos[id]);
+        uintptr_t region_end = pregion->start + pregion->size;
+        uintptr_t linker_end = get_linker_end((enum memmap_region_id)(id));
+
+        pinfo->pregion = pregion;
+        pinfo->linker_end = linker_end;
+        pinfo->arena_used = 0u;
+
+        uintptr_t arena_start = align_up(linker_end, pregion->align);
+        if ((linker_end < pregion->start) || (arena_start > region_end))
+        {
+            // リンカの配置が領域の定義と一致しない。
+            s_is_valid = false;
+            pinfo->arena_start = region_end;
+            pinfo->arena_size = 0u;
+        }
+        else
+        {
+            pinfo->arena_start = arena_start;
+            pinfo->arena_size = (uint32_t)(region_end - arena_start);
+        }
+
+        // 他の領域と重なっていないかを調べる。
+        for (int i = 0; i < id; i++)
+        {
+            const struct memmap_region* pother = &(s_regions[i]);
+            if ((pregion->start < (pother->start + pother->size)) && (pother->start < region_end))
+            {
+                s_is_valid = false;
+            }
+        }
+    }
+
+    return s_is_valid;
+}
+
+/**
+ * @brief 起動時の照合に成功したかどうかを得る。
+ * @return 成功した場合にはtrue, 失敗した場合にはfalse.
+ */
+bool memmap_is_valid(void)
+{
+    return s_is_valid;
+}
+
+/**
+ * @brief メモリ領域の定義を得る。
+ * @param id 領域
+ * @return 領域の定義。範囲外の場合にはNULL.
+ */
+const struct memmap_region* memmap_get_region(enum memmap_region_id id)
+{
+    return ((id >= 0) && (id < MEMMAP_REGION_COUNT)) ? &(s_regions[id]) : NULL;
+}
+
+/**
+ * @brief メモリ領域の使用状況を得る。
+ * @param id 領域
+ * @param pinfo 使用状況を格納する構造体
+ * @return 成功した場合にはtrue, 失敗した場合にはfalse.
+ */
+bool memmap_get_region_info(enum memmap_region_id id, struct memmap_region_info* pinfo)
+{
+    if ((id < 0) || (id >= MEMMAP_REGION_COUNT) || (pinfo == NULL))
+    {
+        return false;
+    }
+
+    (*pinfo) = s_infos[id];
+
+    return true;
+}
+
+/**
+ * @brief アリーナから確保できる最大サイズを得る。
+ * @param id 領域
+ * @param align 配置単位[byte] (0の場合は領域の配置単位)
+ * @return 確保できる最大サイズ[byte]
+ */
+uint32_t memmap_get_free_size(enum memmap_region_id id, uint32_t align)
+{
+    if ((id < 0) || (id >= MEMMAP_REGION_COUNT))
+    {
+        return 0u;
+    }
+    const struct memmap_region_info* pinfo = &(s_infos[id]);
+    if (align < pinfo->pregion->align)
+    {
+        align = pinfo->pregion->align;
+    }
+    if (!is_power_of_2(align))
+    {
+        return 0u;
+    }
+
+    uintptr_t arena_end = pinfo->arena_start + pinfo->arena_size;
+    uintptr_t addr = align_up(pinfo->arena_start + pinfo->arena_used, align);
+
+    return (addr < arena_end) ? (uint32_t)(arena_end - addr) : 0u;
+}
+
+/**
+ * @brief アリーナからバッファを確保する。
+ *        確保したバッファは解放できない。内容は初期化しない。
+ * @param id 領域
+ * @param size サイズ[byte]
+ * @param align 配置単位[byte] (2の累乗。0または領域の配置単位より小さい場合は領域の配置単位)
+ * @param masters バッファにアクセスするバスマスタ(enum memmap_master の組み合わせ)
+ * @param owner 所有者名
+ * @return 確保したバッファ。確保できなかった場合にはNULL.
+ */
+void* memmap_alloc(enum memmap_region_id id, uint32_t size, uint32_t align, uint8_t masters, const char* owner)
+{
+    if ((id < 0) || (id >= MEMMAP_REGION_COUNT) || (size == 0u) || (owner == NULL)
+            || (s_allocation_count >= MEMMAP_MAX_ALLOCATIONS))
+    {
+        return NULL;
+    }
+    struct memmap_region_info* pinfo = &(s_infos[id]);
+    if ((masters & ~(pinfo->pregion->masters)) != 0u) // アクセスできないバスマスタがある？
+    {
+        return NULL;
+    }
+    if (align < pinfo->pregion->align)
+    {
+        align = pinfo->pregion->align;
+    }
+    if (!is_power_of_2(align) || (size > memmap_get_free_size(id, align)))
+    {
+        return NULL;
+    }
+
+    uintptr_t addr = align_up(pinfo->arena_start + pinfo->arena_used, align);
+    pinfo->arena_used = (uint32_t)((addr + size) - pinfo->arena_start);
+
+    struct memmap_allocation* palloc = &(s_allocations[s_allocation_count]);
+    palloc->owner = owner;
+    palloc->region = id;
+    palloc->addr = addr;
+    palloc->size = size;
+    s_allocation_count++;
+
+    return (void*)(addr);
+}
+
+/**
+ * @brief アリーナから確保したバッファ数を得る。
+ * @return バッファ数
+ */
+int memmap_get_allocation_count(void)
+{
+    return s_allocation_count;
+}
+
+/**
+ * @brief アリーナから確保したバッファの情報を得る。
+ * @param index インデックス(確保した順)
+ * @param palloc 情報を格納する構造体
+ * @return 成功した場合にはtrue, 失敗した場合にはfalse.
+ */
+bool memmap_get_allocation(int index, struct memmap_allocation* palloc)
+{
+    if ((index < 0) || (index >= s_allocation_count) || (palloc == NULL))
+    {
+        return false;
+    }
+
+    (*palloc) = s_allocations[index];
+
+    return true;
+}
+
+/**
+ * @brief リンカが配置したデータの終端アドレスを得る。
+ * @param id 領域
+ * @return 終端アドレス
+ */
+static uintptr_t get_linker_end(enum memmap_region_id id)
+{
+    uintptr_t end;
+
+    switch (id)
+    {
+    case MEMMAP_REGION_RAM1: {
+        // スタックは .bss の後ろに配置される。
+        end = (uintptr_t)(s_linker_ebss);
+        if ((uintptr_t)(s_linker_istack) > end)
+        {
+            end = (uintptr_t)(s_linker_istack);
+        }
+        if ((uintptr_t)(s_linker_ustack) > end)
+        {
+            end = (uintptr_t)(s_linker_ustack);
+        }
+        break;
+    }
+    case MEMMAP_REGION_RAM2: {
+        end = (uintptr_t)(s_linker_ebss_ram2);
+        if ((uintptr_t)(s_linker_bss_ram2) < s_regions[id].start) // セクションが領域外に配置された？
+        {
+            end = 0u;
+        }
+        break;
+    }
+    default: {
+        end = 0u;
+        break;
+    }
+    }
+
+    return end;
+}
+
+/**
+ * @brief 2の累乗かどうかを得る。
+ * @param value 値
+ * @return 2の累乗の場合にはtrue, それ以外はfalse.
+ */
+static bool is_power_of_2(uint32_t value)
+{
+    return (value != 0u) && ((value & (value - 1u)) == 0u);
+}
+
+/**
+ * @brief アドレスを配置単位に切り上げる。
+ * @param addr アドレス
+ * @param align 配置単位[byte] (2の累乗)
+ * @return 切り上げたアドレス
+ */
+static uintptr_t align_up(uintptr_t addr, uint32_t align)
+{
+    return (addr + (uintptr_t)(align - 1u)) & ~(uintptr_t)(align - 1u);
+}
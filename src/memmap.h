@@ -0,0 +1,83 @@
+/**
+ * @file メモリ領域マップのインタフェース宣言
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+
+#ifndef MEMMAP_H_
+#define MEMMAP_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief アリーナから確保できる最大数
+ */
+#define MEMMAP_MAX_ALLOCATIONS (8)
+
+/**
+ * @brief メモリ領域
+ */
+enum memmap_region_id
+{
+    MEMMAP_REGION_RAM1 = 0, // 内蔵RAM
+    MEMMAP_REGION_RAM2,     // 拡張RAM
+    MEMMAP_REGION_COUNT,    // 領域数
+};
+
+/**
+ * @brief バスマスタ(領域にアクセスできるマスタの指定に使用する)
+ */
+enum memmap_master
+{
+    MEMMAP_MASTER_CPU = 0x01,   // CPU
+    MEMMAP_MASTER_DMAC = 0x02,  // DMAC/DTC
+    MEMMAP_MASTER_GLCDC = 0x04, // GLCDC
+    MEMMAP_MASTER_DRW2D = 0x08, // DRW2D
+    MEMMAP_MASTER_EDMAC = 0x10, // EDMAC
+};
+
+/**
+ * @brief メモリ領域の定義
+ */
+struct memmap_region
+{
+    const char* name; // 領域名
+    uintptr_t start;  // 先頭アドレス
+    uint32_t size;    // サイズ[byte]
+    uint32_t align;   // アリーナから確保する場合の最小配置単位[byte]
+    uint8_t masters;  // アクセスできるバスマスタ(enum memmap_master の組み合わせ)
+};
+
+/**
+ * @brief メモリ領域の使用状況
+ */
+struct memmap_region_info
+{
+    const struct memmap_region* pregion; // 領域の定義
+    uintptr_t linker_end;                // リンカが配置したデータ(スタック含む)の終端アドレス
+    uintptr_t arena_start;               // アリーナの先頭アドレス
+    uint32_t arena_size;                 // アリーナのサイズ[byte]
+    uint32_t arena_used;                 // アリーナの使用済みサイズ(配置の隙間を含む)[byte]
+};
+
+/**
+ * @brief アリーナから確保したバッファ
+ */
+struct memmap_allocation
+{
+    const char* owner;            // 所有者名
+    enum memmap_region_id region; // 確保した領域
+    uintptr_t addr;               // 先頭アドレス
+    uint32_t size;                // サイズ[byte]
+};
+
+bool memmap_init(void);
+bool memmap_is_valid(void);
+const struct memmap_region* memmap_get_region(enum memmap_region_id id);
+bool memmap_get_region_info(enum memmap_region_id id, struct memmap_region_info* pinfo);
+uint32_t memmap_get_free_size(enum memmap_region_id id, uint32_t align);
+void* memmap_alloc(enum memmap_region_id id, uint32_t size, uint32_t align, uint8_t masters, const char* owner);
+int memmap_get_allocation_count(void);
+bool memmap_get_allocation(int index, struct memmap_allocation* palloc);
+
+#endif /* MEMMAP_H_ */
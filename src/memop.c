@@ -0,0 +1,424 @@
+/**
+ * @file DMAメモリ操作(フィル/コピー)定義
+ *        DMACチャネル管理から優先順位の低い空きチャネルを確保し、ソフトウェア起動で使用して、メモリのフィル, コピー, 2次元(ストライド付き)コピーを非同期に行う。
+ *        DMACのノーマル転送は1回あたり最大65535単位なので、それを超える場合と2次元コピーの行毎には、
+ *        転送完了割り込みで次の転送を開始する。
+ *        チャネルを確保できなかった場合と、DMACが使用中(前回の操作が完了していない)の場合には、
+ *        RXのストリング命令(SSTR/SMOVF)を使用して呼び出し元で同期的に処理する。
+ *        RX72Nはデータキャッシュを持たないため、キャッシュ操作は不要。
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+
+#include <platform.h>
+#include <r_smc_entry.h>
+
+#include "hwtick.h"
+#include "dmac.h"
+#include "memop.h"
+
+/**
+ * @brief DMAC転送完了割り込みプライオリティ
+ */
+#define MEMOP_INTERRUPT_PRIORITY (3)
+
+/**
+ * @brief ノーマル転送1回あたりの最大転送回数(DMCRA.DMCRAL)
+ *        0は転送回数無制限(フリーランニング)になるため使用しない。
+ */
+#define MAX_SEGMENT_UNITS (65535u)
+
+/**
+ * @brief メモリ操作
+ */
+struct memop_job
+{
+    uintptr_t src;                // 現在の行の転送元アドレス(フィルの場合は未使用)
+    uintptr_t dst;                // 現在の行の転送先アドレス
+    uint32_t src_stride;          // 転送元の行間隔[byte]
+    uint32_t dst_stride;          // 転送先の行間隔[byte]
+    uint32_t width;               // 1行のバイト数
+    uint32_t rows;                // 残り行数(現在の行を含む)
+    uint32_t offset;              // 現在の行の転送済みバイト数
+    uint32_t segment_bytes;       // 転送中のバイト数
+    uint32_t total_bytes;         // 全体のバイト数
+    uint8_t unit;                 // 転送単位(1, 2, 4)
+    bool is_fill;                 // フィルかどうか
+    void (*callback)(int status); // 完了時コールバック
+};
+
+static int start_job(uintptr_t dst, uintptr_t src, uint32_t dst_stride, uint32_t src_stride, uint32_t width, uint32_t height,
+                     bool is_fill, void (*callback)(int status));
+static void start_segment(void);
+static uint8_t select_unit(uintptr_t bits);
+static void cpu_copy_2d(uintptr_t dst, uint32_t dst_stride, uintptr_t src, uint32_t src_stride, uint32_t width, uint32_t height);
+static void on_transfer_end(int ch);
+
+/**
+ * @brief 使用するDMACチャネル番号(確保できなかった場合は DMAC_NO_CHANNEL)
+ */
+static int s_channel;
+
+/**
+ * @brief 使用するDMACチャネルのレジスタ
+ */
+static volatile struct st_dmac1* s_pregs;
+
+/**
+ * @brief 実行中のメモリ操作
+ */
+static struct memop_job s_job;
+
+/**
+ * @brief DMACが使用中かどうか
+ */
+static volatile bool s_is_busy;
+
+/**
+ * @brief フィル値(転送元アドレス固定で読み出す)
+ */
+static uint32_t s_fill_word;
+
+/**
+ * @brief メモリ操作を初期化する。
+ */
+void memop_init(void)
+{
+    memset(&s_job, 0, sizeof(s_job));
+    s_is_busy = false;
+
+    // キャプチャの転送を妨げないよう、優先順位の低いチャネルを使用する。(起動要因はソフトウェアのみ)
+    s_channel = dmac_claim("memop", DMAC_PRIORITY_LOW, MEMOP_INTERRUPT_PRIORITY, on_transfer_end);
+    s_pregs = dmac_get_regs(s_channel);
+    if (s_pregs != NULL)
+    {
+        s_pregs->DMTMD.WORD = _0000_DMAC_TRANS_MODE_NORMAL | _2000_DMAC_REPEAT_AREA_NONE | _0200_DMAC_TRANS_DATA_SIZE_32
+                              | _0000_DMAC_TRANS_REQ_SOURCE_SOFTWARE;
+        s_pregs->DMCSL.BYTE = _00_DMAC_INT_TRIGGER_FLAG_CLEAR;
+        s_pregs->DMINT.BYTE = _10_DMAC_TRANS_END_INT_ENABLE;
+    }
+
+    return;
+}
+
+/**
+ * @brief メモリをフィルする。
+ *        DMACを使用できない場合にはSSTR命令で処理し、戻る前にコールバックを呼び出す。
+ * @param pdst フィルする領域
+ * @param value 値
+ * @param len サイズ[byte]
+ * @param callback 完了時に呼び出すコールバック関数(不要な場合にはNULL)。DMACで処理した場合は割り込みコンテキストで呼び出される。
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int memop_fill(void* pdst, uint8_t value, uint32_t len, void (*callback)(int status))
+{
+    if (pdst == NULL)
+    {
+        return EINVAL;
+    }
+
+    if ((len == 0u) || s_is_busy || (s_pregs == NULL))
+    {
+        memop_cpu_fill(pdst, value, len);
+        if (callback != NULL)
+        {
+            callback(0);
+        }
+        return 0;
+    }
+
+    s_fill_word = (uint32_t)(value) * 0x01010101u;
+    return start_job((uintptr_t)(pdst), (uintptr_t)(&s_fill_word), len, 0u, len, 1u, true, callback);
+}
+
+/**
+ * @brief メモリをコピーする。転送元と転送先の領域は重なってはならない。
+ *        DMACを使用できない場合にはSMOVF命令で処理し、戻る前にコールバックを呼び出す。
+ * @param pdst 転送先
+ * @param psrc 転送元
+ * @param len サイズ[byte]
+ * @param callback 完了時に呼び出すコールバック関数(不要な場合にはNULL)。DMACで処理した場合は割り込みコンテキストで呼び出される。
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int memop_copy(void* pdst, const void* psrc, uint32_t len, void (*callback)(int status))
+{
+    return memop_copy_2d(pdst, len, psrc, len, len, 1u, callback);
+}
+
+/**
+ * @brief 矩形領域(2次元, ストライド付き)をコピーする。転送元と転送先の領域は重なってはならない。
+ *        DMACを使用できない場合にはSMOVF命令で1行ずつ処理し、戻る前にコールバックを呼び出す。
+ * @param pdst 転送先の先頭
+ * @param dst_stride 転送先の行間隔[byte]
+ * @param psrc 転送元の先頭
+ * @param src_stride 転送元の行間隔[byte]
+ * @param width 1行のバイト数
+ * @param height 行数
+ * @param callback 完了時に呼び出すコールバック関数(不要な場合にはNULL)。DMACで処理した場合は割り込みコンテキストで呼び出される。
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int memop_copy_2d(void* pdst, uint32_t dst_stride, const void* psrc, uint32_t src_stride, uint32_t width, uint32_t height,
+                  void (*callback)(int status))
+{
+    if ((pdst == NULL) || (psrc == NULL) || ((height > 1u) && ((dst_stride < width) || (src_stride < width))))
+    {
+        return EINVAL;
+    }
+
+    if ((width == 0u) || (height == 0u) || s_is_busy || (s_pregs == NULL))
+    {
+        cpu_copy_2d((uintptr_t)(pdst), dst_stride, (uintptr_t)(psrc), src_stride, width, height);
+        if (callback != NULL)
+        {
+            callback(0);
+        }
+        return 0;
+    }
+
+    return start_job((uintptr_t)(pdst), (uintptr_t)(psrc), dst_stride, src_stride, width, height, false, callback);
+}
+
+/**
+ * @brief DMACでメモリ操作中かどうかを得る。
+ * @return メモリ操作中の場合にはtrue, それ以外はfalse.
+ */
+bool memop_is_busy(void)
+{
+    return s_is_busy;
+}
+
+/**
+ * @brief DMACのメモリ操作が完了するまで待つ。
+ * @param timeout_millis タイムアウト時間[ミリ秒]
+ * @return 完了した場合にはtrue, タイムアウトした場合にはfalse.
+ */
+bool memop_wait(uint32_t timeout_millis)
+{
+    uint32_t begin = hwtick_get();
+    while (s_is_busy)
+    {
+        if ((hwtick_get() - begin) >= timeout_millis)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief DMACのメモリ操作を中止する。コールバックは呼び出さない。
+ *        memop_wait() がタイムアウトした(DMACが停止した)場合に、呼び出し元がCPUで処理し直す前に使用する。
+ *        中止した操作の転送先の内容は不定になる。
+ */
+void memop_abort(void)
+{
+    if (!s_is_busy)
+    {
+        return;
+    }
+
+    s_pregs->DMCNT.BIT.DTE = 0U;
+    s_pregs->DMREQ.BYTE = 0U;
+    s_pregs->DMSTS.BIT.DTIF = 0U;
+    dmac_notify_end(s_channel, 0u);
+    s_is_busy = false;
+
+    return;
+}
+
+/**
+ * @brief CPU(SSTR命令)でメモリをフィルする。
+ *        アドレスとサイズが4バイト単位の場合は4バイトずつ書き込む。
+ * @param pdst フィルする領域
+ * @param value 値
+ * @param len サイズ[byte]
+ */
+void memop_cpu_fill(void* pdst, uint8_t value, uint32_t len)
+{
+#if defined(__RX__)
+    uint32_t word = (uint32_t)(value) * 0x01010101u;
+    register void* r1 __asm__("r1") = pdst;
+    register uint32_t r2 __asm__("r2") = word;
+    if ((((uintptr_t)(pdst) | len) & 0x3u) == 0u)
+    {
+        register uint32_t r3 __asm__("r3") = len / 4u;
+        __asm__ volatile("sstr.l" : "+r"(r1), "+r"(r3) : "r"(r2) : "memory");
+    }
+    else
+    {
+        register uint32_t r3 __asm__("r3") = len;
+        __asm__ volatile("sstr.b" : "+r"(r1), "+r"(r3) : "r"(r2) : "memory");
+    }
+#else
+    memset(pdst, value, len);
+#endif
+
+    return;
+}
+
+/**
+ * @brief CPU(SMOVF命令)でメモリをコピーする。転送元と転送先の領域は重なってはならない。
+ * @param pdst 転送先
+ * @param psrc 転送元
+ * @param len サイズ[byte]
+ */
+void memop_cpu_copy(void* pdst, const void* psrc, uint32_t len)
+{
+#if defined(__RX__)
+    register void* r1 __asm__("r1") = pdst;
+    register const void* r2 __asm__("r2") = psrc;
+    register uint32_t r3 __asm__("r3") = len;
+    __asm__ volatile("smovf" : "+r"(r1), "+r"(r2), "+r"(r3) : : "memory");
+#else
+    memcpy(pdst, psrc, len);
+#endif
+
+    return;
+}
+
+/**
+ * @brief DMACでメモリ操作を開始する。
+ * @param dst 転送先の先頭
+ * @param src 転送元の先頭(フィルの場合はフィル値のアドレス)
+ * @param dst_stride 転送先の行間隔[byte]
+ * @param src_stride 転送元の行間隔[byte]
+ * @param width 1行のバイト数
+ * @param height 行数
+ * @param is_fill フィルかどうか
+ * @param callback 完了時コールバック
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+static int start_job(uintptr_t dst, uintptr_t src, uint32_t dst_stride, uint32_t src_stride, uint32_t width, uint32_t height,
+                     bool is_fill, void (*callback)(int status))
+{
+    if (s_pregs->DMCNT.BIT.DTE != 0U)
+    {
+        return EBUSY;
+    }
+
+    s_job.src = src;
+    s_job.dst = dst;
+    s_job.src_stride = src_stride;
+    s_job.dst_stride = dst_stride;
+    s_job.width = width;
+    s_job.rows = height;
+    s_job.offset = 0u;
+    s_job.total_bytes = width * height;
+    s_job.is_fill = is_fill;
+    s_job.callback = callback;
+    // 転送単位は、全ての行の開始位置とサイズを割り切れる最大の単位にする。
+    s_job.unit = select_unit(is_fill ? (dst | dst_stride | width) : (dst | src | dst_stride | src_stride | width));
+
+    s_pregs->DMTMD.BIT.SZ = s_job.unit >> 1;
+    s_pregs->DMAMD.WORD = (is_fill ? _0000_DMAC_SRC_ADDR_UPDATE_FIXED : _8000_DMAC_SRC_ADDR_UPDATE_INCREMENT)
+                          | _0080_DMAC_DST_ADDR_UPDATE_INCREMENT;
+    s_is_busy = true;
+    dmac_notify_start(s_channel);
+    start_segment();
+
+    return 0;
+}
+
+/**
+ * @brief 現在の行の残りを、1回のノーマル転送で転送できる分だけ転送開始する。
+ */
+static void start_segment(void)
+{
+    uint32_t units = (s_job.width - s_job.offset) / s_job.unit;
+    if (units > MAX_SEGMENT_UNITS)
+    {
+        units = MAX_SEGMENT_UNITS;
+    }
+    s_job.segment_bytes = units * s_job.unit;
+
+    s_pregs->DMSAR = (void*)((s_job.is_fill) ? s_job.src : (s_job.src + s_job.offset));
+    s_pregs->DMDAR = (void*)(s_job.dst + s_job.offset);
+    s_pregs->DMCRA = units;
+    s_pregs->DMCNT.BIT.DTE = 1U;
+    // 要求を保持したままにして、転送回数分を連続して転送させる。
+    s_pregs->DMREQ.BYTE = _01_DMAC_TRIGGER_SOFTWARE | _10_DMAC_TRIGGER_SOFTWARE_CLEAR_MANUAL;
+
+    return;
+}
+
+/**
+ * @brief アドレス, サイズを割り切れる最大の転送単位を得る。
+ * @param bits アドレス, サイズの論理和
+ * @return 転送単位(1, 2, 4)
+ */
+static uint8_t select_unit(uintptr_t bits)
+{
+    if ((bits & 0x3u) == 0u)
+    {
+        return 4u;
+    }
+    else if ((bits & 0x1u) == 0u)
+    {
+        return 2u;
+    }
+    else
+    {
+        return 1u;
+    }
+}
+
+/**
+ * @brief CPU(SMOVF命令)で矩形領域を1行ずつコピーする。
+ * @param dst 転送先の先頭
+ * @param dst_stride 転送先の行間隔[byte]
+ * @param src 転送元の先頭
+ * @param src_stride 転送元の行間隔[byte]
+ * @param width 1行のバイト数
+ * @param height 行数
+ */
+static void cpu_copy_2d(uintptr_t dst, uint32_t dst_stride, uintptr_t src, uint32_t src_stride, uint32_t width, uint32_t height)
+{
+    for (uint32_t y = 0u; y < height; y++)
+    {
+        memop_cpu_copy((void*)(dst + (y * dst_stride)), (const void*)(src + (y * src_stride)), width);
+    }
+
+    return;
+}
+
+/**
+ * @brief DMAC転送完了の通知を受け取る。(割り込みコンテキスト)
+ *        行の残り, 次の行があれば続けて転送し、全て完了したらコールバックを呼び出す。
+ * @param ch チャネル番号
+ */
+static void on_transfer_end(int ch)
+{
+    s_pregs->DMREQ.BYTE = 0U;
+    if (!s_is_busy) // memop_abort() で中止済み？
+    {
+        return;
+    }
+
+    s_job.offset += s_job.segment_bytes;
+    if (s_job.offset >= s_job.width)
+    {
+        s_job.rows--;
+        s_job.src += s_job.src_stride;
+        s_job.dst += s_job.dst_stride;
+        s_job.offset = 0u;
+    }
+
+    if (s_job.rows > 0u)
+    {
+        start_segment();
+    }
+    else
+    {
+        dmac_notify_end(ch, s_job.total_bytes);
+        s_is_busy = false;
+        if (s_job.callback != NULL)
+        {
+            s_job.callback(0);
+        }
+    }
+
+    return;
+}
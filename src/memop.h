@@ -0,0 +1,24 @@
+/**
+ * @file DMAメモリ操作(フィル/コピー)のインタフェース宣言
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+
+#ifndef MEMOP_H_
+#define MEMOP_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+void memop_init(void);
+int memop_fill(void* pdst, uint8_t value, uint32_t len, void (*callback)(int status));
+int memop_copy(void* pdst, const void* psrc, uint32_t len, void (*callback)(int status));
+int memop_copy_2d(void* pdst, uint32_t dst_stride, const void* psrc, uint32_t src_stride, uint32_t width, uint32_t height,
+                  void (*callback)(int status));
+bool memop_is_busy(void);
+bool memop_wait(uint32_t timeout_millis);
+void memop_abort(void);
+
+void memop_cpu_fill(void* pdst, uint8_t value, uint32_t len);
+void memop_cpu_copy(void* pdst, const void* psrc, uint32_t len);
+
+#endif /* MEMOP_H_ */
@@ -0,0 +1,249 @@
+/**
+ * @file メモリ操作ベンチマーク定義
+ *        libcのmemset/memcpy, RXのストリング命令(SSTR/SMOVF), DMACのフィル/コピーと2次元コピーの速度を比較する。
+ *        キャプチャバッファ(RAM2)の前半を転送先, 後半を転送元として使用するため、
+ *        キャプチャ中, パススルー表示中は実行できない。(キャプチャデータは上書きされる)
+ *        DMACの測定は、開始から完了割り込みでの通知までを測定する。
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+
+#include "hwtick.h"
+#include "pdc.h"
+#include "pdc_passthrough.h"
+#include "memop.h"
+#include "memop_bench.h"
+
+/**
+ * @brief DMACの完了待ちタイムアウト時間[ミリ秒]
+ */
+#define DMA_TIMEOUT_MILLIS (1000)
+
+/**
+ * @brief フィル値
+ */
+#define FILL_VALUE (0xA5)
+
+/**
+ * @brief 2次元コピーの1行のバイト数(行間隔の半分 = 左半分をコピーする)
+ */
+#define COPY_2D_WIDTH (MEMOP_BENCH_2D_STRIDE / 2)
+
+/**
+ * @brief 処理方法
+ */
+enum bench_engine
+{
+    BENCH_ENGINE_LIBC = 0, // libc (memset/memcpy)
+    BENCH_ENGINE_STRING,   // RXストリング命令 (SSTR/SMOVF)
+    BENCH_ENGINE_DMA,      // DMAC
+};
+
+static void measure_fill(struct memop_bench_entry* pentry, enum bench_engine engine, uint8_t* pdst, uint32_t size);
+static void measure_copy(struct memop_bench_entry* pentry, enum bench_engine engine, uint8_t* pdst, uint8_t* psrc, uint32_t size);
+static void measure_copy_2d(struct memop_bench_entry* pentry, enum bench_engine engine, uint8_t* pdst, uint8_t* psrc,
+                            uint32_t height);
+static void fill_source(uint8_t* psrc, uint32_t size);
+static const char* get_engine_name(enum bench_engine engine);
+
+/**
+ * @brief メモリ操作ベンチマークを実行する。
+ *        全ての測定が完了してから戻る。
+ * @param size 測定サイズ[byte] (MEMOP_BENCH_2D_STRIDE 以上, キャプチャバッファの半分以下)
+ * @param presult 測定結果を格納する構造体
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int memop_bench_run(uint32_t size, struct memop_bench_result* presult)
+{
+    if ((size < MEMOP_BENCH_2D_STRIDE) || (size > (pdc_get_capture_buffer_size() / 2u)))
+    {
+        return EINVAL;
+    }
+    if (pdc_is_running() || pdc_passthrough_is_running() || memop_is_busy())
+    {
+        return EBUSY;
+    }
+
+    uint8_t* pdst = (uint8_t*)(pdc_get_capture_slot_buffer(0)); // キャプチャバッファの先頭
+    uint8_t* psrc = pdst + (pdc_get_capture_buffer_size() / 2u);
+
+    memset(presult, 0, sizeof(struct memop_bench_result));
+    presult->size = size;
+    for (int i = 0; i < 3; i++)
+    {
+        enum bench_engine engine = (enum bench_engine)(i);
+        measure_fill(&(presult->entries[i]), engine, pdst, size);
+        measure_copy(&(presult->entries[3 + i]), engine, pdst, psrc, size);
+    }
+    measure_copy_2d(&(presult->entries[6]), BENCH_ENGINE_STRING, pdst, psrc, size / MEMOP_BENCH_2D_STRIDE);
+    measure_copy_2d(&(presult->entries[7]), BENCH_ENGINE_DMA, pdst, psrc, size / MEMOP_BENCH_2D_STRIDE);
+    presult->entry_count = MEMOP_BENCH_ENTRY_COUNT;
+
+    return 0;
+}
+
+/**
+ * @brief フィルを測定する。
+ * @param pentry 測定結果を格納する構造体
+ * @param engine 処理方法
+ * @param pdst 転送先
+ * @param size サイズ[byte]
+ */
+static void measure_fill(struct memop_bench_entry* pentry, enum bench_engine engine, uint8_t* pdst, uint32_t size)
+{
+    memset(pdst, 0, size);
+
+    uint32_t begin = hwtick_get_micros();
+    if (engine == BENCH_ENGINE_LIBC)
+    {
+        memset(pdst, FILL_VALUE, size);
+    }
+    else if (engine == BENCH_ENGINE_STRING)
+    {
+        memop_cpu_fill(pdst, FILL_VALUE, size);
+    }
+    else
+    {
+        memop_fill(pdst, FILL_VALUE, size, NULL);
+        memop_wait(DMA_TIMEOUT_MILLIS);
+    }
+    pentry->micros = hwtick_get_micros() - begin;
+
+    pentry->op = "fill";
+    pentry->engine = get_engine_name(engine);
+    pentry->bytes = size;
+    pentry->is_verified = true;
+    for (uint32_t i = 0u; i < size; i++)
+    {
+        if (pdst[i] != FILL_VALUE)
+        {
+            pentry->is_verified = false;
+            break;
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief コピーを測定する。
+ * @param pentry 測定結果を格納する構造体
+ * @param engine 処理方法
+ * @param pdst 転送先
+ * @param psrc 転送元
+ * @param size サイズ[byte]
+ */
+static void measure_copy(struct memop_bench_entry* pentry, enum bench_engine engine, uint8_t* pdst, uint8_t* psrc, uint32_t size)
+{
+    fill_source(psrc, size);
+    memset(pdst, 0, size);
+
+    uint32_t begin = hwtick_get_micros();
+    if (engine == BENCH_ENGINE_LIBC)
+    {
+        memcpy(pdst, psrc, size);
+    }
+    else if (engine == BENCH_ENGINE_STRING)
+    {
+        memop_cpu_copy(pdst, psrc, size);
+    }
+    else
+    {
+        memop_copy(pdst, psrc, size, NULL);
+        memop_wait(DMA_TIMEOUT_MILLIS);
+    }
+    pentry->micros = hwtick_get_micros() - begin;
+
+    pentry->op = "copy";
+    pentry->engine = get_engine_name(engine);
+    pentry->bytes = size;
+    pentry->is_verified = (memcmp(pdst, psrc, size) == 0);
+
+    return;
+}
+
+/**
+ * @brief 2次元コピーを測定する。
+ *        行間隔 MEMOP_BENCH_2D_STRIDE の領域の各行の左半分を、同じ行間隔の領域にコピーする。
+ * @param pentry 測定結果を格納する構造体
+ * @param engine 処理方法(ストリング命令かDMAC)
+ * @param pdst 転送先
+ * @param psrc 転送元
+ * @param height 行数
+ */
+static void measure_copy_2d(struct memop_bench_entry* pentry, enum bench_engine engine, uint8_t* pdst, uint8_t* psrc,
+                            uint32_t height)
+{
+    uint32_t size = height * MEMOP_BENCH_2D_STRIDE;
+
+    fill_source(psrc, size);
+    memset(pdst, 0, size);
+
+    uint32_t begin = hwtick_get_micros();
+    if (engine == BENCH_ENGINE_DMA)
+    {
+        memop_copy_2d(pdst, MEMOP_BENCH_2D_STRIDE, psrc, MEMOP_BENCH_2D_STRIDE, COPY_2D_WIDTH, height, NULL);
+        memop_wait(DMA_TIMEOUT_MILLIS);
+    }
+    else
+    {
+        for (uint32_t y = 0u; y < height; y++)
+        {
+            memop_cpu_copy(pdst + (y * MEMOP_BENCH_2D_STRIDE), psrc + (y * MEMOP_BENCH_2D_STRIDE), COPY_2D_WIDTH);
+        }
+    }
+    pentry->micros = hwtick_get_micros() - begin;
+
+    pentry->op = "copy-2d";
+    pentry->engine = get_engine_name(engine);
+    pentry->bytes = height * COPY_2D_WIDTH;
+    pentry->is_verified = true;
+    for (uint32_t y = 0u; y < height; y++)
+    {
+        const uint8_t* pdst_line = pdst + (y * MEMOP_BENCH_2D_STRIDE);
+        if ((memcmp(pdst_line, psrc + (y * MEMOP_BENCH_2D_STRIDE), COPY_2D_WIDTH) != 0)
+            || (pdst_line[COPY_2D_WIDTH] != 0u)) // 行の右半分は書き換えられていないこと
+        {
+            pentry->is_verified = false;
+            break;
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief 転送元に位置毎に異なるデータを書き込む。
+ * @param psrc 転送元
+ * @param size サイズ[byte]
+ */
+static void fill_source(uint8_t* psrc, uint32_t size)
+{
+    for (uint32_t i = 0u; i < size; i++)
+    {
+        psrc[i] = (uint8_t)((i ^ (i >> 8)) & 0xFFu);
+    }
+
+    return;
+}
+
+/**
+ * @brief 処理方法の名前を得る。
+ * @param engine 処理方法
+ * @return 名前
+ */
+static const char* get_engine_name(enum bench_engine engine)
+{
+    switch (engine)
+    {
+    case BENCH_ENGINE_LIBC:
+        return "libc";
+    case BENCH_ENGINE_STRING:
+        return "sstr/smovf";
+    case BENCH_ENGINE_DMA:
+    default:
+        return "dmac";
+    }
+}
@@ -0,0 +1,46 @@
+/**
+ * @file メモリ操作ベンチマークのインタフェース宣言
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+
+#ifndef MEMOP_BENCH_H_
+#define MEMOP_BENCH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief 測定項目数
+ */
+#define MEMOP_BENCH_ENTRY_COUNT (8)
+
+/**
+ * @brief 2次元コピーの行間隔[byte] (測定サイズの最小値)
+ */
+#define MEMOP_BENCH_2D_STRIDE (1280)
+
+/**
+ * @brief 1項目の測定結果
+ */
+struct memop_bench_entry
+{
+    const char* op;     // 操作(fill, copy, copy-2d)
+    const char* engine; // 処理方法
+    uint32_t bytes;     // 処理したバイト数
+    uint32_t micros;    // 所要時間[マイクロ秒]
+    bool is_verified;   // 結果が正しかったかどうか
+};
+
+/**
+ * @brief 測定結果
+ */
+struct memop_bench_result
+{
+    struct memop_bench_entry entries[MEMOP_BENCH_ENTRY_COUNT]; // 項目毎の結果
+    int entry_count;                                           // 項目数
+    uint32_t size;                                             // 測定サイズ[byte]
+};
+
+int memop_bench_run(uint32_t size, struct memop_bench_result* presult);
+
+#endif /* MEMOP_BENCH_H_ */
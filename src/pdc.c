@@ -11,6 +11,9 @@
 #include <r_smc_entry.h>
 
 #include "hwtick.h"
+#include "dmac.h"
+#include "memop.h"
+#include "memmap.h"
 #include "rx_driver_pdc.h"
 #include "pdc.h"
 
@@ -37,20 +40,35 @@
 
 
 
-#define RAM2_START_ADDR (0x00800000UL)
-#define RAM2_END_ADDR (0x0087FFFFUL)
-#define RAM2_SIZE (RAM2_END_ADDR + 1UL - RAM2_START_ADDR)
-
 #define DMA_AREA_COUNT (1)
 
-#define RAM_USEAREA1_ADDR (uintptr_t)(RAM2_END_ADDR + 1UL - RAM2_SIZE)
-#define RAM_USEAREA1_SIZE (RAM2_SIZE)
+/**
+ * @brief キャプチャスロットの配置単位[byte]
+ *        スロットをGLCDCのグラフィックスプレーンとして直接表示できるよう、GLCDCの読み出し単位に合わせる。
+ */
+#define CAPTURE_SLOT_ALIGN (64)
 
 /**
  * @brief PDC割り込みプライオリティ
  */
 #define PDC_INTERRUPT_PRIORITY (2)
 
+/**
+ * @brief キャプチャに使用するDMACチャネル(Smart ConfiguratorのConfig_DMAC3)
+ */
+#define PDC_DMAC_CHANNEL (3)
+
+/**
+ * @brief キャプチャ領域のゼロクリア完了待ちタイムアウト時間[ミリ秒]
+ */
+#define PDC_CLEAR_TIMEOUT_MILLIS (100)
+
+/**
+ * @brief ゼロクリア待ちの未受信領域の最大数
+ *        パススルー表示のように、スロットを切り替えながら連続してキャプチャしても溢れない数にする。
+ */
+#define TAIL_FILL_QUEUE_SIZE (4)
+
 /**
  * @brief RXマイコンPDC転送要求が発行されるバイト数
  */
@@ -68,7 +86,17 @@ struct dma_param
     uint16_t block_count; // 必要な領域に合わせて変更
 };
 
+/**
+ * @brief ゼロクリアする未受信領域
+ */
+struct tail_fill
+{
+    uintptr_t addr; // 先頭アドレス
+    uint32_t len;   // サイズ[byte]
+};
+
 static uint32_t calc_dma_area_total_size(const struct dma_param* paramp);
+static uint32_t calc_slot_stride(void);
 static uint32_t calc_received_length(void);
 static bool set_transfer_irqs_enable(bool is_enabled);
 static bool update_transfer_size(uint32_t hsize, uint32_t vsize, uint32_t bpw);
@@ -77,6 +105,14 @@ static void on_dma_request_end(int status);
 static void on_frame_end(const pdc_event_arg_t* arg);
 static void on_error(const pdc_event_arg_t* arg);
 static int convert_pdc_event_to_error(int event, uint32_t errors);
+static void record_tail(uint32_t filled_len);
+static void collect_tail(void);
+static void wait_tail_fill(uintptr_t addr, uint32_t len);
+static void drop_tail_fills(uintptr_t addr, uint32_t len);
+static void abort_tail_fill(void);
+static void process_tail_fills(void);
+static void on_tail_fill_done(int status);
+static void on_frame_captured(const struct pdc_status* pstat);
 
 /**
  * @brief PDC設定
@@ -94,7 +130,7 @@ static uint8_t s_bpp;
 static struct dma_param s_dma_param[DMA_AREA_COUNT] = {
                                                        {
                                                            // RAM1割り当て
-                                                           .addr = RAM_USEAREA1_ADDR,
+                                                           .addr = 0u, // pdc_init()でキャプチャバッファを確保して設定する。
                                                            .unit = RX_PDC_TRANSFER_DATA_SIZE,
                                                            .block_size = (RX_PDC_TRANSFER_REQ_UNIT / RX_PDC_TRANSFER_DATA_SIZE),
                                                            .block_count = 1,
@@ -110,21 +146,94 @@ static int s_dma_area;
  */
 static uint32_t s_data_size;
 
+/**
+ * @brief キャプチャバッファの先頭アドレス
+ */
+static uintptr_t s_capture_buf_addr;
+
+/**
+ * @brief キャプチャバッファのサイズ[byte]
+ */
+static uint32_t s_capture_buf_size;
+
+/**
+ * @brief 選択中のキャプチャスロット番号
+ */
+static int s_capture_slot;
+
 /**
  * @brief フレームキャプチャ完了時コールバック
  */
 static void (*s_end_callback)(const struct pdc_status* pstat);
 
+/**
+ * @brief 直前のキャプチャの未受信領域(キャプチャ完了時に割り込みコンテキストで設定される)
+ */
+static struct tail_fill s_last_tail;
+
+/**
+ * @brief 直前のキャプチャの未受信領域があるかどうか
+ */
+static volatile bool s_has_last_tail;
+
+/**
+ * @brief ゼロクリア待ちの未受信領域
+ */
+static struct tail_fill s_tail_fills[TAIL_FILL_QUEUE_SIZE];
+
+/**
+ * @brief ゼロクリア待ちの未受信領域数
+ */
+static int s_tail_fill_count;
+
+/**
+ * @brief ゼロクリア中の未受信領域
+ */
+static struct tail_fill s_running_fill;
+
+/**
+ * @brief 未受信領域をゼロクリア中かどうか
+ */
+static volatile bool s_is_tail_filling;
+
+/**
+ * @brief pdc_capture_frame() のキャプチャ完了フラグ(割り込みで設定される)
+ */
+static volatile bool s_is_frame_captured;
+
+/**
+ * @brief pdc_capture_frame() のキャプチャ完了時のPDCステータス
+ */
+static struct pdc_status s_captured_status;
+
+/**
+ * @brief PDCを使用中の処理の名前(使用中の処理がない場合はNULL)
+ */
+static const char* s_powner;
+
 /**
  * @brief PDC初期化処理を行う。
+ *        RAM2のアリーナの残り全てをキャプチャバッファとして確保するため、
+ *        RAM2に他のバッファを確保する場合には、この関数より前に確保すること。
+ *        起動時間を短くするため、キャプチャバッファはゼロクリアしない。(キャプチャするまで内容は不定)
+ *        キャプチャが途中で終わった場合は、未受信領域を pdc_update() でバックグラウンドでゼロクリアする。
  */
 void pdc_init(void)
 {
-    for (int i = 0; i < DMA_AREA_COUNT; i++)
+    // RAM2の空き領域全体をキャプチャバッファにする。(スロット数は空き領域に合わせて決まる)
+    s_capture_buf_size = memmap_get_free_size(MEMMAP_REGION_RAM2, CAPTURE_SLOT_ALIGN);
+    void* pbuf = memmap_alloc(MEMMAP_REGION_RAM2, s_capture_buf_size, CAPTURE_SLOT_ALIGN,
+                              MEMMAP_MASTER_CPU | MEMMAP_MASTER_DMAC | MEMMAP_MASTER_GLCDC, "pdc");
+    if (pbuf == NULL)
     {
-        uint32_t len = calc_dma_area_total_size(&s_dma_param[i]);
-        memset((void*)(s_dma_param[0].addr), 0, len);
+        s_capture_buf_size = 0u;
     }
+    s_capture_buf_addr = (uintptr_t)(pbuf);
+    s_dma_param[0].addr = s_capture_buf_addr;
+    s_has_last_tail = false;
+    s_tail_fill_count = 0;
+    s_is_tail_filling = false;
+    s_powner = NULL;
 
     s_bpp = 2; // YUV 4:2:2
 
@@ -154,7 +263,7 @@ void pdc_init(void)
 
     // DMAC設定
     // DAMC3の初期化は CG ドライバがHardwareSetup内で呼ばれて実行されるので、
-    // ここで何かをする必要はない。
+    // ここで何かをする必要はない。(チャネルはDMACチャネル管理の初期化時に予約される)
     // もし、FITドライバを使うなら、ここで設定をする。
 
     s_dma_area = 0;
@@ -173,13 +282,19 @@ void pdc_update(void)
             && !rx_driver_pdc_is_receiving()) // キャプチャ動作していない？
     {
         // リセットがタイムアウト終了
+        R_Config_DMAC3_Stop(); // pdc_stop_capture() と同様に、DMA転送を止めてチャネルの統計を閉じる。
+        dmac_notify_end(PDC_DMAC_CHANNEL, calc_received_length());
+        set_transfer_irqs_enable(false);
         struct pdc_status status;
         pdc_get_status(&status);
         status.has_hsize_err = true;
         status.has_vline_err = true;
+        record_tail(calc_received_length());
         s_end_callback(&status);
         s_end_callback = NULL;
     }
+    collect_tail();
+    process_tail_fills();
 
     return;
 }
@@ -193,6 +308,54 @@ bool pdc_is_running(void)
     return rx_driver_pdc_is_receiving();
 }
 
+/**
+ * @brief PDCを使用する処理として確保する。
+ *        複数フレームに渡ってPDCとキャプチャバッファを使用する処理(パススルー表示, セルフテストなど)は、
+ *        開始時に確保し、終了時に pdc_release() で解放する。
+ * @param owner 処理の名前
+ * @return 確保できた場合にはtrue, 他の処理が使用中またはキャプチャ動作中の場合にはfalse.
+ */
+bool pdc_claim(const char* owner)
+{
+    if ((owner == NULL) || pdc_is_busy())
+    {
+        return false;
+    }
+
+    s_powner = owner;
+
+    return true;
+}
+
+/**
+ * @brief pdc_claim() で確保したPDCを解放する。
+ */
+void pdc_release(void)
+{
+    s_powner = NULL;
+
+    return;
+}
+
+/**
+ * @brief PDCを使用中の処理の名前を得る。
+ * @return 処理の名前(使用中の処理がない場合はNULL)
+ */
+const char* pdc_get_owner(void)
+{
+    return s_powner;
+}
+
+/**
+ * @brief PDCがキャプチャ動作中か、他の処理が確保しているかどうかを得る。
+ *        戻るまでメインループに戻らない処理(pdc read など)は、確保せずに開始前にこの関数で確認する。
+ * @return キャプチャ動作中または確保されている場合にはtrue, それ以外はfalse.
+ */
+bool pdc_is_busy(void)
+{
+    return pdc_is_running() || (s_powner != NULL);
+}
+
 /**
  * @brief PDCをリセットする
  * @param timeout_millis タイムアウト時間[ミリ秒]
@@ -257,6 +420,12 @@ bool pdc_set_capture_range(uint16_t xstart, uint16_t xsize, uint16_t ystart, uin
     {
         return false;
     }
+    // キャプチャ領域に収まるかどうかを調べる。
+    // (PDCの範囲設定後に転送サイズ設定で失敗すると、設定が不整合になるため先に調べる)
+    if ((total == 0) || (total > s_capture_buf_size))
+    {
+        return false;
+    }
     pdc_capture_range_t range;
 
     range.hstart = xstart * bpp;
@@ -329,6 +498,10 @@ bool pdc_start_capture(void (*callback)(const struct pdc_status* pstat))
         return false;
     }
 
+    // ゼロクリア中の領域にキャプチャが書き込まないよう、重なる場合は完了を待つ。
+    collect_tail();
+    wait_tail_fill(s_dma_param[0].addr, s_data_size);
+
     s_dma_area = 0;
     if (!setup_dmac_request(s_dma_area))
     {
@@ -346,6 +519,10 @@ bool pdc_start_capture(void (*callback)(const struct pdc_status* pstat))
     if (is_succeed)
     {
         s_end_callback = callback;
+        dmac_notify_start(PDC_DMAC_CHANNEL);
+        // キャプチャで上書きされる範囲のゼロクリアは不要になる。(途中で終わった場合は改めて未受信領域を登録する)
+        // 開始に失敗した場合は前回のデータが残るため、開始できた後で破棄する。
+        drop_tail_fills(s_dma_param[0].addr, s_data_size);
     }
     else
     {
@@ -362,22 +539,80 @@ bool pdc_stop_capture(void)
 {
     bool is_succeed = true;
 
-    if (rx_driver_pdc_is_resetting())
+    R_Config_DMAC3_Stop(); // DMA転送停止
+    dmac_notify_end(PDC_DMAC_CHANNEL, calc_received_length());
+    if (s_end_callback != NULL) // キャプチャ中？
     {
-        R_Config_DMAC3_Stop(); // DMA転送停止
-        if (rx_driver_pdc_set_receive_enable(false) != 0)
-        {
-            is_succeed = false;
-        }
-        if (!set_transfer_irqs_enable(false)) // 割り込み通知停止
-        {
-            is_succeed = false;
-        }
+        record_tail(calc_received_length());
+    }
+    if (rx_driver_pdc_set_receive_enable(false) != 0)
+    {
+        is_succeed = false;
+    }
+    if (!set_transfer_irqs_enable(false)) // 割り込み通知停止
+    {
+        is_succeed = false;
     }
+    s_end_callback = NULL; // 停止したキャプチャの完了は通知しない。
 
     return is_succeed;
 }
 
+/**
+ * @brief 選択中のスロットに1フレームをキャプチャし、完了するまで待つ。
+ *        タイムアウトした場合, エラーで終了した場合はキャプチャを停止する。
+ *        戻る前に未受信領域のゼロクリアを完了させるため、途中で終わった場合は受信済みサイズ以降が0になる。
+ * @param timeout_millis タイムアウト時間[ミリ秒]
+ * @param pstat キャプチャ終了時のPDCステータスを格納する構造体(不要な場合はNULL)
+ * @return エラーなくフレームエンドまでキャプチャできた場合には0, それ以外はEIOを返す。
+ */
+int pdc_capture_frame(uint32_t timeout_millis, struct pdc_status* pstat)
+{
+    s_is_frame_captured = false;
+    if (!pdc_start_capture(on_frame_captured))
+    {
+        return EIO;
+    }
+    uint32_t begin = hwtick_get();
+    while (!s_is_frame_captured && ((hwtick_get() - begin) < timeout_millis))
+    {
+        pdc_update();
+    }
+    if (pdc_is_running()) // タイムアウトした, またはエラーで終了した。
+    {
+        pdc_stop_capture();
+    }
+    pdc_flush_tail_fills(PDC_CLEAR_TIMEOUT_MILLIS);
+
+    struct pdc_status status;
+    if (s_is_frame_captured)
+    {
+        status = s_captured_status;
+    }
+    else
+    {
+        pdc_get_status(&status);
+    }
+    if (pstat != NULL)
+    {
+        (*pstat) = status;
+    }
+
+    bool is_succeed = s_is_frame_captured && pdc_is_frame_complete(&status);
+
+    return is_succeed ? 0 : EIO;
+}
+
+/**
+ * @brief キャプチャ完了時のステータスが、エラーなくフレームエンドまでキャプチャできたことを表すかどうかを得る。
+ * @param pstat キャプチャ完了時のPDCステータス
+ * @return エラーなくフレームエンドまでキャプチャできた場合にはtrue, それ以外はfalse.
+ */
+bool pdc_is_frame_complete(const struct pdc_status* pstat)
+{
+    return pstat->is_frame_end && !pstat->has_overrun && !pstat->has_underrun && !pstat->has_vline_err && !pstat->has_hsize_err;
+}
+
 /**
  * @brief PDCのステータスを得る
  * @param pstat ステータスを取得する構造体
@@ -405,6 +640,140 @@ bool pdc_get_status(struct pdc_status* pstat)
     return true;
 }
 
+/**
+ * @brief キャプチャバッファを得る。
+ *        キャプチャデータは先頭から、キャプチャ範囲の1ライン分ずつ隙間なく格納される。
+ *        キャプチャ中はDMACが書き込むため、完了してから参照すること。
+ * @return 選択中のキャプチャスロットの先頭アドレス
+ */
+const uint8_t* pdc_get_capture_buffer(void)
+{
+    return (const uint8_t*)(s_dma_param[0].addr);
+}
+
+/**
+ * @brief キャプチャバッファのサイズを得る。
+ * @return キャプチャバッファのサイズ[byte]
+ */
+uint32_t pdc_get_capture_buffer_size(void)
+{
+    return s_capture_buf_size;
+}
+
+/**
+ * @brief キャプチャバッファに確保できるキャプチャスロット数を得る。
+ *        キャプチャバッファを、現在のキャプチャ範囲1フレーム分(CAPTURE_SLOT_ALIGN 単位に切り上げ)ずつに区切ったものをスロットとする。
+ * @return キャプチャスロット数
+ */
+int pdc_get_capture_slot_count(void)
+{
+    uint32_t stride = calc_slot_stride();
+
+    return (stride > 0u) ? (int)(s_capture_buf_size / stride) : 0;
+}
+
+/**
+ * @brief 次のキャプチャで書き込むキャプチャスロットを選択する。
+ *        キャプチャ範囲を変更するとスロット0に戻る。
+ * @param slot スロット番号
+ * @return 成功した場合にはtrue, 失敗した場合にはfalse.
+ */
+bool pdc_select_capture_slot(int slot)
+{
+    if (pdc_is_running() || (slot < 0) || (slot >= pdc_get_capture_slot_count()))
+    {
+        return false;
+    }
+
+    s_capture_slot = slot;
+    s_dma_param[0].addr = s_capture_buf_addr + ((uintptr_t)(slot) * calc_slot_stride());
+
+    return true;
+}
+
+/**
+ * @brief 選択中のキャプチャスロット番号を得る。
+ * @return スロット番号
+ */
+int pdc_get_capture_slot(void)
+{
+    return s_capture_slot;
+}
+
+/**
+ * @brief キャプチャスロットの先頭アドレスを得る。
+ * @param slot スロット番号
+ * @return スロットの先頭アドレス。スロット番号が範囲外の場合にはNULL.
+ */
+const uint8_t* pdc_get_capture_slot_buffer(int slot)
+{
+    if ((slot < 0) || (slot >= pdc_get_capture_slot_count()))
+    {
+        return NULL;
+    }
+
+    return (const uint8_t*)(s_capture_buf_addr + ((uintptr_t)(slot) * calc_slot_stride()));
+}
+
+/**
+ * @brief 未受信領域のゼロクリアを完了させる。
+ *        途中で終わったキャプチャのデータを参照する前に呼び出すと、受信済みサイズ以降が0になる。
+ *        キャプチャ中に呼び出した場合は、それまでに終わったキャプチャの分だけ処理する。
+ *        タイムアウトした場合、ゼロクリア中の領域はDMACを中止してCPUでゼロクリアする。
+ * @param timeout_millis タイムアウト時間[ミリ秒]
+ * @return 完了した場合にはtrue, タイムアウトした場合にはfalse.
+ */
+bool pdc_flush_tail_fills(uint32_t timeout_millis)
+{
+    uint32_t begin = hwtick_get();
+
+    collect_tail();
+    while (s_is_tail_filling || (s_tail_fill_count > 0))
+    {
+        if ((hwtick_get() - begin) >= timeout_millis)
+        {
+            abort_tail_fill();
+            return false;
+        }
+        process_tail_fills();
+    }
+
+    return true;
+}
+
+/**
+ * @brief 指定範囲に重なるゼロクリア待ちの未受信領域を破棄する。ゼロクリア中の領域が重なる場合は完了を待つ。
+ *        キャプチャバッファをキャプチャ以外の出力先に使用する前に呼び出すと、
+ *        後から未受信領域のゼロクリアで出力が上書きされなくなる。(破棄した領域のスロットのデータは不定になる)
+ * @param pdata 先頭
+ * @param len サイズ[byte]
+ */
+void pdc_drop_tail_fills(const void* pdata, uint32_t len)
+{
+    collect_tail();
+    drop_tail_fills((uintptr_t)(pdata), len);
+
+    return;
+}
+
+/**
+ * @brief ゼロクリア待ちの未受信領域があるかどうかを得る。
+ * @return ゼロクリア待ち(ゼロクリア中を含む)の場合にはtrue, それ以外はfalse.
+ */
+bool pdc_has_tail_fills(void)
+{
+    return s_has_last_tail || s_is_tail_filling || (s_tail_fill_count > 0);
+}
+
+/**
+ * @brief キャプチャスロット間隔を得る。
+ * @return スロット間隔[byte]
+ */
+static uint32_t calc_slot_stride(void)
+{
+    return ((s_data_size + CAPTURE_SLOT_ALIGN - 1u) / CAPTURE_SLOT_ALIGN) * CAPTURE_SLOT_ALIGN;
+}
+
 /**
  * @brief parampで指定したDMAリクエストの総転送サイズを取得する。
  * @param paramp DMAリクエストパラメータ
@@ -472,24 +841,21 @@ static bool update_transfer_size(uint32_t hsize, uint32_t vsize, uint32_t bpw)
 {
     uint32_t total = hsize * vsize * bpw;
 
-    if ((total < 1) || (total > (RAM_USEAREA1_SIZE)))
+    if ((total < 1) || (total > s_capture_buf_size))
     {
         return false;
     }
 
-    if (total <= RAM_USEAREA1_SIZE) // サイズは1領域1だけで十分？
-    {
-        s_dma_param[0].block_count = total / RX_PDC_TRANSFER_REQ_UNIT;
-        s_dma_param[1].block_count = 0;
-    }
-    else
-    {
-        s_dma_param[0].block_count = RAM_USEAREA1_SIZE / RX_PDC_TRANSFER_REQ_UNIT;
-        s_dma_param[1].block_count = (total - RAM_USEAREA1_SIZE) / RX_PDC_TRANSFER_REQ_UNIT;
-    }
+    s_dma_param[0].block_count = total / RX_PDC_TRANSFER_REQ_UNIT;
+
+    // スロット配置が変わり、キャプチャ済みのデータも不定になるため、ゼロクリア待ちの未受信領域を破棄する。
+    collect_tail();
+    drop_tail_fills(s_capture_buf_addr, s_capture_buf_size);
 
     s_dma_area = 0;
     s_data_size = total;
+    s_capture_slot = 0; // スロット配置が変わるため、先頭のスロットに戻す。
+    s_dma_param[0].addr = s_capture_buf_addr;
 
     if (!setup_dmac_request(s_dma_area))
     {
@@ -548,6 +914,7 @@ static void on_frame_end(const pdc_event_arg_t* arg)
     R_Config_DMAC3_Stop();
 
     // 残りデータがあったら追加する(たぶん必要だと思う?)
+    uint32_t filled_len = calc_received_length();
     if (PDC.PCSR.BIT.FEMPF == 0) // FIFOはエンプティでない？
     {
         uint32_t *dstp = (uint32_t*)(DMAC3.DMDAR);
@@ -557,8 +924,11 @@ static void on_frame_end(const pdc_event_arg_t* arg)
             // バッファに追加(リニアじゃないと面倒な処理がある？？)
             *dstp = word;
             dstp++;
+            filled_len += sizeof(uint32_t);
         }
     }
+    dmac_notify_end(PDC_DMAC_CHANNEL, filled_len); // FIFOから読み出した分も含める。
+    record_tail(filled_len);
 
     set_transfer_irqs_enable(false);
     if (s_end_callback != NULL)
@@ -585,6 +955,8 @@ static void on_frame_end(const pdc_event_arg_t* arg)
 static void on_error(const pdc_event_arg_t* arg)
 {
     R_Config_DMAC3_Stop();
+    dmac_notify_end(PDC_DMAC_CHANNEL, calc_received_length());
+    record_tail(calc_received_length());
     set_transfer_irqs_enable(false);
     if (s_end_callback != NULL)
     {
@@ -657,3 +1029,163 @@ static int convert_pdc_event_to_error(int event, uint32_t errors)
 
     return retval;
 }
+
+/**
+ * @brief 直前のキャプチャの未受信領域を記録する。
+ *        割り込みコンテキストから呼び出される。記録した領域は collect_tail() でゼロクリア待ちに登録する。
+ * @param filled_len 書き込み済みサイズ[byte]
+ */
+static void record_tail(uint32_t filled_len)
+{
+    if (filled_len >= s_data_size) // 全て受信した？
+    {
+        return;
+    }
+
+    s_last_tail.addr = s_dma_param[0].addr + filled_len;
+    s_last_tail.len = s_data_size - filled_len;
+    s_has_last_tail = true;
+
+    return;
+}
+
+/**
+ * @brief 記録された未受信領域をゼロクリア待ちに登録する。
+ *        キャプチャ中は記録が更新されないため、キャプチャ中でなければ割り込みと競合しない。
+ */
+static void collect_tail(void)
+{
+    if (!s_has_last_tail || pdc_is_running())
+    {
+        return;
+    }
+
+    struct tail_fill tail = s_last_tail;
+    s_has_last_tail = false;
+
+    if (s_tail_fill_count >= TAIL_FILL_QUEUE_SIZE) // 溢れる？
+    {
+        // 待っている余裕がないので、CPUでゼロクリアする。
+        memop_cpu_fill((void*)(tail.addr), 0, tail.len);
+    }
+    else
+    {
+        s_tail_fills[s_tail_fill_count] = tail;
+        s_tail_fill_count++;
+    }
+
+    return;
+}
+
+/**
+ * @brief ゼロクリア中の未受信領域が指定範囲に重なる場合は完了を待つ。
+ *        完了しない(DMACが停止した)場合は、DMACを中止してCPUでゼロクリアする。
+ * @param addr 先頭アドレス
+ * @param len サイズ[byte]
+ */
+static void wait_tail_fill(uintptr_t addr, uint32_t len)
+{
+    if (s_is_tail_filling && (s_running_fill.addr < (addr + len)) && (addr < (s_running_fill.addr + s_running_fill.len)))
+    {
+        if (!memop_wait(PDC_CLEAR_TIMEOUT_MILLIS))
+        {
+            abort_tail_fill();
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief 指定範囲に重なるゼロクリア待ちの未受信領域を破棄する。
+ *        ゼロクリア中の領域が重なる場合は完了を待つ。
+ * @param addr 先頭アドレス
+ * @param len サイズ[byte]
+ */
+static void drop_tail_fills(uintptr_t addr, uint32_t len)
+{
+    int count = 0;
+
+    wait_tail_fill(addr, len);
+    for (int i = 0; i < s_tail_fill_count; i++)
+    {
+        const struct tail_fill* pfill = &(s_tail_fills[i]);
+        if ((pfill->addr >= (addr + len)) || (addr >= (pfill->addr + pfill->len))) // 重ならない？
+        {
+            s_tail_fills[count] = *pfill;
+            count++;
+        }
+    }
+    s_tail_fill_count = count;
+
+    return;
+}
+
+/**
+ * @brief ゼロクリア待ちの未受信領域があれば、DMACでゼロクリアを開始する。
+ *        メモリ操作が使用中の場合は次の呼び出しで開始する。
+ */
+static void process_tail_fills(void)
+{
+    if (s_is_tail_filling || (s_tail_fill_count == 0) || memop_is_busy())
+    {
+        return;
+    }
+
+    s_running_fill = s_tail_fills[0];
+    s_tail_fill_count--;
+    for (int i = 0; i < s_tail_fill_count; i++)
+    {
+        s_tail_fills[i] = s_tail_fills[i + 1];
+    }
+
+    s_is_tail_filling = true;
+    if (memop_fill((void*)(s_running_fill.addr), 0, s_running_fill.len, on_tail_fill_done) != 0)
+    {
+        memop_cpu_fill((void*)(s_running_fill.addr), 0, s_running_fill.len);
+        s_is_tail_filling = false;
+    }
+
+    return;
+}
+
+/**
+ * @brief 完了しないDMACでのゼロクリアを中止し、ゼロクリア中の未受信領域をCPUでゼロクリアする。
+ *        ゼロクリア中でない場合は何もしない。
+ */
+static void abort_tail_fill(void)
+{
+    if (!s_is_tail_filling)
+    {
+        return;
+    }
+
+    memop_abort();
+    memop_cpu_fill((void*)(s_running_fill.addr), 0, s_running_fill.len);
+    s_is_tail_filling = false;
+
+    return;
+}
+
+/**
+ * @brief pdc_capture_frame() のキャプチャ完了通知を受け取る。(割り込みコンテキスト)
+ * @param pstat PDCステータス
+ */
+static void on_frame_captured(const struct pdc_status* pstat)
+{
+    s_captured_status = *pstat;
+    s_is_frame_captured = true;
+
+    return;
+}
+
+/**
+ * @brief 未受信領域のゼロクリア完了通知を受け取る。(割り込みコンテキスト)
+ * @param status 結果
+ */
+static void on_tail_fill_done(int status)
+{
+    s_is_tail_filling = false;
+
+    return;
+}
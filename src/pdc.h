@@ -29,6 +29,10 @@ struct pdc_status
 void pdc_init(void);
 void pdc_update(void);
 bool pdc_is_running(void);
+bool pdc_claim(const char* owner);
+void pdc_release(void);
+const char* pdc_get_owner(void);
+bool pdc_is_busy(void);
 bool pdc_reset(uint16_t timeout_millis);
 bool pdc_set_signal_polarity(bool is_hsync_hactive, bool is_vsync_hactive);
 bool pdc_get_signal_polarity(bool* is_hsync_hactive, bool* is_vsync_hactive);
@@ -36,7 +40,18 @@ bool pdc_set_capture_range(uint16_t xst, uint16_t xsize, uint16_t yst, uint16_t
 bool pdc_get_capture_range(uint16_t* xst, uint16_t* xsize, uint16_t* yst, uint16_t* ysize, uint8_t* bpp);
 bool pdc_start_capture(void (*callback)(const struct pdc_status* pstat));
 bool pdc_stop_capture(void);
+int pdc_capture_frame(uint32_t timeout_millis, struct pdc_status* pstat);
+bool pdc_is_frame_complete(const struct pdc_status* pstat);
 
 bool pdc_get_status(struct pdc_status* pstat);
+const uint8_t* pdc_get_capture_buffer(void);
+uint32_t pdc_get_capture_buffer_size(void);
+int pdc_get_capture_slot_count(void);
+bool pdc_select_capture_slot(int slot);
+int pdc_get_capture_slot(void);
+const uint8_t* pdc_get_capture_slot_buffer(int slot);
+bool pdc_flush_tail_fills(uint32_t timeout_millis);
+bool pdc_has_tail_fills(void);
+void pdc_drop_tail_fills(const void* pdata, uint32_t len);
 
 #endif /* PDC_H_ */
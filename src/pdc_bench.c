@@ -0,0 +1,520 @@
+/**
+ * @file PDCベンチマーク定義
+ *        GLCDCのタイミングプロファイル, キャプチャサイズ, bppの組み合わせを順に切り替えながら
+ *        テスト信号をキャプチャし、PDCのエラー発生状況と受信できたデータ量を条件毎に記録する。
+ *        データの中身は検証しない。(データの検証は selftest pdc で行う)
+ *        処理はpdc_bench_update()で少しずつ進める。
+ *        スイープ中はタイミングプロファイル, テスト信号出力, PDCの同期信号極性とキャプチャ範囲を変更し、終了時に元に戻す。
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+
+#include <platform.h>
+
+#include "hwtick.h"
+#include "pdc.h"
+#include "test_signal.h"
+#include "pdc_bench.h"
+
+/**
+ * @brief PDCの最大ピクセルクロック[Hz] (PCLKB * 0.6)
+ */
+#define PDC_MAX_PIXEL_CLOCK_HZ ((uint32_t)(BSP_PCLKB_HZ) / 10u * 6u)
+
+/**
+ * @brief 1回のキャプチャタイムアウト時間[ミリ秒]
+ *        最も遅いプロファイル(約20fps)でも、VSync待ちを含めて2フレームあれば完了する。
+ */
+#define CAPTURE_TIMEOUT_MILLIS (200)
+
+/**
+ * @brief タイミングプロファイル変更後の待ち時間[ミリ秒]
+ *        GLCDCを再オープンした直後のフレームを避けるため、最も遅いプロファイルで2フレーム分待つ。
+ */
+#define SIGNAL_SETTLE_MILLIS (120)
+
+/**
+ * @brief ベンチマーク状態
+ */
+enum bench_state
+{
+    BENCH_STATE_IDLE = 0,      // 停止中
+    BENCH_STATE_SETUP,         // 条件設定待ち
+    BENCH_STATE_SETTLE,        // テスト信号の設定反映待ち
+    BENCH_STATE_START_CAPTURE, // キャプチャ開始待ち
+    BENCH_STATE_CAPTURING,     // キャプチャ中
+};
+
+/**
+ * @brief スイープ開始前の設定
+ */
+struct saved_settings
+{
+    const struct test_signal_profile* pprofile; // タイミングプロファイル
+    bool is_output;                             // テスト信号出力
+    bool is_hsync_hactive;                      // PDC HSync極性
+    bool is_vsync_hactive;                      // PDC VSync極性
+    uint16_t xst;                               // PDC キャプチャ水平開始位置
+    uint16_t xsize;                             // PDC キャプチャ水平サイズ
+    uint16_t yst;                               // PDC キャプチャ垂直開始位置
+    uint16_t ysize;                             // PDC キャプチャ垂直サイズ
+    uint8_t bpp;                                // PDC 1ピクセルあたりのバイト数
+};
+
+static int build_entries(const struct test_signal_profile* pprofile);
+static void setup_entry(void);
+static bool set_capture_window(struct pdc_bench_entry* pentry);
+static void record_capture(const struct pdc_status* pstat, bool is_timeout);
+static void next_entry(void);
+static void finish_sweep(void);
+static void restore_settings(void);
+static void on_capture_done(const struct pdc_status* pstat);
+
+//@formatter:off
+/**
+ * @brief スイープするキャプチャサイズ(有効表示領域の 1/n)
+ */
+static const uint8_t s_size_divs[PDC_BENCH_SIZE_COUNT] = { 1u, 2u, 4u };
+
+/**
+ * @brief スイープするbpp
+ */
+static const uint8_t s_bpps[PDC_BENCH_BPP_COUNT] = { 1u, 2u };
+//@formatter:on
+
+/**
+ * @brief ベンチマーク状態
+ */
+static enum bench_state s_state;
+
+/**
+ * @brief 条件毎の結果
+ */
+static struct pdc_bench_entry s_entries[PDC_BENCH_MAX_ENTRIES];
+
+/**
+ * @brief スイープ結果
+ */
+static struct pdc_bench_sweep_result s_result;
+
+/**
+ * @brief スイープ開始前の設定
+ */
+static struct saved_settings s_saved;
+
+/**
+ * @brief 実行中の条件番号
+ */
+static int s_entry_index;
+
+/**
+ * @brief スイープ開始時刻[ミリ秒]
+ */
+static uint32_t s_sweep_begin;
+
+/**
+ * @brief キャプチャ開始時刻(設定反映待ち中は待ち開始時刻)[ミリ秒]
+ */
+static uint32_t s_capture_begin;
+
+/**
+ * @brief キャプチャ完了フラグ(割り込みで設定される)
+ */
+static volatile bool s_is_capture_done;
+
+/**
+ * @brief キャプチャ完了時のPDCステータス
+ */
+static struct pdc_status s_capture_status;
+
+/**
+ * @brief スイープ完了時コールバック
+ */
+static void (*s_end_callback)(const struct pdc_bench_sweep_result* presult);
+
+/**
+ * @brief PDCベンチマークを初期化する。
+ */
+void pdc_bench_init(void)
+{
+    s_state = BENCH_STATE_IDLE;
+    s_end_callback = NULL;
+
+    return;
+}
+
+/**
+ * @brief スイープを開始する。
+ * @param count 1条件あたりのキャプチャ回数
+ * @param pprofile スイープするタイミングプロファイル(全プロファイルをスイープする場合にはNULL)
+ * @param callback スイープ完了時に呼び出すコールバック関数(不要な場合にはNULL)
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int pdc_bench_sweep_start(uint32_t count, const struct test_signal_profile* pprofile,
+                          void (*callback)(const struct pdc_bench_sweep_result* presult))
+{
+    if ((count == 0u) || (count > PDC_BENCH_MAX_CAPTURES))
+    {
+        return EINVAL;
+    }
+    if ((s_state != BENCH_STATE_IDLE) || pdc_is_busy())
+    {
+        return EBUSY;
+    }
+
+    int retval = build_entries(pprofile);
+    if (retval != 0)
+    {
+        return retval;
+    }
+
+    s_saved.pprofile = test_signal_get_profile();
+    s_saved.is_output = test_signal_is_output();
+    if (!pdc_get_signal_polarity(&(s_saved.is_hsync_hactive), &(s_saved.is_vsync_hactive))
+        || !pdc_get_capture_range(&(s_saved.xst), &(s_saved.xsize), &(s_saved.yst), &(s_saved.ysize), &(s_saved.bpp)))
+    {
+        return EIO;
+    }
+    if (!test_signal_set_output(true))
+    {
+        restore_settings();
+        return EIO;
+    }
+
+    s_result.entries = s_entries;
+    s_result.count = count;
+    s_result.max_pixel_clock_hz = PDC_MAX_PIXEL_CLOCK_HZ;
+    s_result.elapsed_millis = 0u;
+    s_entry_index = 0;
+    s_end_callback = callback;
+    s_sweep_begin = hwtick_get();
+    pdc_claim("pdc-sweep");
+    s_state = BENCH_STATE_SETUP;
+
+    return 0;
+}
+
+/**
+ * @brief スイープ実行中かどうかを得る。
+ * @return スイープ実行中の場合にはtrue, それ以外はfalse.
+ */
+bool pdc_bench_is_running(void)
+{
+    return (s_state != BENCH_STATE_IDLE) ? true : false;
+}
+
+/**
+ * @brief 条件の結果が合格かどうかを得る。
+ *        全てのキャプチャがエラーなくフレームエンドまで完了した場合に合格とする。
+ * @param pentry 条件の結果
+ * @return 合格の場合にはtrue, それ以外はfalse.
+ */
+bool pdc_bench_is_entry_passed(const struct pdc_bench_entry* pentry)
+{
+    return (pentry->is_configured && (pentry->captures > 0u) && (pentry->completed == pentry->captures)) ? true : false;
+}
+
+/**
+ * @brief PDCベンチマーク処理を更新する。
+ *        メインループから呼び出す。タイミングプロファイルの切り替え時以外は待たずに戻る。
+ */
+void pdc_bench_update(void)
+{
+    switch (s_state)
+    {
+    case BENCH_STATE_SETUP: {
+        setup_entry();
+        break;
+    }
+    case BENCH_STATE_SETTLE: {
+        if ((hwtick_get() - s_capture_begin) >= SIGNAL_SETTLE_MILLIS)
+        {
+            s_state = BENCH_STATE_START_CAPTURE;
+        }
+        break;
+    }
+    case BENCH_STATE_START_CAPTURE: {
+        s_is_capture_done = false;
+        s_capture_begin = hwtick_get();
+        if (pdc_start_capture(on_capture_done))
+        {
+            s_state = BENCH_STATE_CAPTURING;
+        }
+        else
+        {
+            struct pdc_status status;
+            pdc_get_status(&status);
+            record_capture(&status, true);
+        }
+        break;
+    }
+    case BENCH_STATE_CAPTURING: {
+        if (s_is_capture_done)
+        {
+            record_capture(&s_capture_status, false);
+        }
+        else if ((hwtick_get() - s_capture_begin) >= CAPTURE_TIMEOUT_MILLIS)
+        {
+            struct pdc_status status;
+            pdc_get_status(&status);
+            pdc_stop_capture();
+            record_capture(&status, true);
+        }
+        else
+        {
+            // 完了待ち
+        }
+        break;
+    }
+    case BENCH_STATE_IDLE:
+    default: {
+        break;
+    }
+    }
+
+    return;
+}
+
+/**
+ * @brief スイープ条件を作成する。
+ *        タイミングプロファイル毎にまとめて並べ、プロファイルの切り替え回数を少なくする。
+ * @param pprofile スイープするタイミングプロファイル(全プロファイルをスイープする場合にはNULL)
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+static int build_entries(const struct test_signal_profile* pprofile)
+{
+    int profile_count = (pprofile != NULL) ? 1 : test_signal_get_profile_count();
+    if (profile_count > PDC_BENCH_MAX_PROFILES)
+    {
+        return ENOMEM;
+    }
+
+    int index = 0;
+    for (int i = 0; i < profile_count; i++)
+    {
+        const struct test_signal_profile* pprof = (pprofile != NULL) ? pprofile : test_signal_get_profile_at(i);
+        for (int s = 0; s < PDC_BENCH_SIZE_COUNT; s++)
+        {
+            for (int b = 0; b < PDC_BENCH_BPP_COUNT; b++)
+            {
+                struct pdc_bench_entry* pentry = &(s_entries[index]);
+                memset(pentry, 0, sizeof(struct pdc_bench_entry));
+                pentry->pprofile = pprof;
+                pentry->size_div = s_size_divs[s];
+                pentry->bpp = s_bpps[b];
+                index++;
+            }
+        }
+    }
+    s_result.entry_count = index;
+
+    return 0;
+}
+
+/**
+ * @brief 実行中の条件を設定する。
+ *        タイミングプロファイルが変わる場合には、プロファイルを適用して信号が安定するまで待つ。
+ *        設定できなかった条件はキャプチャせずに次の条件に進む。
+ */
+static void setup_entry(void)
+{
+    struct pdc_bench_entry* pentry = &(s_entries[s_entry_index]);
+
+    bool is_profile_changed = (test_signal_get_profile() != pentry->pprofile);
+    if (is_profile_changed && !test_signal_set_profile(pentry->pprofile))
+    {
+        next_entry();
+        return;
+    }
+
+    struct test_signal_timing timing;
+    test_signal_get_timing(&timing);
+    pentry->pixel_clock_hz = timing.pixel_clock_hz;
+    if (!pdc_set_signal_polarity(timing.is_hsync_hactive, timing.is_vsync_hactive) || !set_capture_window(pentry))
+    {
+        next_entry();
+        return;
+    }
+    pentry->is_configured = true;
+
+    if (is_profile_changed)
+    {
+        s_capture_begin = hwtick_get();
+        s_state = BENCH_STATE_SETTLE;
+    }
+    else
+    {
+        s_state = BENCH_STATE_START_CAPTURE;
+    }
+
+    return;
+}
+
+/**
+ * @brief 条件に合わせてPDCのキャプチャ範囲を設定する。
+ *        有効表示領域の中央を、水平/垂直とも 1/size_div のサイズでキャプチャする。
+ *        キャプチャバッファに収まらない場合はライン数を減らし、総転送サイズがPDCの転送単位(32バイト)の倍数になるようにする。
+ * @param pentry 条件
+ * @return 成功した場合にはtrue, 失敗した場合にはfalse.
+ */
+static bool set_capture_window(struct pdc_bench_entry* pentry)
+{
+    struct test_signal_timing timing;
+    test_signal_get_timing(&timing);
+
+    uint32_t line_bytes = ((uint32_t)(timing.hactive) / pentry->size_div) & ~3u;
+    uint32_t lines = (uint32_t)(timing.vactive) / pentry->size_div;
+    if (line_bytes == 0u)
+    {
+        return false;
+    }
+    uint32_t max_lines = pdc_get_capture_buffer_size() / line_bytes;
+    if (lines > max_lines)
+    {
+        lines = max_lines;
+    }
+    while ((lines > 0u) && (((line_bytes * lines) % 32u) != 0u))
+    {
+        lines--;
+    }
+    if (lines == 0u)
+    {
+        return false;
+    }
+
+    // 開始位置はピクセル単位で指定するため、bppの倍数にそろえる。
+    uint32_t hstart = ((uint32_t)(timing.hbp) + (((uint32_t)(timing.hactive) - line_bytes) / 2u)) / pentry->bpp;
+    uint32_t vstart = (uint32_t)(timing.vbp) + (((uint32_t)(timing.vactive) - lines) / 2u);
+    if (!pdc_set_capture_range((uint16_t)(hstart), (uint16_t)(line_bytes / pentry->bpp), (uint16_t)(vstart), (uint16_t)(lines),
+                               pentry->bpp))
+    {
+        return false;
+    }
+
+    pentry->line_bytes = (uint16_t)(line_bytes);
+    pentry->lines = (uint16_t)(lines);
+    pentry->total_len = line_bytes * lines;
+    pentry->min_received_len = pentry->total_len;
+
+    return true;
+}
+
+/**
+ * @brief 1回のキャプチャ結果を記録し、次のキャプチャまたは次の条件に進む。
+ * @param pstat PDCステータス
+ * @param is_timeout タイムアウトまたは開始できなかった場合にはtrue, それ以外はfalse.
+ */
+static void record_capture(const struct pdc_status* pstat, bool is_timeout)
+{
+    struct pdc_bench_entry* pentry = &(s_entries[s_entry_index]);
+
+    pentry->captures++;
+    if (is_timeout)
+    {
+        pentry->timeouts++;
+    }
+    if (pstat->has_overrun)
+    {
+        pentry->overruns++;
+    }
+    if (pstat->has_underrun)
+    {
+        pentry->underruns++;
+    }
+    if (pstat->has_vline_err)
+    {
+        pentry->vline_errors++;
+    }
+    if (pstat->has_hsize_err)
+    {
+        pentry->hsize_errors++;
+    }
+    if (!is_timeout && pdc_is_frame_complete(pstat))
+    {
+        pentry->completed++;
+    }
+    uint32_t received_len = (pstat->received_len < pentry->total_len) ? pstat->received_len : pentry->total_len;
+    if (received_len < pentry->min_received_len)
+    {
+        pentry->min_received_len = received_len;
+    }
+
+    if (pentry->captures < s_result.count)
+    {
+        s_state = BENCH_STATE_START_CAPTURE;
+    }
+    else
+    {
+        next_entry();
+    }
+
+    return;
+}
+
+/**
+ * @brief 次の条件に進む。全条件が終わった場合にはスイープを終了する。
+ */
+static void next_entry(void)
+{
+    s_entry_index++;
+    if (s_entry_index < s_result.entry_count)
+    {
+        s_state = BENCH_STATE_SETUP;
+    }
+    else
+    {
+        finish_sweep();
+    }
+
+    return;
+}
+
+/**
+ * @brief スイープを終了し、結果を通知する。
+ */
+static void finish_sweep(void)
+{
+    restore_settings();
+    s_result.elapsed_millis = hwtick_get() - s_sweep_begin;
+    pdc_release();
+    s_state = BENCH_STATE_IDLE;
+
+    if (s_end_callback != NULL)
+    {
+        void (*callback)(const struct pdc_bench_sweep_result* presult) = s_end_callback;
+        s_end_callback = NULL;
+        callback(&s_result);
+    }
+
+    return;
+}
+
+/**
+ * @brief スイープ開始前の設定に戻す。
+ */
+static void restore_settings(void)
+{
+    if (test_signal_get_profile() != s_saved.pprofile)
+    {
+        test_signal_set_profile(s_saved.pprofile);
+    }
+    test_signal_set_output(s_saved.is_output);
+    pdc_set_signal_polarity(s_saved.is_hsync_hactive, s_saved.is_vsync_hactive);
+    pdc_set_capture_range(s_saved.xst, s_saved.xsize, s_saved.yst, s_saved.ysize, s_saved.bpp);
+
+    return;
+}
+
+/**
+ * @brief キャプチャ完了通知を受け取る。(割り込みコンテキスト)
+ * @param pstat PDCステータス
+ */
+static void on_capture_done(const struct pdc_status* pstat)
+{
+    s_capture_status = *pstat;
+    s_is_capture_done = true;
+
+    return;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file PDCベンチマークのインタフェース宣言
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+
+#ifndef PDC_BENCH_H_
+#define PDC_BENCH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "test_signal.h"
+
+/**
+ * @brief 1条件あたりの最大キャプチャ回数
+ */
+#define PDC_BENCH_MAX_CAPTURES (100)
+
+/**
+ * @brief スイープするキャプチャサイズ数(有効表示領域の 1/1, 1/2, 1/4)
+ */
+#define PDC_BENCH_SIZE_COUNT (3)
+
+/**
+ * @brief スイープするbpp数(1, 2)
+ */
+#define PDC_BENCH_BPP_COUNT (2)
+
+/**
+ * @brief スイープするタイミングプロファイルの最大数
+ */
+#define PDC_BENCH_MAX_PROFILES (8)
+
+/**
+ * @brief スイープ条件の最大数
+ */
+#define PDC_BENCH_MAX_ENTRIES (PDC_BENCH_MAX_PROFILES * PDC_BENCH_SIZE_COUNT * PDC_BENCH_BPP_COUNT)
+
+/**
+ * @brief スイープ1条件の結果
+ */
+struct pdc_bench_entry
+{
+    const struct test_signal_profile* pprofile; // タイミングプロファイル
+    uint32_t pixel_clock_hz;                    // ピクセルクロック[Hz]
+    uint8_t size_div;                           // キャプチャサイズ(有効表示領域の 1/size_div)
+    uint8_t bpp;                                // 1ピクセルあたりのバイト数
+    bool is_configured;                         // キャプチャ範囲を設定できたかどうか
+    uint16_t line_bytes;                        // 1ラインのキャプチャバイト数
+    uint16_t lines;                             // キャプチャライン数
+    uint32_t captures;                          // 試行キャプチャ数
+    uint32_t completed;                         // エラーなくフレームエンドまでキャプチャできた数
+    uint32_t overruns;                          // オーバーラン発生数
+    uint32_t underruns;                         // アンダーラン発生数
+    uint32_t vline_errors;                      // 垂直ラインエラー(VERF)発生数
+    uint32_t hsize_errors;                      // 水平ラインエラー(HERF)発生数
+    uint32_t timeouts;                          // タイムアウト数
+    uint32_t total_len;                         // 1キャプチャの総転送サイズ[byte]
+    uint32_t min_received_len;                  // 最も少なかった受信済みサイズ[byte]
+};
+
+/**
+ * @brief スイープ結果
+ */
+struct pdc_bench_sweep_result
+{
+    const struct pdc_bench_entry* entries; // 条件毎の結果
+    int entry_count;                       // 条件数
+    uint32_t count;                        // 1条件あたりのキャプチャ回数
+    uint32_t max_pixel_clock_hz;           // PDCの最大ピクセルクロック[Hz]
+    uint32_t elapsed_millis;               // 所要時間[ミリ秒]
+};
+
+void pdc_bench_init(void);
+void pdc_bench_update(void);
+int pdc_bench_sweep_start(uint32_t count, const struct test_signal_profile* pprofile,
+                          void (*callback)(const struct pdc_bench_sweep_result* presult));
+bool pdc_bench_is_running(void);
+bool pdc_bench_is_entry_passed(const struct pdc_bench_entry* pentry);
+
+#endif /* PDC_BENCH_H_ */
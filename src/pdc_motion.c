@@ -0,0 +1,323 @@
+/**
+ * @file PDC動き検出定義
+ *        YUYVのフレームをキャプチャし、輝度を4x4ピクセル平均(セル)に縮小して、
+ *        前のフレームのセルと4x4セル(16x16ピクセル)のタイル単位でSAD(輝度差の絶対値の合計)を比較する。
+ *        SADがしきい値を超えたタイルが指定数以上あれば動きありとする。
+ *        比較は縮小したセルだけで行うため、前のフレームはセル(フレームの1/32)だけを保持する。
+ *        キャプチャデータは選択中のキャプチャスロットに上書きする。
+ *
+ *        送信データ(ヘッダ行は呼び出し元が出力する)
+ *          タイルビットマップ((総タイル数 + 7) / 8 バイト。左上からライン順, 各バイトのLSBから)に続けて、
+ *          キャプチャデータそのまま(1フレーム分)
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+
+#include "hwtick.h"
+#include "usb_cdc.h"
+#include "yuv.h"
+#include "pdc.h"
+#include "pdc_motion.h"
+
+/**
+ * @brief 1フレームのキャプチャタイムアウト時間[ミリ秒]
+ */
+#define CAPTURE_TIMEOUT_MILLIS (200)
+
+/**
+ * @brief 送信タイムアウト時間[ミリ秒]
+ */
+#define SEND_TIMEOUT_MILLIS (10000)
+
+static void build_grid(const uint8_t* pbuf);
+static uint32_t get_tile_sad(uint32_t tile, uint32_t* pcells);
+
+/**
+ * @brief 検出中かどうか
+ */
+static bool s_is_running;
+
+/**
+ * @brief 動きとみなすタイルのSAD(1タイル全体のセル数で換算した値)
+ */
+static uint16_t s_threshold;
+
+/**
+ * @brief 動きを通知する変化タイル数
+ */
+static uint32_t s_min_tiles;
+
+/**
+ * @brief 前のフレームのセルがあるかどうか
+ */
+static bool s_has_ref;
+
+/**
+ * @brief キャプチャ範囲の幅[pixel]
+ */
+static uint16_t s_width;
+
+/**
+ * @brief キャプチャ範囲のライン数
+ */
+static uint16_t s_lines;
+
+/**
+ * @brief 水平方向のセル数
+ */
+static uint32_t s_cells_x;
+
+/**
+ * @brief 垂直方向のセル数
+ */
+static uint32_t s_cells_y;
+
+/**
+ * @brief 水平方向のタイル数
+ */
+static uint32_t s_tiles_x;
+
+/**
+ * @brief 総タイル数
+ */
+static uint32_t s_tiles;
+
+/**
+ * @brief セル(キャプチャ中のフレーム, 前のフレーム)
+ */
+static uint8_t s_grids[2][PDC_MOTION_MAX_CELLS];
+
+/**
+ * @brief キャプチャ中のフレームのセルのインデックス(s_grids)
+ */
+static uint32_t s_cur_grid;
+
+/**
+ * @brief タイルビットマップ(SADがしきい値を超えたタイルのビットが1)
+ */
+static uint8_t s_bitmap[(PDC_MOTION_MAX_TILES + 7) / 8];
+
+/**
+ * @brief 動き検出を開始する。
+ *        現在のキャプチャ範囲を使用する。YUYV(bpp=2)で、セル数が PDC_MOTION_MAX_CELLS 以下である必要がある。
+ *        キャプチャ範囲の右端, 下端のセルに満たないピクセルは比較しない。
+ * @param threshold 動きとみなすタイルのSAD(右端, 下端のタイルはセル数に比例して下げる)
+ * @param min_tiles 動きを通知する変化タイル数(1以上)
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int pdc_motion_start(uint16_t threshold, uint32_t min_tiles)
+{
+    uint16_t xst, yst;
+    uint8_t bpp;
+
+    if (min_tiles == 0u)
+    {
+        return EINVAL;
+    }
+    if (s_is_running || pdc_is_busy())
+    {
+        return EBUSY;
+    }
+    if (!pdc_get_capture_range(&xst, &s_width, &yst, &s_lines, &bpp))
+    {
+        return EIO;
+    }
+    if (bpp != 2u)
+    {
+        return EINVAL;
+    }
+    s_cells_x = (uint32_t)(s_width) / PDC_MOTION_CELL_SIZE;
+    s_cells_y = (uint32_t)(s_lines) / PDC_MOTION_CELL_SIZE;
+    if ((s_cells_x == 0u) || (s_cells_y == 0u) || ((s_cells_x * s_cells_y) > PDC_MOTION_MAX_CELLS))
+    {
+        return ERANGE;
+    }
+    s_tiles_x = (s_cells_x + PDC_MOTION_TILE_CELLS - 1u) / PDC_MOTION_TILE_CELLS;
+    s_tiles = s_tiles_x * ((s_cells_y + PDC_MOTION_TILE_CELLS - 1u) / PDC_MOTION_TILE_CELLS);
+
+    s_threshold = threshold;
+    s_min_tiles = min_tiles;
+    s_has_ref = false;
+    s_cur_grid = 0u;
+    pdc_claim("pdc-motion");
+    s_is_running = true;
+
+    return 0;
+}
+
+/**
+ * @brief 1フレームをキャプチャし、前のフレームと比較する。
+ *        動きを検出した場合は、ヘッダを出力してから pdc_motion_send() で送信する。
+ * @param presult 結果を格納する構造体
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ *         キャプチャできなかった場合はEIOを返す。(前のフレームは変わらないため、次のフレームに進める)
+ */
+int pdc_motion_capture(struct pdc_motion_result* presult)
+{
+    memset(presult, 0, sizeof(struct pdc_motion_result));
+    if (!s_is_running)
+    {
+        return EINVAL;
+    }
+    presult->total_tiles = s_tiles;
+    presult->frame_bytes = (uint32_t)(s_width) * 2u * s_lines;
+
+    if (pdc_capture_frame(CAPTURE_TIMEOUT_MILLIS, NULL) != 0)
+    {
+        return EIO;
+    }
+    presult->is_captured = true;
+    uint32_t grid_begin = hwtick_get_micros();
+    build_grid(pdc_get_capture_buffer());
+    presult->grid_micros = hwtick_get_micros() - grid_begin;
+
+    uint32_t compare_begin = hwtick_get_micros();
+    memset(s_bitmap, 0, (s_tiles + 7u) / 8u);
+    if (s_has_ref)
+    {
+        for (uint32_t tile = 0u; tile < s_tiles; tile++)
+        {
+            uint32_t cells;
+            uint32_t sad = get_tile_sad(tile, &cells);
+            presult->max_sad = (sad > presult->max_sad) ? sad : presult->max_sad;
+            // 右端, 下端のタイルは、セル数に比例してしきい値を下げる。
+            if ((sad * (PDC_MOTION_TILE_CELLS * PDC_MOTION_TILE_CELLS)) > ((uint32_t)(s_threshold) * cells))
+            {
+                s_bitmap[tile / 8u] |= (uint8_t)(1u << (tile % 8u));
+                presult->changed_tiles++;
+            }
+        }
+        presult->is_motion = (presult->changed_tiles >= s_min_tiles);
+    }
+    else
+    {
+        memset(s_bitmap, 0xFF, (s_tiles + 7u) / 8u);
+        presult->changed_tiles = s_tiles;
+        presult->is_first = true;
+        presult->is_motion = true;
+    }
+    presult->compare_micros = hwtick_get_micros() - compare_begin;
+
+    // キャプチャしたフレームのセルを、次のフレームの比較対象にする。
+    s_cur_grid ^= 1u;
+    s_has_ref = true;
+
+    return 0;
+}
+
+/**
+ * @brief pdc_motion_capture() で動きを検出したフレームのタイルビットマップとキャプチャデータを送信する。
+ * @param presult pdc_motion_capture() の結果(送信結果を追加する)
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int pdc_motion_send(struct pdc_motion_result* presult)
+{
+    if (!s_is_running || !presult->is_captured)
+    {
+        return EINVAL;
+    }
+
+    uint32_t bitmap_bytes = (s_tiles + 7u) / 8u;
+    presult->sent_bytes = usb_cdc_write_blocking(s_bitmap, bitmap_bytes, SEND_TIMEOUT_MILLIS);
+    if (presult->sent_bytes == bitmap_bytes)
+    {
+        presult->sent_bytes += usb_cdc_write_blocking(pdc_get_capture_buffer(), presult->frame_bytes, SEND_TIMEOUT_MILLIS);
+    }
+
+    return (presult->sent_bytes == (bitmap_bytes + presult->frame_bytes)) ? 0 : EIO;
+}
+
+/**
+ * @brief 動き検出を終了する。
+ */
+void pdc_motion_stop(void)
+{
+    if (s_is_running)
+    {
+        pdc_release();
+        s_is_running = false;
+    }
+
+    return;
+}
+
+/**
+ * @brief 動き検出中かどうかを得る。
+ * @return 検出中の場合にはtrue, それ以外はfalse.
+ */
+bool pdc_motion_is_running(void)
+{
+    return s_is_running;
+}
+
+/**
+ * @brief タイル数を得る。
+ * @param ptiles_x 水平方向のタイル数を格納する変数
+ * @param ptiles_y 垂直方向のタイル数を格納する変数
+ */
+void pdc_motion_get_tiles(uint16_t* ptiles_x, uint16_t* ptiles_y)
+{
+    (*ptiles_x) = (uint16_t)(s_tiles_x);
+    (*ptiles_y) = (uint16_t)((s_tiles_x > 0u) ? (s_tiles / s_tiles_x) : 0u);
+
+    return;
+}
+
+/**
+ * @brief タイルビットマップのサイズを得る。
+ * @return タイルビットマップのサイズ[byte]
+ */
+uint32_t pdc_motion_get_bitmap_size(void)
+{
+    return (s_tiles + 7u) / 8u;
+}
+
+/**
+ * @brief キャプチャしたフレームの輝度をセルに縮小する。
+ * @param pbuf キャプチャデータ
+ */
+static void build_grid(const uint8_t* pbuf)
+{
+    uint32_t line_bytes = (uint32_t)(s_width) * 2u;
+    uint8_t* pgrid = s_grids[s_cur_grid];
+
+    for (uint32_t row = 0u; row < s_cells_y; row++)
+    {
+        yuv_bin_y_line(pgrid + (row * s_cells_x), pbuf + (row * PDC_MOTION_CELL_SIZE * line_bytes), line_bytes,
+                       (uint16_t)(s_cells_x * PDC_MOTION_CELL_SIZE), PDC_MOTION_CELL_SIZE);
+    }
+
+    return;
+}
+
+/**
+ * @brief キャプチャしたフレームと前のフレームの、タイル内のセルのSADを求める。
+ * @param tile タイル番号(左上からライン順)
+ * @param pcells タイル内のセル数を格納する変数
+ * @return SAD
+ */
+static uint32_t get_tile_sad(uint32_t tile, uint32_t* pcells)
+{
+    uint32_t cx = (tile % s_tiles_x) * PDC_MOTION_TILE_CELLS;
+    uint32_t cy = (tile / s_tiles_x) * PDC_MOTION_TILE_CELLS;
+    uint32_t width = ((cx + PDC_MOTION_TILE_CELLS) <= s_cells_x) ? PDC_MOTION_TILE_CELLS : (s_cells_x - cx);
+    uint32_t height = ((cy + PDC_MOTION_TILE_CELLS) <= s_cells_y) ? PDC_MOTION_TILE_CELLS : (s_cells_y - cy);
+    const uint8_t* pcur = s_grids[s_cur_grid] + (cy * s_cells_x) + cx;
+    const uint8_t* pref = s_grids[s_cur_grid ^ 1u] + (cy * s_cells_x) + cx;
+    uint32_t sad = 0u;
+
+    for (uint32_t y = 0u; y < height; y++)
+    {
+        for (uint32_t x = 0u; x < width; x++)
+        {
+            sad += (pcur[x] > pref[x]) ? (uint32_t)(pcur[x] - pref[x]) : (uint32_t)(pref[x] - pcur[x]);
+        }
+        pcur += s_cells_x;
+        pref += s_cells_x;
+    }
+    (*pcells) = width * height;
+
+    return sad;
+}
@@ -0,0 +1,68 @@
+/**
+ * @file PDC動き検出のインタフェース宣言
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+
+#ifndef PDC_MOTION_H_
+#define PDC_MOTION_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief 縮小率(1セルのピクセル数, 幅, 高さとも)
+ */
+#define PDC_MOTION_CELL_SIZE (4)
+
+/**
+ * @brief タイルの大きさ[セル] (幅, 高さとも)
+ */
+#define PDC_MOTION_TILE_CELLS (4)
+
+/**
+ * @brief 最大セル数(VGAで 160x120 セル)
+ */
+#define PDC_MOTION_MAX_CELLS (19200)
+
+/**
+ * @brief 最大タイル数
+ */
+#define PDC_MOTION_MAX_TILES (PDC_MOTION_MAX_CELLS / (PDC_MOTION_TILE_CELLS * PDC_MOTION_TILE_CELLS))
+
+/**
+ * @brief 動きとみなすタイルのSAD(輝度差の絶対値の合計)の初期値
+ *        (1タイル16セルで、平均8以上の輝度変化)
+ */
+#define PDC_MOTION_DEFAULT_THRESHOLD (128)
+
+/**
+ * @brief 動きを通知する変化タイル数の初期値
+ */
+#define PDC_MOTION_DEFAULT_MIN_TILES (1)
+
+/**
+ * @brief 1フレームの検出結果
+ */
+struct pdc_motion_result
+{
+    bool is_captured;        // エラーなくフレームエンドまでキャプチャできたかどうか
+    bool is_first;           // 比較するフレームがなかったかどうか
+    bool is_motion;          // 動きを検出したかどうか(最初のフレームは常にtrue)
+    uint32_t changed_tiles;  // SADがしきい値を超えたタイル数
+    uint32_t total_tiles;    // 総タイル数
+    uint32_t max_sad;        // タイルのSADの最大値
+    uint32_t frame_bytes;    // 1フレームのサイズ[byte]
+    uint32_t sent_bytes;     // 送信したサイズ[byte]
+    uint32_t grid_micros;    // 輝度の縮小に要した時間[マイクロ秒]
+    uint32_t compare_micros; // タイル比較に要した時間[マイクロ秒]
+};
+
+int pdc_motion_start(uint16_t threshold, uint32_t min_tiles);
+int pdc_motion_capture(struct pdc_motion_result* presult);
+int pdc_motion_send(struct pdc_motion_result* presult);
+void pdc_motion_stop(void);
+bool pdc_motion_is_running(void);
+void pdc_motion_get_tiles(uint16_t* ptiles_x, uint16_t* ptiles_y);
+uint32_t pdc_motion_get_bitmap_size(void);
+
+#endif /* PDC_MOTION_H_ */
@@ -0,0 +1,435 @@
+/**
+ * @file PDCキャプチャのパススルー表示定義
+ *        キャプチャバッファを2つのスロットに分け、PDCが一方のスロットに書き込む間、
+ *        もう一方のキャプチャ済みスロットをGLCDCのGR2(スタンプ用グラフィックスプレーン)で表示する。
+ *        キャプチャが完了する毎に表示するスロットを切り替える。切り替えはVSyncで反映されるため、
+ *        切り替え前に表示していたスロットへのキャプチャは、反映されるまで開始しない。
+ *        キャプチャデータはコピーせず、RAM2上のスロットをそのまま表示する。
+ *        (GLCDCの読み出しとDMACの書き込みが同時にRAM2へアクセスする)
+ *        ループバック接続では表示した画像を再度キャプチャすることになる。
+ *        RGB565表示の場合は、キャプチャ完了後にスロット上のYUYVをRGB565に変換してから表示する。
+ *        変換はメインループを止めないよう、1回の更新で CONVERT_LINES_PER_UPDATE ラインずつ行う。
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+
+#include "hwtick.h"
+#include "pdc.h"
+#include "test_signal.h"
+#include "yuv.h"
+#include "pdc_passthrough.h"
+
+/**
+ * @brief 使用するキャプチャスロット数
+ */
+#define SLOT_COUNT (2)
+
+/**
+ * @brief 1ラインのバイト数の単位(GLCDCのラインオフセットの単位)
+ */
+#define LINE_BYTES_ALIGN (64)
+
+/**
+ * @brief 1フレームのキャプチャタイムアウト時間[ミリ秒]
+ */
+#define CAPTURE_TIMEOUT_MILLIS (200)
+
+/**
+ * @brief 表示スロットがないことを表すスロット番号
+ */
+#define NO_SLOT (-1)
+
+/**
+ * @brief 1回の更新でRGB565に変換するライン数
+ */
+#define CONVERT_LINES_PER_UPDATE (16)
+
+/**
+ * @brief パススルー状態
+ */
+enum passthrough_state
+{
+    PASSTHROUGH_STATE_IDLE = 0,      // 停止中
+    PASSTHROUGH_STATE_START_CAPTURE, // キャプチャ開始待ち
+    PASSTHROUGH_STATE_CAPTURING,     // キャプチャ中
+    PASSTHROUGH_STATE_CONVERT,       // RGB565への変換中
+    PASSTHROUGH_STATE_SWAP,          // 表示スロットの切り替え待ち
+};
+
+static void start_capture(void);
+static void process_capture_done(void);
+static void convert_lines(void);
+static void swap_slot(void);
+static void on_capture_done(const struct pdc_status* pstat);
+
+/**
+ * @brief パススルー状態
+ */
+static enum passthrough_state s_state;
+
+/**
+ * @brief 統計
+ */
+static struct pdc_passthrough_stats s_stats;
+
+/**
+ * @brief 開始前のテスト信号出力設定
+ */
+static bool s_saved_output;
+
+/**
+ * @brief キャプチャする(キャプチャ中の)スロット番号
+ */
+static int s_capture_slot;
+
+/**
+ * @brief 表示中(切り替え要求済み)のスロット番号
+ */
+static int s_display_slot;
+
+/**
+ * @brief 1ラインのバイト数
+ */
+static uint16_t s_line_bytes;
+
+/**
+ * @brief ライン数
+ */
+static uint16_t s_lines;
+
+/**
+ * @brief RGB565で表示するかどうか
+ */
+static bool s_is_rgb565;
+
+/**
+ * @brief 次に変換するライン番号
+ */
+static uint16_t s_convert_line;
+
+/**
+ * @brief 開始時刻[ミリ秒]
+ */
+static uint32_t s_begin;
+
+/**
+ * @brief キャプチャ開始時刻[ミリ秒]
+ */
+static uint32_t s_capture_begin;
+
+/**
+ * @brief キャプチャ開始を切り替え反映待ちで待っているかどうか
+ */
+static bool s_is_waiting_swap;
+
+/**
+ * @brief キャプチャ完了フラグ(割り込みで設定される)
+ */
+static volatile bool s_is_capture_done;
+
+/**
+ * @brief キャプチャ完了時のPDCステータス
+ */
+static struct pdc_status s_capture_status;
+
+/**
+ * @brief パススルー表示を初期化する。
+ */
+void pdc_passthrough_init(void)
+{
+    s_state = PASSTHROUGH_STATE_IDLE;
+    memset(&s_stats, 0, sizeof(s_stats));
+
+    return;
+}
+
+/**
+ * @brief パススルー表示を開始する。
+ *        現在のPDCキャプチャ範囲を使用する。キャプチャ範囲の1ラインのバイト数は64の倍数で、
+ *        キャプチャバッファに2フレーム分入る必要がある。
+ *        RGB565で表示する場合は、キャプチャデータがYUYV(bpp=2)である必要がある。
+ * @param is_rgb565 YUYVをRGB565に変換して表示する場合はtrue, 1バイトを1ピクセルのグレースケールで表示する場合はfalse.
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int pdc_passthrough_start(bool is_rgb565)
+{
+    if ((s_state != PASSTHROUGH_STATE_IDLE) || pdc_is_busy() || test_signal_is_preview())
+    {
+        return EBUSY;
+    }
+
+    uint16_t xst, xsize, yst, ysize;
+    uint8_t bpp;
+    if (!pdc_get_capture_range(&xst, &xsize, &yst, &ysize, &bpp))
+    {
+        return EIO;
+    }
+    if (is_rgb565 && (bpp != 2u))
+    {
+        return EINVAL;
+    }
+    uint32_t line_bytes = (uint32_t)(xsize) * bpp;
+    if ((line_bytes == 0u) || ((line_bytes % LINE_BYTES_ALIGN) != 0u) || (line_bytes > UINT16_MAX))
+    {
+        return ERANGE;
+    }
+    if (pdc_get_capture_slot_count() < SLOT_COUNT)
+    {
+        return ENOMEM;
+    }
+
+    s_saved_output = test_signal_is_output();
+    if (!test_signal_set_output(true))
+    {
+        test_signal_set_output(s_saved_output);
+        return EIO;
+    }
+
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_line_bytes = (uint16_t)(line_bytes);
+    s_lines = ysize;
+    s_is_rgb565 = is_rgb565;
+    s_capture_slot = 0;
+    s_display_slot = NO_SLOT;
+    s_is_waiting_swap = false;
+    s_begin = hwtick_get();
+    pdc_claim("passthrough");
+    s_state = PASSTHROUGH_STATE_START_CAPTURE;
+
+    return 0;
+}
+
+/**
+ * @brief パススルー表示を停止する。
+ *        GR2をフレーム番号(スタンプ)出力に、テスト信号出力を開始前の設定に戻す。
+ */
+void pdc_passthrough_stop(void)
+{
+    if (s_state == PASSTHROUGH_STATE_IDLE)
+    {
+        return;
+    }
+
+    if (s_state == PASSTHROUGH_STATE_CAPTURING)
+    {
+        pdc_stop_capture();
+    }
+    s_stats.elapsed_millis = hwtick_get() - s_begin;
+    test_signal_stop_preview();
+    test_signal_set_output(s_saved_output);
+    pdc_select_capture_slot(0);
+    pdc_release();
+    s_state = PASSTHROUGH_STATE_IDLE;
+
+    return;
+}
+
+/**
+ * @brief パススルー表示中かどうかを得る。
+ * @return パススルー表示中の場合にはtrue, それ以外はfalse.
+ */
+bool pdc_passthrough_is_running(void)
+{
+    return (s_state != PASSTHROUGH_STATE_IDLE) ? true : false;
+}
+
+/**
+ * @brief パススルー表示の統計を得る。
+ * @param pstats 統計を格納する構造体
+ */
+void pdc_passthrough_get_stats(struct pdc_passthrough_stats* pstats)
+{
+    (*pstats) = s_stats;
+    if (s_state != PASSTHROUGH_STATE_IDLE)
+    {
+        pstats->elapsed_millis = hwtick_get() - s_begin;
+    }
+
+    return;
+}
+
+/**
+ * @brief パススルー表示処理を更新する。
+ *        メインループから呼び出す。1回の呼び出しでは待たずに戻る。
+ */
+void pdc_passthrough_update(void)
+{
+    switch (s_state)
+    {
+    case PASSTHROUGH_STATE_START_CAPTURE: {
+        start_capture();
+        break;
+    }
+    case PASSTHROUGH_STATE_CAPTURING: {
+        if (s_is_capture_done)
+        {
+            process_capture_done();
+        }
+        else if ((hwtick_get() - s_capture_begin) >= CAPTURE_TIMEOUT_MILLIS)
+        {
+            pdc_stop_capture();
+            s_stats.capture_errors++;
+            s_state = PASSTHROUGH_STATE_START_CAPTURE;
+        }
+        else
+        {
+            // 完了待ち
+        }
+        break;
+    }
+    case PASSTHROUGH_STATE_CONVERT: {
+        convert_lines();
+        break;
+    }
+    case PASSTHROUGH_STATE_SWAP: {
+        swap_slot();
+        break;
+    }
+    case PASSTHROUGH_STATE_IDLE:
+    default: {
+        break;
+    }
+    }
+
+    return;
+}
+
+/**
+ * @brief キャプチャを開始する。
+ *        表示スロットの切り替えが反映されるまでは、切り替え前のスロットが表示されているため開始しない。
+ */
+static void start_capture(void)
+{
+    if (test_signal_is_preview_pending())
+    {
+        if (!s_is_waiting_swap)
+        {
+            s_is_waiting_swap = true;
+            s_stats.swap_waits++;
+        }
+        return;
+    }
+    s_is_waiting_swap = false;
+
+    s_is_capture_done = false;
+    s_capture_begin = hwtick_get();
+    if (pdc_select_capture_slot(s_capture_slot) && pdc_start_capture(on_capture_done))
+    {
+        s_state = PASSTHROUGH_STATE_CAPTURING;
+    }
+    else
+    {
+        s_stats.capture_errors++;
+    }
+
+    return;
+}
+
+/**
+ * @brief キャプチャ完了時の処理を行う。
+ *        エラーなくフレームエンドまでキャプチャできた場合だけ表示スロットを切り替える。
+ *        RGB565表示の場合は、切り替える前に変換を開始する。
+ *        エラーの場合は同じスロットに再度キャプチャする。
+ */
+static void process_capture_done(void)
+{
+    const struct pdc_status* pstat = &s_capture_status;
+
+    if (pdc_is_frame_complete(pstat))
+    {
+        s_stats.captured_frames++;
+        if (s_is_rgb565)
+        {
+            s_convert_line = 0u;
+            s_state = PASSTHROUGH_STATE_CONVERT;
+            convert_lines();
+        }
+        else
+        {
+            s_state = PASSTHROUGH_STATE_SWAP;
+            swap_slot();
+        }
+    }
+    else
+    {
+        s_stats.capture_errors++;
+        s_state = PASSTHROUGH_STATE_START_CAPTURE;
+    }
+
+    return;
+}
+
+/**
+ * @brief キャプチャしたスロットのYUYVを、CONVERT_LINES_PER_UPDATE ラインだけRGB565に変換する。
+ *        全ラインを変換し終えたら表示スロットを切り替える。
+ */
+static void convert_lines(void)
+{
+    uint8_t* pslot = (uint8_t*)(pdc_get_capture_slot_buffer(s_capture_slot));
+    uint16_t lines = s_lines - s_convert_line;
+    lines = (lines > CONVERT_LINES_PER_UPDATE) ? CONVERT_LINES_PER_UPDATE : lines;
+    uint8_t* pline = pslot + ((uint32_t)(s_convert_line) * s_line_bytes);
+    uint32_t len = (uint32_t)(lines) * s_line_bytes;
+
+    uint32_t begin = hwtick_get_micros();
+    yuv_to_rgb565(pline, pline, len);
+    s_stats.convert_micros += hwtick_get_micros() - begin;
+    s_stats.convert_pixels += len / 2u;
+
+    s_convert_line += lines;
+    if (s_convert_line >= s_lines)
+    {
+        s_state = PASSTHROUGH_STATE_SWAP;
+        swap_slot();
+    }
+
+    return;
+}
+
+/**
+ * @brief キャプチャしたスロットを表示し、次のキャプチャを切り替え前の表示スロットに行う。
+ *        前回の切り替えが反映されていない場合には、次回の更新で再度切り替える。
+ *        最初のフレームではGR2をプレビュー表示に切り替える。
+ */
+static void swap_slot(void)
+{
+    const uint8_t* pslot = pdc_get_capture_slot_buffer(s_capture_slot);
+
+    if (s_display_slot == NO_SLOT)
+    {
+        if (!test_signal_start_preview(pslot, s_line_bytes, s_lines, s_is_rgb565))
+        {
+            pdc_passthrough_stop();
+            return;
+        }
+    }
+    else if (!test_signal_show_preview(pslot))
+    {
+        return; // 切り替え要求を受け付けられなかった。
+    }
+    else
+    {
+        // 次のVSyncで切り替わる。
+    }
+
+    s_stats.swaps++;
+    s_display_slot = s_capture_slot;
+    s_capture_slot = (s_capture_slot + 1) % SLOT_COUNT;
+    s_state = PASSTHROUGH_STATE_START_CAPTURE;
+
+    return;
+}
+
+/**
+ * @brief キャプチャ完了通知を受け取る。(割り込みコンテキスト)
+ * @param pstat PDCステータス
+ */
+static void on_capture_done(const struct pdc_status* pstat)
+{
+    s_capture_status = *pstat;
+    s_is_capture_done = true;
+
+    return;
+}
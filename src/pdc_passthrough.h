@@ -0,0 +1,33 @@
+/**
+ * @file PDCキャプチャのパススルー表示のインタフェース宣言
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+
+#ifndef PDC_PASSTHROUGH_H_
+#define PDC_PASSTHROUGH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief パススルー表示の統計
+ */
+struct pdc_passthrough_stats
+{
+    uint32_t captured_frames; // エラーなくキャプチャできたフレーム数
+    uint32_t capture_errors;  // キャプチャできなかったフレーム数(エラー, タイムアウト)
+    uint32_t swaps;           // 表示バッファを切り替えた回数
+    uint32_t swap_waits;      // 表示バッファの切り替え反映待ちでキャプチャ開始を待った回数
+    uint32_t elapsed_millis;  // 開始からの経過時間[ミリ秒]
+    uint64_t convert_pixels;  // RGB565に変換したピクセル数
+    uint32_t convert_micros;  // RGB565への変換に要した時間の合計[マイクロ秒]
+};
+
+void pdc_passthrough_init(void);
+void pdc_passthrough_update(void);
+int pdc_passthrough_start(bool is_rgb565);
+void pdc_passthrough_stop(void);
+bool pdc_passthrough_is_running(void);
+void pdc_passthrough_get_stats(struct pdc_passthrough_stats* pstats);
+
+#endif /* PDC_PASSTHROUGH_H_ */
@@ -0,0 +1,356 @@
+/**
+ * @file PDCフレームシーケンスチェック定義
+ *        テスト信号の先頭ラインにフレーム番号(スタンプ)を出力し、PDCで連続してキャプチャしたフレームの
+ *        フレーム番号から、フレームの欠落/重複/順序の入れ替わりを検出する。
+ *        キャプチャは1フレームずつ再開するため、再開がブランキング期間内に間に合わない場合には
+ *        フレームが飛ばされる。(飛ばされたフレーム数として数える)
+ *        DMAが先頭ラインを書き込まなかった場合には、前回のデータが残るため重複として検出される。
+ *        チェック中はフレーム番号出力, テスト信号出力を変更し、終了時に元に戻す。
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+
+#include "hwtick.h"
+#include "pdc.h"
+#include "test_signal.h"
+#include "pdc_seq.h"
+
+/**
+ * @brief 1フレームのキャプチャタイムアウト時間[ミリ秒]
+ *        最も遅いタイミングプロファイル(約20fps)でも、VSync待ちを含めて2フレームあれば完了する。
+ */
+#define CAPTURE_TIMEOUT_MILLIS (200)
+
+/**
+ * @brief フレーム番号出力の設定変更が反映されるまでの待ち時間[ミリ秒]
+ *        GLCDCのレイヤー設定は次のVSyncで反映されるため、最も遅いプロファイルで2フレーム分待つ。
+ */
+#define SIGNAL_SETTLE_MILLIS (120)
+
+/**
+ * @brief チェック状態
+ */
+enum seq_state
+{
+    SEQ_STATE_IDLE = 0,      // 停止中
+    SEQ_STATE_SETTLE,        // テスト信号の設定反映待ち
+    SEQ_STATE_START_CAPTURE, // キャプチャ開始待ち
+    SEQ_STATE_CAPTURING,     // キャプチャ中
+};
+
+static void process_capture_done(void);
+static void check_stamp(void);
+static void next_frame(void);
+static void finish_check(void);
+static void restore_settings(void);
+static void on_capture_done(const struct pdc_status* pstat);
+
+/**
+ * @brief チェック状態
+ */
+static enum seq_state s_state;
+
+/**
+ * @brief チェック結果
+ */
+static struct pdc_seq_result s_result;
+
+/**
+ * @brief 開始前のフレーム番号出力設定
+ */
+static bool s_saved_stamp_enabled;
+
+/**
+ * @brief 開始前のテスト信号出力設定
+ */
+static bool s_saved_output;
+
+/**
+ * @brief キャプチャ中のフレーム番号(試行回数)
+ */
+static uint32_t s_frame_index;
+
+/**
+ * @brief チェック開始時刻[ミリ秒]
+ */
+static uint32_t s_check_begin;
+
+/**
+ * @brief キャプチャ開始時刻(設定反映待ち中は待ち開始時刻)[ミリ秒]
+ */
+static uint32_t s_capture_begin;
+
+/**
+ * @brief キャプチャ完了フラグ(割り込みで設定される)
+ */
+static volatile bool s_is_capture_done;
+
+/**
+ * @brief キャプチャ完了時のPDCステータス
+ */
+static struct pdc_status s_capture_status;
+
+/**
+ * @brief チェック完了時コールバック
+ */
+static void (*s_end_callback)(const struct pdc_seq_result* presult);
+
+/**
+ * @brief フレームシーケンスチェックを初期化する。
+ */
+void pdc_seq_init(void)
+{
+    s_state = SEQ_STATE_IDLE;
+    s_end_callback = NULL;
+
+    return;
+}
+
+/**
+ * @brief フレームシーケンスチェックを開始する。
+ *        現在のPDCキャプチャ範囲を使用する。キャプチャ範囲は有効表示領域の先頭ライン, 先頭位置から
+ *        始まっている必要がある。
+ * @param frames キャプチャするフレーム数
+ * @param callback チェック完了時に呼び出すコールバック関数(不要な場合にはNULL)
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int pdc_seq_start(uint32_t frames, void (*callback)(const struct pdc_seq_result* presult))
+{
+    if ((frames == 0u) || (frames > PDC_SEQ_MAX_FRAMES))
+    {
+        return EINVAL;
+    }
+    if ((s_state != SEQ_STATE_IDLE) || pdc_is_busy())
+    {
+        return EBUSY;
+    }
+
+    uint16_t xst, xsize, yst, ysize;
+    uint8_t bpp;
+    if (!pdc_get_capture_range(&xst, &xsize, &yst, &ysize, &bpp))
+    {
+        return EIO;
+    }
+    struct test_signal_timing timing;
+    test_signal_get_timing(&timing);
+    if ((((uint32_t)(xst) * bpp) != timing.hbp) || (yst != timing.vbp) || (((uint32_t)(xsize) * bpp) < TEST_SIGNAL_STAMP_BYTES))
+    {
+        return ERANGE;
+    }
+
+    s_saved_stamp_enabled = test_signal_is_stamp_enabled();
+    s_saved_output = test_signal_is_output();
+    if (!test_signal_set_stamp(true) || !test_signal_set_output(true))
+    {
+        restore_settings();
+        return EIO;
+    }
+
+    memset(&s_result, 0, sizeof(s_result));
+    s_result.frames = frames;
+    s_frame_index = 0u;
+    s_end_callback = callback;
+    s_check_begin = hwtick_get();
+    s_capture_begin = s_check_begin;
+    pdc_claim("pdc-seq");
+    s_state = SEQ_STATE_SETTLE;
+
+    return 0;
+}
+
+/**
+ * @brief チェック実行中かどうかを得る。
+ * @return チェック実行中の場合にはtrue, それ以外はfalse.
+ */
+bool pdc_seq_is_running(void)
+{
+    return (s_state != SEQ_STATE_IDLE) ? true : false;
+}
+
+/**
+ * @brief フレームシーケンスチェック処理を更新する。
+ *        メインループから呼び出す。1回の呼び出しでは待たずに戻る。
+ */
+void pdc_seq_update(void)
+{
+    switch (s_state)
+    {
+    case SEQ_STATE_SETTLE: {
+        if ((hwtick_get() - s_capture_begin) >= SIGNAL_SETTLE_MILLIS)
+        {
+            s_state = SEQ_STATE_START_CAPTURE;
+        }
+        break;
+    }
+    case SEQ_STATE_START_CAPTURE: {
+        s_is_capture_done = false;
+        s_capture_begin = hwtick_get();
+        if (pdc_start_capture(on_capture_done))
+        {
+            s_state = SEQ_STATE_CAPTURING;
+        }
+        else
+        {
+            s_result.capture_errors++;
+            next_frame();
+        }
+        break;
+    }
+    case SEQ_STATE_CAPTURING: {
+        if (s_is_capture_done)
+        {
+            process_capture_done();
+        }
+        else if ((hwtick_get() - s_capture_begin) >= CAPTURE_TIMEOUT_MILLIS)
+        {
+            pdc_stop_capture();
+            s_result.capture_errors++;
+            next_frame();
+        }
+        else
+        {
+            // 完了待ち
+        }
+        break;
+    }
+    case SEQ_STATE_IDLE:
+    default: {
+        break;
+    }
+    }
+
+    return;
+}
+
+/**
+ * @brief キャプチャ完了時の処理を行う。
+ *        エラーなくフレームエンドまでキャプチャできた場合だけフレーム番号を調べる。
+ */
+static void process_capture_done(void)
+{
+    const struct pdc_status* pstat = &s_capture_status;
+
+    if (pdc_is_frame_complete(pstat))
+    {
+        s_result.captured_frames++;
+        check_stamp();
+    }
+    else
+    {
+        s_result.capture_errors++;
+    }
+    next_frame();
+
+    return;
+}
+
+/**
+ * @brief キャプチャしたフレームのフレーム番号を前回のフレーム番号と比較する。
+ */
+static void check_stamp(void)
+{
+    uint32_t seq;
+
+    if (!test_signal_decode_stamp(pdc_get_capture_buffer(), TEST_SIGNAL_STAMP_BYTES, &seq))
+    {
+        s_result.bad_stamps++;
+        return;
+    }
+
+    if (!s_result.has_seq)
+    {
+        s_result.has_seq = true;
+        s_result.first_seq = seq;
+    }
+    else
+    {
+        // フレーム番号は32bitで一周するため、差分を符号付きで扱う。
+        int32_t gap = (int32_t)(seq - s_result.last_seq);
+        if (gap == 1)
+        {
+            s_result.sequential++;
+        }
+        else if (gap > 1)
+        {
+            s_result.skipped_frames += (uint32_t)(gap - 1);
+        }
+        else if (gap == 0)
+        {
+            s_result.duplicates++;
+        }
+        else
+        {
+            s_result.out_of_order++;
+        }
+        if ((gap > 0) && ((uint32_t)(gap) > s_result.max_gap))
+        {
+            s_result.max_gap = (uint32_t)(gap);
+        }
+    }
+    s_result.last_seq = seq;
+
+    return;
+}
+
+/**
+ * @brief 次のフレームに進む。指定フレーム数に達した場合にはチェックを終了する。
+ */
+static void next_frame(void)
+{
+    s_frame_index++;
+    if (s_frame_index < s_result.frames)
+    {
+        s_state = SEQ_STATE_START_CAPTURE;
+    }
+    else
+    {
+        finish_check();
+    }
+
+    return;
+}
+
+/**
+ * @brief チェックを終了し、結果を通知する。
+ */
+static void finish_check(void)
+{
+    s_result.elapsed_millis = hwtick_get() - s_check_begin;
+    restore_settings();
+    pdc_release();
+    s_state = SEQ_STATE_IDLE;
+
+    if (s_end_callback != NULL)
+    {
+        void (*callback)(const struct pdc_seq_result* presult) = s_end_callback;
+        s_end_callback = NULL;
+        callback(&s_result);
+    }
+
+    return;
+}
+
+/**
+ * @brief チェック開始前の設定に戻す。
+ */
+static void restore_settings(void)
+{
+    test_signal_set_stamp(s_saved_stamp_enabled);
+    test_signal_set_output(s_saved_output);
+
+    return;
+}
+
+/**
+ * @brief キャプチャ完了通知を受け取る。(割り込みコンテキスト)
+ * @param pstat PDCステータス
+ */
+static void on_capture_done(const struct pdc_status* pstat)
+{
+    s_capture_status = *pstat;
+    s_is_capture_done = true;
+
+    return;
+}
@@ -0,0 +1,42 @@
+/**
+ * @file PDCフレームシーケンスチェックのインタフェース宣言
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+
+#ifndef PDC_SEQ_H_
+#define PDC_SEQ_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief シーケンスチェックの最大フレーム数
+ */
+#define PDC_SEQ_MAX_FRAMES (10000)
+
+/**
+ * @brief シーケンスチェック結果
+ */
+struct pdc_seq_result
+{
+    uint32_t frames;          // 試行フレーム数
+    uint32_t captured_frames; // エラーなくキャプチャできたフレーム数
+    uint32_t capture_errors;  // キャプチャできなかったフレーム数(エラー, タイムアウト)
+    uint32_t bad_stamps;      // フレーム番号を読み取れなかったフレーム数
+    uint32_t sequential;      // 前回のフレーム番号+1だったフレーム数
+    uint32_t skipped_frames;  // 前回のキャプチャから飛ばされたフレーム数の合計
+    uint32_t duplicates;      // 前回と同じフレーム番号だったフレーム数
+    uint32_t out_of_order;    // 前回より前のフレーム番号だったフレーム数
+    uint32_t max_gap;         // フレーム番号の最大増分
+    bool has_seq;             // フレーム番号を1回以上読み取れたかどうか
+    uint32_t first_seq;       // 最初に読み取ったフレーム番号
+    uint32_t last_seq;        // 最後に読み取ったフレーム番号
+    uint32_t elapsed_millis;  // 所要時間[ミリ秒]
+};
+
+void pdc_seq_init(void);
+void pdc_seq_update(void);
+int pdc_seq_start(uint32_t frames, void (*callback)(const struct pdc_seq_result* presult));
+bool pdc_seq_is_running(void);
+
+#endif /* PDC_SEQ_H_ */
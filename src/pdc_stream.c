@@ -0,0 +1,1091 @@
+/**
+ * @file PDCキャプチャデータ送信定義
+ *        1フレームをキャプチャしながら、DMAが書き込み終えた部分(ストライプ)から順にUSB CDCで送信する。
+ *        輝度(Y)だけを送信する場合は、ストライプ毎にキャプチャバッファ上でその場で変換するため、
+ *        送信後のキャプチャバッファの前半には輝度だけが残る。
+ *        縮小して送信する場合は、縮小率分のラインが揃う毎に、キャプチャバッファの先頭側に縮小したラインを書き込む。
+ *        RGB565で送信する場合は、ストライプ毎にキャプチャバッファ上でその場で変換する。
+ *        RGB888で送信する場合は、サイズが大きくなるため、ストライプ毎にストライプバッファに変換し、送信し終えてから次を変換する。
+ *        圧縮して送信する場合は、圧縮後のサイズをヘッダで通知するため、1フレーム分圧縮し終えてから送信する。
+ *        (delta はライン毎, jpeg は8ライン毎に、受信済みの部分からキャプチャと並行して圧縮する)
+ *        キャプチャが途中で終わった場合は、未受信領域を0として送信する。(送信サイズは常に一定)
+ *        YUYVの場合は、受信済みの部分から統計情報を集計し、ROIのラインが揃った部分から合焦評価値を計算する。
+ *        送信が完了するまで呼び出し元をブロックする。
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+
+#include "hwtick.h"
+#include "usb_cdc.h"
+#include "yuv.h"
+#include "frame_codec.h"
+#include "jpeg_enc.h"
+#include "pdc.h"
+#include "pdc_stream.h"
+
+/**
+ * @brief 変換/送信の単位(ストライプ)[byte]
+ *        PDCのDMA転送要求単位(32byte)と変換単位(8byte)の倍数にする。
+ */
+#define STRIPE_BYTES (1024u)
+
+/**
+ * @brief キャプチャのタイムアウト時間[ミリ秒]
+ *        最も遅いタイミングプロファイル(約20fps)でも、VSync待ちを含めて2フレームあれば完了する。
+ */
+#define CAPTURE_TIMEOUT_MILLIS (200)
+
+/**
+ * @brief 送信のタイムアウト時間[ミリ秒]
+ */
+#define SEND_TIMEOUT_MILLIS (10000)
+
+/**
+ * @brief 未受信領域のゼロクリア完了待ちタイムアウト時間[ミリ秒]
+ */
+#define TAIL_FILL_TIMEOUT_MILLIS (100)
+
+/**
+ * @brief usb_cdc_write() に1回で渡す最大サイズ[byte]
+ */
+#define MAX_WRITE_BYTES (0xFFFFu)
+
+static bool get_layout(uint16_t* pwidth, uint16_t* plines, uint8_t* pbpp);
+static uint8_t get_bin_factor(enum pdc_stream_format format);
+static uint32_t process_stripes(enum pdc_stream_format format, uint8_t* pbuf, uint32_t received, uint32_t* pprocessed);
+static int encode_lines(enum pdc_stream_format format, const uint8_t* pbuf, uint32_t line, uint32_t line_bytes, uint8_t bpp,
+                        uint8_t* penc, uint32_t enc_size);
+static void begin_stats(uint8_t bpp);
+static void update_stats(const uint8_t* pbuf, uint32_t received, bool is_done, struct pdc_stream_result* presult);
+static bool get_focus_area(uint16_t width, uint16_t lines, struct pdc_stream_roi* parea);
+static bool fit_roi(const struct pdc_stream_roi* proi, uint16_t width, uint16_t lines, struct pdc_stream_roi* parea);
+static void begin_focus(bool is_enabled, uint16_t width, uint16_t lines, uint8_t bpp);
+static void update_focus(const uint8_t* pbuf, uint32_t received, bool is_done, struct pdc_stream_result* presult);
+static uint32_t poll_capture(uint32_t total, uint32_t begin, struct pdc_stream_result* presult, bool* pis_done);
+static void send_ready(const uint8_t* pdata, uint32_t ready, struct pdc_stream_result* presult);
+static void send_rgb888(const uint8_t* pbuf, uint32_t received, uint32_t total, uint32_t* pprocessed,
+                        struct pdc_stream_result* presult);
+static void finish_capture(void);
+static void on_capture_done(const struct pdc_status* pstat);
+
+/**
+ * @brief フォーマット名
+ */
+//@formatter:off
+static const char* const s_format_names[] = {
+    "raw",
+    "y",
+    "bin2",
+    "bin4",
+    "delta",
+    "jpeg",
+    "rgb565",
+    "rgb888",
+};
+//@formatter:on
+
+/**
+ * @brief 圧縮データ
+ */
+static const uint8_t* s_pencoded;
+
+/**
+ * @brief 圧縮データのサイズ[byte]
+ */
+static uint32_t s_encoded_size;
+
+/**
+ * @brief JPEGの品質
+ */
+static uint8_t s_jpeg_quality = PDC_STREAM_DEFAULT_JPEG_QUALITY;
+
+/**
+ * @brief RGB888のストライプバッファ(1ストライプ分の変換結果)
+ */
+static uint32_t s_rgb_stripe[(STRIPE_BYTES / 2u * 3u) / sizeof(uint32_t)];
+
+/**
+ * @brief RGB888のストライプバッファに変換したサイズ[byte]
+ */
+static uint32_t s_rgb_stripe_len;
+
+/**
+ * @brief 直前にキャプチャしたフレームの統計情報
+ */
+static struct yuv_stats s_stats;
+
+/**
+ * @brief 統計情報を集計するかどうか(YUYVの場合だけ集計する)
+ */
+static bool s_is_stats_enabled;
+
+/**
+ * @brief 統計情報に加えたサイズ[byte]
+ */
+static uint32_t s_stats_pos;
+
+/**
+ * @brief 統計情報が1フレーム分揃っているかどうか
+ */
+static bool s_is_stats_valid;
+
+/**
+ * @brief 合焦評価の対象領域(s_is_focus_roi_center が false の場合に使用する)
+ */
+static struct pdc_stream_roi s_focus_roi;
+
+/**
+ * @brief 合焦評価の対象領域をキャプチャ範囲の中央(幅, 高さとも1/2)にするかどうか
+ */
+static bool s_is_focus_roi_center = true;
+
+/**
+ * @brief 直前にキャプチャしたフレームの合焦評価値
+ */
+static struct yuv_focus s_focus;
+
+/**
+ * @brief 合焦評価値を計算するかどうか
+ */
+static bool s_is_focus_enabled;
+
+/**
+ * @brief 合焦評価値が揃っているかどうか
+ */
+static bool s_is_focus_valid;
+
+/**
+ * @brief 今回のキャプチャで合焦評価する領域
+ */
+static struct pdc_stream_roi s_focus_area;
+
+/**
+ * @brief 次に合焦評価値に加えるライン
+ */
+static uint32_t s_focus_line;
+
+/**
+ * @brief 1ラインのバイト数
+ */
+static uint32_t s_focus_line_bytes;
+
+/**
+ * @brief フレーム完了時コールバック
+ */
+static void (*s_frame_callback)(const struct yuv_stats* pstats);
+
+/**
+ * @brief キャプチャ完了フラグ(割り込みで設定される)
+ */
+static volatile bool s_is_capture_done;
+
+/**
+ * @brief キャプチャ完了時のPDCステータス
+ */
+static struct pdc_status s_capture_status;
+
+/**
+ * @brief フォーマット名からフォーマットを得る。
+ * @param name フォーマット名
+ * @param pformat フォーマットを格納する変数
+ * @return 見つかった場合にはtrue, それ以外はfalse.
+ */
+bool pdc_stream_find_format(const char* name, enum pdc_stream_format* pformat)
+{
+    for (int i = 0; i < (int)(sizeof(s_format_names) / sizeof(s_format_names[0])); i++)
+    {
+        if (strcmp(name, s_format_names[i]) == 0)
+        {
+            (*pformat) = (enum pdc_stream_format)(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief フォーマット名を得る。
+ * @param format フォーマット
+ * @return フォーマット名
+ */
+const char* pdc_stream_get_format_name(enum pdc_stream_format format)
+{
+    return ((format >= 0) && (format < (int)(sizeof(s_format_names) / sizeof(s_format_names[0])))) ? s_format_names[format]
+                                                                                                    : "?";
+}
+
+/**
+ * @brief 現在のキャプチャ範囲で送信される画像のサイズを得る。
+ *        raw, y, delta, jpeg の場合はキャプチャ範囲のサイズになる。
+ * @param format フォーマット
+ * @param pwidth 幅[pixel]を格納する変数
+ * @param pheight 高さ[line]を格納する変数
+ * @return 成功した場合にはtrue, フォーマットがキャプチャ範囲に合わない場合はfalse.
+ */
+bool pdc_stream_get_output_dimension(enum pdc_stream_format format, uint16_t* pwidth, uint16_t* pheight)
+{
+    uint16_t width, lines;
+    uint8_t bpp;
+
+    if (!get_layout(&width, &lines, &bpp))
+    {
+        return false;
+    }
+
+    uint8_t factor = get_bin_factor(format);
+    if ((format == PDC_STREAM_FORMAT_RAW) || (format == PDC_STREAM_FORMAT_DELTA))
+    {
+        // そのまま
+    }
+    else if (bpp != 2u) // YUYVでない？
+    {
+        return false;
+    }
+    else if (format == PDC_STREAM_FORMAT_JPEG)
+    {
+        if (((width % JPEG_ENC_MCU_WIDTH) != 0u) || ((lines % JPEG_ENC_MCU_HEIGHT) != 0u))
+        {
+            return false;
+        }
+    }
+    else if (factor > 1u)
+    {
+        if (((width % (2u * factor)) != 0u) || (lines < factor))
+        {
+            return false;
+        }
+        width = (uint16_t)(width / factor);
+        lines = (uint16_t)(lines / factor); // 縮小率に満たない最後のラインは捨てる。
+    }
+    else
+    {
+        // 輝度だけ, RGBでもピクセル数は同じ
+    }
+    (*pwidth) = width;
+    (*pheight) = lines;
+
+    return true;
+}
+
+/**
+ * @brief 現在のキャプチャ範囲で送信されるサイズを得る。
+ * @param format フォーマット
+ * @return 送信サイズ[byte]。フォーマットがキャプチャ範囲に合わない場合, 圧縮する場合は0.
+ */
+uint32_t pdc_stream_get_output_size(enum pdc_stream_format format)
+{
+    uint16_t width, lines, out_width, out_lines;
+    uint8_t bpp;
+
+    if (!get_layout(&width, &lines, &bpp) || !pdc_stream_get_output_dimension(format, &out_width, &out_lines))
+    {
+        return 0u;
+    }
+
+    if ((format == PDC_STREAM_FORMAT_DELTA) || (format == PDC_STREAM_FORMAT_JPEG)) // 圧縮後のサイズは圧縮するまで分からない。
+    {
+        return 0u;
+    }
+    uint32_t out_bpp;
+    if (format == PDC_STREAM_FORMAT_RAW)
+    {
+        out_bpp = bpp;
+    }
+    else if (format == PDC_STREAM_FORMAT_Y)
+    {
+        out_bpp = 1u;
+    }
+    else if (format == PDC_STREAM_FORMAT_RGB888)
+    {
+        out_bpp = 3u;
+    }
+    else
+    {
+        out_bpp = 2u;
+    }
+    return (uint32_t)(out_width) * out_bpp * out_lines;
+}
+
+/**
+ * @brief 1フレームをキャプチャし、キャプチャしながらUSB CDCで送信する。
+ *        送信サイズは pdc_stream_get_output_size() で得られるサイズになる。
+ *        選択中のキャプチャスロットを使用する。
+ * @param format 送信フォーマット
+ * @param presult 結果を格納する構造体
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ *         キャプチャエラーの場合も送信は行い、0を返す。(presult->is_captured で判別する)
+ */
+int pdc_stream_read(enum pdc_stream_format format, struct pdc_stream_result* presult)
+{
+    memset(presult, 0, sizeof(struct pdc_stream_result));
+    presult->format = format;
+
+    uint32_t out_size = pdc_stream_get_output_size(format);
+    if (out_size == 0u)
+    {
+        return EINVAL;
+    }
+    if (pdc_is_busy())
+    {
+        return EBUSY;
+    }
+    if (!usb_cdc_get_DSR())
+    {
+        return EIO;
+    }
+
+    // 変換はキャプチャバッファ上で行う。
+    uint8_t* pbuf = (uint8_t*)(pdc_get_capture_buffer());
+    uint16_t width, lines;
+    uint8_t bpp;
+    get_layout(&width, &lines, &bpp);
+    uint32_t total = (uint32_t)(width) * bpp * lines;
+
+    presult->total_len = total;
+    begin_stats(bpp);
+    begin_focus(format == PDC_STREAM_FORMAT_RAW, width, lines, bpp); // y, bin2, bin4 は変換で上のラインを上書きする。
+
+    s_is_capture_done = false;
+    uint32_t begin = hwtick_get();
+    if (!pdc_start_capture(on_capture_done))
+    {
+        return EIO;
+    }
+
+    uint32_t received = 0u;  // 書き込み済みのサイズ
+    uint32_t processed = 0u; // 変換済みの入力サイズ
+    uint32_t ready = 0u;     // 送信できる出力サイズ
+    bool is_capture_done = false;
+    int retval = 0;
+    s_rgb_stripe_len = 0u;
+    while (presult->sent_bytes < out_size)
+    {
+        pdc_update();
+        if (!is_capture_done)
+        {
+            received = poll_capture(total, begin, presult, &is_capture_done);
+            update_stats(pbuf, received, is_capture_done, presult); // 変換前のデータで集計する。
+            update_focus(pbuf, received, is_capture_done, presult);
+            if (format != PDC_STREAM_FORMAT_RGB888)
+            {
+                uint32_t convert_begin = hwtick_get_micros();
+                ready = process_stripes(format, pbuf, received, &processed);
+                presult->convert_micros += hwtick_get_micros() - convert_begin;
+            }
+        }
+
+        if (format == PDC_STREAM_FORMAT_RGB888)
+        {
+            send_rgb888(pbuf, received, total, &processed, presult);
+        }
+        else
+        {
+            send_ready(pbuf, ready, presult);
+        }
+        if (!usb_cdc_get_DSR() || ((hwtick_get() - begin) >= SEND_TIMEOUT_MILLIS))
+        {
+            retval = EIO;
+            break;
+        }
+    }
+    if (!is_capture_done)
+    {
+        pdc_stop_capture();
+    }
+    presult->elapsed_millis = hwtick_get() - begin;
+
+    return retval;
+}
+
+/**
+ * @brief JPEGの品質を設定する。
+ * @param quality 品質(1〜100)
+ * @return 成功した場合にはtrue, 範囲外の場合はfalse.
+ */
+bool pdc_stream_set_jpeg_quality(uint8_t quality)
+{
+    if ((quality < JPEG_ENC_MIN_QUALITY) || (quality > JPEG_ENC_MAX_QUALITY))
+    {
+        return false;
+    }
+    s_jpeg_quality = quality;
+
+    return true;
+}
+
+/**
+ * @brief JPEGの品質を得る。
+ * @return 品質
+ */
+uint8_t pdc_stream_get_jpeg_quality(void)
+{
+    return s_jpeg_quality;
+}
+
+/**
+ * @brief 1フレームをキャプチャしながら圧縮する。
+ *        delta はライン毎, jpeg は8ライン(MCUストライプ)毎に、受信済みの部分から圧縮する。
+ *        圧縮データは、キャプチャバッファの選択中のスロットのキャプチャデータより後ろ(バッファの末尾まで)に書き込む。
+ *        そのため、選択中のスロットより後ろのスロットのキャプチャデータは上書きされる。(前のスロットは変更しない)
+ *        上書きする範囲のゼロクリア待ちの未受信領域は、圧縮データを消さないよう開始前に破棄する。
+ *        圧縮が完了したら、ヘッダを送信してから pdc_stream_send_encoded() で送信する。
+ *        選択中のキャプチャスロットを使用する。
+ * @param format 圧縮フォーマット(delta, jpeg)
+ * @param presult 結果を格納する構造体
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ *         キャプチャエラーの場合も圧縮は行い、0を返す。(presult->is_captured で判別する)
+ */
+int pdc_stream_encode(enum pdc_stream_format format, struct pdc_stream_result* presult)
+{
+    uint16_t width, lines;
+    uint8_t bpp;
+
+    memset(presult, 0, sizeof(struct pdc_stream_result));
+    presult->format = format;
+    s_encoded_size = 0u;
+
+    if (((format != PDC_STREAM_FORMAT_DELTA) && (format != PDC_STREAM_FORMAT_JPEG))
+        || !pdc_stream_get_output_dimension(format, &width, &lines))
+    {
+        return EINVAL;
+    }
+    if (pdc_is_busy())
+    {
+        return EBUSY;
+    }
+
+    get_layout(&width, &lines, &bpp);
+    uint8_t* pbuf = (uint8_t*)(pdc_get_capture_buffer());
+    uint32_t line_bytes = (uint32_t)(width) * bpp;
+    uint32_t total = line_bytes * lines;
+    uintptr_t buf_end = (uintptr_t)(pdc_get_capture_slot_buffer(0)) + pdc_get_capture_buffer_size();
+    uint8_t* penc = pbuf + total;
+    uint32_t enc_size = (buf_end > (uintptr_t)(penc)) ? (uint32_t)(buf_end - (uintptr_t)(penc)) : 0u;
+    pdc_drop_tail_fills(penc, enc_size);
+    uint32_t unit; // 1回に圧縮するライン数
+    int retval;
+    if (format == PDC_STREAM_FORMAT_JPEG)
+    {
+        unit = JPEG_ENC_MCU_HEIGHT;
+        retval = jpeg_enc_begin(penc, enc_size, width, lines, s_jpeg_quality);
+    }
+    else
+    {
+        unit = 1u;
+        retval = (enc_size >= FRAME_CODEC_MAX_LINE_SIZE(line_bytes)) ? 0 : ENOSPC;
+    }
+    if (retval != 0)
+    {
+        return retval;
+    }
+    presult->total_len = total;
+    begin_stats(bpp);
+    begin_focus(true, width, lines, bpp);
+
+    s_is_capture_done = false;
+    uint32_t begin = hwtick_get();
+    if (!pdc_start_capture(on_capture_done))
+    {
+        if (format == PDC_STREAM_FORMAT_JPEG)
+        {
+            jpeg_enc_end(&s_encoded_size);
+        }
+        return EIO;
+    }
+
+    uint32_t line = 0u;
+    bool is_capture_done = false;
+    while ((retval == 0) && (line < lines))
+    {
+        pdc_update();
+        uint32_t received = poll_capture(total, begin, presult, &is_capture_done);
+        update_stats(pbuf, received, is_capture_done, presult);
+        update_focus(pbuf, received, is_capture_done, presult);
+        while ((retval == 0) && ((line + unit) <= (received / line_bytes)))
+        {
+            uint32_t encode_begin = hwtick_get_micros();
+            retval = encode_lines(format, pbuf, line, line_bytes, bpp, penc, enc_size);
+            presult->encode_micros += hwtick_get_micros() - encode_begin;
+            line += unit;
+        }
+    }
+    if (!is_capture_done)
+    {
+        pdc_stop_capture();
+    }
+    if (format == PDC_STREAM_FORMAT_JPEG)
+    {
+        uint32_t encode_begin = hwtick_get_micros();
+        int end_retval = jpeg_enc_end(&s_encoded_size);
+        presult->encode_micros += hwtick_get_micros() - encode_begin;
+        retval = (retval != 0) ? retval : end_retval;
+    }
+    if (retval != 0)
+    {
+        s_encoded_size = 0u;
+        return retval;
+    }
+    s_pencoded = penc;
+    presult->encoded_bytes = s_encoded_size;
+    presult->elapsed_millis = hwtick_get() - begin;
+
+    return 0;
+}
+
+/**
+ * @brief 1フレームをキャプチャしながら統計情報を集計し、合焦評価値を計算する。(送信しない)
+ *        DMAが書き込み終えた部分から順に集計する。YUYV(bpp=2)の場合だけ使用できる。
+ *        選択中のキャプチャスロットを使用する。
+ * @param presult 結果を格納する構造体
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ *         キャプチャエラーの場合も受信済みの部分で集計し、0を返す。(presult->is_captured で判別する)
+ */
+int pdc_stream_measure(struct pdc_stream_result* presult)
+{
+    uint16_t width, lines;
+    uint8_t bpp;
+
+    memset(presult, 0, sizeof(struct pdc_stream_result));
+    presult->format = PDC_STREAM_FORMAT_RAW;
+
+    if (!get_layout(&width, &lines, &bpp) || (bpp != 2u))
+    {
+        return EINVAL;
+    }
+    if (pdc_is_busy())
+    {
+        return EBUSY;
+    }
+
+    const uint8_t* pbuf = pdc_get_capture_buffer();
+    uint32_t total = (uint32_t)(width) * bpp * lines;
+    presult->total_len = total;
+    begin_stats(bpp);
+    begin_focus(true, width, lines, bpp);
+
+    s_is_capture_done = false;
+    uint32_t begin = hwtick_get();
+    if (!pdc_start_capture(on_capture_done))
+    {
+        return EIO;
+    }
+    bool is_capture_done = false;
+    while (!is_capture_done)
+    {
+        pdc_update();
+        uint32_t received = poll_capture(total, begin, presult, &is_capture_done);
+        update_stats(pbuf, received, is_capture_done, presult);
+        update_focus(pbuf, received, is_capture_done, presult);
+    }
+    presult->elapsed_millis = hwtick_get() - begin;
+
+    return 0;
+}
+
+/**
+ * @brief 直前にキャプチャしたフレームの統計情報を得る。
+ *        pdc_stream_read(), pdc_stream_encode(), pdc_stream_measure() でYUYVをキャプチャした場合に集計される。
+ *        キャプチャが途中で終わった場合は、受信済みの部分だけの統計情報になる。
+ * @return 統計情報。集計していない場合はNULL.
+ */
+const struct yuv_stats* pdc_stream_get_stats(void)
+{
+    return s_is_stats_valid ? &s_stats : NULL;
+}
+
+/**
+ * @brief 合焦評価の対象領域(ROI)を設定する。
+ *        x, width は偶数に切り下げる。ラプラシアンに上下左右のピクセルを使うため、
+ *        ROIの外側に左右2ピクセル, 上下1ラインが必要になる。
+ * @param proi 対象領域(NULLの場合はキャプチャ範囲の中央の1/2x1/2にする)
+ * @return 成功した場合にはtrue, 現在のキャプチャ範囲に収まらない場合はfalse.
+ */
+bool pdc_stream_set_focus_roi(const struct pdc_stream_roi* proi)
+{
+    uint16_t width, lines;
+    uint8_t bpp;
+    struct pdc_stream_roi area;
+
+    if (proi == NULL)
+    {
+        s_is_focus_roi_center = true;
+        return true;
+    }
+    if (!get_layout(&width, &lines, &bpp) || !fit_roi(proi, width, lines, &area))
+    {
+        return false;
+    }
+    s_focus_roi = area;
+    s_is_focus_roi_center = false;
+
+    return true;
+}
+
+/**
+ * @brief 現在のキャプチャ範囲で合焦評価する領域を得る。
+ * @param proi 対象領域を格納する構造体
+ * @return 成功した場合にはtrue, 対象領域がキャプチャ範囲に収まらない場合はfalse.
+ */
+bool pdc_stream_get_focus_roi(struct pdc_stream_roi* proi)
+{
+    uint16_t width, lines;
+    uint8_t bpp;
+
+    return get_layout(&width, &lines, &bpp) && get_focus_area(width, lines, proi);
+}
+
+/**
+ * @brief 直前にキャプチャしたフレームの合焦評価値を得る。
+ *        pdc_stream_read() (raw), pdc_stream_encode(), pdc_stream_measure() でYUYVをキャプチャした場合に計算される。
+ *        キャプチャが途中で終わった場合は、受信済みのラインだけの値になる。
+ * @return 合焦評価値。計算していない場合はNULL.
+ */
+const struct yuv_focus* pdc_stream_get_focus(void)
+{
+    return s_is_focus_valid ? &s_focus : NULL;
+}
+
+/**
+ * @brief フレーム完了時コールバックを設定する。
+ *        YUYVのフレームをエラーなくキャプチャし、統計情報が揃った時点(フレームエンド直後)に、
+ *        メインループのコンテキストで呼び出す。
+ * @param callback コールバック関数(解除する場合はNULL)
+ */
+void pdc_stream_set_frame_callback(void (*callback)(const struct yuv_stats* pstats))
+{
+    s_frame_callback = callback;
+
+    return;
+}
+
+/**
+ * @brief pdc_stream_encode() で圧縮したデータを送信する。
+ * @param presult pdc_stream_encode() の結果(送信結果を追加する)
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int pdc_stream_send_encoded(struct pdc_stream_result* presult)
+{
+    if (s_encoded_size == 0u)
+    {
+        return EINVAL;
+    }
+
+    uint32_t begin = hwtick_get();
+    presult->sent_bytes = usb_cdc_write_blocking(s_pencoded, s_encoded_size, SEND_TIMEOUT_MILLIS);
+    presult->elapsed_millis += hwtick_get() - begin;
+
+    return (presult->sent_bytes == s_encoded_size) ? 0 : EIO;
+}
+
+/**
+ * @brief 圧縮の1単位(delta は1ライン, jpeg は8ライン)を圧縮する。
+ * @param format 圧縮フォーマット
+ * @param pbuf キャプチャデータ
+ * @param line 先頭ライン番号
+ * @param line_bytes 1ラインのバイト数
+ * @param bpp 1ピクセルあたりのバイト数
+ * @param penc 圧縮データの出力先
+ * @param enc_size 出力先のサイズ[byte]
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+static int encode_lines(enum pdc_stream_format format, const uint8_t* pbuf, uint32_t line, uint32_t line_bytes, uint8_t bpp,
+                        uint8_t* penc, uint32_t enc_size)
+{
+    const uint8_t* pline = pbuf + (line * line_bytes);
+
+    if (format == PDC_STREAM_FORMAT_JPEG)
+    {
+        return jpeg_enc_encode_stripe(pline, line_bytes);
+    }
+
+    int32_t len = frame_codec_encode_line(penc + s_encoded_size, enc_size - s_encoded_size, pline,
+                                          (line > 0u) ? (pline - line_bytes) : NULL, line_bytes, bpp);
+    if (len < 0)
+    {
+        return ENOSPC;
+    }
+    s_encoded_size += (uint32_t)(len);
+
+    return 0;
+}
+
+/**
+ * @brief 統計情報の集計を開始する。
+ * @param bpp 1ピクセルあたりのバイト数(2の場合だけ集計する)
+ */
+static void begin_stats(uint8_t bpp)
+{
+    s_is_stats_enabled = (bpp == 2u);
+    s_is_stats_valid = false;
+    s_stats_pos = 0u;
+    yuv_stats_clear(&s_stats);
+
+    return;
+}
+
+/**
+ * @brief 書き込み済みの部分を統計情報に加える。完了した場合は統計情報を確定し、フレーム完了時コールバックを呼び出す。
+ *        完了後は未受信領域がゼロクリアされるため、受信済みサイズまでを集計する。
+ * @param pbuf キャプチャデータ
+ * @param received 書き込み済みのサイズ[byte]
+ * @param is_done キャプチャが完了したかどうか
+ * @param presult 結果(集計時間を更新する)
+ */
+static void update_stats(const uint8_t* pbuf, uint32_t received, bool is_done, struct pdc_stream_result* presult)
+{
+    if (!s_is_stats_enabled || s_is_stats_valid)
+    {
+        return;
+    }
+
+    uint32_t limit = (is_done && (presult->received_len < received)) ? presult->received_len : received;
+    limit &= ~0x3u; // ワード単位で集計する。
+    if (limit > s_stats_pos)
+    {
+        uint32_t stats_begin = hwtick_get_micros();
+        yuv_stats_add(&s_stats, pbuf + s_stats_pos, limit - s_stats_pos);
+        presult->stats_micros += hwtick_get_micros() - stats_begin;
+        s_stats_pos = limit;
+    }
+    if (is_done)
+    {
+        yuv_stats_finish(&s_stats);
+        s_is_stats_valid = true;
+        if (presult->is_captured && (s_frame_callback != NULL))
+        {
+            s_frame_callback(&s_stats);
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief キャプチャ範囲に合わせて、合焦評価する領域を得る。
+ * @param width キャプチャ範囲の幅[pixel]
+ * @param lines キャプチャ範囲のライン数
+ * @param parea 領域を格納する構造体
+ * @return 成功した場合にはtrue, 領域がキャプチャ範囲に収まらない場合はfalse.
+ */
+static bool get_focus_area(uint16_t width, uint16_t lines, struct pdc_stream_roi* parea)
+{
+    struct pdc_stream_roi roi = s_focus_roi;
+
+    if (s_is_focus_roi_center)
+    {
+        roi.x = (uint16_t)(width / 4u);
+        roi.y = (uint16_t)(lines / 4u);
+        roi.width = (uint16_t)(width / 2u);
+        roi.height = (uint16_t)(lines / 2u);
+    }
+
+    return fit_roi(&roi, width, lines, parea);
+}
+
+/**
+ * @brief 領域の x, width を偶数に切り下げ、キャプチャ範囲に収まるかどうかを調べる。
+ * @param proi 領域
+ * @param width キャプチャ範囲の幅[pixel]
+ * @param lines キャプチャ範囲のライン数
+ * @param parea 切り下げた領域を格納する構造体
+ * @return 収まる場合にはtrue, それ以外はfalse.
+ */
+static bool fit_roi(const struct pdc_stream_roi* proi, uint16_t width, uint16_t lines, struct pdc_stream_roi* parea)
+{
+    struct pdc_stream_roi area = (*proi);
+
+    area.x = (uint16_t)(area.x & ~0x1u);
+    area.width = (uint16_t)(area.width & ~0x1u);
+    // 左右2ピクセル(1ワード), 上下1ラインを読む。
+    if ((area.x < 2u) || (area.width == 0u) || (((uint32_t)(area.x) + area.width + 2u) > width) || (area.y < 1u)
+        || (area.height == 0u) || (((uint32_t)(area.y) + area.height + 1u) > lines))
+    {
+        return false;
+    }
+    (*parea) = area;
+
+    return true;
+}
+
+/**
+ * @brief 合焦評価値の計算を開始する。
+ * @param is_enabled 計算するかどうか(YUYVで、対象領域がキャプチャ範囲に収まる場合だけ計算する)
+ * @param width キャプチャ範囲の幅[pixel]
+ * @param lines キャプチャ範囲のライン数
+ * @param bpp 1ピクセルあたりのバイト数
+ */
+static void begin_focus(bool is_enabled, uint16_t width, uint16_t lines, uint8_t bpp)
+{
+    s_is_focus_enabled = is_enabled && (bpp == 2u) && get_focus_area(width, lines, &s_focus_area);
+    s_is_focus_valid = false;
+    s_focus_line = s_focus_area.y;
+    s_focus_line_bytes = (uint32_t)(width) * bpp;
+    yuv_focus_clear(&s_focus);
+
+    return;
+}
+
+/**
+ * @brief 下のラインまで書き込み済みになったROIのラインを合焦評価値に加える。
+ *        ROIの最終ラインを加えた時点(またはキャプチャ完了時)で合焦評価値を確定する。
+ * @param pbuf キャプチャデータ
+ * @param received 書き込み済みのサイズ[byte]
+ * @param is_done キャプチャが完了したかどうか
+ * @param presult 結果(計算時間を更新する)
+ */
+static void update_focus(const uint8_t* pbuf, uint32_t received, bool is_done, struct pdc_stream_result* presult)
+{
+    if (!s_is_focus_enabled || s_is_focus_valid)
+    {
+        return;
+    }
+
+    uint32_t limit = (is_done && (presult->received_len < received)) ? presult->received_len : received;
+    uint32_t available = limit / s_focus_line_bytes; // 書き込み済みのライン数
+    uint32_t end = (uint32_t)(s_focus_area.y) + s_focus_area.height;
+    if ((s_focus_line < end) && ((s_focus_line + 1u) < available))
+    {
+        uint32_t focus_begin = hwtick_get_micros();
+        while ((s_focus_line < end) && ((s_focus_line + 1u) < available))
+        {
+            yuv_focus_add_line(&s_focus, pbuf + (s_focus_line * s_focus_line_bytes), s_focus_line_bytes, s_focus_area.x,
+                               s_focus_area.width);
+            s_focus_line++;
+        }
+        presult->focus_micros += hwtick_get_micros() - focus_begin;
+    }
+    if ((s_focus_line >= end) || is_done)
+    {
+        yuv_focus_finish(&s_focus);
+        s_is_focus_valid = true;
+    }
+
+    return;
+}
+
+/**
+ * @brief キャプチャの完了を調べ、書き込み済みのサイズを得る。
+ *        完了またはタイムアウトした場合は、未受信領域のゼロクリアを完了させてからキャプチャ範囲全体のサイズを返す。
+ * @param total キャプチャ範囲全体のサイズ[byte]
+ * @param begin キャプチャ開始時刻[ミリ秒]
+ * @param presult 結果を格納する構造体(完了時にキャプチャ結果を設定する)
+ * @param pis_done 完了したかどうかを格納する変数
+ * @return 書き込み済みのサイズ[byte]
+ */
+static uint32_t poll_capture(uint32_t total, uint32_t begin, struct pdc_stream_result* presult, bool* pis_done)
+{
+    struct pdc_status status;
+
+    if ((*pis_done))
+    {
+        return total;
+    }
+    if (s_is_capture_done)
+    {
+        finish_capture();
+        presult->received_len = s_capture_status.received_len;
+        presult->is_captured = pdc_is_frame_complete(&s_capture_status);
+    }
+    else if ((hwtick_get() - begin) >= CAPTURE_TIMEOUT_MILLIS)
+    {
+        pdc_stop_capture();
+        finish_capture();
+        pdc_get_status(&status);
+        presult->received_len = status.received_len;
+    }
+    else
+    {
+        pdc_get_status(&status);
+        return status.received_len;
+    }
+    (*pis_done) = true;
+    presult->capture_millis = hwtick_get() - begin;
+
+    return total; // 未受信領域はゼロクリア済み
+}
+
+/**
+ * @brief 送信できるデータを送信キューに書き込む。
+ * @param pdata 送信データ
+ * @param ready 送信できるサイズ[byte]
+ * @param presult 結果(送信したサイズを更新する)
+ */
+static void send_ready(const uint8_t* pdata, uint32_t ready, struct pdc_stream_result* presult)
+{
+    if (ready > presult->sent_bytes)
+    {
+        uint32_t len = ready - presult->sent_bytes;
+        int written = usb_cdc_write(pdata + presult->sent_bytes, (uint16_t)((len > MAX_WRITE_BYTES) ? MAX_WRITE_BYTES : len));
+        if (written > 0)
+        {
+            presult->sent_bytes += (uint32_t)(written);
+        }
+    }
+    usb_cdc_update();
+
+    return;
+}
+
+/**
+ * @brief RGB888で送信する。
+ *        ストライプバッファを送信し終えていれば、次の書き込み済みストライプをストライプバッファに変換し、
+ *        ストライプバッファの未送信部分を送信キューに書き込む。
+ * @param pbuf キャプチャデータ
+ * @param received 書き込み済みのサイズ[byte]
+ * @param total キャプチャ範囲全体のサイズ[byte]
+ * @param pprocessed 変換済みの入力サイズ[byte]を格納した変数(更新する)
+ * @param presult 結果(送信したサイズ, 変換時間を更新する)
+ */
+static void send_rgb888(const uint8_t* pbuf, uint32_t received, uint32_t total, uint32_t* pprocessed,
+                        struct pdc_stream_result* presult)
+{
+    uint32_t processed = (*pprocessed);
+    uint32_t converted = (processed / 2u) * 3u; // 変換済みの出力サイズ
+
+    if (presult->sent_bytes >= converted)
+    {
+        uint32_t limit = (received < total) ? ((received / STRIPE_BYTES) * STRIPE_BYTES) : received;
+        if (limit > processed)
+        {
+            uint32_t len = ((limit - processed) > STRIPE_BYTES) ? STRIPE_BYTES : (limit - processed);
+            uint32_t convert_begin = hwtick_get_micros();
+            s_rgb_stripe_len = yuv_to_rgb888((uint8_t*)(s_rgb_stripe), pbuf + processed, len);
+            presult->convert_micros += hwtick_get_micros() - convert_begin;
+            processed += len;
+            converted += s_rgb_stripe_len;
+            (*pprocessed) = processed;
+        }
+    }
+
+    if (converted > presult->sent_bytes)
+    {
+        uint32_t remain = converted - presult->sent_bytes;
+        const uint8_t* pdata = ((const uint8_t*)(s_rgb_stripe)) + (s_rgb_stripe_len - remain);
+        int written = usb_cdc_write(pdata, (uint16_t)(remain));
+        if (written > 0)
+        {
+            presult->sent_bytes += (uint32_t)(written);
+        }
+    }
+    usb_cdc_update();
+
+    return;
+}
+
+/**
+ * @brief 現在のキャプチャ範囲を得る。
+ * @param pwidth 1ラインのピクセル数を格納する変数
+ * @param plines ライン数を格納する変数
+ * @param pbpp 1ピクセルあたりのバイト数を格納する変数
+ * @return 成功した場合にはtrue, 失敗した場合にはfalse.
+ */
+static bool get_layout(uint16_t* pwidth, uint16_t* plines, uint8_t* pbpp)
+{
+    uint16_t xst, yst;
+
+    return pdc_get_capture_range(&xst, pwidth, &yst, plines, pbpp);
+}
+
+/**
+ * @brief 縮小率を得る。
+ * @param format フォーマット
+ * @return 縮小率(縮小しないフォーマットは1)
+ */
+static uint8_t get_bin_factor(enum pdc_stream_format format)
+{
+    return (format == PDC_STREAM_FORMAT_BIN2) ? 2u : ((format == PDC_STREAM_FORMAT_BIN4) ? 4u : 1u);
+}
+
+/**
+ * @brief 受信済みの部分を、フォーマットに合わせてストライプ単位で変換する。
+ *        y はストライプ(STRIPE_BYTES)単位、縮小は縮小率分のライン単位で変換する。
+ *        受信済みサイズがキャプチャ範囲全体の場合は、残り全てを変換する。
+ * @param format フォーマット
+ * @param pbuf キャプチャバッファ
+ * @param received 受信済みサイズ[byte]
+ * @param pprocessed 変換済みの入力サイズ[byte]を格納した変数(更新される)
+ * @return 送信できる出力サイズ[byte]
+ */
+static uint32_t process_stripes(enum pdc_stream_format format, uint8_t* pbuf, uint32_t received, uint32_t* pprocessed)
+{
+    uint16_t width, lines;
+    uint8_t bpp;
+    uint32_t processed = (*pprocessed);
+
+    get_layout(&width, &lines, &bpp);
+    uint32_t line_bytes = (uint32_t)(width) * bpp;
+    uint32_t total = line_bytes * lines;
+    uint8_t factor = get_bin_factor(format);
+
+    if (factor > 1u)
+    {
+        uint32_t row_bytes = line_bytes * factor; // 出力1ライン分の入力サイズ
+        uint32_t out_line_bytes = line_bytes / factor;
+        uint32_t rows = received / row_bytes;
+        for (uint32_t row = processed / row_bytes; row < rows; row++)
+        {
+            yuv_bin_line(pbuf + (row * out_line_bytes), pbuf + (row * row_bytes), line_bytes, width, factor);
+        }
+        (*pprocessed) = rows * row_bytes;
+        return rows * out_line_bytes;
+    }
+
+    if (received < total)
+    {
+        received = (received / STRIPE_BYTES) * STRIPE_BYTES; // 書き込み終えたストライプまで
+    }
+    if (format == PDC_STREAM_FORMAT_Y)
+    {
+        if (received > processed)
+        {
+            yuv_extract_y(pbuf + (processed / 2u), pbuf + processed, received - processed);
+            processed = received;
+        }
+        (*pprocessed) = processed;
+        return processed / 2u;
+    }
+    else if (format == PDC_STREAM_FORMAT_RGB565)
+    {
+        if (received > processed)
+        {
+            yuv_to_rgb565(pbuf + processed, pbuf + processed, received - processed);
+            processed = received;
+        }
+        (*pprocessed) = processed;
+        return processed;
+    }
+    else
+    {
+        (*pprocessed) = received;
+        return received;
+    }
+}
+
+/**
+ * @brief キャプチャ終了後、未受信領域のゼロクリアを完了させる。
+ */
+static void finish_capture(void)
+{
+    if (pdc_is_running()) // エラーで終了した場合は受信が止まっていない。
+    {
+        pdc_stop_capture();
+    }
+    pdc_flush_tail_fills(TAIL_FILL_TIMEOUT_MILLIS);
+
+    return;
+}
+
+/**
+ * @brief キャプチャ完了通知を受け取る。(割り込みコンテキスト)
+ * @param pstat PDCステータス
+ */
+static void on_capture_done(const struct pdc_status* pstat)
+{
+    s_capture_status = *pstat;
+    s_is_capture_done = true;
+
+    return;
+}
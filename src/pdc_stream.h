@@ -0,0 +1,80 @@
+/**
+ * @file PDCキャプチャデータ送信のインタフェース宣言
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+
+#ifndef PDC_STREAM_H_
+#define PDC_STREAM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "yuv.h"
+
+/**
+ * @brief JPEGの品質の初期値
+ */
+#define PDC_STREAM_DEFAULT_JPEG_QUALITY (75)
+
+/**
+ * @brief 送信フォーマット
+ */
+enum pdc_stream_format
+{
+    PDC_STREAM_FORMAT_RAW = 0, // キャプチャデータそのまま
+    PDC_STREAM_FORMAT_Y,       // YUYVの輝度(Y)だけ(サイズは半分)
+    PDC_STREAM_FORMAT_BIN2,    // YUYVを2x2ピクセル平均で縮小(サイズは1/4)
+    PDC_STREAM_FORMAT_BIN4,    // YUYVを4x4ピクセル平均で縮小(サイズは1/16)
+    PDC_STREAM_FORMAT_DELTA,   // 差分予測 + ランレングスで可逆圧縮(frame_codec.h)
+    PDC_STREAM_FORMAT_JPEG,    // YUYVをベースラインJPEG(4:2:2)で圧縮(jpeg_enc.h)
+    PDC_STREAM_FORMAT_RGB565,  // YUYVをRGB565(1ピクセル16bit, CPUのバイトオーダー)に変換(サイズは同じ)
+    PDC_STREAM_FORMAT_RGB888,  // YUYVをRGB888(1ピクセル3バイト, R, G, B の順)に変換(サイズは1.5倍)
+};
+
+/**
+ * @brief 合焦評価の対象領域(ROI) (キャプチャ範囲内の位置[pixel, line])
+ */
+struct pdc_stream_roi
+{
+    uint16_t x;      // 左端
+    uint16_t y;      // 上端
+    uint16_t width;  // 幅
+    uint16_t height; // 高さ
+};
+
+/**
+ * @brief 送信結果
+ */
+struct pdc_stream_result
+{
+    enum pdc_stream_format format; // 送信フォーマット
+    bool is_captured;              // エラーなくフレームエンドまでキャプチャできたかどうか
+    uint32_t received_len;         // 受信済みサイズ[byte]
+    uint32_t total_len;            // 総転送サイズ[byte]
+    uint32_t sent_bytes;           // 送信したサイズ[byte]
+    uint32_t encoded_bytes;        // 圧縮後のサイズ[byte] (delta, jpeg のみ)
+    uint32_t encode_micros;        // 圧縮に要した時間の合計[マイクロ秒] (delta, jpeg のみ)
+    uint32_t convert_micros;       // 変換に要した時間の合計[マイクロ秒] (y, bin2, bin4, rgb565, rgb888 のみ)
+    uint32_t stats_micros;         // 統計情報の集計に要した時間の合計[マイクロ秒] (YUYVのみ)
+    uint32_t focus_micros;         // 合焦評価値の計算に要した時間の合計[マイクロ秒] (YUYVのみ)
+    uint32_t capture_millis;       // キャプチャ完了までの時間[ミリ秒]
+    uint32_t elapsed_millis;       // 送信完了までの時間[ミリ秒]
+};
+
+bool pdc_stream_find_format(const char* name, enum pdc_stream_format* pformat);
+const char* pdc_stream_get_format_name(enum pdc_stream_format format);
+uint32_t pdc_stream_get_output_size(enum pdc_stream_format format);
+bool pdc_stream_get_output_dimension(enum pdc_stream_format format, uint16_t* pwidth, uint16_t* pheight);
+int pdc_stream_read(enum pdc_stream_format format, struct pdc_stream_result* presult);
+bool pdc_stream_set_jpeg_quality(uint8_t quality);
+uint8_t pdc_stream_get_jpeg_quality(void);
+int pdc_stream_encode(enum pdc_stream_format format, struct pdc_stream_result* presult);
+int pdc_stream_send_encoded(struct pdc_stream_result* presult);
+int pdc_stream_measure(struct pdc_stream_result* presult);
+const struct yuv_stats* pdc_stream_get_stats(void);
+bool pdc_stream_set_focus_roi(const struct pdc_stream_roi* proi);
+bool pdc_stream_get_focus_roi(struct pdc_stream_roi* proi);
+const struct yuv_focus* pdc_stream_get_focus(void);
+void pdc_stream_set_frame_callback(void (*callback)(const struct yuv_stats* pstats));
+
+#endif /* PDC_STREAM_H_ */
@@ -0,0 +1,392 @@
+/**
+ * @file PDCフレーム間差分送信定義
+ *        キャプチャバッファの2スロットを、参照フレーム(ホストが持っているフレーム)とキャプチャ先に使い、
+ *        キャプチャしたフレームを参照フレームと16x16ピクセルのタイル単位で比較して、
+ *        変化したタイルだけを送信する。
+ *        変化したタイルは送信後に参照フレームへコピーするため、参照フレームは常にホスト側の表示内容と一致する。
+ *        (しきい値以下の変化を無視しても、ホスト側との差はしきい値を超えない)
+ *        キーフレームは、参照フレームがない場合, キーフレーム間隔に達した場合, タイル送信の方が大きくなる場合に送信する。
+ *        キーフレームを送信したら、キャプチャ先と参照フレームのスロットを入れ替える。(コピーしない)
+ *
+ *        送信データ(ヘッダ行は呼び出し元が出力する)
+ *          key:  キャプチャデータそのまま(1フレーム分)
+ *          tile: タイルビットマップ((総タイル数 + 7) / 8 バイト。左上からライン順, 各バイトのLSBから)に続けて、
+ *                変化したタイルのデータをビットマップの順に送信する。
+ *                1タイルは先頭ラインから順に、タイル幅分のキャプチャデータを並べたもの。
+ *                右端, 下端のタイルはキャプチャ範囲に収まる部分だけになる。
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+
+#include "hwtick.h"
+#include "usb_cdc.h"
+#include "pdc.h"
+#include "pdc_tile.h"
+
+/**
+ * @brief 1フレームのキャプチャタイムアウト時間[ミリ秒]
+ */
+#define CAPTURE_TIMEOUT_MILLIS (200)
+
+/**
+ * @brief 送信タイムアウト時間[ミリ秒]
+ */
+#define SEND_TIMEOUT_MILLIS (10000)
+
+/**
+ * @brief 使用するスロット数(参照フレーム, キャプチャ先)
+ */
+#define SLOT_COUNT (2)
+
+static void get_tile_rect(uint32_t tile, uint32_t* poffset, uint32_t* prow_bytes, uint32_t* prows);
+static bool is_tile_changed(const uint8_t* pcur, const uint8_t* pref, uint32_t row_bytes, uint32_t rows);
+static bool send_bytes(const uint8_t* pdata, uint32_t len, struct pdc_tile_result* presult);
+
+/**
+ * @brief 送信モード名
+ */
+//@formatter:off
+static const char* const s_mode_names[] = {
+    "key",
+    "tile",
+};
+//@formatter:on
+
+/**
+ * @brief 送信中かどうか
+ */
+static bool s_is_running;
+
+/**
+ * @brief キーフレーム間隔[フレーム]
+ */
+static uint32_t s_key_interval;
+
+/**
+ * @brief 変化とみなさない差分の最大値(0の場合は完全一致だけを変化なしとする)
+ */
+static uint8_t s_threshold;
+
+/**
+ * @brief 参照フレームがあるかどうか
+ */
+static bool s_has_ref;
+
+/**
+ * @brief 参照フレームのスロット番号
+ */
+static int s_ref_slot;
+
+/**
+ * @brief 前回のキーフレームからのフレーム数
+ */
+static uint32_t s_frames_since_key;
+
+/**
+ * @brief キャプチャ範囲の幅[pixel]
+ */
+static uint16_t s_width;
+
+/**
+ * @brief キャプチャ範囲のライン数
+ */
+static uint16_t s_lines;
+
+/**
+ * @brief 1ピクセルあたりのバイト数
+ */
+static uint8_t s_bpp;
+
+/**
+ * @brief 水平方向のタイル数
+ */
+static uint32_t s_tiles_x;
+
+/**
+ * @brief 総タイル数
+ */
+static uint32_t s_tiles;
+
+/**
+ * @brief タイルビットマップ(変化したタイルのビットが1)
+ */
+static uint8_t s_bitmap[PDC_TILE_MAX_TILES / 8];
+
+/**
+ * @brief フレーム間差分送信を開始する。
+ *        現在のキャプチャ範囲を使用する。キャプチャバッファに2フレーム分入る必要がある。
+ * @param key_interval キーフレーム間隔[フレーム] (1の場合は毎フレームキーフレームになる)
+ * @param threshold 変化とみなさない差分の最大値(0の場合は完全一致だけを変化なしとする)
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int pdc_tile_start(uint32_t key_interval, uint8_t threshold)
+{
+    uint16_t xst, yst;
+
+    if (key_interval == 0u)
+    {
+        return EINVAL;
+    }
+    if (s_is_running || pdc_is_busy())
+    {
+        return EBUSY;
+    }
+    if (!pdc_get_capture_range(&xst, &s_width, &yst, &s_lines, &s_bpp))
+    {
+        return EIO;
+    }
+    if (pdc_get_capture_slot_count() < SLOT_COUNT)
+    {
+        return ENOMEM;
+    }
+    s_tiles_x = ((uint32_t)(s_width) + PDC_TILE_SIZE - 1u) / PDC_TILE_SIZE;
+    s_tiles = s_tiles_x * (((uint32_t)(s_lines) + PDC_TILE_SIZE - 1u) / PDC_TILE_SIZE);
+    if (s_tiles > PDC_TILE_MAX_TILES)
+    {
+        return ERANGE;
+    }
+
+    s_key_interval = key_interval;
+    s_threshold = threshold;
+    s_has_ref = false;
+    s_ref_slot = 0;
+    s_frames_since_key = 0u;
+    pdc_claim("pdc-tile");
+    s_is_running = true;
+
+    return 0;
+}
+
+/**
+ * @brief 1フレームをキャプチャし、参照フレームと比較して送信モードと送信サイズを決める。
+ *        続けて、ヘッダを出力してから pdc_tile_send() で送信する。
+ * @param presult 結果を格納する構造体
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ *         キャプチャできなかった場合はEIOを返す。(参照フレームは変わらないため、次のフレームに進める)
+ */
+int pdc_tile_capture(struct pdc_tile_result* presult)
+{
+    memset(presult, 0, sizeof(struct pdc_tile_result));
+    if (!s_is_running)
+    {
+        return EINVAL;
+    }
+    presult->total_tiles = s_tiles;
+    presult->frame_bytes = (uint32_t)(s_width) * s_bpp * s_lines;
+
+    int capture_slot = (s_ref_slot + 1) % SLOT_COUNT;
+    if (!pdc_select_capture_slot(capture_slot) || (pdc_capture_frame(CAPTURE_TIMEOUT_MILLIS, NULL) != 0))
+    {
+        return EIO;
+    }
+    presult->is_captured = true;
+
+    if (!s_has_ref || (s_frames_since_key >= s_key_interval))
+    {
+        presult->mode = PDC_TILE_MODE_KEY;
+        presult->payload_bytes = presult->frame_bytes;
+        return 0;
+    }
+
+    const uint8_t* pcur = pdc_get_capture_slot_buffer(capture_slot);
+    const uint8_t* pref = pdc_get_capture_slot_buffer(s_ref_slot);
+    uint32_t payload = (s_tiles + 7u) / 8u;
+    uint32_t compare_begin = hwtick_get_micros();
+    memset(s_bitmap, 0, payload);
+    for (uint32_t tile = 0u; tile < s_tiles; tile++)
+    {
+        uint32_t offset, row_bytes, rows;
+        get_tile_rect(tile, &offset, &row_bytes, &rows);
+        if (is_tile_changed(pcur + offset, pref + offset, row_bytes, rows))
+        {
+            s_bitmap[tile / 8u] |= (uint8_t)(1u << (tile % 8u));
+            presult->changed_tiles++;
+            payload += row_bytes * rows;
+        }
+    }
+    presult->compare_micros = hwtick_get_micros() - compare_begin;
+
+    if (payload >= presult->frame_bytes) // キーフレームの方が小さい？
+    {
+        presult->mode = PDC_TILE_MODE_KEY;
+        presult->payload_bytes = presult->frame_bytes;
+    }
+    else
+    {
+        presult->mode = PDC_TILE_MODE_TILE;
+        presult->payload_bytes = payload;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief pdc_tile_capture() でキャプチャしたフレームを送信し、参照フレームを更新する。
+ *        送信に失敗した場合は、ホスト側の内容が分からなくなるため、次のフレームをキーフレームにする。
+ * @param presult pdc_tile_capture() の結果(送信結果を追加する)
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int pdc_tile_send(struct pdc_tile_result* presult)
+{
+    if (!s_is_running || !presult->is_captured)
+    {
+        return EINVAL;
+    }
+
+    int capture_slot = (s_ref_slot + 1) % SLOT_COUNT;
+    const uint8_t* pcur = pdc_get_capture_slot_buffer(capture_slot);
+    uint8_t* pref = (uint8_t*)(pdc_get_capture_slot_buffer(s_ref_slot));
+    uint32_t line_bytes = (uint32_t)(s_width) * s_bpp;
+
+    presult->sent_bytes = 0u;
+    if (presult->mode == PDC_TILE_MODE_KEY)
+    {
+        if (!send_bytes(pcur, presult->frame_bytes, presult))
+        {
+            s_has_ref = false;
+            return EIO;
+        }
+        s_ref_slot = capture_slot; // 送信したフレームをそのまま参照フレームにする。
+        s_has_ref = true;
+        s_frames_since_key = 1u;
+        return 0;
+    }
+
+    if (!send_bytes(s_bitmap, (s_tiles + 7u) / 8u, presult))
+    {
+        s_has_ref = false;
+        return EIO;
+    }
+    for (uint32_t tile = 0u; tile < s_tiles; tile++)
+    {
+        if ((s_bitmap[tile / 8u] & (1u << (tile % 8u))) == 0u)
+        {
+            continue;
+        }
+        uint32_t offset, row_bytes, rows;
+        get_tile_rect(tile, &offset, &row_bytes, &rows);
+        for (uint32_t row = 0u; row < rows; row++)
+        {
+            uint32_t row_offset = offset + (row * line_bytes);
+            if (!send_bytes(pcur + row_offset, row_bytes, presult))
+            {
+                s_has_ref = false;
+                return EIO;
+            }
+            memcpy(pref + row_offset, pcur + row_offset, row_bytes);
+        }
+    }
+    s_frames_since_key++;
+
+    return 0;
+}
+
+/**
+ * @brief フレーム間差分送信を終了する。キャプチャスロットを0に戻す。
+ */
+void pdc_tile_stop(void)
+{
+    if (s_is_running)
+    {
+        pdc_select_capture_slot(0);
+        pdc_release();
+        s_is_running = false;
+    }
+
+    return;
+}
+
+/**
+ * @brief フレーム間差分送信中かどうかを得る。
+ * @return 送信中の場合にはtrue, それ以外はfalse.
+ */
+bool pdc_tile_is_running(void)
+{
+    return s_is_running;
+}
+
+/**
+ * @brief 送信モード名を得る。
+ * @param mode 送信モード
+ * @return 送信モード名
+ */
+const char* pdc_tile_get_mode_name(enum pdc_tile_mode mode)
+{
+    return ((mode >= 0) && (mode < (int)(sizeof(s_mode_names) / sizeof(s_mode_names[0])))) ? s_mode_names[mode] : "?";
+}
+
+/**
+ * @brief タイルの位置と大きさを得る。
+ * @param tile タイル番号(左上からライン順)
+ * @param poffset フレーム先頭からのオフセット[byte]を格納する変数
+ * @param prow_bytes 1ラインのバイト数を格納する変数
+ * @param prows ライン数を格納する変数
+ */
+static void get_tile_rect(uint32_t tile, uint32_t* poffset, uint32_t* prow_bytes, uint32_t* prows)
+{
+    uint32_t x = (tile % s_tiles_x) * PDC_TILE_SIZE;
+    uint32_t y = (tile / s_tiles_x) * PDC_TILE_SIZE;
+    uint32_t width = ((x + PDC_TILE_SIZE) <= s_width) ? PDC_TILE_SIZE : (s_width - x);
+
+    (*poffset) = ((y * s_width) + x) * s_bpp;
+    (*prow_bytes) = width * s_bpp;
+    (*prows) = ((y + PDC_TILE_SIZE) <= s_lines) ? PDC_TILE_SIZE : (s_lines - y);
+
+    return;
+}
+
+/**
+ * @brief タイルが変化したかどうかを調べる。
+ * @param pcur キャプチャしたフレームのタイル左上
+ * @param pref 参照フレームのタイル左上
+ * @param row_bytes タイルの1ラインのバイト数
+ * @param rows タイルのライン数
+ * @return しきい値を超える差分がある場合にはtrue, それ以外はfalse.
+ */
+static bool is_tile_changed(const uint8_t* pcur, const uint8_t* pref, uint32_t row_bytes, uint32_t rows)
+{
+    uint32_t line_bytes = (uint32_t)(s_width) * s_bpp;
+
+    for (uint32_t row = 0u; row < rows; row++)
+    {
+        const uint8_t* pc = pcur + (row * line_bytes);
+        const uint8_t* pr = pref + (row * line_bytes);
+        if (s_threshold == 0u)
+        {
+            if (memcmp(pc, pr, row_bytes) != 0)
+            {
+                return true;
+            }
+        }
+        else
+        {
+            for (uint32_t i = 0u; i < row_bytes; i++)
+            {
+                uint8_t diff = (pc[i] > pr[i]) ? (uint8_t)(pc[i] - pr[i]) : (uint8_t)(pr[i] - pc[i]);
+                if (diff > s_threshold)
+                {
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief データを送信キューに全て書き込むまで送信し、送信したサイズを結果に加える。
+ * @param pdata 送信データ
+ * @param len 送信サイズ[byte]
+ * @param presult 結果(送信したサイズを更新する)
+ * @return 成功した場合にはtrue, 切断された場合, タイムアウトした場合にはfalse.
+ */
+static bool send_bytes(const uint8_t* pdata, uint32_t len, struct pdc_tile_result* presult)
+{
+    uint32_t sent = usb_cdc_write_blocking(pdata, len, SEND_TIMEOUT_MILLIS);
+    presult->sent_bytes += sent;
+
+    return sent == len;
+}
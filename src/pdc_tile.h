@@ -0,0 +1,58 @@
+/**
+ * @file PDCフレーム間差分送信のインタフェース宣言
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+
+#ifndef PDC_TILE_H_
+#define PDC_TILE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief タイルの大きさ[pixel] (幅, 高さとも)
+ */
+#define PDC_TILE_SIZE (16)
+
+/**
+ * @brief 最大タイル数
+ */
+#define PDC_TILE_MAX_TILES (8192)
+
+/**
+ * @brief キーフレーム間隔の初期値[フレーム]
+ */
+#define PDC_TILE_DEFAULT_KEY_INTERVAL (30)
+
+/**
+ * @brief フレームの送信モード
+ */
+enum pdc_tile_mode
+{
+    PDC_TILE_MODE_KEY = 0, // キーフレーム(フレーム全体)
+    PDC_TILE_MODE_TILE,    // 変化したタイルだけ(タイルビットマップ + タイルデータ)
+};
+
+/**
+ * @brief 1フレームの送信結果
+ */
+struct pdc_tile_result
+{
+    enum pdc_tile_mode mode; // 送信モード
+    bool is_captured;        // エラーなくフレームエンドまでキャプチャできたかどうか
+    uint32_t changed_tiles;  // 変化したタイル数
+    uint32_t total_tiles;    // 総タイル数
+    uint32_t frame_bytes;    // 1フレームのサイズ[byte]
+    uint32_t payload_bytes;  // 送信するサイズ(ヘッダ行を除く)[byte]
+    uint32_t sent_bytes;     // 送信したサイズ[byte]
+    uint32_t compare_micros; // タイル比較に要した時間[マイクロ秒]
+};
+
+int pdc_tile_start(uint32_t key_interval, uint8_t threshold);
+int pdc_tile_capture(struct pdc_tile_result* presult);
+int pdc_tile_send(struct pdc_tile_result* presult);
+void pdc_tile_stop(void);
+bool pdc_tile_is_running(void);
+const char* pdc_tile_get_mode_name(enum pdc_tile_mode mode);
+
+#endif /* PDC_TILE_H_ */
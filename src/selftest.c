@@ -0,0 +1,711 @@
+/**
+ * @file セルフテスト定義
+ *        GLCDCのテストパターンをPDCでキャプチャし、期待値と比較するループバックテストを行う。
+ *        バンドパターンでは、ライン検出割り込みによる背景色の切り替え位置を測定する。
+ *        キャプチャと検証を1フレームずつ交互に行い、処理はselftest_update()で少しずつ進める。
+ *        テスト中はテストパターン, フレーム番号(スタンプ)出力, テスト信号出力, PDCの同期信号極性を変更し、終了時に元に戻す。
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+
+#include "hwtick.h"
+#include "pdc.h"
+#include "test_signal.h"
+#include "selftest.h"
+
+/**
+ * @brief 1フレームのキャプチャタイムアウト時間[ミリ秒]
+ *        キャプチャ開始からVSync待ちを含めて2フレーム(約67ミリ秒)あれば完了する。
+ *        タイムアウトした場合はテスト信号が届いていないとみなし、テストを中止する。
+ */
+#define CAPTURE_TIMEOUT_MILLIS (200)
+
+/**
+ * @brief テスト信号の設定変更が反映されるまでの待ち時間[ミリ秒]
+ *        GLCDCのレイヤー設定は次のVSyncで反映されるため、2フレーム分待つ。
+ */
+#define SIGNAL_SETTLE_MILLIS (70)
+
+/**
+ * @brief 期待値バッファのワード数
+ *        キャプチャサイズは32バイトの倍数なので、32バイトの倍数にしておけば端数は出ない。
+ */
+#define EXPECTED_BUFFER_WORDS (256)
+
+/**
+ * @brief テスト状態
+ */
+enum selftest_state
+{
+    SELFTEST_STATE_IDLE = 0,      // 停止中
+    SELFTEST_STATE_SETTLE,        // テスト信号の設定反映待ち
+    SELFTEST_STATE_START_CAPTURE, // キャプチャ開始待ち
+    SELFTEST_STATE_CAPTURING,     // キャプチャ中
+};
+
+/**
+ * @brief テスト種別
+ */
+enum selftest_type
+{
+    SELFTEST_TYPE_PDC = 0, // PDCループバックテスト
+    SELFTEST_TYPE_BANDS,   // バンド切り替え位置の測定
+};
+
+/**
+ * @brief テスト開始前の設定
+ */
+struct saved_settings
+{
+    enum test_pattern pattern; // テストパターン
+    bool is_stamp_enabled;     // フレーム番号(スタンプ)出力
+    bool is_output;            // テスト信号出力
+    bool is_hsync_hactive;     // PDC HSync極性
+    bool is_vsync_hactive;     // PDC VSync極性
+};
+
+static int prepare_test(uint32_t frames, enum test_pattern pattern);
+static void process_capture_done(void);
+static void verify_frame(void);
+static void setup_band_landings(void);
+static void measure_bands(void);
+static bool find_band_switch(uint16_t from_line, uint16_t to_line, uint8_t value, uint16_t* pline, uint16_t* px);
+static uint32_t compare_words(const uint32_t* pexpected, const uint32_t* pactual, uint32_t words, uint32_t* pfirst_word);
+static uint32_t count_bits(uint32_t value);
+static void count_dropped_frame(void);
+static void finish_test(void);
+static void restore_settings(void);
+static void on_capture_done(const struct pdc_status* pstat);
+
+/**
+ * @brief テスト状態
+ */
+static enum selftest_state s_state;
+
+/**
+ * @brief 実行中のテスト種別
+ */
+static enum selftest_type s_type;
+
+/**
+ * @brief PDCループバックテスト結果
+ */
+static struct selftest_pdc_result s_result;
+
+/**
+ * @brief バンド切り替え位置の測定結果
+ */
+static struct selftest_bands_result s_bands_result;
+
+/**
+ * @brief テスト開始前の設定
+ */
+static struct saved_settings s_saved;
+
+/**
+ * @brief キャプチャ範囲の有効表示領域内での水平開始位置[byte]
+ */
+static uint16_t s_capture_x;
+
+/**
+ * @brief キャプチャ範囲の有効表示領域内での垂直開始位置[line]
+ */
+static uint16_t s_capture_y;
+
+/**
+ * @brief 1ラインのキャプチャバイト数
+ */
+static uint16_t s_line_bytes;
+
+/**
+ * @brief キャプチャライン数
+ */
+static uint16_t s_capture_lines;
+
+/**
+ * @brief 試行するフレーム数
+ */
+static uint32_t s_frames;
+
+/**
+ * @brief キャプチャ中のフレーム番号
+ */
+static uint32_t s_frame_index;
+
+/**
+ * @brief テスト開始時刻[マイクロ秒]
+ */
+static uint32_t s_test_begin;
+
+/**
+ * @brief キャプチャ開始時刻(設定反映待ち中は待ち開始時刻)[ミリ秒]
+ */
+static uint32_t s_capture_begin;
+
+/**
+ * @brief キャプチャ開始時刻[マイクロ秒]
+ */
+static uint32_t s_capture_begin_micros;
+
+/**
+ * @brief キャプチャ完了フラグ(割り込みで設定される)
+ */
+static volatile bool s_is_capture_done;
+
+/**
+ * @brief キャプチャ完了時のPDCステータス
+ */
+static struct pdc_status s_capture_status;
+
+/**
+ * @brief 期待値バッファ
+ */
+static uint32_t s_expected[EXPECTED_BUFFER_WORDS];
+
+/**
+ * @brief PDCループバックテスト完了時コールバック
+ */
+static void (*s_end_callback)(const struct selftest_pdc_result* presult);
+
+/**
+ * @brief バンド切り替え位置の測定完了時コールバック
+ */
+static void (*s_bands_end_callback)(const struct selftest_bands_result* presult);
+
+/**
+ * @brief セルフテストを初期化する。
+ */
+void selftest_init(void)
+{
+    s_state = SELFTEST_STATE_IDLE;
+    s_end_callback = NULL;
+    s_bands_end_callback = NULL;
+
+    return;
+}
+
+/**
+ * @brief PDCループバックテストを開始する。
+ *        現在のPDCキャプチャ範囲を使用する。キャプチャ範囲はテスト信号の有効表示領域内にある必要がある。
+ * @param frames テストするフレーム数
+ * @param pattern テストパターン
+ * @param callback テスト完了時に呼び出すコールバック関数(不要な場合にはNULL)
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int selftest_pdc_start(uint32_t frames, enum test_pattern pattern, void (*callback)(const struct selftest_pdc_result* presult))
+{
+    int retval = prepare_test(frames, pattern);
+    if (retval != 0)
+    {
+        return retval;
+    }
+
+    memset(&s_result, 0, sizeof(s_result));
+    s_result.pattern = pattern;
+    s_result.frames = frames;
+    s_result.line_bytes = s_line_bytes;
+    s_result.frame_bytes = (uint32_t)(s_line_bytes) * s_capture_lines;
+    s_type = SELFTEST_TYPE_PDC;
+    s_end_callback = callback;
+
+    return 0;
+}
+
+/**
+ * @brief バンド切り替え位置の測定を開始する。
+ *        現在のPDCキャプチャ範囲と、テスト信号のバンドテーブルを使用する。
+ *        キャプチャ範囲はテスト信号の有効表示領域内にある必要がある。
+ * @param frames 測定するフレーム数
+ * @param callback 測定完了時に呼び出すコールバック関数(不要な場合にはNULL)
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int selftest_bands_start(uint32_t frames, void (*callback)(const struct selftest_bands_result* presult))
+{
+    const struct test_signal_band* pbands;
+    if (test_signal_get_bands(&pbands) == 0)
+    {
+        return ENOENT;
+    }
+
+    int retval = prepare_test(frames, TEST_PATTERN_BANDS);
+    if (retval != 0)
+    {
+        return retval;
+    }
+
+    memset(&s_bands_result, 0, sizeof(s_bands_result));
+    s_bands_result.frames = frames;
+    setup_band_landings();
+    s_type = SELFTEST_TYPE_BANDS;
+    s_bands_end_callback = callback;
+
+    return 0;
+}
+
+/**
+ * @brief テスト実行中かどうかを得る。
+ * @return テスト実行中の場合にはtrue, それ以外はfalse.
+ */
+bool selftest_is_running(void)
+{
+    return (s_state != SELFTEST_STATE_IDLE) ? true : false;
+}
+
+/**
+ * @brief セルフテスト処理を更新する。
+ *        メインループから呼び出す。フレームの検証中以外は待たずに戻る。
+ */
+void selftest_update(void)
+{
+    switch (s_state)
+    {
+    case SELFTEST_STATE_SETTLE: {
+        if ((hwtick_get() - s_capture_begin) >= SIGNAL_SETTLE_MILLIS)
+        {
+            s_state = SELFTEST_STATE_START_CAPTURE;
+        }
+        break;
+    }
+    case SELFTEST_STATE_START_CAPTURE: {
+        s_is_capture_done = false;
+        s_capture_begin = hwtick_get();
+        s_capture_begin_micros = hwtick_get_micros();
+        if (pdc_start_capture(on_capture_done))
+        {
+            s_state = SELFTEST_STATE_CAPTURING;
+        }
+        else
+        {
+            count_dropped_frame();
+            s_frame_index++;
+            finish_test();
+        }
+        break;
+    }
+    case SELFTEST_STATE_CAPTURING: {
+        if (s_is_capture_done)
+        {
+            process_capture_done();
+        }
+        else if ((hwtick_get() - s_capture_begin) >= CAPTURE_TIMEOUT_MILLIS)
+        {
+            pdc_stop_capture();
+            count_dropped_frame();
+            s_frame_index++;
+            finish_test();
+        }
+        else
+        {
+            // 完了待ち
+        }
+        break;
+    }
+    case SELFTEST_STATE_IDLE:
+    default: {
+        break;
+    }
+    }
+
+    return;
+}
+
+/**
+ * @brief テストを準備する。
+ *        キャプチャ範囲を確認し、テスト信号とPDCの設定を保存してからテスト用に設定する。
+ * @param frames テストするフレーム数
+ * @param pattern テストパターン
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+static int prepare_test(uint32_t frames, enum test_pattern pattern)
+{
+    if ((frames == 0u) || (frames > SELFTEST_PDC_MAX_FRAMES))
+    {
+        return EINVAL;
+    }
+    if ((s_state != SELFTEST_STATE_IDLE) || pdc_is_busy())
+    {
+        return EBUSY;
+    }
+
+    uint16_t xst, xsize, yst, ysize;
+    uint8_t bpp;
+    if (!pdc_get_capture_range(&xst, &xsize, &yst, &ysize, &bpp))
+    {
+        return EIO;
+    }
+
+    // キャプチャ範囲を有効表示領域内の位置に変換する。
+    struct test_signal_timing timing;
+    test_signal_get_timing(&timing);
+    int32_t x = ((int32_t)(xst) * (int32_t)(bpp)) - (int32_t)(timing.hbp);
+    int32_t y = (int32_t)(yst) - (int32_t)(timing.vbp);
+    uint32_t line_bytes = (uint32_t)(xsize) * (uint32_t)(bpp);
+    if ((x < 0) || (y < 0) || (((uint32_t)(x) + line_bytes) > timing.hactive) || (((uint32_t)(y) + ysize) > timing.vactive))
+    {
+        return ERANGE;
+    }
+
+    s_saved.pattern = test_signal_get_pattern();
+    s_saved.is_stamp_enabled = test_signal_is_stamp_enabled();
+    s_saved.is_output = test_signal_is_output();
+    if (!pdc_get_signal_polarity(&(s_saved.is_hsync_hactive), &(s_saved.is_vsync_hactive)))
+    {
+        return EIO;
+    }
+    if (!pdc_set_signal_polarity(timing.is_hsync_hactive, timing.is_vsync_hactive) || !test_signal_set_pattern(pattern)
+        || !test_signal_set_stamp(false) || !test_signal_set_output(true))
+    {
+        restore_settings();
+        return EIO;
+    }
+
+    s_capture_x = (uint16_t)(x);
+    s_capture_y = (uint16_t)(y);
+    s_line_bytes = (uint16_t)(line_bytes);
+    s_capture_lines = ysize;
+    s_frames = frames;
+    s_frame_index = 0u;
+    s_test_begin = hwtick_get_micros();
+    s_capture_begin = hwtick_get();
+    pdc_claim("selftest");
+    s_state = SELFTEST_STATE_SETTLE;
+
+    return 0;
+}
+
+/**
+ * @brief キャプチャ完了時の処理を行う。
+ *        エラーなくフレームエンドまでキャプチャできた場合だけデータを検証する。
+ */
+static void process_capture_done(void)
+{
+    const struct pdc_status* pstat = &s_capture_status;
+    bool is_captured = pdc_is_frame_complete(pstat);
+
+    if (s_type == SELFTEST_TYPE_PDC)
+    {
+        s_result.capture_micros += hwtick_get_micros() - s_capture_begin_micros;
+    }
+    if (!is_captured)
+    {
+        count_dropped_frame();
+    }
+    else if (s_type == SELFTEST_TYPE_BANDS)
+    {
+        s_bands_result.captured_frames++;
+        measure_bands();
+    }
+    else
+    {
+        s_result.captured_frames++;
+        uint32_t begin = hwtick_get_micros();
+        verify_frame();
+        s_result.verify_micros += hwtick_get_micros() - begin;
+    }
+
+    s_frame_index++;
+    if (s_frame_index < s_frames)
+    {
+        s_state = SELFTEST_STATE_START_CAPTURE;
+    }
+    else
+    {
+        finish_test();
+    }
+
+    return;
+}
+
+/**
+ * @brief キャプチャしたフレームを期待値と比較する。
+ *        期待値を期待値バッファ単位で生成し、ワード単位で比較する。
+ */
+static void verify_frame(void)
+{
+    const uint8_t* pcaptured = pdc_get_capture_buffer();
+    uint32_t frame_bytes = s_result.frame_bytes;
+    uint16_t x = 0u; // キャプチャライン内位置
+    uint16_t y = 0u; // キャプチャライン番号
+    uint32_t frame_bit_errors = 0u;
+
+    for (uint32_t offset = 0u; offset < frame_bytes; offset += sizeof(s_expected))
+    {
+        uint32_t len = frame_bytes - offset;
+        if (len > sizeof(s_expected))
+        {
+            len = sizeof(s_expected);
+        }
+
+        uint8_t* pexpected = (uint8_t*)(s_expected);
+        for (uint32_t i = 0u; i < len; i++)
+        {
+            pexpected[i] = test_signal_get_pattern_value(s_result.pattern, (uint16_t)(s_capture_x + x), (uint16_t)(s_capture_y + y));
+            x++;
+            if (x >= s_line_bytes)
+            {
+                x = 0u;
+                y++;
+            }
+        }
+
+        uint32_t first_word;
+        uint32_t bit_errors = compare_words(s_expected, (const uint32_t*)(pcaptured + offset), len / sizeof(uint32_t), &first_word);
+        if ((bit_errors > 0u) && !s_result.has_bad_data)
+        {
+            const uint8_t* pactual = pcaptured + offset + (first_word * sizeof(uint32_t));
+            const uint8_t* pexpected_word = pexpected + (first_word * sizeof(uint32_t));
+            uint32_t i = 0u;
+            while ((i < (sizeof(uint32_t) - 1u)) && (pactual[i] == pexpected_word[i]))
+            {
+                i++;
+            }
+            s_result.has_bad_data = true;
+            s_result.first_bad_frame = s_frame_index;
+            s_result.first_bad_offset = offset + (first_word * sizeof(uint32_t)) + i;
+            s_result.first_bad_expected = pexpected_word[i];
+            s_result.first_bad_actual = pactual[i];
+        }
+        frame_bit_errors += bit_errors;
+    }
+
+    if (frame_bit_errors > 0u)
+    {
+        s_result.error_frames++;
+        s_result.bit_errors += frame_bit_errors;
+    }
+
+    return;
+}
+
+/**
+ * @brief バンド毎の測定結果を初期化する。
+ *        キャプチャ範囲内に開始ラインがあり、直前の値と異なるバンドだけを測定対象にする。
+ */
+static void setup_band_landings(void)
+{
+    const struct test_signal_band* pbands;
+    int count = test_signal_get_bands(&pbands);
+    struct test_signal_timing timing;
+    test_signal_get_timing(&timing);
+
+    s_bands_result.band_count = count;
+    s_bands_result.capture_start_clocks = (uint16_t)(timing.hsync + timing.hbp + s_capture_x);
+    s_bands_result.htotal_clocks = (uint16_t)(timing.hactive + timing.hfp + timing.hsync + timing.hbp);
+    s_bands_result.pixel_clock_hz = timing.pixel_clock_hz;
+
+    for (int i = 0; i < count; i++)
+    {
+        struct selftest_band_landing* planding = &(s_bands_result.landings[i]);
+        uint8_t prev_value = (i > 0) ? pbands[i - 1].value : test_signal_get_data();
+        planding->line = pbands[i].line;
+        planding->value = pbands[i].value;
+        planding->is_measurable = (pbands[i].value != prev_value) && (pbands[i].line >= s_capture_y)
+                                  && (pbands[i].line < (s_capture_y + s_capture_lines))
+                                  && (test_signal_get_pattern_value(TEST_PATTERN_BANDS, 0u, pbands[i].line) == pbands[i].value);
+        planding->min_clocks = INT32_MAX;
+        planding->max_clocks = INT32_MIN;
+    }
+
+    return;
+}
+
+/**
+ * @brief キャプチャしたフレームで、バンド毎に背景色が切り替わった位置を調べる。
+ *        開始ラインの1ライン前から次のバンドの開始ラインの手前までで、最初にバンドの値になった位置を切り替え位置とする。
+ *        (バンドの間隔は2ライン以上あるため、1ライン前は必ず直前の値になっている)
+ */
+static void measure_bands(void)
+{
+    for (int i = 0; i < s_bands_result.band_count; i++)
+    {
+        struct selftest_band_landing* planding = &(s_bands_result.landings[i]);
+        if (!planding->is_measurable)
+        {
+            continue;
+        }
+
+        uint16_t from_line = (planding->line > s_capture_y) ? (uint16_t)(planding->line - 1u) : s_capture_y;
+        uint16_t to_line = (uint16_t)(s_capture_y + s_capture_lines);
+        if (((i + 1) < s_bands_result.band_count) && (s_bands_result.landings[i + 1].line < to_line))
+        {
+            to_line = s_bands_result.landings[i + 1].line;
+        }
+
+        uint16_t line, x;
+        if (!find_band_switch(from_line, to_line, planding->value, &line, &x))
+        {
+            continue;
+        }
+        int32_t clocks = (((int32_t)(line) - (int32_t)(planding->line)) * (int32_t)(s_bands_result.htotal_clocks))
+                         + (int32_t)(s_bands_result.capture_start_clocks) + (int32_t)(x);
+        planding->found_frames++;
+        if ((line == planding->line) && (x == 0u))
+        {
+            planding->clean_frames++;
+        }
+        if (clocks < planding->min_clocks)
+        {
+            planding->min_clocks = clocks;
+        }
+        if (clocks > planding->max_clocks)
+        {
+            planding->max_clocks = clocks;
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief キャプチャデータから、最初に指定値になった位置を探す。
+ * @param from_line 探索開始ライン(有効表示領域先頭からのライン番号)
+ * @param to_line 探索終了ライン(このラインは含まない)
+ * @param value 値
+ * @param pline 見つかったライン番号を格納する変数
+ * @param px 見つかったキャプチャライン内の位置[byte]を格納する変数
+ * @return 見つかった場合にはtrue, 見つからない場合にはfalse.
+ */
+static bool find_band_switch(uint16_t from_line, uint16_t to_line, uint8_t value, uint16_t* pline, uint16_t* px)
+{
+    const uint8_t* pcaptured = pdc_get_capture_buffer();
+
+    for (uint16_t line = from_line; line < to_line; line++)
+    {
+        const uint8_t* pline_data = pcaptured + ((uint32_t)(line - s_capture_y) * s_line_bytes);
+        for (uint16_t x = 0u; x < s_line_bytes; x++)
+        {
+            if (pline_data[x] == value)
+            {
+                (*pline) = line;
+                (*px) = x;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief ワード列を比較し、不一致ビット数を数える。
+ * @param pexpected 期待値
+ * @param pactual 比較するデータ
+ * @param words ワード数
+ * @param pfirst_word 最初に不一致があったワード位置を格納する変数
+ * @return 不一致ビット数
+ */
+static uint32_t compare_words(const uint32_t* pexpected, const uint32_t* pactual, uint32_t words, uint32_t* pfirst_word)
+{
+    uint32_t bit_errors = 0u;
+
+    (*pfirst_word) = words;
+    for (uint32_t i = 0u; i < words; i++)
+    {
+        uint32_t diff = pexpected[i] ^ pactual[i];
+        if (diff != 0u)
+        {
+            if (bit_errors == 0u)
+            {
+                (*pfirst_word) = i;
+            }
+            bit_errors += count_bits(diff);
+        }
+    }
+
+    return bit_errors;
+}
+
+/**
+ * @brief 1になっているビット数を数える。
+ * @param value 値
+ * @return 1になっているビット数
+ */
+static uint32_t count_bits(uint32_t value)
+{
+    uint32_t v = value - ((value >> 1) & 0x55555555u);
+    v = (v & 0x33333333u) + ((v >> 2) & 0x33333333u);
+    v = (v + (v >> 4)) & 0x0F0F0F0Fu;
+
+    return (v * 0x01010101u) >> 24;
+}
+
+/**
+ * @brief キャプチャできなかったフレームを数える。
+ */
+static void count_dropped_frame(void)
+{
+    if (s_type == SELFTEST_TYPE_BANDS)
+    {
+        s_bands_result.dropped_frames++;
+    }
+    else
+    {
+        s_result.dropped_frames++;
+    }
+
+    return;
+}
+
+/**
+ * @brief テストを終了し、結果を通知する。
+ *        途中で中止した場合、試行フレーム数は実際に試行したフレーム数になる。
+ */
+static void finish_test(void)
+{
+    uint32_t elapsed = hwtick_get_micros() - s_test_begin;
+    restore_settings();
+    pdc_release();
+    s_state = SELFTEST_STATE_IDLE;
+
+    if (s_type == SELFTEST_TYPE_BANDS)
+    {
+        s_bands_result.elapsed_micros = elapsed;
+        s_bands_result.frames = s_frame_index;
+        if (s_bands_end_callback != NULL)
+        {
+            void (*callback)(const struct selftest_bands_result* presult) = s_bands_end_callback;
+            s_bands_end_callback = NULL;
+            callback(&s_bands_result);
+        }
+    }
+    else
+    {
+        s_result.elapsed_micros = elapsed;
+        s_result.frames = s_frame_index;
+        if (s_end_callback != NULL)
+        {
+            void (*callback)(const struct selftest_pdc_result* presult) = s_end_callback;
+            s_end_callback = NULL;
+            callback(&s_result);
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief テスト開始前の設定に戻す。
+ */
+static void restore_settings(void)
+{
+    test_signal_set_pattern(s_saved.pattern);
+    test_signal_set_stamp(s_saved.is_stamp_enabled);
+    test_signal_set_output(s_saved.is_output);
+    pdc_set_signal_polarity(s_saved.is_hsync_hactive, s_saved.is_vsync_hactive);
+
+    return;
+}
+
+/**
+ * @brief キャプチャ完了通知を受け取る。(割り込みコンテキスト)
+ * @param pstat PDCステータス
+ */
+static void on_capture_done(const struct pdc_status* pstat)
+{
+    s_capture_status = *pstat;
+    s_is_capture_done = true;
+
+    return;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file セルフテストインタフェース宣言
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+
+#ifndef SELFTEST_H_
+#define SELFTEST_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "test_signal.h"
+
+/**
+ * @brief PDCループバックテストの最大フレーム数
+ */
+#define SELFTEST_PDC_MAX_FRAMES (1000)
+
+/**
+ * @brief PDCループバックテスト結果
+ */
+struct selftest_pdc_result
+{
+    enum test_pattern pattern;  // テストパターン
+    uint32_t frames;            // 試行フレーム数
+    uint32_t captured_frames;   // キャプチャできたフレーム数
+    uint32_t dropped_frames;    // キャプチャできなかったフレーム数(エラー, タイムアウト)
+    uint32_t error_frames;      // データ不一致があったフレーム数
+    uint32_t bit_errors;        // 不一致ビット数
+    bool has_bad_data;          // データ不一致があったかどうか
+    uint32_t first_bad_frame;   // 最初に不一致があったフレーム番号
+    uint32_t first_bad_offset;  // 最初に不一致があったフレーム内オフセット[byte]
+    uint8_t first_bad_expected; // 最初の不一致の期待値
+    uint8_t first_bad_actual;   // 最初の不一致の実際の値
+    uint16_t line_bytes;        // 1ラインのキャプチャバイト数
+    uint32_t frame_bytes;       // 1フレームのキャプチャバイト数
+    uint32_t elapsed_micros;    // テスト全体の所要時間[マイクロ秒]
+    uint32_t capture_micros;    // キャプチャ所要時間の合計[マイクロ秒]
+    uint32_t verify_micros;     // 検証所要時間の合計[マイクロ秒]
+};
+
+/**
+ * @brief バンド切り替え位置の測定結果
+ *        切り替え位置はバンド開始ラインのHSync開始からのピクセルクロック数で表す。
+ *        キャプチャ範囲の先頭で切り替わっていた場合には、それより前のどこで切り替わったかは分からないため、
+ *        キャプチャ範囲の先頭位置(上限値)として扱う。
+ */
+struct selftest_band_landing
+{
+    uint16_t line;         // バンドの開始ライン
+    uint8_t value;         // バンドの値
+    bool is_measurable;    // 測定対象かどうか(キャプチャ範囲内で、直前と値が異なる)
+    uint32_t found_frames; // 切り替わりを検出できたフレーム数
+    uint32_t clean_frames; // 開始ラインのキャプチャ範囲より前で切り替わったフレーム数
+    int32_t min_clocks;    // 切り替わり位置の最小値[pixel clock]
+    int32_t max_clocks;    // 切り替わり位置の最大値[pixel clock]
+};
+
+/**
+ * @brief バンド切り替え位置の測定結果
+ */
+struct selftest_bands_result
+{
+    uint32_t frames;                                              // 試行フレーム数
+    uint32_t captured_frames;                                     // キャプチャできたフレーム数
+    uint32_t dropped_frames;                                      // キャプチャできなかったフレーム数(エラー, タイムアウト)
+    int band_count;                                               // バンド数
+    struct selftest_band_landing landings[TEST_SIGNAL_MAX_BANDS]; // バンド毎の測定結果
+    uint16_t capture_start_clocks;                                // HSync開始からキャプチャ範囲の先頭までのピクセルクロック数
+    uint16_t htotal_clocks;                                       // 1ラインのピクセルクロック数
+    uint32_t pixel_clock_hz;                                      // ピクセルクロック[Hz]
+    uint32_t elapsed_micros;                                      // テスト全体の所要時間[マイクロ秒]
+};
+
+void selftest_init(void);
+void selftest_update(void);
+int selftest_pdc_start(uint32_t frames, enum test_pattern pattern, void (*callback)(const struct selftest_pdc_result* presult));
+int selftest_bands_start(uint32_t frames, void (*callback)(const struct selftest_bands_result* presult));
+bool selftest_is_running(void);
+
+#endif /* SELFTEST_H_ */
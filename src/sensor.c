@@ -0,0 +1,327 @@
+/**
+ * @file イメージセンサインタフェース定義
+ *        登録されたセンサドライバを順に検出し、検出したセンサのモード切り替え、
+ *        露光時間/ゲイン設定、出力ON/OFFを行う。
+ *        モード切り替え時にはPDCのキャプチャ範囲と同期信号極性も合わせて設定する。
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+
+#include "i2c.h"
+#include "pdc.h"
+#include "sensor_driver.h"
+#include "sensor.h"
+
+/**
+ * @brief レジスタアクセスのタイムアウト時間[ミリ秒]
+ */
+#define SENSOR_REG_TIMEOUT_MILLIS (100)
+
+static const struct sensor_mode* find_mode(const char* name);
+static int write_mode_regs(const struct sensor_mode* pnew, const struct sensor_mode* pcur);
+
+//@formatter:off
+/**
+ * @brief センサドライバ一覧。先頭から順に検出を試みる。
+ */
+static const struct sensor_driver* const s_drivers[] = {
+    &sensor_ov7670_driver,
+    &sensor_loopback_driver,
+};
+//@formatter:on
+
+/**
+ * @brief センサドライバ数
+ */
+static const int s_driver_count = (int)(sizeof(s_drivers) / sizeof(s_drivers[0]));
+
+/**
+ * @brief 検出したセンサドライバ
+ */
+static const struct sensor_driver* s_driver;
+
+/**
+ * @brief 現在のモード(センサのレジスタ状態が不明な場合にはNULL)
+ */
+static const struct sensor_mode* s_mode;
+
+/**
+ * @brief 出力中かどうか
+ */
+static bool s_is_streaming;
+
+/**
+ * @brief センサインタフェースを初期化する。
+ *        センサの検出はsensor_probe()で行う。
+ */
+void sensor_init(void)
+{
+    s_driver = NULL;
+    s_mode = NULL;
+    s_is_streaming = false;
+
+    return;
+}
+
+/**
+ * @brief センサを検出する。
+ *        登録されたドライバを順に試し、最初に検出できたセンサを使用する。
+ *        検出後のモードは未設定状態になる。
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int sensor_probe(void)
+{
+    int retval = ENODEV;
+
+    s_driver = NULL;
+    s_mode = NULL;
+    s_is_streaming = false;
+    for (int i = 0; i < s_driver_count; i++)
+    {
+        const struct sensor_driver* pdriver = s_drivers[i];
+        if (pdriver->probe() == 0)
+        {
+            s_driver = pdriver;
+            retval = 0;
+            break;
+        }
+    }
+
+    return retval;
+}
+
+/**
+ * @brief 検出したセンサドライバを得る。
+ * @return センサドライバ。検出していない場合にはNULL.
+ */
+const struct sensor_driver* sensor_get_driver(void)
+{
+    return s_driver;
+}
+
+/**
+ * @brief センサのモードを設定する。
+ *        PDCのキャプチャ範囲と同期信号極性をモードに合わせて設定し、
+ *        センサには現在のモードと値が異なるレジスタだけを書き込む。
+ *        いずれかに失敗した場合には、PDC設定を元に戻す。
+ *        キャプチャ動作中は設定できない。
+ * @param name モード名
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int sensor_set_mode(const char* name)
+{
+    if (s_driver == NULL)
+    {
+        return ENODEV;
+    }
+    const struct sensor_mode* pmode = find_mode(name);
+    if (pmode == NULL)
+    {
+        return EINVAL;
+    }
+    if (pdc_is_running())
+    {
+        return EBUSY;
+    }
+
+    uint16_t xst, xsize, yst, ysize;
+    uint8_t bpp;
+    bool is_hsync_hactive, is_vsync_hactive;
+    if (!pdc_get_capture_range(&xst, &xsize, &yst, &ysize, &bpp) || !pdc_get_signal_polarity(&is_hsync_hactive, &is_vsync_hactive))
+    {
+        return EIO;
+    }
+
+    if (!pdc_set_capture_range(pmode->xst, pmode->xsize, pmode->yst, pmode->ysize, pmode->bpp))
+    {
+        return EINVAL;
+    }
+    if (!pdc_set_signal_polarity(pmode->is_hsync_hactive, pmode->is_vsync_hactive))
+    {
+        pdc_set_capture_range(xst, xsize, yst, ysize, bpp);
+        return EIO;
+    }
+
+    int retval = write_mode_regs(pmode, s_mode);
+    if (retval == 0)
+    {
+        s_mode = pmode;
+    }
+    else
+    {
+        // センサのレジスタは途中まで書き込まれているので、次回は全レジスタを書き込む。
+        s_mode = NULL;
+        pdc_set_capture_range(xst, xsize, yst, ysize, bpp);
+        pdc_set_signal_polarity(is_hsync_hactive, is_vsync_hactive);
+    }
+
+    return retval;
+}
+
+/**
+ * @brief 現在のモードを得る。
+ * @return モード。未設定の場合にはNULL.
+ */
+const struct sensor_mode* sensor_get_mode(void)
+{
+    return s_mode;
+}
+
+/**
+ * @brief 露光時間を設定する。
+ * @param exposure 露光時間[line]
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int sensor_set_exposure(uint32_t exposure)
+{
+    if (s_driver == NULL)
+    {
+        return ENODEV;
+    }
+
+    return (s_driver->set_exposure != NULL) ? s_driver->set_exposure(exposure) : ENOTSUP;
+}
+
+/**
+ * @brief ゲインを設定する。
+ * @param gain ゲイン(16で1倍)
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int sensor_set_gain(uint16_t gain)
+{
+    if (s_driver == NULL)
+    {
+        return ENODEV;
+    }
+
+    return (s_driver->set_gain != NULL) ? s_driver->set_gain(gain) : ENOTSUP;
+}
+
+/**
+ * @brief sensor_set_gain() で実際に設定されるゲインを得る。
+ *        センサのゲインの分解能で丸めた値になる。
+ * @param gain ゲイン(16で1倍)
+ * @return 設定されるゲイン(16で1倍)
+ */
+uint16_t sensor_round_gain(uint16_t gain)
+{
+    if ((s_driver == NULL) || (s_driver->round_gain == NULL))
+    {
+        return gain;
+    }
+
+    return s_driver->round_gain(gain);
+}
+
+/**
+ * @brief センサの出力をON/OFFする。
+ * @param is_on 出力する場合にはtrue, 停止する場合にはfalse.
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int sensor_set_stream(bool is_on)
+{
+    if (s_driver == NULL)
+    {
+        return ENODEV;
+    }
+
+    int retval = (s_driver->set_stream != NULL) ? s_driver->set_stream(is_on) : ENOTSUP;
+    if (retval == 0)
+    {
+        s_is_streaming = is_on;
+    }
+
+    return retval;
+}
+
+/**
+ * @brief センサが出力中かどうかを得る。
+ * @return 出力中の場合にはtrue, それ以外はfalse.
+ */
+bool sensor_is_streaming(void)
+{
+    return s_is_streaming;
+}
+
+/**
+ * @brief センサのレジスタに書き込む。(SCCB 3フェーズライト)
+ * @param slave_addr スレーブアドレス
+ * @param reg レジスタアドレス
+ * @param value 書き込む値
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int sensor_write_reg(uint8_t slave_addr, uint8_t reg, uint8_t value)
+{
+    uint8_t tx_data[2] = { reg, value };
+
+    return i2c_master_send_sync(slave_addr, tx_data, sizeof(tx_data), SENSOR_REG_TIMEOUT_MILLIS);
+}
+
+/**
+ * @brief センサのレジスタを読み出す。
+ *        SCCBはリピートスタートに対応しないため、アドレス送信と受信を別トランザクションで行う。
+ * @param slave_addr スレーブアドレス
+ * @param reg レジスタアドレス
+ * @param pvalue 読み出した値を格納する変数
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int sensor_read_reg(uint8_t slave_addr, uint8_t reg, uint8_t* pvalue)
+{
+    int retval = i2c_master_send_sync(slave_addr, &reg, 1, SENSOR_REG_TIMEOUT_MILLIS);
+    if (retval == 0)
+    {
+        retval = i2c_master_receive_sync(slave_addr, pvalue, 1, SENSOR_REG_TIMEOUT_MILLIS);
+    }
+
+    return retval;
+}
+
+/**
+ * @brief 検出したセンサのモードを名前で検索する。
+ * @param name モード名
+ * @return モード。見つからない場合にはNULL.
+ */
+static const struct sensor_mode* find_mode(const char* name)
+{
+    const struct sensor_mode* pmode = NULL;
+
+    for (uint8_t i = 0u; i < s_driver->mode_count; i++)
+    {
+        if (strcmp(s_driver->modes[i].name, name) == 0)
+        {
+            pmode = &(s_driver->modes[i]);
+            break;
+        }
+    }
+
+    return pmode;
+}
+
+/**
+ * @brief モードレジスタを書き込む。
+ *        現在のモードが分かっている場合には、値が異なるレジスタだけを書き込む。
+ * @param pnew 設定するモード
+ * @param pcur 現在のモード(不明な場合にはNULL)
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+static int write_mode_regs(const struct sensor_mode* pnew, const struct sensor_mode* pcur)
+{
+    int retval = 0;
+
+    for (uint8_t i = 0u; i < s_driver->mode_reg_count; i++)
+    {
+        if ((pcur != NULL) && (pcur->reg_values[i] == pnew->reg_values[i]))
+        {
+            continue;
+        }
+        retval = sensor_write_reg(s_driver->slave_addr, s_driver->mode_reg_addrs[i], pnew->reg_values[i]);
+        if (retval != 0)
+        {
+            break;
+        }
+    }
+
+    return retval;
+}
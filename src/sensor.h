@@ -0,0 +1,66 @@
+/**
+ * @file イメージセンサインタフェース宣言
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+
+#ifndef SENSOR_H_
+#define SENSOR_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief センサ動作モード
+ *        センサのレジスタ設定値と、そのモードで出力される信号に合わせたPDC設定を持つ。
+ */
+struct sensor_mode
+{
+    const char* name;          // モード名
+    uint16_t width;            // 出力画像幅[pixel]
+    uint16_t height;           // 出力画像高さ[line]
+    uint16_t xst;              // PDC 水平方向キャプチャ開始位置[pixel]
+    uint16_t xsize;            // PDC 水平方向キャプチャサイズ[pixel]
+    uint16_t yst;              // PDC 垂直方向キャプチャ開始位置[line]
+    uint16_t ysize;            // PDC 垂直方向キャプチャサイズ[line]
+    uint8_t bpp;               // 1ピクセルあたりのバイト数
+    uint16_t frame_lines;      // 1フレームの総ライン数(垂直ブランキングを含む, 露光時間の単位。0:不明)
+    bool is_hsync_hactive;     // HSync極性(true:H-Active, false:L-Active)
+    bool is_vsync_hactive;     // VSync極性(true:H-Active, false:L-Active)
+    const uint8_t* reg_values; // モードレジスタ設定値(sensor_driver.mode_reg_addrs と同じ並び)
+};
+
+/**
+ * @brief センサドライバ
+ *        モードによって変わるレジスタは、全モード共通のアドレス列(mode_reg_addrs)として定義し、
+ *        各モードはその並びで設定値を持つ。モード切り替え時は、値が異なるレジスタだけを書き込む。
+ */
+struct sensor_driver
+{
+    const char* name;                       // センサ名
+    uint8_t slave_addr;                     // I2Cスレーブアドレス
+    const uint8_t* mode_reg_addrs;          // モードレジスタアドレス列
+    uint8_t mode_reg_count;                 // モードレジスタ数
+    const struct sensor_mode* modes;        // モードテーブル
+    uint8_t mode_count;                     // モード数
+    int (*probe)(void);                     // 検出と初期化
+    int (*set_exposure)(uint32_t exposure); // 露光時間設定[line]
+    int (*set_gain)(uint16_t gain);         // ゲイン設定(16で1倍)
+    uint16_t (*round_gain)(uint16_t gain);  // 設定されるゲインを得る(ゲインの分解能で丸める。NULL:丸めない)
+    int (*set_stream)(bool is_on);          // 出力ON/OFF
+};
+
+void sensor_init(void);
+int sensor_probe(void);
+const struct sensor_driver* sensor_get_driver(void);
+int sensor_set_mode(const char* name);
+const struct sensor_mode* sensor_get_mode(void);
+int sensor_set_exposure(uint32_t exposure);
+int sensor_set_gain(uint16_t gain);
+uint16_t sensor_round_gain(uint16_t gain);
+int sensor_set_stream(bool is_on);
+bool sensor_is_streaming(void);
+
+int sensor_write_reg(uint8_t slave_addr, uint8_t reg, uint8_t value);
+int sensor_read_reg(uint8_t slave_addr, uint8_t reg, uint8_t* pvalue);
+
+#endif /* SENSOR_H_ */
@@ -0,0 +1,365 @@
+/**
+ * @file 自動露出(AE/AGC)定義
+ *        フレーム毎の輝度統計から平均輝度を求め、目標との比で露光量(露光時間 x ゲイン)を補正する。
+ *        補正量は damping[%] で減衰させ、比は1フレームあたり 1/4〜4倍に制限する。
+ *        白側の飽和ピクセルが多い場合は、平均輝度が目標以下でも露光量を下げる。
+ *        露光量はノイズの少ない露光時間から割り当て、露光時間が上限に達した分だけゲインを上げる。
+ *        露光時間の上限は、現在のモードの1フレームの総ライン数からフレームレートを下げない範囲に制限する。
+ *        ゲインはセンサの分解能で丸め、実際に設定される値を状態に記録する。
+ *
+ *        開始すると、pdc_stream のフレーム完了通知に登録する。通知はフレームエンド直後(垂直ブランキング中)に
+ *        メインループのコンテキストで呼ばれるため、その場でI2C経由でセンサに書き込む。
+ *        センサは変更を次のフレームから反映するため、変更後 settle_frames フレームは統計を使わない。
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+
+#include "sensor.h"
+#include "pdc_stream.h"
+#include "sensor_ae.h"
+
+/**
+ * @brief 白側の飽和ピクセルの許容割合[%]
+ */
+#define CLIP_LIMIT_PERCENT (2u)
+
+/**
+ * @brief 飽和ピクセルが多い場合の露光量の補正比(Q8, 7/8倍)
+ */
+#define CLIP_RATIO_Q8 (224u)
+
+/**
+ * @brief 1フレームあたりの補正比の最小値(Q8, 1/4倍)
+ */
+#define MIN_RATIO_Q8 (64u)
+
+/**
+ * @brief 1フレームあたりの補正比の最大値(Q8, 4倍)
+ */
+#define MAX_RATIO_Q8 (1024u)
+
+/**
+ * @brief ゲイン1倍の値
+ */
+#define GAIN_UNITY (16u)
+
+/**
+ * @brief 露光時間の上限を1フレームの総ライン数より短くするライン数
+ *        総ライン数を超えて露光するとセンサがフレームを延長し、フレームレートが下がる。
+ */
+#define EXPOSURE_MARGIN_LINES (10u)
+
+static int apply(uint32_t exposure, uint16_t gain);
+static void split_exposure(uint64_t amount, uint32_t* pexposure, uint16_t* pgain);
+static void on_frame(const struct yuv_stats* pstats);
+
+/**
+ * @brief 自動露出設定
+ */
+static struct sensor_ae_config s_config;
+
+/**
+ * @brief 自動露出状態
+ */
+static struct sensor_ae_state s_state;
+
+/**
+ * @brief 統計を使わずに捨てる残りフレーム数
+ */
+static uint8_t s_settle_remain;
+
+/**
+ * @brief 自動露出を初期化する。
+ */
+void sensor_ae_init(void)
+{
+    s_config.target = SENSOR_AE_DEFAULT_TARGET;
+    s_config.tolerance = SENSOR_AE_DEFAULT_TOLERANCE;
+    s_config.damping = SENSOR_AE_DEFAULT_DAMPING;
+    s_config.settle_frames = SENSOR_AE_DEFAULT_SETTLE_FRAMES;
+    s_config.min_exposure = 1u;
+    s_config.max_exposure = SENSOR_AE_DEFAULT_MAX_EXPOSURE;
+    s_config.min_gain = GAIN_UNITY;
+    s_config.max_gain = GAIN_UNITY * 8u;
+
+    memset(&s_state, 0, sizeof(s_state));
+    s_state.exposure = SENSOR_AE_INITIAL_EXPOSURE;
+    s_state.gain = SENSOR_AE_INITIAL_GAIN;
+    s_settle_remain = 0u;
+
+    return;
+}
+
+/**
+ * @brief 自動露出設定を変更する。動作中でも変更できる。
+ * @param pconfig 設定
+ * @return 成功した場合にはtrue, 設定値が不正な場合にはfalse.
+ */
+bool sensor_ae_set_config(const struct sensor_ae_config* pconfig)
+{
+    if ((pconfig->damping == 0u) || (pconfig->damping > 100u) || (pconfig->min_exposure == 0u)
+        || (pconfig->min_exposure > pconfig->max_exposure) || (pconfig->min_gain < GAIN_UNITY)
+        || (pconfig->min_gain > pconfig->max_gain))
+    {
+        return false;
+    }
+    s_config = *pconfig;
+
+    return true;
+}
+
+/**
+ * @brief 自動露出設定を得る。
+ * @param pconfig 設定を格納する構造体
+ */
+void sensor_ae_get_config(struct sensor_ae_config* pconfig)
+{
+    (*pconfig) = s_config;
+
+    return;
+}
+
+/**
+ * @brief 実際に使用する露光時間の上限を得る。
+ *        設定の上限を、現在のモードのフレームレートを下げない範囲(1フレームの総ライン数 - EXPOSURE_MARGIN_LINES)に制限する。
+ *        モードの総ライン数が不明な場合は設定の上限になる。下限を下回る場合は下限になる。
+ * @return 露光時間の上限[line]
+ */
+uint32_t sensor_ae_get_max_exposure(void)
+{
+    uint32_t max_exposure = s_config.max_exposure;
+    const struct sensor_mode* pmode = sensor_get_mode();
+
+    if ((pmode != NULL) && (pmode->frame_lines > EXPOSURE_MARGIN_LINES))
+    {
+        uint32_t mode_limit = (uint32_t)(pmode->frame_lines) - EXPOSURE_MARGIN_LINES;
+        max_exposure = (max_exposure > mode_limit) ? mode_limit : max_exposure;
+    }
+
+    return (max_exposure < s_config.min_exposure) ? s_config.min_exposure : max_exposure;
+}
+
+/**
+ * @brief 自動露出を開始する。
+ *        前回の露光時間/ゲイン(初回は SENSOR_AE_INITIAL_EXPOSURE, SENSOR_AE_INITIAL_GAIN)を、
+ *        設定範囲と現在のモードの露光時間の上限に収めてセンサに設定し、
+ *        pdc_stream のフレーム完了通知に登録する。
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+int sensor_ae_start(void)
+{
+    uint32_t exposure;
+    uint16_t gain;
+
+    split_exposure((uint64_t)(s_state.exposure) * s_state.gain, &exposure, &gain);
+    int retval = apply(exposure, gain);
+    if (retval != 0)
+    {
+        return retval;
+    }
+
+    s_state.is_enabled = true;
+    s_state.is_converged = false;
+    s_state.is_limited = false;
+    s_state.frames = 0u;
+    s_state.settled = 0u;
+    s_state.updates = 0u;
+    s_state.errors = 0u;
+    pdc_stream_set_frame_callback(on_frame);
+
+    return 0;
+}
+
+/**
+ * @brief 自動露出を停止する。露光時間/ゲインはそのままになる。
+ */
+void sensor_ae_stop(void)
+{
+    if (s_state.is_enabled)
+    {
+        pdc_stream_set_frame_callback(NULL);
+        s_state.is_enabled = false;
+    }
+
+    return;
+}
+
+/**
+ * @brief 自動露出が動作中かどうかを得る。
+ * @return 動作中の場合にはtrue, それ以外はfalse.
+ */
+bool sensor_ae_is_enabled(void)
+{
+    return s_state.is_enabled;
+}
+
+/**
+ * @brief 自動露出状態を得る。
+ * @param pstate 状態を格納する構造体
+ */
+void sensor_ae_get_state(struct sensor_ae_state* pstate)
+{
+    (*pstate) = s_state;
+
+    return;
+}
+
+/**
+ * @brief 1フレームの統計情報から露光量を補正し、センサに設定する。
+ * @param pstats フレームの統計情報
+ * @return 成功した場合(補正不要の場合を含む)には0, 失敗した場合にはエラー番号を返す。
+ */
+int sensor_ae_process(const struct yuv_stats* pstats)
+{
+    if (!s_state.is_enabled)
+    {
+        return EINVAL;
+    }
+    if ((pstats == NULL) || (pstats->pixels == 0u))
+    {
+        return EINVAL;
+    }
+    s_state.frames++;
+    if (s_settle_remain > 0u) // 前回の変更がまだ反映されていない？
+    {
+        s_settle_remain--;
+        s_state.settled++;
+        return 0;
+    }
+
+    uint32_t mean = pstats->y_sum / pstats->pixels;
+    s_state.last_mean = (uint8_t)(mean);
+    bool is_clipped = (pstats->y_clip_high * 100u) > (pstats->pixels * CLIP_LIMIT_PERCENT);
+    uint32_t ratio_q8;
+    if (is_clipped && (mean <= ((uint32_t)(s_config.target) + s_config.tolerance)))
+    {
+        ratio_q8 = CLIP_RATIO_Q8;
+    }
+    else if (((mean > s_config.target) ? (mean - s_config.target) : (s_config.target - mean)) <= s_config.tolerance)
+    {
+        s_state.is_converged = true;
+        s_state.is_limited = false;
+        return 0;
+    }
+    else
+    {
+        ratio_q8 = ((uint32_t)(s_config.target) * 256u) / ((mean > 0u) ? mean : 1u);
+        ratio_q8 = (ratio_q8 < MIN_RATIO_Q8) ? MIN_RATIO_Q8 : ((ratio_q8 > MAX_RATIO_Q8) ? MAX_RATIO_Q8 : ratio_q8);
+    }
+    s_state.is_converged = false;
+
+    // 補正比を damping[%] だけ適用する。
+    int32_t step_q8 = 256 + ((((int32_t)(ratio_q8) - 256) * (int32_t)(s_config.damping)) / 100);
+    uint64_t current = (uint64_t)(s_state.exposure) * s_state.gain;
+    uint64_t amount = (current * (uint32_t)(step_q8)) / 256u;
+    if ((step_q8 > 256) && (amount <= current)) // 露光時間が短い場合でも最低1ラインは変える。
+    {
+        amount = current + s_config.min_gain;
+    }
+    else if ((step_q8 < 256) && (amount >= current) && (current > s_config.min_gain))
+    {
+        amount = current - s_config.min_gain;
+    }
+    else
+    {
+        // 補正量どおり
+    }
+
+    uint32_t exposure;
+    uint16_t gain;
+    split_exposure(amount, &exposure, &gain);
+    if ((exposure == s_state.exposure) && (gain == s_state.gain))
+    {
+        s_state.is_limited = true;
+        return 0;
+    }
+    s_state.is_limited = false;
+
+    return apply(exposure, gain);
+}
+
+/**
+ * @brief 露光時間とゲインをセンサに設定する。
+ *        変更したものだけを書き込み、書き込んだ場合は settle_frames フレームを捨てる。
+ * @param exposure 露光時間[line]
+ * @param gain ゲイン(16で1倍)
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+static int apply(uint32_t exposure, uint16_t gain)
+{
+    int retval = 0;
+    bool is_first = !s_state.is_enabled; // 開始時はセンサの値が分からないため両方書き込む。
+
+    if (is_first || (exposure != s_state.exposure))
+    {
+        retval = sensor_set_exposure(exposure);
+        if (retval == 0)
+        {
+            s_state.exposure = exposure;
+        }
+    }
+    if ((retval == 0) && (is_first || (gain != s_state.gain)))
+    {
+        retval = sensor_set_gain(gain);
+        if (retval == 0)
+        {
+            s_state.gain = gain;
+        }
+    }
+    if (retval != 0)
+    {
+        s_state.errors++;
+        return retval;
+    }
+    s_state.updates++;
+    s_settle_remain = s_config.settle_frames;
+
+    return 0;
+}
+
+/**
+ * @brief 露光量(露光時間[line] x ゲイン)を露光時間とゲインに分ける。
+ *        ゲインは最小にして露光時間から割り当て、露光時間が上限に達した分をゲインで補う。
+ *        ゲインはセンサに実際に設定される値に丸める。
+ * @param amount 露光量(ゲインは16で1倍)
+ * @param pexposure 露光時間[line]を格納する変数
+ * @param pgain ゲインを格納する変数
+ */
+static void split_exposure(uint64_t amount, uint32_t* pexposure, uint16_t* pgain)
+{
+    uint32_t max_exposure = sensor_ae_get_max_exposure();
+    uint64_t exposure = amount / s_config.min_gain;
+    uint64_t gain = s_config.min_gain;
+
+    if (exposure > max_exposure)
+    {
+        exposure = max_exposure;
+        gain = amount / exposure;
+        gain = (gain > s_config.max_gain) ? s_config.max_gain : gain;
+    }
+    else if (exposure < s_config.min_exposure)
+    {
+        exposure = s_config.min_exposure;
+    }
+    else
+    {
+        // 範囲内
+    }
+    (*pexposure) = (uint32_t)(exposure);
+    (*pgain) = sensor_round_gain((uint16_t)(gain));
+
+    return;
+}
+
+/**
+ * @brief pdc_stream のフレーム完了通知を受け取る。(メインループのコンテキスト)
+ * @param pstats フレームの統計情報
+ */
+static void on_frame(const struct yuv_stats* pstats)
+{
+    sensor_ae_process(pstats);
+
+    return;
+}
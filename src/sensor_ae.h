@@ -0,0 +1,93 @@
+/**
+ * @file 自動露出(AE/AGC)のインタフェース宣言
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+
+#ifndef SENSOR_AE_H_
+#define SENSOR_AE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "yuv.h"
+
+/**
+ * @brief 目標平均輝度の初期値
+ */
+#define SENSOR_AE_DEFAULT_TARGET (110)
+
+/**
+ * @brief 不感帯の初期値
+ */
+#define SENSOR_AE_DEFAULT_TOLERANCE (6)
+
+/**
+ * @brief 1フレームで補正する割合の初期値[%]
+ */
+#define SENSOR_AE_DEFAULT_DAMPING (70)
+
+/**
+ * @brief 設定変更後に捨てるフレーム数の初期値
+ *        センサは露光時間/ゲインの変更を次のフレームから反映するため、変更直後の1フレームは使わない。
+ */
+#define SENSOR_AE_DEFAULT_SETTLE_FRAMES (1)
+
+/**
+ * @brief 露光時間の上限の初期値[line]
+ *        実際の上限は、現在のモードのフレームレートを下げない範囲に制限される。(sensor_ae_get_max_exposure()を参照)
+ */
+#define SENSOR_AE_DEFAULT_MAX_EXPOSURE (0xFFFF)
+
+/**
+ * @brief 開始時の露光時間[line]
+ */
+#define SENSOR_AE_INITIAL_EXPOSURE (256)
+
+/**
+ * @brief 開始時のゲイン(16で1倍)
+ */
+#define SENSOR_AE_INITIAL_GAIN (16)
+
+/**
+ * @brief 自動露出設定
+ */
+struct sensor_ae_config
+{
+    uint8_t target;        // 目標平均輝度
+    uint8_t tolerance;     // 不感帯(平均輝度と目標の差がこの値以下の場合は変更しない)
+    uint8_t damping;       // 1フレームで補正する割合[%] (1〜100)
+    uint8_t settle_frames; // 設定変更後に捨てるフレーム数
+    uint32_t min_exposure; // 露光時間の最小値[line]
+    uint32_t max_exposure; // 露光時間の最大値[line]
+    uint16_t min_gain;     // ゲインの最小値(16で1倍)
+    uint16_t max_gain;     // ゲインの最大値(16で1倍)
+};
+
+/**
+ * @brief 自動露出状態
+ */
+struct sensor_ae_state
+{
+    bool is_enabled;   // 動作中かどうか
+    bool is_converged; // 平均輝度が目標の不感帯内にあるかどうか
+    bool is_limited;   // 露光時間/ゲインが上限/下限に達したか、ゲインの分解能が足りずに補正できないかどうか
+    uint32_t exposure; // 現在の露光時間[line]
+    uint16_t gain;     // 現在のゲイン(16で1倍, センサに設定された値)
+    uint8_t last_mean; // 直前のフレームの平均輝度
+    uint32_t frames;   // 処理したフレーム数
+    uint32_t settled;  // 設定変更直後のため捨てたフレーム数
+    uint32_t updates;  // 露光時間/ゲインを変更した回数
+    uint32_t errors;   // センサへの設定に失敗した回数
+};
+
+void sensor_ae_init(void);
+bool sensor_ae_set_config(const struct sensor_ae_config* pconfig);
+void sensor_ae_get_config(struct sensor_ae_config* pconfig);
+uint32_t sensor_ae_get_max_exposure(void);
+int sensor_ae_start(void);
+void sensor_ae_stop(void);
+bool sensor_ae_is_enabled(void);
+void sensor_ae_get_state(struct sensor_ae_state* pstate);
+int sensor_ae_process(const struct yuv_stats* pstats);
+
+#endif /* SENSOR_AE_H_ */
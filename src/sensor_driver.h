@@ -0,0 +1,14 @@
+/**
+ * @file センサドライバ一覧の宣言
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+
+#ifndef SENSOR_DRIVER_H_
+#define SENSOR_DRIVER_H_
+
+#include "sensor.h"
+
+extern const struct sensor_driver sensor_ov7670_driver;
+extern const struct sensor_driver sensor_loopback_driver;
+
+#endif /* SENSOR_DRIVER_H_ */
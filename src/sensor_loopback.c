@@ -0,0 +1,68 @@
+/**
+ * @file ループバック センサドライバ定義
+ *        GLCDCのテスト信号出力をPDCに折り返し接続した構成を、センサの1つとして扱う。
+ *        テスト信号は640x480 YUYV(1ライン1280バイト)で、水平バックポーチ612バイト、
+ *        垂直バックポーチ10ラインの位置から有効データになる。
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stddef.h>
+#include <errno.h>
+
+#include "test_signal.h"
+#include "sensor_driver.h"
+#include "sensor.h"
+
+static int loopback_probe(void);
+static int loopback_set_stream(bool is_on);
+
+//@formatter:off
+/**
+ * @brief モードテーブル
+ *        水平開始位置はバックポーチ612バイト/2バイト = 306ピクセル。
+ *        fullはRAM2(512KB)に収まる400ラインまでをキャプチャする。
+ */
+static const struct sensor_mode s_modes[] = {
+    { .name = "default", .width = 480, .height = 200,
+      .xst = 306, .xsize = 480, .yst = 10, .ysize = 200, .bpp = 2, .frame_lines = 0,
+      .is_hsync_hactive = true, .is_vsync_hactive = false, .reg_values = NULL },
+    { .name = "full", .width = 640, .height = 400,
+      .xst = 306, .xsize = 640, .yst = 10, .ysize = 400, .bpp = 2, .frame_lines = 0,
+      .is_hsync_hactive = true, .is_vsync_hactive = false, .reg_values = NULL },
+};
+//@formatter:on
+
+/**
+ * @brief ループバック センサドライバ
+ */
+const struct sensor_driver sensor_loopback_driver = {
+    .name = "Loopback(GLCDC)",
+    .slave_addr = 0,
+    .mode_reg_addrs = NULL,
+    .mode_reg_count = 0,
+    .modes = s_modes,
+    .mode_count = (uint8_t)(sizeof(s_modes) / sizeof(s_modes[0])),
+    .probe = loopback_probe,
+    .set_exposure = NULL,
+    .set_gain = NULL,
+    .round_gain = NULL,
+    .set_stream = loopback_set_stream,
+};
+
+/**
+ * @brief ループバックを検出する。テスト信号は常に存在するので常に成功する。
+ * @return 0
+ */
+static int loopback_probe(void)
+{
+    return 0;
+}
+
+/**
+ * @brief テスト信号の出力をON/OFFする。
+ * @param is_on 出力する場合にはtrue, 停止する場合にはfalse.
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+static int loopback_set_stream(bool is_on)
+{
+    return test_signal_set_output(is_on) ? 0 : EIO;
+}
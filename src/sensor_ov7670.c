@@ -0,0 +1,334 @@
+/**
+ * @file OV7670 センサドライバ定義
+ *        YUV422(YUYV)出力で、VGA/QVGA/QQVGAのモードを持つ。
+ *        PDCへはHREFをHSyncとして接続する想定。HREFは有効ライン中だけアサートされるため、
+ *        キャプチャ開始位置は水平/垂直とも0になる。
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stddef.h>
+#include <errno.h>
+
+#include "hwtick.h"
+#include "sensor_driver.h"
+#include "sensor.h"
+
+/**
+ * @brief OV7670 スレーブアドレス(SCCB)
+ */
+#define OV7670_SLAVE_ADDR (0x21)
+
+#define REG_GAIN (0x00)    // AGCゲイン[7:0]
+#define REG_VREF (0x03)    // [7:6]:AGCゲイン[9:8], [3:0]:垂直ウィンドウ下位ビット
+#define REG_COM1 (0x04)    // [1:0]:露光時間[1:0]
+#define REG_AECHH (0x07)   // [5:0]:露光時間[15:10]
+#define REG_COM2 (0x09)    // [4]:ソフトスリープ
+#define REG_PID (0x0A)     // 製品ID MSB
+#define REG_VER (0x0B)     // 製品ID LSB
+#define REG_COM3 (0x0C)    // [2]:DCW有効
+#define REG_AECH (0x10)    // 露光時間[9:2]
+#define REG_CLKRC (0x11)   // 内部クロック分周
+#define REG_COM7 (0x12)    // [7]:リセット, [4]:QVGA
+#define REG_COM8 (0x13)    // [2]:AGC有効, [0]:AEC有効
+#define REG_COM10 (0x15)   // 同期信号極性
+#define REG_HSTART (0x17)  // 水平ウィンドウ開始[10:3]
+#define REG_HSTOP (0x18)   // 水平ウィンドウ終了[10:3]
+#define REG_VSTART (0x19)  // 垂直ウィンドウ開始[9:2]
+#define REG_VSTOP (0x1A)   // 垂直ウィンドウ終了[9:2]
+#define REG_HREF (0x32)    // 水平ウィンドウ下位ビット
+#define REG_TSLB (0x3A)    // 出力シーケンス
+#define REG_COM13 (0x3D)   // ガンマ, UV自動調整
+#define REG_COM14 (0x3E)   // PCLK分周, スケーリング
+#define REG_COM15 (0x40)   // 出力レンジ
+#define REG_XSC (0x70)     // 水平スケーリング係数
+#define REG_YSC (0x71)     // 垂直スケーリング係数
+#define REG_DCWCTR (0x72)  // ダウンサンプリング制御
+#define REG_PCLKDIV (0x73) // DSP PCLK分周
+#define REG_PCLKDLY (0xA2) // PCLK遅延
+
+#define OV7670_PID (0x76)
+#define OV7670_VER (0x73)
+
+#define COM2_SOFT_SLEEP (0x10)
+#define COM2_DRIVE_2X (0x01)
+#define COM7_RESET (0x80)
+#define COM8_AGC (0x04)
+#define COM8_AEC (0x01)
+
+/**
+ * @brief リセット後の待ち時間[ミリ秒]
+ */
+#define OV7670_RESET_WAIT_MILLIS (10)
+
+/**
+ * @brief 露光時間の最大値[line]
+ */
+#define OV7670_MAX_EXPOSURE (0xFFFF)
+
+static int ov7670_probe(void);
+static int ov7670_set_exposure(uint32_t exposure);
+static int ov7670_set_gain(uint16_t gain);
+static uint16_t ov7670_round_gain(uint16_t gain);
+static uint16_t split_gain(uint16_t gain, uint8_t* pdoubling);
+static int ov7670_set_stream(bool is_on);
+static int update_reg(uint8_t reg, uint8_t mask, uint8_t value);
+
+//@formatter:off
+/**
+ * @brief 初期化レジスタテーブル(リセット後に書き込む)
+ */
+static const uint8_t s_init_regs[][2] = {
+    { REG_CLKRC, 0x01 },                          // PCLK = XCLK / 2
+    { REG_TSLB, 0x04 },                           // YUYV順
+    { REG_COM13, 0x88 },                          // ガンマ有効, UV自動調整
+    { REG_COM10, 0x00 },                          // HREF出力, VSync H-Active
+    { REG_VREF, 0x0A },                           // 全モード共通の垂直ウィンドウ下位ビット
+    { REG_COM15, 0xC0 },                          // 出力レンジ 00h-FFh
+    { REG_COM8, 0xE7 },                           // AGC/AEC/AWB 自動
+    { REG_COM2, COM2_SOFT_SLEEP | COM2_DRIVE_2X } // 出力停止状態
+};
+
+/**
+ * @brief モードレジスタアドレス列
+ */
+static const uint8_t s_mode_reg_addrs[] = {
+    REG_COM7, REG_COM3, REG_COM14,
+    REG_XSC, REG_YSC, REG_DCWCTR, REG_PCLKDIV, REG_PCLKDLY,
+    REG_HSTART, REG_HSTOP, REG_HREF, REG_VSTART, REG_VSTOP
+};
+
+/**
+ * @brief VGA(640x480) モードレジスタ値
+ */
+static const uint8_t s_vga_regs[] = {
+    0x00, 0x00, 0x00,
+    0x3A, 0x35, 0x11, 0xF0, 0x02,
+    0x13, 0x01, 0xB6, 0x02, 0x7A
+};
+
+/**
+ * @brief QVGA(320x240) モードレジスタ値
+ */
+static const uint8_t s_qvga_regs[] = {
+    0x10, 0x04, 0x19,
+    0x3A, 0x35, 0x11, 0xF1, 0x02,
+    0x14, 0x02, 0xA4, 0x03, 0x7B
+};
+
+/**
+ * @brief QQVGA(160x120) モードレジスタ値(ウィンドウはQVGAと同じ)
+ */
+static const uint8_t s_qqvga_regs[] = {
+    0x00, 0x04, 0x1A,
+    0x3A, 0x35, 0x22, 0xF2, 0x02,
+    0x14, 0x02, 0xA4, 0x03, 0x7B
+};
+
+/**
+ * @brief モードテーブル
+ *        VGAはRAM2(512KB)に収まる400ラインまでをキャプチャする。
+ *        QVGA, QQVGAはVGAの画素アレイを縮小して出力するため、1フレームの総ライン数(露光時間の単位)はVGAと同じ510ラインになる。
+ */
+static const struct sensor_mode s_modes[] = {
+    { .name = "vga", .width = 640, .height = 480,
+      .xst = 0, .xsize = 640, .yst = 0, .ysize = 400, .bpp = 2, .frame_lines = 510,
+      .is_hsync_hactive = true, .is_vsync_hactive = true, .reg_values = s_vga_regs },
+    { .name = "qvga", .width = 320, .height = 240,
+      .xst = 0, .xsize = 320, .yst = 0, .ysize = 240, .bpp = 2, .frame_lines = 510,
+      .is_hsync_hactive = true, .is_vsync_hactive = true, .reg_values = s_qvga_regs },
+    { .name = "qqvga", .width = 160, .height = 120,
+      .xst = 0, .xsize = 160, .yst = 0, .ysize = 120, .bpp = 2, .frame_lines = 510,
+      .is_hsync_hactive = true, .is_vsync_hactive = true, .reg_values = s_qqvga_regs },
+};
+//@formatter:on
+
+/**
+ * @brief OV7670 センサドライバ
+ */
+const struct sensor_driver sensor_ov7670_driver = {
+    .name = "OV7670",
+    .slave_addr = OV7670_SLAVE_ADDR,
+    .mode_reg_addrs = s_mode_reg_addrs,
+    .mode_reg_count = (uint8_t)(sizeof(s_mode_reg_addrs)),
+    .modes = s_modes,
+    .mode_count = (uint8_t)(sizeof(s_modes) / sizeof(s_modes[0])),
+    .probe = ov7670_probe,
+    .set_exposure = ov7670_set_exposure,
+    .set_gain = ov7670_set_gain,
+    .round_gain = ov7670_round_gain,
+    .set_stream = ov7670_set_stream,
+};
+
+/**
+ * @brief OV7670を検出し、初期化する。
+ *        製品IDを確認後、ソフトウェアリセットして初期化レジスタを書き込む。
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+static int ov7670_probe(void)
+{
+    uint8_t pid;
+    uint8_t ver;
+
+    int retval = sensor_read_reg(OV7670_SLAVE_ADDR, REG_PID, &pid);
+    if (retval == 0)
+    {
+        retval = sensor_read_reg(OV7670_SLAVE_ADDR, REG_VER, &ver);
+    }
+    if (retval != 0)
+    {
+        return retval;
+    }
+    if ((pid != OV7670_PID) || (ver != OV7670_VER))
+    {
+        return ENODEV;
+    }
+
+    retval = sensor_write_reg(OV7670_SLAVE_ADDR, REG_COM7, COM7_RESET);
+    if (retval != 0)
+    {
+        return retval;
+    }
+    uint32_t begin = hwtick_get();
+    while ((hwtick_get() - begin) < OV7670_RESET_WAIT_MILLIS)
+    {
+        // do nothing.
+    }
+
+    for (uint32_t i = 0u; i < (sizeof(s_init_regs) / sizeof(s_init_regs[0])); i++)
+    {
+        retval = sensor_write_reg(OV7670_SLAVE_ADDR, s_init_regs[i][0], s_init_regs[i][1]);
+        if (retval != 0)
+        {
+            break;
+        }
+    }
+
+    return retval;
+}
+
+/**
+ * @brief 露光時間を設定する。AECは無効になる。
+ * @param exposure 露光時間[line]
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+static int ov7670_set_exposure(uint32_t exposure)
+{
+    if (exposure > OV7670_MAX_EXPOSURE)
+    {
+        exposure = OV7670_MAX_EXPOSURE;
+    }
+
+    int retval = update_reg(REG_COM8, COM8_AEC, 0x00);
+    if (retval == 0)
+    {
+        retval = update_reg(REG_AECHH, 0x3F, (uint8_t)((exposure >> 10) & 0x3F));
+    }
+    if (retval == 0)
+    {
+        retval = sensor_write_reg(OV7670_SLAVE_ADDR, REG_AECH, (uint8_t)((exposure >> 2) & 0xFF));
+    }
+    if (retval == 0)
+    {
+        retval = update_reg(REG_COM1, 0x03, (uint8_t)(exposure & 0x03));
+    }
+
+    return retval;
+}
+
+/**
+ * @brief ゲインを設定する。AGCは無効になる。
+ *        指定値を2倍段と1/16段に分解してゲインコードに変換する。(split_gain()を参照)
+ * @param gain ゲイン(16で1倍, 最大2047)
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+static int ov7670_set_gain(uint16_t gain)
+{
+    uint8_t doubling;
+    uint16_t g = split_gain(gain, &doubling);
+    uint16_t code = (uint16_t)((((1u << doubling) - 1u) << 4) | (g - 16u));
+
+    int retval = update_reg(REG_COM8, COM8_AGC, 0x00);
+    if (retval == 0)
+    {
+        retval = sensor_write_reg(OV7670_SLAVE_ADDR, REG_GAIN, (uint8_t)(code & 0xFF));
+    }
+    if (retval == 0)
+    {
+        retval = update_reg(REG_VREF, 0xC0, (uint8_t)((code >> 2) & 0xC0));
+    }
+
+    return retval;
+}
+
+/**
+ * @brief ov7670_set_gain() で実際に設定されるゲインを得る。
+ * @param gain ゲイン(16で1倍)
+ * @return 設定されるゲイン(16で1倍, 16〜1984)
+ */
+static uint16_t ov7670_round_gain(uint16_t gain)
+{
+    uint8_t doubling;
+    uint16_t g = split_gain(gain, &doubling);
+
+    return (uint16_t)(g << doubling);
+}
+
+/**
+ * @brief ゲインを2倍段と1/16段に分解する。
+ *        OV7670のゲインコードは、bit[3:0]が(1 + n/16)倍、bit4以上が各ビット2倍になる。
+ *        2倍段を1つ上げる毎に1/16段の下位ビットが切り捨てられるため、2倍以上では分解能が下がる。
+ * @param gain ゲイン(16で1倍)
+ * @param pdoubling 2倍段の数(0〜6)を格納する変数
+ * @return 1/16段(16〜31, 16で1倍)
+ */
+static uint16_t split_gain(uint16_t gain, uint8_t* pdoubling)
+{
+    uint16_t g = (gain < 16u) ? 16u : gain;
+    uint8_t doubling = 0u;
+
+    while ((g >= 32u) && (doubling < 6u))
+    {
+        g >>= 1;
+        doubling++;
+    }
+    if (g >= 32u)
+    {
+        g = 31u;
+    }
+    (*pdoubling) = doubling;
+
+    return g;
+}
+
+/**
+ * @brief 出力をON/OFFする。(COM2 ソフトスリープ)
+ * @param is_on 出力する場合にはtrue, 停止する場合にはfalse.
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+static int ov7670_set_stream(bool is_on)
+{
+    return sensor_write_reg(OV7670_SLAVE_ADDR, REG_COM2, (is_on) ? COM2_DRIVE_2X : (COM2_SOFT_SLEEP | COM2_DRIVE_2X));
+}
+
+/**
+ * @brief レジスタの一部ビットを更新する。(リードモディファイライト)
+ * @param reg レジスタアドレス
+ * @param mask 更新するビット
+ * @param value 更新するビットの値
+ * @return 成功した場合には0, 失敗した場合にはエラー番号を返す。
+ */
+static int update_reg(uint8_t reg, uint8_t mask, uint8_t value)
+{
+    uint8_t d;
+
+    int retval = sensor_read_reg(OV7670_SLAVE_ADDR, reg, &d);
+    if (retval == 0)
+    {
+        uint8_t new_value = (uint8_t)((d & ~mask) | (value & mask));
+        if (new_value != d)
+        {
+            retval = sensor_write_reg(OV7670_SLAVE_ADDR, reg, new_value);
+        }
+    }
+
+    return retval;
+}
@@ -56,7 +56,7 @@
  * 0: Setting by user programming (default)
  *    Set the value for parameter of the GLCDC structure in the user program.
  */
-#define GLCDC_CFG_CONFIGURATION_MODE (1)
+#define GLCDC_CFG_CONFIGURATION_MODE (0)
 
 /**********************************************************************************************************************
  * Configuration Options for GLCDC parameters setting
@@ -1,16 +1,169 @@
 /**
  * @file テスト信号インタフェース
  *       GLCDCを使って640x480@30fps YUYV 信号を出すようなモジュール。
- *       RAMが足りないので、単色データを出すだけとする。
+ *       RAMが足りないのでフレームバッファは持たず、背景色による単色データか、
+ *       小さなCLUTグラフィックスプレーンを繰り返し読み出したテストパターンを出す。
+ *
+ *       GLCDC→PDCのループバックではB[7:0]だけが接続されているため、GLCDCの1ピクセルが
+ *       キャプチャデータの1バイトになる。CLUTは入力値=Bの値となるグレースケールにし、
+ *       パターンデータの値がそのままキャプチャされるようにしている。
+ *       グラフィックスプレーンのラインオフセット(次ラインの読み出し開始位置)を
+ *       0や64にすることで、数十KB以下のデータで640x480(1280x480バイト)を埋める。
+ *
+ *       フレームの欠落/重複を検出できるよう、GR2を有効表示領域の先頭ラインに重ねて
+ *       フレーム番号(スタンプ)を出力できる。フレーム番号は有効表示期間の終了直後の
+ *       ライン検出(VPOS)割り込みで更新するため、次のフレームの先頭ラインから反映される。
+ *
+ *       バンドパターンでは、ライン検出割り込みの中で背景色を書き換え、検出ラインを次のバンドの
+ *       開始ラインに設定し直す。パターンデータを使わずに横縞を出せるが、切り替え位置は
+ *       割り込み応答時間だけ遅れる。(selftest bands で測定できる)
  * @author Cosmosweb Co.,Ltd. 2024
  */
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #include <platform.h>
 #include <r_glcdc_rx_if.h>
 #include <r_glcdc_rx_pinset.h>
+#include "hwtick.h"
 #include "test_signal.h"
 
+/**
+ * @brief テストパターンを表示するグラフィックスプレーン
+ */
+#define PATTERN_LAYER (GLCDC_FRAME_LAYER_1)
+
+/**
+ * @brief フレーム番号(スタンプ)を表示するグラフィックスプレーン
+ */
+#define STAMP_LAYER (GLCDC_FRAME_LAYER_2)
+
+/**
+ * @brief スタンプの幅[pixel] (GR2はRGB888(32bit)なので、16ピクセルでちょうど1読み出し単位になる)
+ */
+#define STAMP_WIDTH (TEST_SIGNAL_STAMP_BYTES)
+
+/**
+ * @brief 有効表示領域のライン番号からライン検出位置への加算値
+ *        (FITのR_GLCDC_Open()が有効表示期間終了直後の検出ラインに加算している値と同じ)
+ */
+#define DETECT_LINE_OFFSET (1)
+
+/**
+ * @brief ライン検出位置に有効表示期間終了直後が設定されていることを表すバンド番号
+ */
+#define BAND_ARMED_FRAME_END (-1)
+
+/**
+ * @brief テストパターンの最大幅[byte] (有効表示期間がこれを超えるタイミングは設定できない)
+ */
+#define PATTERN_MAX_WIDTH (1280)
+
+/**
+ * @brief テストパターンの最大高さ[line] (有効表示期間がこれを超えるタイミングは設定できない)
+ */
+#define PATTERN_MAX_HEIGHT (480)
+
+/**
+ * @brief GLCDCの読み出し単位[byte] (アドレス, ラインオフセットはこの倍数である必要がある)
+ */
+#define PATTERN_BLOCK_SIZE (64)
+
+/**
+ * @brief ブロックパターンのブロック数
+ *        ライン毎に1ブロックずつずらして読み出すため、高さ+1ライン分のブロック数が必要。
+ */
+#define PATTERN_BLOCK_COUNT(width, height) ((height) + ((width) / PATTERN_BLOCK_SIZE))
+
+/**
+ * @brief ビットマップ(CLUT1)パターンの1ラインのバイト数
+ */
+#define PATTERN_BITMAP_STRIDE(width) (((((width) / 8) + PATTERN_BLOCK_SIZE - 1) / PATTERN_BLOCK_SIZE) * PATTERN_BLOCK_SIZE)
+
+/**
+ * @brief ブロックパターンに必要なバッファサイズ[byte]
+ */
+#define PATTERN_BLOCK_BUFFER_SIZE (PATTERN_BLOCK_SIZE * PATTERN_BLOCK_COUNT(PATTERN_MAX_WIDTH, PATTERN_MAX_HEIGHT))
+
+/**
+ * @brief ビットマップパターンに必要なバッファサイズ[byte]
+ */
+#define PATTERN_BITMAP_BUFFER_SIZE (PATTERN_BITMAP_STRIDE(PATTERN_MAX_WIDTH) * PATTERN_MAX_HEIGHT)
+
+/**
+ * @brief パターンバッファサイズ[byte]
+ */
+#define PATTERN_BUFFER_SIZE \
+    ((PATTERN_BLOCK_BUFFER_SIZE > PATTERN_BITMAP_BUFFER_SIZE) ? PATTERN_BLOCK_BUFFER_SIZE : PATTERN_BITMAP_BUFFER_SIZE)
+
+/**
+ * @brief チェッカーボードのマスの幅[byte] (CLUT1で1バイトが同じ値になるよう8の倍数とする)
+ */
+#define CHECKER_CELL_WIDTH (64)
+
+/**
+ * @brief チェッカーボードのマスの高さ[line]
+ */
+#define CHECKER_CELL_HEIGHT (32)
+
+/**
+ * @brief チェッカーボードの暗部の値
+ */
+#define CHECKER_LOW (0x00)
+
+/**
+ * @brief チェッカーボードの明部の値
+ */
+#define CHECKER_HIGH (0xFF)
+
+/**
+ * @brief カラーバーの本数
+ */
+#define COLOR_BAR_COUNT (8)
+
+/**
+ * @brief パネルクロックのソース(PLLクロック)周波数[Hz]
+ */
+#define PANEL_CLOCK_SOURCE_HZ ((uint32_t)(BSP_SELECTED_CLOCK_HZ))
+
+/**
+ * @brief レイヤー更新の待ち時間上限[ミリ秒] (レジスタ反映は次のVSyncで行われる)
+ */
+#define LAYER_UPDATE_TIMEOUT_MILLIS (100)
+
+/**
+ * @brief パターンデータの配置
+ */
+enum pattern_layout
+{
+    PATTERN_LAYOUT_NONE = 0, // パターンデータなし(背景色)
+    PATTERN_LAYOUT_LINE,     // 1ライン分のデータを全ラインで読み出す(ラインオフセット0)
+    PATTERN_LAYOUT_BLOCK,    // 1ライン毎に1ブロックずらして読み出す(ラインオフセット64)
+    PATTERN_LAYOUT_BITMAP,   // 全ライン分のCLUT1データ
+};
+
+/**
+ * @brief テストパターン定義
+ */
+struct pattern_desc
+{
+    const char* name;           // パターン名
+    enum pattern_layout layout; // パターンデータの配置
+};
+
+static uint8_t get_block_pattern_value(enum test_pattern pattern, uint16_t x, uint16_t y);
+static void render_pattern(enum test_pattern pattern);
+static bool apply_layer(glcdc_frame_layer_t layer);
+static void write_stamp(uint32_t seq);
+static void set_stamp_layer_input(void);
+static uint8_t get_band_value(uint16_t y);
+static bool is_band_usable(int index);
+static void on_line_detected(void);
+static void arm_band(int index);
+static uint32_t to_bg_color_reg(uint8_t value);
+static bool reopen_glcdc(void);
+static bool is_displaying(void);
+
 /**
  * イベント処理を実行するかどうか。
  * FITモジュールの解説にあるとおり、ソフトウェアリセット解除後、初回のみ意図しない通知が行われるため、
@@ -20,6 +173,120 @@ static bool s_is_lcd_event_processing;
 
 static void glcdc_callback(void* arg);
 
+//@formatter:off
+/**
+ * @brief テストパターン定義テーブル(enum test_pattern の並び)
+ */
+static const struct pattern_desc s_pattern_descs[TEST_PATTERN_COUNT] = {
+    { "solid", PATTERN_LAYOUT_NONE },
+    { "color-bars", PATTERN_LAYOUT_LINE },
+    { "h-ramp", PATTERN_LAYOUT_LINE },
+    { "v-ramp", PATTERN_LAYOUT_BLOCK },
+    { "checker", PATTERN_LAYOUT_BITMAP },
+    { "line-counter", PATTERN_LAYOUT_BLOCK },
+    { "bands", PATTERN_LAYOUT_NONE },
+};
+
+/**
+ * @brief カラーバーの値(BT.601 75% Y, U, V)
+ */
+static const uint8_t s_color_bars[COLOR_BAR_COUNT][3] = {
+    { 235, 128, 128 }, // White
+    { 210, 16, 146 },  // Yellow
+    { 170, 166, 16 },  // Cyan
+    { 145, 54, 34 },   // Green
+    { 106, 202, 222 }, // Magenta
+    { 81, 90, 240 },   // Red
+    { 41, 240, 110 },  // Blue
+    { 16, 128, 128 },  // Black
+};
+//@formatter:on
+
+//@formatter:off
+/**
+ * @brief タイミングプロファイルテーブル
+ *        先頭(vga)がr_glcdc_rx_config.hの設定と同じで、起動時のプロファイルになる。
+ *        ピクセルクロック上限の目安は PCLKB(60MHz) * 0.6 = 36MHz (PDCの仕様)。
+ */
+static const struct test_signal_profile s_profiles[] = {
+    // name        hact  hfp  hs  hbp  vact vfp vs vbp div
+    { "vga",       1280, 48,  60, 612, 480, 8,  2, 10, 8 },  // 30.0MHz, 30.0fps
+    { "vga-20m",   1280, 48,  60, 612, 480, 8,  2, 10, 12 }, // 20.0MHz, 20.0fps
+    { "vga-34m",   1280, 48,  60, 612, 480, 8,  2, 10, 7 },  // 34.3MHz, 34.3fps
+    { "vga-40m",   1280, 48,  60, 612, 480, 8,  2, 10, 6 },  // 40.0MHz, 40.0fps (上限超え)
+    { "vga-tight", 1280, 16,  16, 32,  480, 4,  2, 6,  8 },  // 30.0MHz, 45.4fps (最小ブランキング)
+    { "qvga",      640,  40,  40, 280, 240, 4,  2, 14, 16 }, // 15.0MHz, 57.7fps
+    { "qvga-34m",  640,  40,  40, 280, 240, 4,  2, 14, 7 },  // 34.3MHz, 131.9fps
+};
+//@formatter:on
+
+/**
+ * @brief 現在のタイミングプロファイル
+ */
+static const struct test_signal_profile* s_profile;
+
+/**
+ * @brief パターンデータ
+ *        GLCDCは64バイト単位で読み出すため、64バイト境界に配置する。
+ */
+static uint8_t s_pattern_buf[PATTERN_BUFFER_SIZE] __attribute__((aligned(PATTERN_BLOCK_SIZE)));
+
+/**
+ * @brief パターン用CLUT(ARGB8888)
+ */
+static uint32_t s_pattern_clut[256];
+
+/**
+ * @brief 現在のテストパターン
+ */
+static enum test_pattern s_pattern;
+
+/**
+ * @brief スタンプデータ(RGB888)
+ *        GLCDCは64バイト単位で読み出すため、64バイト境界に配置する。
+ */
+static uint32_t s_stamp_buf[STAMP_WIDTH] __attribute__((aligned(PATTERN_BLOCK_SIZE)));
+
+/**
+ * @brief フレーム番号(ライン検出割り込みで更新される)
+ */
+static volatile uint32_t s_frame_seq;
+
+/**
+ * @brief プレビュー用CLUT(ARGB8888, グレースケール)
+ */
+static uint32_t s_preview_clut[256];
+
+/**
+ * @brief スタンプ用グラフィックスプレーンでプレビューを表示中かどうか
+ */
+static bool s_is_preview;
+
+/**
+ * @brief プレビュー開始前のスタンプ出力設定
+ */
+static bool s_saved_stamp_visible;
+
+/**
+ * @brief バンドテーブル
+ */
+static struct test_signal_band s_bands[TEST_SIGNAL_MAX_BANDS];
+
+/**
+ * @brief バンド数
+ */
+static int s_band_count;
+
+/**
+ * @brief バンドの切り替えを行うかどうか(バンドパターン表示中)
+ */
+static volatile bool s_is_bands_enabled;
+
+/**
+ * @brief ライン検出位置に設定しているバンド番号(有効表示期間終了直後の場合は BAND_ARMED_FRAME_END)
+ */
+static volatile int s_armed_band;
+
 /**
  * @brief GLCDC Gamma R設定
  */
@@ -154,11 +421,11 @@ static const gamma_correction_t s_gamma_correction_B = {
 static glcdc_cfg_t s_lcd_config = {
     .input = {
         {
-            .p_base = (void*)((uintptr_t)(LCD_CH0_IN_GR1_PBASE)),
-            .hsize = LCD_CH0_IN_GR1_HSIZE,
-            .vsize = LCD_CH0_IN_GR1_VSIZE,
-            .offset = LCD_CH0_IN_GR1_LINEOFFSET,
-            .format = LCD_CH0_IN_GR1_FORMAT,
+            .p_base = (uint32_t*)(s_pattern_buf),
+            .hsize = LCD_CH0_DISP_HW,
+            .vsize = LCD_CH0_DISP_VW,
+            .offset = 0,
+            .format = GLCDC_IN_FORMAT_CLUT8,
             .frame_edge = LCD_CH0_IN_GR1_FRAME_EDGE,
             .coordinate = {
                 .x = LCD_CH0_IN_GR1_COORD_X,
@@ -167,11 +434,11 @@ static glcdc_cfg_t s_lcd_config = {
             .bg_color = LCD_CH0_IN_GR1_BG_COLOR
         },
         {
-            .p_base = (void*)((uintptr_t)(LCD_CH0_IN_GR2_PBASE)),
-            .hsize = LCD_CH0_IN_GR2_HSIZE,
-            .vsize = LCD_CH0_IN_GR2_VSIZE,
-            .offset = LCD_CH0_IN_GR2_LINEOFFSET,
-            .format = LCD_CH0_IN_GR2_FORMAT,
+            .p_base = s_stamp_buf,
+            .hsize = STAMP_WIDTH,
+            .vsize = 1,
+            .offset = PATTERN_BLOCK_SIZE,
+            .format = GLCDC_IN_FORMAT_32BITS_RGB888,
             .frame_edge = LCD_CH0_IN_GR2_FRAME_EDGE,
             .coordinate = {
                 .x = LCD_CH0_IN_GR2_COORD_X,
@@ -283,10 +550,10 @@ static glcdc_cfg_t s_lcd_config = {
     },
     .clut = {
         {
-            .enable = LCD_CH0_CLUT_GR1_ENABLE,
-            .p_base = NULL,
-            .start = LCD_CH0_CLUT_GR1_START,
-            .size = LCD_CH0_CLUT_GR1_SIZE
+            .enable = true,
+            .p_base = s_pattern_clut,
+            .start = 0,
+            .size = 256
         },
         {
             .enable = LCD_CH0_CLUT_GR2_ENABLE,
@@ -296,12 +563,12 @@ static glcdc_cfg_t s_lcd_config = {
         }
     },
     .detection = {
-        .vpos_detect = LCD_CH0_DETECT_VPOS,
+        .vpos_detect = true, // フレーム番号の更新に使用する。
         .gr1uf_detect = LCD_CH0_DETECT_GR1UF,
         .gr2uf_detect = LCD_CH0_DETECT_GR2UF
     },
     .interrupt = {
-        .vpos_enable = LCD_CH0_INTERRUPT_VPOS_ENABLE,
+        .vpos_enable = true,
         .gr1uf_enable = LCD_CH0_INTERRUPT_GR1UF_ENABLE,
         .gr2uf_enable = LCD_CH0_INTERRUPT_GR2UF_ENABLE
     },
@@ -321,6 +588,19 @@ void test_signal_init(void)
 {
     s_is_lcd_event_processing = false;
     s_bg_color = s_lcd_config.output.bg_color; // memcpy()に相当。
+    s_pattern = TEST_PATTERN_SOLID;
+    s_profile = &(s_profiles[0]);
+    render_pattern(s_pattern);
+    s_frame_seq = 0u;
+    write_stamp(s_frame_seq);
+    for (uint32_t i = 0u; i < 256u; i++)
+    {
+        s_preview_clut[i] = 0xFF000000u | (i * 0x00010101u);
+    }
+    s_is_preview = false;
+    s_band_count = 0;
+    s_is_bands_enabled = false;
+    s_armed_band = BAND_ARMED_FRAME_END;
 
     if (R_GLCDC_Open(&s_lcd_config) == GLCDC_SUCCESS)
     {
@@ -372,6 +652,135 @@ bool test_signal_is_output(void)
     return GLCDC.BGEN.BIT.VEN != 0;
 }
 
+/**
+ * @brief テスト信号のタイミングを得る。
+ * @param ptiming タイミングを格納する構造体
+ */
+void test_signal_get_timing(struct test_signal_timing* ptiming)
+{
+    ptiming->hactive = s_lcd_config.output.htiming.display_cyc;
+    ptiming->hfp = s_lcd_config.output.htiming.front_porch;
+    ptiming->hsync = s_lcd_config.output.htiming.sync_width;
+    ptiming->hbp = s_lcd_config.output.htiming.back_porch;
+    ptiming->vactive = s_lcd_config.output.vtiming.display_cyc;
+    ptiming->vfp = s_lcd_config.output.vtiming.front_porch;
+    ptiming->vsync = s_lcd_config.output.vtiming.sync_width;
+    ptiming->vbp = s_lcd_config.output.vtiming.back_porch;
+    ptiming->pixel_clock_hz = PANEL_CLOCK_SOURCE_HZ / (uint32_t)(s_lcd_config.output.clock_div_ratio);
+    ptiming->is_hsync_hactive = (s_lcd_config.output.hsync_polarity == GLCDC_SIGNAL_POLARITY_HIACTIVE);
+    ptiming->is_vsync_hactive = (s_lcd_config.output.vsync_polarity == GLCDC_SIGNAL_POLARITY_HIACTIVE);
+
+    return;
+}
+
+/**
+ * @brief タイミングプロファイル数を得る。
+ * @return タイミングプロファイル数
+ */
+int test_signal_get_profile_count(void)
+{
+    return (int)(sizeof(s_profiles) / sizeof(s_profiles[0]));
+}
+
+/**
+ * @brief タイミングプロファイルを得る。
+ * @param index インデックス
+ * @return タイミングプロファイル。インデックスが範囲外の場合にはNULL.
+ */
+const struct test_signal_profile* test_signal_get_profile_at(int index)
+{
+    return ((index >= 0) && (index < test_signal_get_profile_count())) ? &(s_profiles[index]) : NULL;
+}
+
+/**
+ * @brief タイミングプロファイルを名前で検索する。
+ * @param name プロファイル名
+ * @return タイミングプロファイル。見つからない場合にはNULL.
+ */
+const struct test_signal_profile* test_signal_find_profile(const char* name)
+{
+    const struct test_signal_profile* pprofile = NULL;
+
+    for (int i = 0; i < test_signal_get_profile_count(); i++)
+    {
+        if (strcmp(s_profiles[i].name, name) == 0)
+        {
+            pprofile = &(s_profiles[i]);
+            break;
+        }
+    }
+
+    return pprofile;
+}
+
+/**
+ * @brief タイミングプロファイルを設定する。
+ *        タイミングは表示中に変更できないため、出力を停止してGLCDCを再オープンし、
+ *        出力中だった場合には再度出力を開始する。テストパターンは新しいタイミングで再生成する。
+ *        再オープンに失敗した場合には、元のタイミングに戻す。
+ * @param pprofile タイミングプロファイル
+ * @return 成功した場合にはtrue, 失敗した場合にはfalse.
+ */
+bool test_signal_set_profile(const struct test_signal_profile* pprofile)
+{
+    if ((pprofile == NULL) || (pprofile->hactive == 0u) || (pprofile->hactive > PATTERN_MAX_WIDTH) || ((pprofile->hactive % 4u) != 0u)
+        || (pprofile->vactive == 0u) || (pprofile->vactive > PATTERN_MAX_HEIGHT) || (pprofile->clock_div == 0u))
+    {
+        return false;
+    }
+
+    bool is_output = is_displaying();
+    if (is_output && !test_signal_set_output(false))
+    {
+        return false;
+    }
+
+    glcdc_timing_t htiming = s_lcd_config.output.htiming;
+    glcdc_timing_t vtiming = s_lcd_config.output.vtiming;
+    glcdc_panel_clk_div_t clock_div = s_lcd_config.output.clock_div_ratio;
+
+    s_lcd_config.output.htiming.display_cyc = pprofile->hactive;
+    s_lcd_config.output.htiming.front_porch = pprofile->hfp;
+    s_lcd_config.output.htiming.sync_width = pprofile->hsync;
+    s_lcd_config.output.htiming.back_porch = pprofile->hbp;
+    s_lcd_config.output.vtiming.display_cyc = pprofile->vactive;
+    s_lcd_config.output.vtiming.front_porch = pprofile->vfp;
+    s_lcd_config.output.vtiming.sync_width = pprofile->vsync;
+    s_lcd_config.output.vtiming.back_porch = pprofile->vbp;
+    s_lcd_config.output.clock_div_ratio = (glcdc_panel_clk_div_t)(pprofile->clock_div);
+    render_pattern(s_pattern);
+
+    bool is_succeed = reopen_glcdc();
+    if (is_succeed)
+    {
+        s_profile = pprofile;
+    }
+    else
+    {
+        s_lcd_config.output.htiming = htiming;
+        s_lcd_config.output.vtiming = vtiming;
+        s_lcd_config.output.clock_div_ratio = clock_div;
+        render_pattern(s_pattern);
+        reopen_glcdc();
+    }
+
+    if (is_output)
+    {
+        test_signal_set_output(true);
+    }
+
+    return is_succeed;
+}
+
+/**
+ * @brief 現在のタイミングプロファイルを得る。
+ * @return タイミングプロファイル
+ */
+const struct test_signal_profile* test_signal_get_profile(void)
+{
+    return s_profile;
+}
+
 /**
  * @brief テストデータを設定する。
  * @param data テストデータ
@@ -395,6 +804,683 @@ uint8_t test_signal_get_data(void)
     return s_bg_color.byte.b;
 }
 
+/**
+ * @brief テストパターンを設定する。
+ *        出力中はCLUTとグラフィックスプレーンを更新し、次のVSyncで切り替わる。
+ *        出力停止中はGLCDCを再オープンして設定を反映する。
+ * @param pattern テストパターン
+ * @return 成功した場合にはtrue, 失敗した場合にはfalse.
+ */
+bool test_signal_set_pattern(enum test_pattern pattern)
+{
+    if ((pattern < TEST_PATTERN_SOLID) || (pattern >= TEST_PATTERN_COUNT))
+    {
+        return false;
+    }
+
+    render_pattern(pattern);
+    bool is_succeed = apply_layer(PATTERN_LAYER);
+    if (is_succeed)
+    {
+        s_pattern = pattern;
+        s_is_bands_enabled = (pattern == TEST_PATTERN_BANDS);
+    }
+
+    return is_succeed;
+}
+
+/**
+ * @brief 現在のテストパターンを得る。
+ * @return テストパターン
+ */
+enum test_pattern test_signal_get_pattern(void)
+{
+    return s_pattern;
+}
+
+/**
+ * @brief テストパターンの名前を得る。
+ * @param pattern テストパターン
+ * @return テストパターン名。範囲外の場合にはNULL.
+ */
+const char* test_signal_get_pattern_name(enum test_pattern pattern)
+{
+    return ((pattern >= TEST_PATTERN_SOLID) && (pattern < TEST_PATTERN_COUNT)) ? s_pattern_descs[pattern].name : NULL;
+}
+
+/**
+ * @brief テストパターンを名前で検索する。
+ * @param name テストパターン名
+ * @param ppattern テストパターンを格納する変数
+ * @return 見つかった場合にはtrue, 見つからない場合にはfalse.
+ */
+bool test_signal_find_pattern(const char* name, enum test_pattern* ppattern)
+{
+    bool is_found = false;
+
+    for (int i = 0; i < TEST_PATTERN_COUNT; i++)
+    {
+        if (strcmp(s_pattern_descs[i].name, name) == 0)
+        {
+            (*ppattern) = (enum test_pattern)(i);
+            is_found = true;
+            break;
+        }
+    }
+
+    return is_found;
+}
+
+/**
+ * @brief フレーム番号(スタンプ)を出力するかどうかを設定する。
+ *        出力中は次のVSyncで切り替わる。
+ * @param is_enabled 出力する場合にはtrue, 出力しない場合にはfalse.
+ * @return 成功した場合にはtrue, 失敗した場合にはfalse.
+ */
+bool test_signal_set_stamp(bool is_enabled)
+{
+    if (s_is_preview)
+    {
+        return false; // プレビュー表示中はスタンプ用グラフィックスプレーンを使用できない。
+    }
+
+    bool is_visible = s_lcd_config.blend[STAMP_LAYER].visible;
+
+    s_lcd_config.blend[STAMP_LAYER].visible = is_enabled;
+    bool is_succeed = apply_layer(STAMP_LAYER);
+    if (!is_succeed)
+    {
+        s_lcd_config.blend[STAMP_LAYER].visible = is_visible;
+    }
+
+    return is_succeed;
+}
+
+/**
+ * @brief フレーム番号(スタンプ)を出力しているかどうかを得る。
+ * @return 出力している場合にはtrue, それ以外はfalse.
+ */
+bool test_signal_is_stamp_enabled(void)
+{
+    return !s_is_preview && s_lcd_config.blend[STAMP_LAYER].visible;
+}
+
+/**
+ * @brief 現在のフレーム番号を得る。
+ *        出力中のフレームの番号になる。(スタンプの出力有無に関わらず、フレーム毎に更新される)
+ * @return フレーム番号
+ */
+uint32_t test_signal_get_frame_seq(void)
+{
+    return s_frame_seq;
+}
+
+/**
+ * @brief キャプチャデータからフレーム番号(スタンプ)を取り出す。
+ *        スタンプは有効表示領域の先頭ラインの先頭 TEST_SIGNAL_STAMP_BYTES バイトで、
+ *        フレーム番号(LE 4バイト), その反転(LE 4バイト)を2回繰り返したもの。
+ * @param pdata 有効表示領域の先頭ラインの先頭からのキャプチャデータ
+ * @param len データ長[byte]
+ * @param pseq フレーム番号を格納する変数
+ * @return スタンプとして正しいデータだった場合にはtrue, それ以外はfalse.
+ */
+bool test_signal_decode_stamp(const uint8_t* pdata, uint32_t len, uint32_t* pseq)
+{
+    if (len < TEST_SIGNAL_STAMP_BYTES)
+    {
+        return false;
+    }
+
+    uint32_t seq = (uint32_t)(pdata[0]) | ((uint32_t)(pdata[1]) << 8) | ((uint32_t)(pdata[2]) << 16) | ((uint32_t)(pdata[3]) << 24);
+    uint32_t inv = (uint32_t)(pdata[4]) | ((uint32_t)(pdata[5]) << 8) | ((uint32_t)(pdata[6]) << 16) | ((uint32_t)(pdata[7]) << 24);
+    if (((seq ^ inv) != 0xFFFFFFFFu) || (memcmp(pdata, pdata + 8, 8) != 0))
+    {
+        return false;
+    }
+    (*pseq) = seq;
+
+    return true;
+}
+
+/**
+ * @brief スタンプ用グラフィックスプレーン(GR2)で、バッファの内容をプレビュー表示する。
+ *        バッファの1バイトを1ピクセルのグレースケールとして、または2バイトを1ピクセルのRGB565として表示する。
+ *        プレビュー中はフレーム番号(スタンプ)を出力できない。
+ *        GLCDCは64バイト単位で読み出すため、バッファと幅は64バイト単位である必要がある。
+ * @param pbuf 表示するバッファ
+ * @param width 1ラインのバイト数
+ * @param height ライン数
+ * @param is_rgb565 RGB565として表示する場合はtrue, グレースケールとして表示する場合はfalse.
+ * @return 成功した場合にはtrue, 失敗した場合にはfalse.
+ */
+bool test_signal_start_preview(const uint8_t* pbuf, uint16_t width, uint16_t height, bool is_rgb565)
+{
+    if (s_is_preview || (pbuf == NULL) || (((uintptr_t)(pbuf) % PATTERN_BLOCK_SIZE) != 0u) || (width == 0u)
+        || ((width % PATTERN_BLOCK_SIZE) != 0u) || (height == 0u))
+    {
+        return false;
+    }
+
+    s_saved_stamp_visible = s_lcd_config.blend[STAMP_LAYER].visible;
+
+    glcdc_input_cfg_t* pinput = &(s_lcd_config.input[STAMP_LAYER]);
+    uint16_t pixels = is_rgb565 ? (uint16_t)(width / 2u) : width;
+    pinput->p_base = (uint32_t*)(pbuf);
+    pinput->hsize = (pixels < s_lcd_config.output.htiming.display_cyc) ? pixels : s_lcd_config.output.htiming.display_cyc;
+    pinput->vsize = (height < s_lcd_config.output.vtiming.display_cyc) ? height : s_lcd_config.output.vtiming.display_cyc;
+    pinput->offset = width;
+    if (is_rgb565)
+    {
+        pinput->format = GLCDC_IN_FORMAT_16BITS_RGB565;
+        s_lcd_config.clut[STAMP_LAYER].enable = false;
+    }
+    else
+    {
+        pinput->format = GLCDC_IN_FORMAT_CLUT8;
+        s_lcd_config.clut[STAMP_LAYER].enable = true;
+        s_lcd_config.clut[STAMP_LAYER].p_base = s_preview_clut;
+        s_lcd_config.clut[STAMP_LAYER].start = 0;
+        s_lcd_config.clut[STAMP_LAYER].size = 256;
+    }
+    s_lcd_config.blend[STAMP_LAYER].visible = true;
+    if (!apply_layer(STAMP_LAYER))
+    {
+        set_stamp_layer_input();
+        s_lcd_config.blend[STAMP_LAYER].visible = s_saved_stamp_visible;
+        return false;
+    }
+    s_is_preview = true;
+
+    return true;
+}
+
+/**
+ * @brief プレビュー表示するバッファを切り替える。
+ *        出力中は次のVSync(垂直ブランキング期間)で切り替わる。
+ *        前回の切り替えが反映される前に呼び出した場合は待たずに失敗するので、後で再度呼び出すこと。
+ * @param pbuf 表示するバッファ(開始時と同じサイズ, 配置であること)
+ * @return 成功した場合にはtrue, 失敗した場合にはfalse.
+ */
+bool test_signal_show_preview(const uint8_t* pbuf)
+{
+    if (!s_is_preview || (pbuf == NULL) || (((uintptr_t)(pbuf) % PATTERN_BLOCK_SIZE) != 0u))
+    {
+        return false;
+    }
+
+    const uint32_t* pbase = s_lcd_config.input[STAMP_LAYER].p_base;
+    s_lcd_config.input[STAMP_LAYER].p_base = (uint32_t*)(pbuf);
+    if (!is_displaying())
+    {
+        return true; // 出力開始時(再オープン時)に反映される。
+    }
+
+    glcdc_runtime_cfg_t runtime_cfg;
+    runtime_cfg.input = s_lcd_config.input[STAMP_LAYER];
+    runtime_cfg.blend = s_lcd_config.blend[STAMP_LAYER];
+    runtime_cfg.chromakey = s_lcd_config.chromakey[STAMP_LAYER];
+    if (R_GLCDC_LayerChange(STAMP_LAYER, &runtime_cfg) != GLCDC_SUCCESS)
+    {
+        s_lcd_config.input[STAMP_LAYER].p_base = (uint32_t*)(pbase);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief プレビューのバッファ切り替えが反映待ちかどうかを得る。
+ *        反映待ちの間は、切り替え前のバッファが表示されている。
+ * @return 反映待ちの場合にはtrue, それ以外はfalse.
+ */
+bool test_signal_is_preview_pending(void)
+{
+    return s_is_preview && (GLCDC.GR2VEN.BIT.VEN != 0);
+}
+
+/**
+ * @brief プレビュー表示を終了し、スタンプ用グラフィックスプレーンをフレーム番号(スタンプ)出力に戻す。
+ *        スタンプの出力有無は開始前の状態に戻る。
+ * @return 成功した場合にはtrue, 失敗した場合にはfalse.
+ */
+bool test_signal_stop_preview(void)
+{
+    if (!s_is_preview)
+    {
+        return true;
+    }
+
+    set_stamp_layer_input();
+    s_lcd_config.blend[STAMP_LAYER].visible = s_saved_stamp_visible;
+    s_is_preview = false;
+
+    return apply_layer(STAMP_LAYER);
+}
+
+/**
+ * @brief プレビュー表示中かどうかを得る。
+ * @return プレビュー表示中の場合にはtrue, それ以外はfalse.
+ */
+bool test_signal_is_preview(void)
+{
+    return s_is_preview;
+}
+
+/**
+ * @brief バンドテーブルを設定する。
+ *        開始ラインは昇順で、TEST_SIGNAL_BAND_MIN_LINES ライン以上離れている必要がある。
+ *        最後のバンドも有効表示期間の終了まで TEST_SIGNAL_BAND_MIN_LINES ライン以上必要。
+ *        バンドパターン表示中は次のフレームから反映される。
+ * @param pbands バンドテーブル
+ * @param count バンド数(0の場合は全ラインがテストデータの値になる)
+ * @return 成功した場合にはtrue, 失敗した場合にはfalse.
+ */
+bool test_signal_set_bands(const struct test_signal_band* pbands, int count)
+{
+    if ((count < 0) || (count > TEST_SIGNAL_MAX_BANDS) || ((count > 0) && (pbands == NULL)))
+    {
+        return false;
+    }
+    uint32_t vactive = s_lcd_config.output.vtiming.display_cyc;
+    for (int i = 0; i < count; i++)
+    {
+        if ((i > 0) && (pbands[i].line < (pbands[i - 1].line + TEST_SIGNAL_BAND_MIN_LINES)))
+        {
+            return false;
+        }
+        if (((uint32_t)(pbands[i].line) + TEST_SIGNAL_BAND_MIN_LINES) > vactive)
+        {
+            return false;
+        }
+    }
+
+    // 割り込みでテーブルを参照するため、書き換え中は割り込みを禁止する。
+    R_BSP_InterruptsDisable();
+    for (int i = 0; i < count; i++)
+    {
+        s_bands[i] = pbands[i];
+    }
+    s_band_count = count;
+    R_BSP_InterruptsEnable();
+
+    return true;
+}
+
+/**
+ * @brief バンドテーブルを得る。
+ * @param ppbands バンドテーブルの先頭アドレスを格納する変数
+ * @return バンド数
+ */
+int test_signal_get_bands(const struct test_signal_band** ppbands)
+{
+    (*ppbands) = s_bands;
+
+    return s_band_count;
+}
+
+/**
+ * @brief テストパターンの期待値を得る。
+ *        キャプチャデータの検証用。パターンデータの生成もこの関数で行う。
+ *        フレーム番号(スタンプ)は含まない。
+ * @param pattern テストパターン
+ * @param x 有効表示領域先頭からの水平位置[byte]
+ * @param y 有効表示領域先頭からの垂直位置[line]
+ * @return 出力される値
+ */
+uint8_t test_signal_get_pattern_value(enum test_pattern pattern, uint16_t x, uint16_t y)
+{
+    uint16_t width = s_lcd_config.input[PATTERN_LAYER].hsize;
+    if ((x >= width) || (y >= s_lcd_config.input[PATTERN_LAYER].vsize))
+    {
+        return s_bg_color.byte.b;
+    }
+
+    uint8_t value;
+    switch (pattern)
+    {
+    case TEST_PATTERN_COLOR_BARS: {
+        // Y, U, Y, V の並び。
+        const uint8_t* pbar = s_color_bars[((uint32_t)(x) * COLOR_BAR_COUNT) / width];
+        uint8_t pos = (uint8_t)(x & 0x3);
+        value = (pos == 1u) ? pbar[1] : ((pos == 3u) ? pbar[2] : pbar[0]);
+        break;
+    }
+    case TEST_PATTERN_H_RAMP: {
+        value = (uint8_t)(x & 0xFF);
+        break;
+    }
+    case TEST_PATTERN_CHECKER: {
+        value = ((((x / CHECKER_CELL_WIDTH) + (y / CHECKER_CELL_HEIGHT)) & 0x1) != 0) ? CHECKER_HIGH : CHECKER_LOW;
+        break;
+    }
+    case TEST_PATTERN_V_RAMP:
+    case TEST_PATTERN_LINE_COUNTER: {
+        value = get_block_pattern_value(pattern, x, y);
+        break;
+    }
+    case TEST_PATTERN_BANDS: {
+        value = get_band_value(y);
+        break;
+    }
+    case TEST_PATTERN_SOLID:
+    default: {
+        value = s_bg_color.byte.b;
+        break;
+    }
+    }
+
+    return value;
+}
+
+/**
+ * @brief ブロックパターンの値を得る。
+ *        ブロックパターンはラインオフセット64で読み出すため、
+ *        (x, y)の値は (y + x / 64) 番目のブロックの (x % 64) バイト目になる。
+ *        y がパターンの高さを超えていても計算できる。(パターンデータの生成で使用する)
+ * @param pattern テストパターン
+ * @param x 水平位置[byte]
+ * @param y 垂直位置[line]
+ * @return 値
+ */
+static uint8_t get_block_pattern_value(enum test_pattern pattern, uint16_t x, uint16_t y)
+{
+    uint32_t block = (uint32_t)(y) + (x / PATTERN_BLOCK_SIZE);
+    uint8_t value;
+
+    if (pattern == TEST_PATTERN_LINE_COUNTER)
+    {
+        // ライン先頭のブロックはライン番号(下位, 上位, 反転下位, 反転上位)の繰り返しになる。
+        switch (x & 0x3)
+        {
+        case 0:
+            value = (uint8_t)(block & 0xFF);
+            break;
+        case 1:
+            value = (uint8_t)((block >> 8) & 0xFF);
+            break;
+        case 2:
+            value = (uint8_t)(~block & 0xFF);
+            break;
+        default:
+            value = (uint8_t)((~block >> 8) & 0xFF);
+            break;
+        }
+    }
+    else
+    {
+        // 1ライン下がる毎、64バイト右へ進む毎に1増える階段状のランプになる。
+        value = (uint8_t)(block & 0xFF);
+    }
+
+    return value;
+}
+
+/**
+ * @brief バンドパターンの値を得る。
+ * @param y 垂直位置[line]
+ * @return 値
+ */
+static uint8_t get_band_value(uint16_t y)
+{
+    uint8_t value = s_bg_color.byte.b;
+
+    for (int i = 0; is_band_usable(i) && (s_bands[i].line <= y); i++)
+    {
+        value = s_bands[i].value;
+    }
+
+    return value;
+}
+
+/**
+ * @brief バンドを現在のタイミングで使用できるかどうかを判定する。
+ *        タイミングプロファイルの変更で有効表示期間が短くなった場合、はみ出したバンドは使用しない。
+ * @param index バンド番号
+ * @return 使用できる場合にはtrue, それ以外はfalse.
+ */
+static bool is_band_usable(int index)
+{
+    return (index >= 0) && (index < s_band_count)
+           && (((uint32_t)(s_bands[index].line) + TEST_SIGNAL_BAND_MIN_LINES) <= s_lcd_config.output.vtiming.display_cyc);
+}
+
+/**
+ * @brief 現在のタイミングでテストパターンのデータとCLUTを生成し、GLCDC設定に反映する。
+ *        GLCDCへの反映はapply_layer()で行う。
+ * @param pattern テストパターン
+ */
+static void render_pattern(enum test_pattern pattern)
+{
+    glcdc_input_cfg_t* pinput = &(s_lcd_config.input[PATTERN_LAYER]);
+    enum pattern_layout layout = s_pattern_descs[pattern].layout;
+
+    // パターンは有効表示領域全体に表示する。
+    uint16_t width = s_lcd_config.output.htiming.display_cyc;
+    uint16_t height = s_lcd_config.output.vtiming.display_cyc;
+    pinput->hsize = width;
+    pinput->vsize = height;
+
+    // グレースケール。CLUT1のときは0,1番を暗部/明部にする。
+    for (uint32_t i = 0u; i < 256u; i++)
+    {
+        s_pattern_clut[i] = 0xFF000000u | (i * 0x00010101u);
+    }
+    if (layout == PATTERN_LAYOUT_BITMAP)
+    {
+        s_pattern_clut[0] = 0xFF000000u | (CHECKER_LOW * 0x00010101u);
+        s_pattern_clut[1] = 0xFF000000u | (CHECKER_HIGH * 0x00010101u);
+    }
+
+    switch (layout)
+    {
+    case PATTERN_LAYOUT_LINE: {
+        for (uint16_t x = 0u; x < width; x++)
+        {
+            s_pattern_buf[x] = test_signal_get_pattern_value(pattern, x, 0u);
+        }
+        pinput->format = GLCDC_IN_FORMAT_CLUT8;
+        pinput->offset = 0;
+        break;
+    }
+    case PATTERN_LAYOUT_BLOCK: {
+        for (uint16_t block = 0u; block < PATTERN_BLOCK_COUNT(width, height); block++)
+        {
+            uint8_t* pblock = &(s_pattern_buf[block * PATTERN_BLOCK_SIZE]);
+            for (uint16_t x = 0u; x < PATTERN_BLOCK_SIZE; x++)
+            {
+                pblock[x] = get_block_pattern_value(pattern, x, block);
+            }
+        }
+        pinput->format = GLCDC_IN_FORMAT_CLUT8;
+        pinput->offset = PATTERN_BLOCK_SIZE;
+        break;
+    }
+    case PATTERN_LAYOUT_BITMAP: {
+        for (uint16_t y = 0u; y < height; y++)
+        {
+            uint8_t* pline = &(s_pattern_buf[y * PATTERN_BITMAP_STRIDE(width)]);
+            for (uint16_t i = 0u; i < (width / 8); i++)
+            {
+                // マスの幅は8の倍数なので、1バイト(8ピクセル)は全て同じ値になる。
+                pline[i] = (test_signal_get_pattern_value(pattern, (uint16_t)(i * 8u), y) == CHECKER_HIGH) ? 0xFF : 0x00;
+            }
+        }
+        pinput->format = GLCDC_IN_FORMAT_CLUT1;
+        pinput->offset = PATTERN_BITMAP_STRIDE(width);
+        break;
+    }
+    case PATTERN_LAYOUT_NONE:
+    default: {
+        pinput->format = GLCDC_IN_FORMAT_CLUT8;
+        pinput->offset = 0;
+        break;
+    }
+    }
+    s_lcd_config.blend[PATTERN_LAYER].visible = (layout != PATTERN_LAYOUT_NONE);
+
+    return;
+}
+
+/**
+ * @brief GLCDC設定のレイヤー設定とCLUTをGLCDCに反映する。
+ *        出力中は、CLUT(有効な場合)を反映待ちで書き込んだ後、レイヤー設定と一緒に次のVSyncで反映させる。
+ *        前回の反映が完了していない場合には、完了するまで待つ。
+ *        出力停止中は、LayerChange/ClutUpdateが使用できないため、GLCDCを再オープンする。
+ * @param layer グラフィックスプレーン
+ * @return 成功した場合にはtrue, 失敗した場合にはfalse.
+ */
+static bool apply_layer(glcdc_frame_layer_t layer)
+{
+    if (!is_displaying())
+    {
+        return reopen_glcdc();
+    }
+
+    glcdc_runtime_cfg_t runtime_cfg;
+    runtime_cfg.input = s_lcd_config.input[layer];
+    runtime_cfg.blend = s_lcd_config.blend[layer];
+    runtime_cfg.chromakey = s_lcd_config.chromakey[layer];
+
+    glcdc_err_t err;
+    uint32_t begin = hwtick_get();
+    do
+    {
+        err = (s_lcd_config.clut[layer].enable) ? R_GLCDC_ClutUpdate_NoReflect(layer, &(s_lcd_config.clut[layer])) : GLCDC_SUCCESS;
+        if (err == GLCDC_SUCCESS)
+        {
+            err = R_GLCDC_LayerChange(layer, &runtime_cfg);
+        }
+    } while ((err == GLCDC_ERR_INVALID_UPDATE_TIMING) && ((hwtick_get() - begin) < LAYER_UPDATE_TIMEOUT_MILLIS));
+
+    return err == GLCDC_SUCCESS;
+}
+
+/**
+ * @brief フレーム番号(スタンプ)データを書き込む。
+ *        フレーム番号(LE 4バイト), その反転(LE 4バイト)を繰り返す。
+ *        出力はB[7:0]なので、各ピクセルのR,G,Bに同じ値を書き込む。
+ * @param seq フレーム番号
+ */
+static void write_stamp(uint32_t seq)
+{
+    for (uint32_t i = 0u; i < STAMP_WIDTH; i++)
+    {
+        uint32_t word = ((i & 0x4) != 0u) ? ~seq : seq;
+        uint32_t value = (word >> ((i & 0x3) * 8u)) & 0xFFu;
+        s_stamp_buf[i] = 0xFF000000u | (value * 0x00010101u);
+    }
+
+    return;
+}
+
+/**
+ * @brief スタンプ用グラフィックスプレーンの入力設定をスタンプ出力用にする。
+ */
+static void set_stamp_layer_input(void)
+{
+    glcdc_input_cfg_t* pinput = &(s_lcd_config.input[STAMP_LAYER]);
+    pinput->p_base = s_stamp_buf;
+    pinput->hsize = STAMP_WIDTH;
+    pinput->vsize = 1;
+    pinput->offset = PATTERN_BLOCK_SIZE;
+    pinput->format = GLCDC_IN_FORMAT_32BITS_RGB888;
+    s_lcd_config.clut[STAMP_LAYER].enable = false;
+
+    return;
+}
+
+/**
+ * @brief ライン検出時の処理を行う。(割り込みコンテキスト)
+ *        有効表示期間の終了直後では、次のフレームのフレーム番号を書き込み、
+ *        バンドパターン表示中なら背景色をテストデータの値に戻して最初のバンドの検出を設定する。
+ *        バンドの開始ラインでは、背景色をバンドの値にして次のバンド(なければ有効表示期間の終了直後)の検出を設定する。
+ */
+static void on_line_detected(void)
+{
+    if (s_armed_band == BAND_ARMED_FRAME_END)
+    {
+        s_frame_seq++;
+        write_stamp(s_frame_seq);
+        if (s_is_bands_enabled)
+        {
+            GLCDC.BGCOLOR.LONG = to_bg_color_reg(s_bg_color.byte.b);
+            arm_band(0);
+        }
+    }
+    else if (s_is_bands_enabled)
+    {
+        GLCDC.BGCOLOR.LONG = to_bg_color_reg(s_bands[s_armed_band].value);
+        arm_band(s_armed_band + 1);
+    }
+    else
+    {
+        // バンドパターンが終了した。
+        GLCDC.BGCOLOR.LONG = to_bg_color_reg(s_bg_color.byte.b);
+        arm_band(BAND_ARMED_FRAME_END);
+    }
+
+    return;
+}
+
+/**
+ * @brief ライン検出位置を設定する。(割り込みコンテキスト)
+ * @param index 検出するバンド番号。使用できないバンドの場合は有効表示期間の終了直後を検出する。
+ */
+static void arm_band(int index)
+{
+    uint32_t vsync_bp = (uint32_t)(s_lcd_config.output.vtiming.sync_width) + s_lcd_config.output.vtiming.back_porch;
+    uint32_t line;
+
+    if (is_band_usable(index))
+    {
+        s_armed_band = index;
+        line = s_bands[index].line;
+    }
+    else
+    {
+        s_armed_band = BAND_ARMED_FRAME_END;
+        line = s_lcd_config.output.vtiming.display_cyc;
+    }
+    GLCDC.GR2CLUTINT.BIT.LINE = vsync_bp + line + DETECT_LINE_OFFSET;
+
+    return;
+}
+
+/**
+ * @brief 値を背景色レジスタ(BGCOLOR)の値に変換する。
+ * @param value 値(R, G, B 共通)
+ * @return BGCOLORレジスタの値
+ */
+static uint32_t to_bg_color_reg(uint8_t value)
+{
+    return (uint32_t)(value) * 0x00010101u;
+}
+
+/**
+ * @brief GLCDCを閉じて、現在のGLCDC設定で再オープンする。出力停止中に呼び出すこと。
+ * @return 成功した場合にはtrue, 失敗した場合にはfalse.
+ */
+static bool reopen_glcdc(void)
+{
+    R_GLCDC_Close();
+    s_lcd_config.output.bg_color = s_bg_color; // テストデータを引き継ぐ。
+    s_is_lcd_event_processing = false;
+    s_armed_band = BAND_ARMED_FRAME_END; // R_GLCDC_Open()は有効表示期間の終了直後を検出ラインに設定する。
+
+    return R_GLCDC_Open(&s_lcd_config) == GLCDC_SUCCESS;
+}
+
+/**
+ * @brief GLCDCが表示中(出力中)かどうかを判定する。
+ * @return 表示中の場合にはtrue, それ以外はfalse.
+ */
+static bool is_displaying(void)
+{
+    glcdc_status_t status;
+
+    return (R_GLCDC_GetStatus(&status) == GLCDC_SUCCESS) && (status.state == GLCDC_STATE_DISPLAYING);
+}
+
 /**
  * @brief GLCDC のイベントコールバック
  * @param arg パラメータ
@@ -412,7 +1498,7 @@ static void glcdc_callback(void* arg)
     switch (p->event)
     {
     case GLCDC_EVENT_LINE_DETECTION: {
-        // TODO : VPOS Event
+        on_line_detected();
         break;
     }
     default: {
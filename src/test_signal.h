@@ -1,7 +1,10 @@
 /**
  * @file テスト信号インタフェース
  *       GLCDCを使って640x480@30fps YUYV 信号を出すようなモジュール。
- *       RAMが足りないので、単色データを出すだけとする。
+ *       RAMが足りないのでフレームバッファは持たず、背景色による単色データか、
+ *       小さなCLUTグラフィックスプレーンを繰り返し読み出したテストパターンを出す。
+ *       先頭ラインにフレーム番号(スタンプ)を重ねて出すこともできる。
+ *       ライン検出割り込みで背景色を切り替えることで、パターンデータなしで横縞(バンド)も出せる。
  * @author Cosmosweb Co.,Ltd. 2024
  */
 
@@ -11,11 +14,117 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+/**
+ * @brief フレーム番号(スタンプ)のバイト数
+ */
+#define TEST_SIGNAL_STAMP_BYTES (16)
+
+/**
+ * @brief バンドの最大数
+ */
+#define TEST_SIGNAL_MAX_BANDS (16)
+
+/**
+ * @brief バンドの最小間隔[line]
+ *        割り込みで次の検出ラインを設定するまでに、次のラインが始まってしまわないようにする。
+ */
+#define TEST_SIGNAL_BAND_MIN_LINES (2)
+
+/**
+ * @brief テストパターン
+ */
+enum test_pattern
+{
+    TEST_PATTERN_SOLID = 0,     // 単色(テストデータ)
+    TEST_PATTERN_COLOR_BARS,    // カラーバー(BT.601 YUYV 8色)
+    TEST_PATTERN_H_RAMP,        // 水平ランプ
+    TEST_PATTERN_V_RAMP,        // 垂直ランプ(64バイト毎の階段状)
+    TEST_PATTERN_CHECKER,       // チェッカーボード
+    TEST_PATTERN_LINE_COUNTER,  // ラインカウンタ
+    TEST_PATTERN_BANDS,         // バンド(ライン検出割り込みで背景色を切り替える)
+    TEST_PATTERN_COUNT,         // テストパターン数
+};
+
+/**
+ * @brief テスト信号のタイミング
+ *        ループバックでは1ピクセルクロックがキャプチャデータの1バイトになる。
+ */
+struct test_signal_timing
+{
+    uint16_t hactive;        // 水平有効期間[pixel clock]
+    uint16_t hfp;            // 水平フロントポーチ[pixel clock]
+    uint16_t hsync;          // 水平同期幅[pixel clock]
+    uint16_t hbp;            // 水平バックポーチ[pixel clock]
+    uint16_t vactive;        // 垂直有効期間[line]
+    uint16_t vfp;            // 垂直フロントポーチ[line]
+    uint16_t vsync;          // 垂直同期幅[line]
+    uint16_t vbp;            // 垂直バックポーチ[line]
+    uint32_t pixel_clock_hz; // ピクセルクロック[Hz]
+    bool is_hsync_hactive;   // HSync極性(true:H-Active, false:L-Active)
+    bool is_vsync_hactive;   // VSync極性(true:H-Active, false:L-Active)
+};
+
+/**
+ * @brief バンド
+ *        有効表示領域の line ライン目から、次のバンドの手前まで value になる。
+ *        最初のバンドより上はテストデータの値になる。
+ */
+struct test_signal_band
+{
+    uint16_t line; // 開始ライン(有効表示領域先頭からのライン番号)
+    uint8_t value; // 値
+};
+
+/**
+ * @brief テスト信号のタイミングプロファイル
+ *        ピクセルクロックは PLLクロック(240MHz) / clock_div になる。
+ */
+struct test_signal_profile
+{
+    const char* name;  // プロファイル名
+    uint16_t hactive;  // 水平有効期間[pixel clock] (最大1280)
+    uint16_t hfp;      // 水平フロントポーチ[pixel clock]
+    uint16_t hsync;    // 水平同期幅[pixel clock]
+    uint16_t hbp;      // 水平バックポーチ[pixel clock]
+    uint16_t vactive;  // 垂直有効期間[line] (最大480)
+    uint16_t vfp;      // 垂直フロントポーチ[line]
+    uint16_t vsync;    // 垂直同期幅[line]
+    uint16_t vbp;      // 垂直バックポーチ[line]
+    uint8_t clock_div; // パネルクロック分周比
+};
+
 void test_signal_init(void);
 bool test_signal_set_output(bool is_output);
 bool test_signal_is_output(void);
+void test_signal_get_timing(struct test_signal_timing* ptiming);
+
+int test_signal_get_profile_count(void);
+const struct test_signal_profile* test_signal_get_profile_at(int index);
+const struct test_signal_profile* test_signal_find_profile(const char* name);
+bool test_signal_set_profile(const struct test_signal_profile* pprofile);
+const struct test_signal_profile* test_signal_get_profile(void);
 
 bool test_signal_set_data(uint8_t data);
 uint8_t test_signal_get_data(void);
 
+bool test_signal_set_pattern(enum test_pattern pattern);
+enum test_pattern test_signal_get_pattern(void);
+const char* test_signal_get_pattern_name(enum test_pattern pattern);
+bool test_signal_find_pattern(const char* name, enum test_pattern* ppattern);
+uint8_t test_signal_get_pattern_value(enum test_pattern pattern, uint16_t x, uint16_t y);
+
+bool test_signal_set_stamp(bool is_enabled);
+bool test_signal_is_stamp_enabled(void);
+uint32_t test_signal_get_frame_seq(void);
+bool test_signal_decode_stamp(const uint8_t* pdata, uint32_t len, uint32_t* pseq);
+
+bool test_signal_start_preview(const uint8_t* pbuf, uint16_t width, uint16_t height, bool is_rgb565);
+bool test_signal_show_preview(const uint8_t* pbuf);
+bool test_signal_is_preview_pending(void);
+bool test_signal_stop_preview(void);
+bool test_signal_is_preview(void);
+
+bool test_signal_set_bands(const struct test_signal_band* pbands, int count);
+int test_signal_get_bands(const struct test_signal_band** ppbands);
+
 #endif /* TEST_SIGNAL_H_ */
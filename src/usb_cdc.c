@@ -41,6 +41,9 @@
 #include <stddef.h>
 #include <string.h>
 
+#include "hwtick.h"
+#include "usb_cdc.h"
+
 /**
  * @brief USB Vendor ID (libusb共用ID)
  */
@@ -878,3 +881,39 @@ int usb_cdc_write(const void* data, uint16_t length)
 
     return retval;
 }
+
+/**
+ * @brief 送信データを全て送信キューに書き込むまで送信する。書き込めるまで呼び出し元をブロックする。
+ *        相手が切断した(DSR=0)場合, タイムアウトした場合は途中で戻る。
+ * @param data 送信データのアドレス
+ * @param length 送信データ長
+ * @param timeout_millis タイムアウト時間[ミリ秒]
+ * @return 送信キューに書き込んだバイト数が返る。途中で戻った場合は length より小さくなる。
+ */
+uint32_t usb_cdc_write_blocking(const void* data, uint32_t length, uint32_t timeout_millis)
+{
+    const uint8_t* rp = (const uint8_t*)(data);
+    uint32_t sent = 0u;
+    uint32_t begin = hwtick_get();
+
+    while (sent < length)
+    {
+        uint32_t remain = length - sent;
+        int written = usb_cdc_write(rp + sent, (uint16_t)((remain > TX_QUEUE_SIZE) ? TX_QUEUE_SIZE : remain));
+        if (written < 0) // 送信キューがない(未接続)
+        {
+            break;
+        }
+        sent += (uint32_t)(written);
+        if (sent < length)
+        {
+            usb_cdc_update();
+            if (!usb_cdc_get_DSR() || ((hwtick_get() - begin) >= timeout_millis))
+            {
+                break;
+            }
+        }
+    }
+
+    return sent;
+}
@@ -7,6 +7,7 @@
 #define USB_CDC_H_
 
 #include <stdbool.h>
+#include <stdint.h>
 
 void usb_cdc_init(void);
 void usb_cdc_update(void);
@@ -16,5 +17,6 @@ bool usb_cdc_get_CTS(void);
 
 int usb_cdc_read(void* bufp, uint16_t bufsize);
 int usb_cdc_write(const void* data, uint16_t length);
+uint32_t usb_cdc_write_blocking(const void* data, uint32_t length, uint32_t timeout_millis);
 
 #endif /* USB_CDC_H_ */
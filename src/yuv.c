@@ -0,0 +1,678 @@
+/**
+ * @file YUV変換定義
+ *        YUV 4:2:2 (YUYV, 1ピクセル2バイト)のデータを扱う。
+ *        RGBへの変換は ITU-R BT.601 (Y: 16〜235, U/V: 16〜240)の係数を使用する。
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "yuv.h"
+
+#if defined(__RX_BIG_ENDIAN__)
+/**
+ * @brief 1ワード(Y0 U Y1 V)の輝度を16bitレーン2つに分ける。(上位レーン: Y0, 下位レーン: Y1)
+ */
+#define Y_LANES(w) (((w) >> 8) & 0x00FF00FFu)
+/**
+ * @brief 1ワード(Y0 U Y1 V)の色差を16bitレーン2つに分ける。(上位レーン: U, 下位レーン: V)
+ */
+#define C_LANES(w) ((w) & 0x00FF00FFu)
+/**
+ * @brief 輝度2つと色差レーンから1ワード(Y0 U Y1 V)を組み立てる。
+ */
+#define PACK_YUYV(y0, y1, c) (((y0) << 24) | ((y1) << 8) | (c))
+/**
+ * @brief 色差レーンからUを取り出す。
+ */
+#define C_LANE_U(c) ((c) >> 16)
+/**
+ * @brief 色差レーンからVを取り出す。
+ */
+#define C_LANE_V(c) ((c) & 0xFFFFu)
+/**
+ * @brief 輝度レーンからY0を取り出す。
+ */
+#define Y_LANE_0(y) ((y) >> 16)
+/**
+ * @brief 輝度レーンからY1を取り出す。
+ */
+#define Y_LANE_1(y) ((y) & 0xFFFFu)
+/**
+ * @brief RGB565の2ピクセルを1ワードにする。(メモリ上はピクセル0, ピクセル1の順)
+ */
+#define PACK_RGB565(p0, p1) (((p0) << 16) | (p1))
+/**
+ * @brief 4バイトを1ワードにする。(メモリ上は b0, b1, b2, b3 の順)
+ */
+#define PACK_BYTES(b0, b1, b2, b3) (((b0) << 24) | ((b1) << 16) | ((b2) << 8) | (b3))
+#else
+/**
+ * @brief 1ワード(Y0 U Y1 V)の輝度を16bitレーン2つに分ける。(下位レーン: Y0, 上位レーン: Y1)
+ */
+#define Y_LANES(w) ((w) & 0x00FF00FFu)
+/**
+ * @brief 1ワード(Y0 U Y1 V)の色差を16bitレーン2つに分ける。(下位レーン: U, 上位レーン: V)
+ */
+#define C_LANES(w) (((w) >> 8) & 0x00FF00FFu)
+/**
+ * @brief 輝度2つと色差レーンから1ワード(Y0 U Y1 V)を組み立てる。
+ */
+#define PACK_YUYV(y0, y1, c) ((y0) | ((y1) << 16) | ((c) << 8))
+/**
+ * @brief 色差レーンからUを取り出す。
+ */
+#define C_LANE_U(c) ((c) & 0xFFFFu)
+/**
+ * @brief 色差レーンからVを取り出す。
+ */
+#define C_LANE_V(c) ((c) >> 16)
+/**
+ * @brief 輝度レーンからY0を取り出す。
+ */
+#define Y_LANE_0(y) ((y) & 0xFFFFu)
+/**
+ * @brief 輝度レーンからY1を取り出す。
+ */
+#define Y_LANE_1(y) ((y) >> 16)
+/**
+ * @brief RGB565の2ピクセルを1ワードにする。(メモリ上はピクセル0, ピクセル1の順)
+ */
+#define PACK_RGB565(p0, p1) ((p0) | ((p1) << 16))
+/**
+ * @brief 4バイトを1ワードにする。(メモリ上は b0, b1, b2, b3 の順)
+ */
+#define PACK_BYTES(b0, b1, b2, b3) ((b0) | ((b1) << 8) | ((b2) << 16) | ((b3) << 24))
+#endif
+
+/**
+ * @brief 色差の合計を16bitレーンのまま足し込めるワード数(255 * 256 < 65536)
+ */
+#define STATS_LANE_WORDS (256u)
+
+/**
+ * @brief RGB変換テーブルの小数部のビット数
+ */
+#define RGB_FRAC_BITS (6)
+
+/**
+ * @brief RGB変換の飽和テーブルのオフセット(負の値を正のインデックスにする)
+ *        輝度と色差の項の和は -277〜534 になる。
+ */
+#define RGB_CLAMP_BIAS (288)
+
+/**
+ * @brief RGB変換の飽和テーブルのサイズ
+ */
+#define RGB_CLAMP_SIZE (832u)
+
+/**
+ * @brief RGB変換係数(Q16)
+ */
+#define COEF_Y (76309)   // 1.164383 (255 / 219)
+#define COEF_RV (104597) // 1.596027
+#define COEF_GU (25675)  // 0.391762
+#define COEF_GV (53279)  // 0.812968
+#define COEF_BU (132201) // 2.017232
+
+/**
+ * @brief 合焦評価値を32bitのまま足し込めるワード数
+ *        (ラプラシアンの2乗は1ワード(2ピクセル)あたり最大 2 * 1020^2 のため、1024ワードで 2^32 未満)
+ */
+#define FOCUS_CHUNK_WORDS (1024u)
+
+static void init_rgb_tables(void);
+
+/**
+ * @brief RGB変換テーブルを作成済みかどうか
+ */
+static bool s_is_rgb_ready;
+
+/**
+ * @brief 輝度の項((Y - 16) * COEF_Y + RGB_CLAMP_BIAS + 0.5, 小数部 RGB_FRAC_BITS ビット)
+ */
+static uint16_t s_rgb_y[256];
+
+/**
+ * @brief Rの色差の項((V - 128) * COEF_RV)
+ */
+static int16_t s_rgb_rv[256];
+
+/**
+ * @brief Gの色差の項(-(U - 128) * COEF_GU)
+ */
+static int16_t s_rgb_gu[256];
+
+/**
+ * @brief Gの色差の項(-(V - 128) * COEF_GV)
+ */
+static int16_t s_rgb_gv[256];
+
+/**
+ * @brief Bの色差の項((U - 128) * COEF_BU)
+ */
+static int16_t s_rgb_bu[256];
+
+/**
+ * @brief 飽和テーブル(0〜255)
+ */
+static uint8_t s_rgb_clamp[RGB_CLAMP_SIZE];
+
+/**
+ * @brief 飽和テーブル(RGB565のRの位置)
+ */
+static uint16_t s_rgb565_r[RGB_CLAMP_SIZE];
+
+/**
+ * @brief 飽和テーブル(RGB565のGの位置)
+ */
+static uint16_t s_rgb565_g[RGB_CLAMP_SIZE];
+
+/**
+ * @brief 飽和テーブル(RGB565のBの位置)
+ */
+static uint16_t s_rgb565_b[RGB_CLAMP_SIZE];
+
+/**
+ * @brief YUYVデータから輝度(Y)だけを取り出す。
+ *        4バイト(Y0 U Y1 V)から2バイト(Y0 Y1)を取り出すため、出力は入力の半分のサイズになる。
+ *        pdst と psrc が4バイト境界にある場合は、2ワード(8バイト)読んで1ワード書く。
+ *        出力位置は常に入力位置より前になるため、pdst == psrc としてその場で変換できる。
+ * @param pdst 出力先
+ * @param psrc YUYVデータ
+ * @param len YUYVデータのサイズ[byte] (2の倍数)
+ * @return 出力したサイズ[byte]
+ */
+uint32_t yuv_extract_y(uint8_t* pdst, const uint8_t* psrc, uint32_t len)
+{
+    uint32_t offset = 0u;
+
+    if (((((uintptr_t)(pdst)) | ((uintptr_t)(psrc))) & 0x3u) == 0u)
+    {
+        const uint32_t* ps = (const uint32_t*)(psrc);
+        uint32_t* pd = (uint32_t*)(pdst);
+        for (uint32_t n = len / 8u; n > 0u; n--)
+        {
+            uint32_t w0 = ps[0];
+            uint32_t w1 = ps[1];
+            ps += 2;
+#if defined(__RX_BIG_ENDIAN__)
+            // w0 = Y0:U0:Y1:V0 (上位から)
+            (*pd) = (w0 & 0xFF000000u) | ((w0 << 8) & 0x00FF0000u) | ((w1 >> 16) & 0x0000FF00u) | ((w1 >> 8) & 0x000000FFu);
+#else
+            // w0 = V0:Y1:U0:Y0 (上位から)
+            (*pd) = (w0 & 0x000000FFu) | ((w0 >> 8) & 0x0000FF00u) | ((w1 << 16) & 0x00FF0000u) | ((w1 << 8) & 0xFF000000u);
+#endif
+            pd++;
+        }
+        offset = (len / 8u) * 8u;
+    }
+
+    for (; (offset + 1u) < len; offset += 2u)
+    {
+        pdst[offset / 2u] = psrc[offset];
+    }
+
+    return len / 2u;
+}
+
+/**
+ * @brief YUYVデータを factor x factor ピクセルの平均(ボックスフィルタ)で縮小し、1ライン分を出力する。
+ *        入力の factor ライン x 2*factor ピクセル(factor ワード)から、出力の2ピクセル(1ワード)を生成する。
+ *        輝度, 色差をそれぞれ16bitレーン2つに分けて、ワード単位で加算する。(1レーンの最大値は 16 * 255)
+ *        出力位置は常に入力位置より前になるため、pdst を入力の先頭ライン以前に置けば、その場で縮小できる。
+ * @param pdst 出力先(4バイト境界)
+ * @param psrc 入力の先頭ライン(4バイト境界)
+ * @param src_stride 入力のライン間隔[byte] (4の倍数)
+ * @param width 入力の1ラインのピクセル数(2*factor の倍数)
+ * @param factor 縮小率(2 または 4)
+ * @return 成功した場合にはtrue, 引数が不正な場合にはfalse.
+ */
+bool yuv_bin_line(uint8_t* pdst, const uint8_t* psrc, uint32_t src_stride, uint16_t width, uint8_t factor)
+{
+    if (((factor != 2u) && (factor != 4u)) || ((width % (2u * factor)) != 0u)
+            || (((((uintptr_t)(pdst)) | ((uintptr_t)(psrc)) | src_stride) & 0x3u) != 0u))
+    {
+        return false;
+    }
+
+    const uint32_t shift = (factor == 2u) ? 2u : 4u; // factor * factor で割る。
+    const uint32_t round = 1u << (shift - 1u);
+    const uint32_t half = factor / 2u; // 出力ピクセル1つ分の入力ワード数
+    const uint32_t src_stride_words = src_stride / sizeof(uint32_t);
+    uint32_t* pd = (uint32_t*)(pdst);
+
+    for (uint32_t x = 0u; x < ((uint32_t)(width) / 2u); x += factor)
+    {
+        const uint32_t* ps = ((const uint32_t*)(psrc)) + x;
+        uint32_t y0_lanes = 0u;
+        uint32_t y1_lanes = 0u;
+        uint32_t c_lanes = 0u;
+        for (uint32_t line = 0u; line < factor; line++)
+        {
+            for (uint32_t i = 0u; i < half; i++)
+            {
+                uint32_t w0 = ps[i];
+                uint32_t w1 = ps[half + i];
+                y0_lanes += Y_LANES(w0);
+                y1_lanes += Y_LANES(w1);
+                c_lanes += C_LANES(w0) + C_LANES(w1);
+            }
+            ps += src_stride_words;
+        }
+        // 2つのレーンを足し合わせて1ピクセル分の輝度にする。
+        uint32_t y0 = (((y0_lanes & 0xFFFFu) + (y0_lanes >> 16)) + round) >> shift;
+        uint32_t y1 = (((y1_lanes & 0xFFFFu) + (y1_lanes >> 16)) + round) >> shift;
+        uint32_t c = ((c_lanes + ((round << 16) | round)) >> shift) & 0x00FF00FFu;
+        (*pd) = PACK_YUYV(y0, y1, c);
+        pd++;
+    }
+
+    return true;
+}
+
+/**
+ * @brief YUYVデータの輝度だけを factor x factor ピクセルの平均で縮小し、1ライン分を出力する。(1ピクセル1バイト)
+ *        入力の factor ライン x factor ピクセル(factor / 2 ワード)から、出力の1ピクセルを生成する。
+ *        輝度を16bitレーン2つに分けて、ワード単位で加算する。
+ * @param pdst 出力先(width / factor バイト)
+ * @param psrc 入力の先頭ライン(4バイト境界)
+ * @param src_stride 入力のライン間隔[byte] (4の倍数)
+ * @param width 入力の1ラインのピクセル数(factor の倍数)
+ * @param factor 縮小率(2 または 4)
+ * @return 成功した場合にはtrue, 引数が不正な場合にはfalse.
+ */
+bool yuv_bin_y_line(uint8_t* pdst, const uint8_t* psrc, uint32_t src_stride, uint16_t width, uint8_t factor)
+{
+    if (((factor != 2u) && (factor != 4u)) || ((width % factor) != 0u) || (((((uintptr_t)(psrc)) | src_stride) & 0x3u) != 0u))
+    {
+        return false;
+    }
+
+    const uint32_t shift = (factor == 2u) ? 2u : 4u; // factor * factor で割る。
+    const uint32_t round = 1u << (shift - 1u);
+    const uint32_t half = factor / 2u; // 出力ピクセル1つ分の入力ワード数
+    const uint32_t src_stride_words = src_stride / sizeof(uint32_t);
+    const uint32_t* pline = (const uint32_t*)(psrc);
+
+    for (uint32_t x = 0u; x < ((uint32_t)(width) / 2u); x += half)
+    {
+        const uint32_t* ps = pline + x;
+        uint32_t y_lanes = 0u;
+        for (uint32_t line = 0u; line < factor; line++)
+        {
+            for (uint32_t i = 0u; i < half; i++)
+            {
+                y_lanes += Y_LANES(ps[i]);
+            }
+            ps += src_stride_words;
+        }
+        (*pdst) = (uint8_t)((((y_lanes & 0xFFFFu) + (y_lanes >> 16)) + round) >> shift);
+        pdst++;
+    }
+
+    return true;
+}
+
+/**
+ * @brief 統計情報をクリアする。
+ * @param pstats 統計情報
+ */
+void yuv_stats_clear(struct yuv_stats* pstats)
+{
+    memset(pstats, 0, sizeof(struct yuv_stats));
+    pstats->u_min = 0xFFu;
+    pstats->v_min = 0xFFu;
+
+    return;
+}
+
+/**
+ * @brief YUYVデータを統計情報に加える。
+ *        1ワード(2ピクセル)ずつ読み、輝度はヒストグラムだけを数える。(最小/最大, 合計, 飽和数は yuv_stats_finish() でヒストグラムから求める)
+ *        色差の合計は16bitレーン2つのまま足し込み、溢れる前に32bitの合計に移す。
+ * @param pstats 統計情報
+ * @param psrc YUYVデータ(4バイト境界)
+ * @param len YUYVデータのサイズ[byte] (4の倍数)
+ * @return 成功した場合にはtrue, 境界, サイズが不正な場合にはfalse.
+ */
+bool yuv_stats_add(struct yuv_stats* pstats, const uint8_t* psrc, uint32_t len)
+{
+    if (((((uintptr_t)(psrc)) & 0x3u) != 0u) || ((len & 0x3u) != 0u))
+    {
+        return false;
+    }
+
+    const uint32_t* ps = (const uint32_t*)(psrc);
+    uint32_t* phist = pstats->y_hist;
+    uint32_t u_min = pstats->u_min;
+    uint32_t u_max = pstats->u_max;
+    uint32_t v_min = pstats->v_min;
+    uint32_t v_max = pstats->v_max;
+    uint32_t words = len / 4u;
+    while (words > 0u)
+    {
+        uint32_t n = (words > STATS_LANE_WORDS) ? STATS_LANE_WORDS : words;
+        uint32_t c_sum = 0u;
+        words -= n;
+        for (; n > 0u; n--)
+        {
+            uint32_t w = *ps;
+            ps++;
+            uint32_t y = Y_LANES(w);
+            uint32_t c = C_LANES(w);
+            phist[y & 0xFFu]++;
+            phist[y >> 16]++;
+            c_sum += c;
+            uint32_t u = C_LANE_U(c);
+            uint32_t v = C_LANE_V(c);
+            u_min = (u < u_min) ? u : u_min;
+            u_max = (u > u_max) ? u : u_max;
+            v_min = (v < v_min) ? v : v_min;
+            v_max = (v > v_max) ? v : v_max;
+        }
+        pstats->u_sum += C_LANE_U(c_sum);
+        pstats->v_sum += C_LANE_V(c_sum);
+    }
+    pstats->u_min = (uint8_t)(u_min);
+    pstats->u_max = (uint8_t)(u_max);
+    pstats->v_min = (uint8_t)(v_min);
+    pstats->v_max = (uint8_t)(v_max);
+    pstats->pixels += len / 2u;
+
+    return true;
+}
+
+/**
+ * @brief 輝度ヒストグラムから、輝度の最小/最大, 合計, 飽和ピクセル数を求める。
+ * @param pstats 統計情報
+ */
+void yuv_stats_finish(struct yuv_stats* pstats)
+{
+    pstats->y_sum = 0u;
+    pstats->y_min = 0u;
+    pstats->y_max = 0u;
+    pstats->y_clip_low = 0u;
+    pstats->y_clip_high = 0u;
+    bool has_min = false;
+    for (uint32_t i = 0u; i < 256u; i++)
+    {
+        uint32_t count = pstats->y_hist[i];
+        if (count == 0u)
+        {
+            continue;
+        }
+        if (!has_min)
+        {
+            pstats->y_min = (uint8_t)(i);
+            has_min = true;
+        }
+        pstats->y_max = (uint8_t)(i);
+        pstats->y_sum += count * i;
+        if (i <= YUV_STATS_CLIP_LOW)
+        {
+            pstats->y_clip_low += count;
+        }
+        else if (i >= YUV_STATS_CLIP_HIGH)
+        {
+            pstats->y_clip_high += count;
+        }
+        else
+        {
+            // 範囲内
+        }
+    }
+    if (pstats->pixels == 0u)
+    {
+        pstats->u_min = 0u;
+        pstats->v_min = 0u;
+    }
+
+    return;
+}
+
+/**
+ * @brief 合焦評価値をクリアする。
+ * @param pfocus 合焦評価値
+ */
+void yuv_focus_clear(struct yuv_focus* pfocus)
+{
+    memset(pfocus, 0, sizeof(struct yuv_focus));
+
+    return;
+}
+
+/**
+ * @brief YUYVデータの1ラインのうち、x から width ピクセルの輝度を合焦評価値に加える。
+ *        上下のライン(pline - stride, pline + stride)と、左右1ワード(x - 2, x + width のピクセル)も読むため、
+ *        呼び出し元はそれらがフレーム内にあるようにする。
+ *        注目ライン, 上下のラインを1ワード(2ピクセル)ずつ読み、右隣のワードを先読みして左右のピクセルに使う。
+ *        整数演算だけで、ラインの途中では32bitで足し込み、FOCUS_CHUNK_WORDS ワード毎に64bitの合計に移す。
+ * @param pfocus 合焦評価値
+ * @param pline 注目ラインの先頭(4バイト境界)
+ * @param stride ライン間隔[byte] (4の倍数)
+ * @param x 開始ピクセル位置(2以上の偶数)
+ * @param width ピクセル数(2以上の偶数)
+ * @return 成功した場合にはtrue, 引数が不正な場合にはfalse.
+ */
+bool yuv_focus_add_line(struct yuv_focus* pfocus, const uint8_t* pline, uint32_t stride, uint16_t x, uint16_t width)
+{
+    if ((x < 2u) || (width == 0u) || ((((uint32_t)(x) | width) & 0x1u) != 0u)
+        || (((((uintptr_t)(pline)) | stride) & 0x3u) != 0u))
+    {
+        return false;
+    }
+
+    const uint32_t stride_words = stride / sizeof(uint32_t);
+    const uint32_t* pc = ((const uint32_t*)(pline)) + (x / 2u);
+    const uint32_t* pu = pc - stride_words;
+    const uint32_t* pd = pc + stride_words;
+    int32_t left = (int32_t)(Y_LANE_1(Y_LANES(pc[-1])));
+    uint32_t cur = Y_LANES(pc[0]);
+    uint32_t words = (uint32_t)(width) / 2u;
+    while (words > 0u)
+    {
+        uint32_t n = (words > FOCUS_CHUNK_WORDS) ? FOCUS_CHUNK_WORDS : words;
+        uint32_t gradient = 0u;
+        int32_t laplacian = 0;
+        uint32_t laplacian_sq = 0u;
+        words -= n;
+        for (; n > 0u; n--)
+        {
+            uint32_t next = Y_LANES(pc[1]);
+            uint32_t up = Y_LANES(*pu);
+            uint32_t down = Y_LANES(*pd);
+            pc++;
+            pu++;
+            pd++;
+            int32_t c0 = (int32_t)(Y_LANE_0(cur));
+            int32_t c1 = (int32_t)(Y_LANE_1(cur));
+            int32_t right = (int32_t)(Y_LANE_0(next));
+            int32_t d0 = (int32_t)(Y_LANE_0(down));
+            int32_t d1 = (int32_t)(Y_LANE_1(down));
+            int32_t dx0 = c1 - c0;
+            int32_t dy0 = d0 - c0;
+            int32_t dx1 = right - c1;
+            int32_t dy1 = d1 - c1;
+            int32_t l0 = (4 * c0) - left - c1 - (int32_t)(Y_LANE_0(up)) - d0;
+            int32_t l1 = (4 * c1) - c0 - right - (int32_t)(Y_LANE_1(up)) - d1;
+            gradient += (uint32_t)((dx0 * dx0) + (dy0 * dy0) + (dx1 * dx1) + (dy1 * dy1));
+            laplacian += l0 + l1;
+            laplacian_sq += (uint32_t)((l0 * l0) + (l1 * l1));
+            left = c1;
+            cur = next;
+        }
+        pfocus->gradient_sum += gradient;
+        pfocus->laplacian_sum += laplacian;
+        pfocus->laplacian_sq_sum += laplacian_sq;
+    }
+    pfocus->pixels += width;
+
+    return true;
+}
+
+/**
+ * @brief 合計から、1ピクセルあたりの勾配エネルギーとラプラシアンの分散を求める。
+ * @param pfocus 合焦評価値
+ */
+void yuv_focus_finish(struct yuv_focus* pfocus)
+{
+    if (pfocus->pixels == 0u)
+    {
+        pfocus->gradient = 0u;
+        pfocus->laplacian_var = 0u;
+        return;
+    }
+
+    // 分散 = (2乗の合計 - 平均 * 合計) / ピクセル数
+    int64_t mean = pfocus->laplacian_sum / (int64_t)(pfocus->pixels);
+    int64_t deviation = (int64_t)(pfocus->laplacian_sq_sum) - (mean * pfocus->laplacian_sum);
+    pfocus->gradient = (uint32_t)(pfocus->gradient_sum / pfocus->pixels);
+    pfocus->laplacian_var = (deviation > 0) ? (uint32_t)((uint64_t)(deviation) / pfocus->pixels) : 0u;
+
+    return;
+}
+
+/**
+ * @brief YUYVデータをRGB565(1ピクセル16bit, CPUのバイトオーダー)に変換する。
+ *        1ワード(Y0 U Y1 V)を読み、テーブル参照と加算だけで2ピクセルを求めて1ワードで書く。
+ *        出力は入力と同じサイズのため、pdst == psrc としてその場で変換できる。
+ * @param pdst 出力先(4バイト境界)
+ * @param psrc YUYVデータ(4バイト境界)
+ * @param len YUYVデータのサイズ[byte] (4の倍数)
+ * @return 出力したサイズ[byte]。引数が不正な場合は0.
+ */
+uint32_t yuv_to_rgb565(uint8_t* pdst, const uint8_t* psrc, uint32_t len)
+{
+    if (((((uintptr_t)(pdst)) | ((uintptr_t)(psrc)) | len) & 0x3u) != 0u)
+    {
+        return 0u;
+    }
+    if (!s_is_rgb_ready)
+    {
+        init_rgb_tables();
+    }
+
+    const uint32_t* ps = (const uint32_t*)(psrc);
+    uint32_t* pd = (uint32_t*)(pdst);
+    for (uint32_t n = len / 4u; n > 0u; n--)
+    {
+        uint32_t w = *ps;
+        ps++;
+        uint32_t y = Y_LANES(w);
+        uint32_t c = C_LANES(w);
+        uint32_t u = C_LANE_U(c);
+        uint32_t v = C_LANE_V(c);
+        int32_t rv = s_rgb_rv[v];
+        int32_t guv = s_rgb_gu[u] + s_rgb_gv[v];
+        int32_t bu = s_rgb_bu[u];
+        int32_t y0 = s_rgb_y[Y_LANE_0(y)];
+        int32_t y1 = s_rgb_y[Y_LANE_1(y)];
+        uint32_t p0 = (uint32_t)(s_rgb565_r[(uint32_t)(y0 + rv) >> RGB_FRAC_BITS]) | s_rgb565_g[(uint32_t)(y0 + guv) >> RGB_FRAC_BITS]
+                      | s_rgb565_b[(uint32_t)(y0 + bu) >> RGB_FRAC_BITS];
+        uint32_t p1 = (uint32_t)(s_rgb565_r[(uint32_t)(y1 + rv) >> RGB_FRAC_BITS]) | s_rgb565_g[(uint32_t)(y1 + guv) >> RGB_FRAC_BITS]
+                      | s_rgb565_b[(uint32_t)(y1 + bu) >> RGB_FRAC_BITS];
+        (*pd) = PACK_RGB565(p0, p1);
+        pd++;
+    }
+
+    return len;
+}
+
+/**
+ * @brief YUYVデータをRGB888(1ピクセル3バイト, R, G, B の順)に変換する。
+ *        2ワード(4ピクセル)を読み、12バイトを3ワードで書く。
+ *        出力は入力の1.5倍のサイズになるため、その場では変換できない。
+ * @param pdst 出力先(4バイト境界, len / 2 * 3 バイト)
+ * @param psrc YUYVデータ(4バイト境界)
+ * @param len YUYVデータのサイズ[byte] (4の倍数)
+ * @return 出力したサイズ[byte]。引数が不正な場合は0.
+ */
+uint32_t yuv_to_rgb888(uint8_t* pdst, const uint8_t* psrc, uint32_t len)
+{
+    if (((((uintptr_t)(pdst)) | ((uintptr_t)(psrc)) | len) & 0x3u) != 0u)
+    {
+        return 0u;
+    }
+    if (!s_is_rgb_ready)
+    {
+        init_rgb_tables();
+    }
+
+    const uint32_t* ps = (const uint32_t*)(psrc);
+    uint32_t* pd = (uint32_t*)(pdst);
+    uint32_t words = len / 4u;
+    while (words > 0u)
+    {
+        uint32_t rgb[12]; // R0 G0 B0 R1 G1 B1 R2 G2 B2 R3 G3 B3
+        uint32_t n = (words >= 2u) ? 2u : 1u;
+        for (uint32_t i = 0u; i < n; i++)
+        {
+            uint32_t w = ps[i];
+            uint32_t y = Y_LANES(w);
+            uint32_t c = C_LANES(w);
+            uint32_t u = C_LANE_U(c);
+            uint32_t v = C_LANE_V(c);
+            int32_t rv = s_rgb_rv[v];
+            int32_t guv = s_rgb_gu[u] + s_rgb_gv[v];
+            int32_t bu = s_rgb_bu[u];
+            int32_t y0 = s_rgb_y[Y_LANE_0(y)];
+            int32_t y1 = s_rgb_y[Y_LANE_1(y)];
+            uint32_t* prgb = &(rgb[i * 6u]);
+            prgb[0] = s_rgb_clamp[(uint32_t)(y0 + rv) >> RGB_FRAC_BITS];
+            prgb[1] = s_rgb_clamp[(uint32_t)(y0 + guv) >> RGB_FRAC_BITS];
+            prgb[2] = s_rgb_clamp[(uint32_t)(y0 + bu) >> RGB_FRAC_BITS];
+            prgb[3] = s_rgb_clamp[(uint32_t)(y1 + rv) >> RGB_FRAC_BITS];
+            prgb[4] = s_rgb_clamp[(uint32_t)(y1 + guv) >> RGB_FRAC_BITS];
+            prgb[5] = s_rgb_clamp[(uint32_t)(y1 + bu) >> RGB_FRAC_BITS];
+        }
+        ps += n;
+        words -= n;
+        if (n == 2u)
+        {
+            pd[0] = PACK_BYTES(rgb[0], rgb[1], rgb[2], rgb[3]);
+            pd[1] = PACK_BYTES(rgb[4], rgb[5], rgb[6], rgb[7]);
+            pd[2] = PACK_BYTES(rgb[8], rgb[9], rgb[10], rgb[11]);
+            pd += 3;
+        }
+        else
+        {
+            uint8_t* pb = (uint8_t*)(pd); // 最後の1ワード(2ピクセル)
+            for (uint32_t i = 0u; i < 6u; i++)
+            {
+                pb[i] = (uint8_t)(rgb[i]);
+            }
+        }
+    }
+
+    return (len / 2u) * 3u;
+}
+
+/**
+ * @brief RGB変換テーブルを作成する。(整数演算のみ)
+ */
+static void init_rgb_tables(void)
+{
+    for (int32_t i = 0; i < 256; i++)
+    {
+        int32_t c = i - 128;
+        // 輝度の項にオフセットと丸め(0.5)を含め、和が常に正になるようにする。
+        s_rgb_y[i] = (uint16_t)((((i - 16) * COEF_Y) + (RGB_CLAMP_BIAS << 16) + (1 << 15)) / (1 << (16 - RGB_FRAC_BITS)));
+        s_rgb_rv[i] = (int16_t)((c * COEF_RV) / (1 << (16 - RGB_FRAC_BITS)));
+        s_rgb_gu[i] = (int16_t)((-c * COEF_GU) / (1 << (16 - RGB_FRAC_BITS)));
+        s_rgb_gv[i] = (int16_t)((-c * COEF_GV) / (1 << (16 - RGB_FRAC_BITS)));
+        s_rgb_bu[i] = (int16_t)((c * COEF_BU) / (1 << (16 - RGB_FRAC_BITS)));
+    }
+    for (uint32_t i = 0u; i < RGB_CLAMP_SIZE; i++)
+    {
+        int32_t value = (int32_t)(i) - RGB_CLAMP_BIAS;
+        uint32_t clamped = (value < 0) ? 0u : ((value > 255) ? 255u : (uint32_t)(value));
+        s_rgb_clamp[i] = (uint8_t)(clamped);
+        s_rgb565_r[i] = (uint16_t)((clamped >> 3) << 11);
+        s_rgb565_g[i] = (uint16_t)((clamped >> 2) << 5);
+        s_rgb565_b[i] = (uint16_t)(clamped >> 3);
+    }
+    s_is_rgb_ready = true;
+
+    return;
+}
@@ -0,0 +1,68 @@
+/**
+ * @file YUV変換のインタフェース宣言
+ * @author Cosmosweb Co.,Ltd. 2024
+ */
+
+#ifndef YUV_H_
+#define YUV_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief 輝度が黒側で飽和しているとみなす値(この値以下, ITU-R BT.601 の黒レベル)
+ */
+#define YUV_STATS_CLIP_LOW (16)
+
+/**
+ * @brief 輝度が白側で飽和しているとみなす値(この値以上, ITU-R BT.601 の白レベル)
+ */
+#define YUV_STATS_CLIP_HIGH (235)
+
+/**
+ * @brief YUYVデータの統計情報
+ */
+struct yuv_stats
+{
+    uint32_t y_hist[256]; // 輝度ヒストグラム
+    uint32_t pixels;      // ピクセル数(U, V のサンプル数はこの半分)
+    uint32_t y_sum;       // 輝度の合計
+    uint32_t u_sum;       // Uの合計
+    uint32_t v_sum;       // Vの合計
+    uint8_t y_min;        // 輝度の最小値
+    uint8_t y_max;        // 輝度の最大値
+    uint8_t u_min;        // Uの最小値
+    uint8_t u_max;        // Uの最大値
+    uint8_t v_min;        // Vの最小値
+    uint8_t v_max;        // Vの最大値
+    uint32_t y_clip_low;  // 輝度が YUV_STATS_CLIP_LOW 以下のピクセル数
+    uint32_t y_clip_high; // 輝度が YUV_STATS_CLIP_HIGH 以上のピクセル数
+};
+
+/**
+ * @brief 合焦評価値(ROI内の輝度の鮮鋭度)
+ *        勾配エネルギー, ラプラシアンの分散とも、ピントが合うほど大きくなる。
+ */
+struct yuv_focus
+{
+    uint32_t pixels;           // 評価したピクセル数
+    uint64_t gradient_sum;     // 勾配エネルギー((右隣 - 注目)^2 + (下隣 - 注目)^2)の合計
+    int64_t laplacian_sum;     // ラプラシアン(4 * 注目 - 上下左右)の合計
+    uint64_t laplacian_sq_sum; // ラプラシアンの2乗の合計
+    uint32_t gradient;         // 1ピクセルあたりの勾配エネルギー(yuv_focus_finish() で求める)
+    uint32_t laplacian_var;    // ラプラシアンの分散(yuv_focus_finish() で求める)
+};
+
+uint32_t yuv_extract_y(uint8_t* pdst, const uint8_t* psrc, uint32_t len);
+bool yuv_bin_line(uint8_t* pdst, const uint8_t* psrc, uint32_t src_stride, uint16_t width, uint8_t factor);
+bool yuv_bin_y_line(uint8_t* pdst, const uint8_t* psrc, uint32_t src_stride, uint16_t width, uint8_t factor);
+void yuv_stats_clear(struct yuv_stats* pstats);
+bool yuv_stats_add(struct yuv_stats* pstats, const uint8_t* psrc, uint32_t len);
+void yuv_stats_finish(struct yuv_stats* pstats);
+uint32_t yuv_to_rgb565(uint8_t* pdst, const uint8_t* psrc, uint32_t len);
+uint32_t yuv_to_rgb888(uint8_t* pdst, const uint8_t* psrc, uint32_t len);
+void yuv_focus_clear(struct yuv_focus* pfocus);
+bool yuv_focus_add_line(struct yuv_focus* pfocus, const uint8_t* pline, uint32_t stride, uint16_t x, uint16_t width);
+void yuv_focus_finish(struct yuv_focus* pfocus);
+
+#endif /* YUV_H_ */